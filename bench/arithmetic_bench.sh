@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Evaluations per second of `$((...))`, which `my_shell` evaluates by itself,
+# against `$(expr ...)`, which forks `expr` for every evaluation. The
+# evaluations are the `x=...` lines of a generated script fed to `stdin`.
+
+evals=${BENCH_EVALS:-100000}
+# forking is much slower, fewer evaluations give the same precision
+expr_evals=${BENCH_EXPR_EVALS:-2000}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+bash_path=$(command -v bash)
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+# writes `count` copies of the `line` and a final `echo $x` into the `file`
+generate_script() {
+    local line=$1 count=$2 file=$3
+    yes "$line" | head -n "$count" > "$file"
+    echo 'echo $x' >> "$file"
+}
+
+generate_script 'x=$((x + 1))' "$evals" "$tmp_dir/arithmetic"
+generate_script 'x=$((x * 3 + (x >> 2) % 7 - 1))' "$evals" "$tmp_dir/complex"
+generate_script 'x=$(expr $x + 1)' "$expr_evals" "$tmp_dir/expr"
+
+# prints the best wall time of the `runs` in nanoseconds
+measure() {
+    local sh=$1 script=$2 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        "$sh" < "$script" > /dev/null
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+# prints the evaluations per second
+rate() {
+    echo $(( $2 * 1000000000 / $(measure "$1" "$3") ))
+}
+
+printf 'best of %d runs\n\n' "$runs"
+printf '%-45s %14s %14s\n' "case" "my_shell ev/s" "bash ev/s"
+printf '%-45s %14d %14d\n' 'x=$((x + 1))' \
+    "$(rate "$shell" "$evals" "$tmp_dir/arithmetic")" \
+    "$(rate "$bash_path" "$evals" "$tmp_dir/arithmetic")"
+printf '%-45s %14d %14d\n' 'x=$((x * 3 + (x >> 2) % 7 - 1))' \
+    "$(rate "$shell" "$evals" "$tmp_dir/complex")" \
+    "$(rate "$bash_path" "$evals" "$tmp_dir/complex")"
+printf '%-45s %14d %14d\n' 'x=$(expr $x + 1)' \
+    "$(rate "$shell" "$expr_evals" "$tmp_dir/expr")" \
+    "$(rate "$bash_path" "$expr_evals" "$tmp_dir/expr")"
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+# Wall time of a foreground command while background jobs keep every CPU
+# busy: the jobs started as usual, and with `set -o bgnice` under the batch
+# and the idle scheduling policies.
+
+hogs=${BENCH_HOGS:-$(( $(nproc) * 2 ))}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+
+tmp_dir=$(mktemp -d)
+trap 'pkill -f "$tmp_dir/hog"; rm -rf "$tmp_dir"' EXIT
+
+cp "$(command -v yes)" "$tmp_dir/hog"
+# the foreground command prints its own wall time in milliseconds
+cat > "$tmp_dir/foreground" <<'SCRIPT'
+#!/usr/bin/env bash
+start=$(date +%s%N)
+for ((i = 0; i < 200000; i++)); do :; done
+echo $(( ($(date +%s%N) - start) / 1000000 ))
+SCRIPT
+chmod +x "$tmp_dir/foreground"
+
+# prints the best time of the foreground command of the `runs`, each one
+# run by a shell whose background jobs are set up by the `setup` lines
+measure() {
+    local setup=$1 best="" i j
+    for ((i = 0; i < runs; i++)); do
+        local script="$setup"$'\n'
+        for ((j = 0; j < hogs; j++)); do
+            script+="$tmp_dir/hog > /dev/null &"$'\n'
+        done
+        script+="$tmp_dir/foreground"$'\n'
+        local elapsed
+        printf '%s' "$script" > "$tmp_dir/script"
+        elapsed=$("$shell" "$tmp_dir/script")
+        pkill -f "$tmp_dir/hog"
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+printf '%d background jobs, %d CPUs, best of %d runs\n\n' \
+    "$hogs" "$(nproc)" "$runs"
+printf '%-36s %8s\n' "background jobs" "ms"
+printf '%-36s %8d\n' "none" "$(hogs=0 measure "")"
+printf '%-36s %8d\n' "as usual" "$(measure "")"
+printf '%-36s %8d\n' "bgnice, batch, nice +10" \
+    "$(measure "set -o bgnice")"
+printf '%-36s %8d\n' "bgnice, idle, I/O idle" \
+    "$(measure $'set -o bgnice\nMY_SHELL_BG_SCHED=idle\nMY_SHELL_BG_IOPRIO=idle')"
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+# Throughput of the `cat` and `tee` builtins against the coreutils ones.
+# Every case is run by `my_shell` twice: once with the builtin (`cat`) and
+# once with the external program (`/bin/cat`), so only the copying differs.
+
+size_mb=${BENCH_SIZE_MB:-256}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+cat_path=$(command -v cat)
+tee_path=$(command -v tee)
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+input="$tmp_dir/input"
+head -c "$((size_mb * 1024 * 1024))" /dev/urandom > "$input"
+
+cases=(
+    "CAT file | wc -c > /dev/null"
+    "CAT file > out"
+    "CAT file | CAT | CAT > out"
+    "CAT file | TEE log > out"
+    "CAT file | TEE log log2 | wc -c > /dev/null"
+)
+
+# prints the best wall time of the `runs` in seconds
+measure() {
+    local cmd=$1 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        (cd "$tmp_dir" && "$OLDPWD/$shell" <<< "$cmd" > /dev/null)
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+cp "$input" "$tmp_dir/file"
+printf 'input size: %d MB, best of %d runs\n\n' "$size_mb" "$runs"
+printf '%-45s %12s %12s\n' "case" "builtin MB/s" "coreutils MB/s"
+for case in "${cases[@]}"; do
+    builtin_cmd=${case//CAT/cat}
+    builtin_cmd=${builtin_cmd//TEE/tee}
+    external_cmd=${case//CAT/$cat_path}
+    external_cmd=${external_cmd//TEE/$tee_path}
+    builtin_ns=$(measure "$builtin_cmd")
+    external_ns=$(measure "$external_cmd")
+    printf '%-45s %12d %12d\n' "$builtin_cmd" \
+        "$(( size_mb * 1000000000 / builtin_ns ))" \
+        "$(( size_mb * 1000000000 / external_ns ))"
+done
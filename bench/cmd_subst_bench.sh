@@ -0,0 +1,51 @@
+#!/usr/bin/env bash
+# Cost of substituting a large output with `$(...)` in `my_shell` against
+# `bash`. Every case is a single command line whose argument is built from
+# the output of `cat`, so the time is spent capturing and splitting it.
+
+size_mb=${BENCH_SIZE_MB:-16}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+bash_path=$(command -v bash)
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+# lines of a few words each, so both the quoted and the split forms are used
+base64 -w 60 < <(head -c "$((size_mb * 1024 * 1024 * 3 / 4))" /dev/urandom) |
+    sed 's/[+\/]/ /g' > "$tmp_dir/file"
+
+# the `my_shell` command line and its `bash` counterpart; `bash` has no
+# `batch`, so the split words are passed to `xargs` instead
+cases=(
+    'wc -c <<< "$(cat file)"'
+    'wc -c <<< "$(cat file)"'
+    'cat <<< "$(cat file | cat)" | wc -l'
+    'cat <<< "$(cat file | cat)" | wc -l'
+    'batch true ::: $(cat file)'
+    'printf "%s\n" $(cat file) | xargs true'
+)
+
+# prints the best wall time of the `runs` in seconds
+measure() {
+    local sh=$1 cmd=$2 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        (cd "$tmp_dir" && "$sh" <<< "$cmd" > /dev/null)
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+printf 'output size: %d MB, best of %d runs\n\n' "$size_mb" "$runs"
+printf '%-40s %12s %12s\n' "case" "my_shell ms" "bash ms"
+for ((i = 0; i < ${#cases[@]}; i += 2)); do
+    my_shell_ns=$(measure "$OLDPWD/$shell" "${cases[i]}")
+    bash_ns=$(measure "$bash_path" "${cases[i+1]}")
+    printf '%-40s %12d %12d\n' "${cases[i]}" \
+        "$(( my_shell_ns / 1000000 ))" "$(( bash_ns / 1000000 ))"
+done
@@ -0,0 +1,116 @@
+/* completion_bench.c */
+
+/* Cost of completing a command name on every Tab: scanning all the `PATH`
+directories each time against the prefix tree of `completion.c`, made once
+and kept up to date by `inotify`. Also the cost of keeping it up to date,
+with no change and with a command added, and of finding the path a command
+is run from. Built and run by `completion_bench.sh` */
+
+#define _GNU_SOURCE
+#include "completion.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RESULT_FORMAT "%-40s %11.1f us\n"
+
+static double elapsed_us(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start->tv_sec)*1e6 + (end.tv_nsec - start->tv_nsec)/1e3
+    );
+}
+
+static int scan_path(const char *prefix)
+{
+    /* what the completion does without the tree: every directory of the
+    `PATH` is listed and its matching executables checked */
+    char *path = strdup(getenv("PATH")), *dir_path, *saveptr;
+    int prefix_len = strlen(prefix), found = 0;
+    for (dir_path = strtok_r(path, ":", &saveptr); dir_path;
+        dir_path = strtok_r(NULL, ":", &saveptr))
+    {
+        DIR *dir = opendir(dir_path);
+        struct dirent *entry;
+        if (!dir)
+            continue;
+        while ((entry = readdir(dir))) {
+            if (0 == strncmp(entry->d_name, prefix, prefix_len) &&
+                0 == faccessat(dirfd(dir), entry->d_name, X_OK, AT_EACCESS))
+            {
+                found++;
+            }
+        }
+        closedir(dir);
+    }
+    free(path);
+    return found;
+}
+
+static int complete(const char *prefix)
+{
+    completion_matches matches = { NULL, 0, 0 };
+    int found;
+    complete_command_name(prefix, strlen(prefix), &matches);
+    found = matches.len;
+    free_completion_matches(&matches);
+    return found;
+}
+
+int main(int argc, char **argv)
+{
+    /* the number of runs, the prefix to complete, the name to look up and
+    the path of the command to add */
+    struct timespec start;
+    int i, runs, scanned = 0, completed = 0;
+    char *path;
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s RUNS PREFIX NAME NEW_COMMAND\n", argv[0]);
+        return 1;
+    }
+    runs = atoi(argv[1]);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    init_completion();
+    printf(RESULT_FORMAT, "making the tree", elapsed_us(&start));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < runs; i++)
+        scanned = scan_path(argv[2]);
+    printf(RESULT_FORMAT, "Tab, scanning the PATH", elapsed_us(&start) / runs);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < runs; i++) {
+        refresh_completion();
+        completed = complete(argv[2]);
+    }
+    printf(RESULT_FORMAT, "Tab, the tree", elapsed_us(&start) / runs);
+    printf("(%d and %d matches)\n", scanned, completed);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < runs; i++)
+        refresh_completion();
+    printf(
+        RESULT_FORMAT, "keeping up to date, no change",
+        elapsed_us(&start) / runs
+    );
+    close(open(argv[4], O_WRONLY|O_CREAT|O_CLOEXEC, 0755));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    refresh_completion();
+    printf(
+        RESULT_FORMAT, "keeping up to date, a command added",
+        elapsed_us(&start)
+    );
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < runs; i++)
+        free(find_command_path(argv[3]));
+    printf(RESULT_FORMAT, "the path of a command", elapsed_us(&start) / runs);
+    path = find_command_path(strrchr(argv[4], '/') + 1);
+    printf("the added command: %s\n", path ? path : "not found");
+    free(path);
+    free_completion();
+    return 0;
+}
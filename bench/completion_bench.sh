@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+# Cost of the Tab completion of command names with a large `PATH`: listing
+# every directory on each Tab against the prefix tree made once and kept up
+# to date by `inotify`. The operations are timed by `completion_bench.c`,
+# built here with `completion.c`.
+
+commands=${BENCH_COMMANDS:-20000}
+runs=${BENCH_RUNS:-100}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+gcc -O2 -Iinclude bench/completion_bench.c src/completion.c \
+    -o "$tmp_dir/completion_bench" || exit 1
+# a large directory of commands after the usual ones
+mkdir "$tmp_dir/bin"
+(cd "$tmp_dir/bin" && seq -f 'tool%06g' 1 "$commands" | xargs touch &&
+    chmod +x tool*)
+
+printf '%d commands in the PATH directory added\n\n' "$commands"
+PATH="$PATH:$tmp_dir/bin" "$tmp_dir/completion_bench" "$runs" \
+    tool0001 "tool$(printf '%06d' "$commands")" "$tmp_dir/bin/new_tool"
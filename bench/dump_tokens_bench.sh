@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+# Throughput of `my_shell --dump-tokens` in each of its formats, against the
+# token printing build writing a token per `printf`. Both are built here
+# with `-O2` and no sanitizers, the output goes to /dev/null.
+
+lines=${BENCH_LINES:-500000}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+sources=$(ls src/*.c | grep -v parse_library)
+gcc -O2 -Iinclude -D EXEC_MODE $sources -lm -o "$tmp_dir/my_shell" \
+    2> /dev/null || exit 1
+gcc -O2 -Iinclude -D PRINT_TOKENS_MODE $sources -lm \
+    -o "$tmp_dir/print_tokens_shell" 2> /dev/null || exit 1
+# logged command lines: pipelines with quotes, expansions and redirections
+seq 1 "$lines" | awk '{
+    printf "grep -v \"x %d\" $HOME/log_%d.txt | sort -k2 | uniq -c > out_%d\n", $1, $1, $1
+}' > "$tmp_dir/lines"
+size=$(stat -c %s "$tmp_dir/lines")
+
+run()
+{
+    local name=$1 start end
+    shift
+    start=$(date +%s%N)
+    "$@" > /dev/null
+    end=$(date +%s%N)
+    awk -v name="$name" -v ns=$(( end - start )) -v size="$size" 'BEGIN {
+        printf "%-36s %8d ms %8.1f MB/s\n", name, ns / 1e6, size / 1048576 / (ns / 1e9)
+    }'
+}
+
+printf '%d lines, %d MB\n\n' "$lines" $(( size / 1048576 ))
+run "token printing build" "$tmp_dir/print_tokens_shell" "$tmp_dir/lines"
+for format in text json binary; do
+    run "--dump-tokens=$format" \
+        "$tmp_dir/my_shell" "--dump-tokens=$format" "$tmp_dir/lines"
+done
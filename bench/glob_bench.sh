@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+# Wall time of command lines with several glob patterns over one large
+# directory. `my_shell` reads each directory once per command line, however
+# many patterns refer to it, the time is compared against bash.
+
+files=${BENCH_FILES:-100000}
+lines=${BENCH_LINES:-20}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+bash_path=$(command -v bash)
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+mkdir "$tmp_dir/big"
+(cd "$tmp_dir/big" && seq -f 'f%06g' 1 "$files" | xargs touch)
+
+# writes a script of `lines` command lines, each with `patterns` patterns
+# over the large directory
+generate_script() {
+    local patterns=$1 file=$2 i j
+    for ((i = 0; i < lines; i++)); do
+        printf 'true'
+        for ((j = 1; j <= patterns; j++)); do
+            printf ' %s/big/f0000%d*' "$tmp_dir" "$j"
+        done
+        printf '\n'
+    done > "$file"
+}
+
+generate_script 1 "$tmp_dir/one"
+generate_script 4 "$tmp_dir/four"
+
+# prints the best wall time of the `runs` in milliseconds
+measure() {
+    local sh=$1 script=$2 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        "$sh" < "$script" > /dev/null
+        end=$(date +%s%N)
+        local elapsed=$(( (end - start) / 1000000 ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+printf '%d files, %d command lines, best of %d runs\n\n' \
+    "$files" "$lines" "$runs"
+printf '%-30s %14s %14s\n' "patterns per line" "my_shell ms" "bash ms"
+printf '%-30s %14d %14d\n' 1 \
+    "$(measure "$shell" "$tmp_dir/one")" \
+    "$(measure "$bash_path" "$tmp_dir/one")"
+printf '%-30s %14d %14d\n' 4 \
+    "$(measure "$shell" "$tmp_dir/four")" \
+    "$(measure "$bash_path" "$tmp_dir/four")"
@@ -0,0 +1,67 @@
+/* history_bench.c */
+
+/* Cost of the history operations of the line editor on a large history
+file: mapping it at startup, the first time along with making its index,
+stepping back through the entries as the up arrow does, and the ^R search
+for the entries at several depths. Built and run by `history_bench.sh` */
+
+#include "history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RESULT_FORMAT "%-36s %11.1f us\n"
+
+static double elapsed_us(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start->tv_sec)*1e6 + (end.tv_nsec - start->tv_nsec)/1e3
+    );
+}
+
+static void measure_search(const char *query)
+{
+    /* the search for each prefix of the query, as the characters are typed,
+    each one starting from the previous match. Like the line editor, it
+    stops once a prefix isn't found */
+    struct timespec start;
+    history_entry match;
+    char title[64];
+    int len;
+    bool found = false, failed = false;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (len = 1; len <= (int)strlen(query) && !failed; len++) {
+        long pos = found ? match.pos + match.len : history_end();
+        failed = !search_history(query, len, pos, &match);
+        found = found || !failed;
+    }
+    snprintf(title, sizeof(title), "^R %s%s", query, failed ? " (none)" : "");
+    printf(RESULT_FORMAT, title, elapsed_us(&start));
+}
+
+int main(int argc, char **argv)
+{
+    struct timespec start;
+    history_entry entry;
+    long pos;
+    int i, steps = (argc > 1) ? atoi(argv[1]) : 1000;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    init_history();
+    printf(RESULT_FORMAT, "startup", elapsed_us(&start));
+    free_history();
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    init_history();
+    printf(RESULT_FORMAT, "startup, with the index made", elapsed_us(&start));
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pos = history_end();
+    for (i = 0; i < steps && previous_history_entry(pos, &entry); i++)
+        pos = entry.pos;
+    printf(RESULT_FORMAT, "up arrow, per entry", elapsed_us(&start) / steps);
+    for (i = 2; i < argc; i++)
+        measure_search(argv[i]);
+    free_history();
+    return 0;
+}
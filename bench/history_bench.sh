@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Cost of the history of the line editor with a large history file: the
+# startup, the up arrow and the ^R search for the entries near the end, in
+# the middle and at the start of the file, and for one that isn't there.
+# The operations are timed by `history_bench.c`, built here with
+# `history.c`.
+
+entries=${BENCH_ENTRIES:-1000000}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+gcc -O2 -Iinclude bench/history_bench.c src/history.c src/error_handling.c \
+    -o "$tmp_dir/history_bench" || exit 1
+# command lines of a few words, each one unique
+seq 1 "$entries" |
+    awk '{ printf "git commit -m \"change %d\" && make test_%d\n", $1, $1 }' \
+    > "$tmp_dir/history"
+
+printf '%d entries, %d MB\n\n' "$entries" \
+    "$(( $(stat -c %s "$tmp_dir/history") / 1024 / 1024 ))"
+MY_SHELL_HISTFILE="$tmp_dir/history" "$tmp_dir/history_bench" 1000 \
+    "change $(( entries - 10 ))\"" \
+    "change $(( entries / 2 ))\"" \
+    "change 1\"" \
+    "no such command"
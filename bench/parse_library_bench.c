@@ -0,0 +1,85 @@
+/* parse_library_bench.c */
+
+/* Cost of validating command lines in-process with the parsing library:
+the whole file handed to one parser, with and without the plan of the
+pipelines, and the lines handed one by one to `validate_shell_line`. Built
+and run by `parse_library_bench.sh` with the file of the lines */
+
+#include "my_shell_parse.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RESULT_FORMAT "%-40s %9.0f ns per line %9.1f MB/s\n"
+
+static double elapsed_ns(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start->tv_sec)*1e9 + (end.tv_nsec - start->tv_nsec)
+    );
+}
+
+static char *read_file(const char *path, long *len)
+{
+    FILE *f = fopen(path, "r");
+    char *text;
+    if (!f)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    *len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    text = malloc(*len);
+    if (fread(text, 1, *len, f) != (size_t)*len) {
+        free(text);
+        text = NULL;
+    }
+    fclose(f);
+    return text;
+}
+
+static void count_line(const parsed_line *line, void *data)
+{
+    (void)line;
+    (*(long *)data)++;
+}
+
+static void report(const char *name, double ns, long lines, long len)
+{
+    printf(RESULT_FORMAT, name, ns / lines, len / (ns / 1e9) / 1e6);
+}
+
+int main(int argc, char **argv)
+{
+    shell_parser *parser = new_shell_parser(NULL);
+    struct timespec start;
+    long len, lines = 0, errors = 0;
+    const char *line, *end;
+    char *text;
+    if (argc < 2 || !(text = read_file(argv[1], &len))) {
+        fprintf(stderr, "usage: %s FILE\n", argv[0]);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    parse_shell_text(parser, text, len, false, count_line, &lines);
+    report("tokens, the whole file", elapsed_ns(&start), lines, len);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    parse_shell_text(parser, text, len, true, NULL, NULL);
+    report("plan, the whole file", elapsed_ns(&start), lines, len);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (line = text; line < text + len; line = end + 1) {
+        end = memchr(line, '\n', text + len - line);
+        if (!end)
+            end = text + len;
+        if (validate_shell_line(parser, line, end - line) != no_error)
+            errors++;
+    }
+    report("validate_shell_line, line by line", elapsed_ns(&start), lines,
+        len);
+    printf("\n%ld lines, %ld with an error\n", lines, errors);
+    free_shell_parser(parser);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# Cost of validating command lines: in-process with the parsing library,
+# against the token printing build of the shell run over the file and run
+# once per line. The library is timed by `parse_library_bench.c`, linked
+# here with the library built by `make lib`.
+
+lines=${BENCH_LINES:-200000}
+spawned_lines=${BENCH_SPAWNED_LINES:-500}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+make -s lib || exit 1
+gcc -O2 -Iinclude bench/parse_library_bench.c build/lib/libmy_shell_parse.a \
+    -o "$tmp_dir/parse_library_bench" || exit 1
+gcc -O2 -Iinclude -D PRINT_TOKENS_MODE \
+    $(ls src/*.c | grep -v parse_library) -lm \
+    -o "$tmp_dir/print_tokens_shell" 2> /dev/null || exit 1
+# pipelines with redirections and expansions, every tenth one with an error
+seq 1 "$lines" | awk '{
+    if ($1 % 10 == 0)
+        printf "grep -v \"x %d\" < in_%d | | sort\n", $1, $1
+    else
+        printf "grep -v \"x %d\" $HOME < in_%d | sort -k2 | uniq -c > out_%d\n", $1, $1, $1
+}' > "$tmp_dir/lines"
+
+printf '%d lines, %d KB\n\n' "$lines" \
+    "$(( $(stat -c %s "$tmp_dir/lines") / 1024 ))"
+"$tmp_dir/parse_library_bench" "$tmp_dir/lines"
+
+start=$(date +%s%N)
+"$tmp_dir/print_tokens_shell" "$tmp_dir/lines" > /dev/null 2>&1
+end=$(date +%s%N)
+printf '\n%-40s %9d ns per line\n' "token printing shell, the whole file" \
+    $(( (end - start) / lines ))
+
+head -n "$spawned_lines" "$tmp_dir/lines" > "$tmp_dir/spawned_lines"
+start=$(date +%s%N)
+while IFS= read -r line; do
+    "$tmp_dir/print_tokens_shell" -c "$line" > /dev/null 2>&1
+done < "$tmp_dir/spawned_lines"
+end=$(date +%s%N)
+printf '%-40s %9d ns per line\n' "token printing shell, line by line" \
+    $(( (end - start) / spawned_lines ))
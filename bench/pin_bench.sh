@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+# Throughput of pipelines of external commands, with the stages left to the
+# scheduler and pinned by `pin auto` to the CPUs sharing a cache, or by
+# `pin LIST` to the CPUs given in BENCH_CPUS. A pinned stage only gains
+# when there are at least as many CPUs as stages.
+
+size_mb=${BENCH_SIZE_MB:-2048}
+runs=${BENCH_RUNS:-3}
+cpus=${BENCH_CPUS:-}
+shell=./build/bin/my_shell
+
+cases=(
+    "head -c SIZE /dev/zero | /bin/cat | wc -c"
+    "head -c SIZE /dev/zero | /bin/cat | /bin/cat | /bin/cat | wc -c"
+)
+
+# prints the best wall time of the `runs` in nanoseconds
+measure() {
+    local cmd=$1 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        "$shell" -c "$cmd" > /dev/null
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+# prints the throughput for a time in nanoseconds
+throughput() {
+    echo $(( size_mb * 1000000000 / $1 ))
+}
+
+printf '%d MB through each pipeline, %d CPUs, best of %d runs\n\n' \
+    "$size_mb" "$(nproc)" "$runs"
+printf '%-8s %10s %10s %10s\n' "stages" "MB/s" "pin auto" \
+    "${cpus:+pin $cpus}"
+for c in "${cases[@]}"; do
+    cmd=${c//SIZE/$((size_mb * 1024 * 1024))}
+    stages=$(( $(grep -o '|' <<< "$cmd" | wc -l) + 1 ))
+    printf '%-8d %10d %10d' "$stages" \
+        "$(throughput "$(measure "$cmd")")" \
+        "$(throughput "$(measure "pin auto $cmd")")"
+    if [[ -n "$cpus" ]]; then
+        printf ' %10d' "$(throughput "$(measure "pin $cpus $cmd")")"
+    fi
+    printf '\n'
+done
@@ -0,0 +1,72 @@
+/* server_bench.c */
+
+/* Latency of a short task run by an orchestrator: a fresh `my_shell -c TEXT`
+started with `posix_spawn` and waited for, against the same TEXT sent to a
+`my_shell --server` with the client of `server.c`. Built and run by
+`server_bench.sh` */
+
+#include "server.h"
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <time.h>
+
+extern char **environ;
+
+#define RESULT_FORMAT "%-20s %11.1f us\n"
+
+static const char *shell_path;
+static const char *socket_path;
+static const char *text;
+
+static int run_fresh_shell()
+{
+    char *argv[] = { (char *)shell_path, "-c", (char *)text, NULL };
+    pid_t pid;
+    int status;
+    if (posix_spawn(&pid, shell_path, NULL, NULL, argv, environ))
+        return -1;
+    waitpid(pid, &status, 0);
+    return WEXITSTATUS(status);
+}
+
+static int run_on_server()
+{
+    return run_client(socket_path, text);
+}
+
+static double measure(int (*run)(), int tasks)
+{
+    /* returns the average microseconds per task */
+    struct timespec start, end;
+    int i;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < tasks; i++) {
+        if ((*run)() != 0) {
+            fprintf(stderr, "server_bench: the task has failed\n");
+            exit(1);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3
+    ) / tasks;
+}
+
+int main(int argc, char **argv)
+{
+    int tasks;
+    if (argc < 5) {
+        fprintf(stderr, "usage: server_bench SHELL SOCKET TEXT TASKS\n");
+        return 2;
+    }
+    shell_path = argv[1];
+    socket_path = argv[2];
+    text = argv[3];
+    tasks = atoi(argv[4]);
+    printf("%s\n", text);
+    printf(RESULT_FORMAT, "my_shell -c", measure(run_fresh_shell, tasks));
+    printf(RESULT_FORMAT, "my_shell --server", measure(run_on_server, tasks));
+    return 0;
+}
@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# Per-task overhead of running short command lines in a fresh `my_shell -c`
+# against sending them to a long-lived `my_shell --server`. The tasks are
+# run one after another by `server_bench.c`, built here with `server.c`,
+# which plays the orchestrator.
+
+tasks=${BENCH_TASKS:-500}
+shell=./build/bin/my_shell
+
+tmp_dir=$(mktemp -d)
+"$shell" --server "$tmp_dir/socket" &
+server_pid=$!
+trap 'kill "$server_pid"; rm -rf "$tmp_dir"' EXIT
+
+gcc -O2 -Iinclude -D EXEC_MODE bench/server_bench.c src/server.c \
+    src/error_handling.c -o "$tmp_dir/server_bench" || exit 1
+# the server has to be listening before the first task
+while [[ ! -S "$tmp_dir/socket" ]]; do
+    sleep 0.1
+done
+
+cases=(
+    'true'
+    'x=1; echo $x > /dev/null'
+    '/bin/true | /bin/true'
+)
+
+printf 'average of %d tasks, one after another\n\n' "$tasks"
+for text in "${cases[@]}"; do
+    "$tmp_dir/server_bench" "$shell" "$tmp_dir/socket" "$text" "$tasks"
+    echo
+done
@@ -0,0 +1,102 @@
+/* spawn_bench.c */
+
+/* Latency of starting `/bin/true` and waiting for it from a process with a
+large touched heap: `fork` and `execv`, `posix_spawn`, and the zygote of
+`my_shell`, which was forked before the heap was allocated. Built and run by
+`spawn_bench.sh` */
+
+#include "zygote.h"
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+#define RESULT_FORMAT "%-14s %11.1f us\n"
+
+static char *true_argv[] = { "/bin/true", NULL };
+
+static pid_t launch_with_fork()
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        execv(true_argv[0], true_argv);
+        _exit(1);
+    }
+    return pid;
+}
+
+static pid_t launch_with_posix_spawn()
+{
+    pid_t pid;
+    if (posix_spawn(&pid, true_argv[0], NULL, NULL, true_argv, environ))
+        return -1;
+    return pid;
+}
+
+static pid_t launch_with_zygote()
+{
+    return spawn_with_zygote(true_argv, 0, 1);
+}
+
+static double measure(pid_t (*launch)(), int launches)
+{
+    /* returns the average microseconds per launch and wait */
+    struct timespec start, end;
+    int i;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < launches; i++) {
+        pid_t pid = (*launch)();
+        if (pid == -1) {
+            fprintf(stderr, "spawn_bench: launch failed\n");
+            exit(1);
+        }
+        waitpid(pid, NULL, 0);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start.tv_sec)*1e6 + (end.tv_nsec - start.tv_nsec)/1e3
+    ) / launches;
+}
+
+int main(int argc, char **argv)
+{
+    int heap_mb = (argc > 1) ? atoi(argv[1]) : 256;
+    int launches = (argc > 2) ? atoi(argv[2]) : 1000;
+    size_t heap_len = (size_t)heap_mb*1024*1024;
+    char *heap;
+    start_zygote();
+    if (!zygote_running()) {
+        fprintf(stderr, "spawn_bench: the zygote hasn't started\n");
+        return 1;
+    }
+    /* the pages are touched, so `fork` has to copy their page tables. A
+    heap of the small pages, like the one of a long running shell */
+    heap = mmap(
+        NULL, heap_len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0
+    );
+    if (heap == MAP_FAILED) {
+        perror("spawn_bench: mmap");
+        return 1;
+    }
+    madvise(heap, heap_len, MADV_NOHUGEPAGE);
+    memset(heap, 1, heap_len);
+    printf("%-14s %8d MB heap\n", "", heap_mb);
+    printf(
+        RESULT_FORMAT, "fork + execv", measure(launch_with_fork, launches)
+    );
+    printf(
+        RESULT_FORMAT, "posix_spawn", measure(launch_with_posix_spawn, launches)
+    );
+    printf(
+        RESULT_FORMAT, "zygote", measure(launch_with_zygote, launches)
+    );
+    stop_zygote();
+    munmap(heap, heap_len);
+    return 0;
+}
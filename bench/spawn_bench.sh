@@ -0,0 +1,46 @@
+#!/usr/bin/env bash
+# Latency of starting a command from a process with a large heap: `fork`,
+# `posix_spawn` and the zygote of `my_shell` (`MY_SHELL_ZYGOTE=1`). The
+# launches are measured by `spawn_bench.c`, built here with `zygote.c`, for
+# a few heap sizes; then `my_shell` runs a script of `true` commands with and
+# without the zygote.
+
+launches=${BENCH_LAUNCHES:-1000}
+commands=${BENCH_COMMANDS:-2000}
+runs=${BENCH_RUNS:-3}
+heap_sizes=(${BENCH_HEAP_MB:-16 256 1024})
+shell=./build/bin/my_shell
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+gcc -O2 -Iinclude -D EXEC_MODE bench/spawn_bench.c src/zygote.c \
+    src/error_handling.c -o "$tmp_dir/spawn_bench" || exit 1
+printf 'average of %d launches of /bin/true, each waited for\n\n' "$launches"
+for heap_mb in "${heap_sizes[@]}"; do
+    "$tmp_dir/spawn_bench" "$heap_mb" "$launches"
+    echo
+done
+
+yes /bin/true | head -n "$commands" > "$tmp_dir/script"
+
+# prints the best wall time of the `runs` in nanoseconds
+measure() {
+    local best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        "$@" < "$tmp_dir/script" > /dev/null
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+printf '%d commands, best of %d runs\n' "$commands" "$runs"
+printf '%-14s %11d ms\n' "my_shell" "$(( $(measure "$shell") / 1000000 ))"
+printf '%-14s %11d ms\n' "with zygote" \
+    "$(( $(measure env MY_SHELL_ZYGOTE=1 "$shell") / 1000000 ))"
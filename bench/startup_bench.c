@@ -0,0 +1,101 @@
+/* startup_bench.c */
+
+/* Startup cost of a command: the average wall time of its launches with
+`posix_spawn`, each one waited for, and the number of the system calls made
+by one launch, counted with `ptrace` in the command and in every process it
+starts. Built and run by `startup_bench.sh` */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+#define USAGE "usage: %s LAUNCHES command [arg]...\n"
+#define RESULT_FORMAT "%11.1f us %9ld syscalls\n"
+
+static double elapsed_us(const struct timespec *start)
+{
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    return (
+        (end.tv_sec - start->tv_sec)*1e6 + (end.tv_nsec - start->tv_nsec)/1e3
+    );
+}
+
+static double average_launch_us(char **argv, int launches)
+{
+    /* returns -1 if the command can't be started */
+    struct timespec start;
+    int i, status;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < launches; i++) {
+        pid_t pid;
+        if (posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ))
+            return -1;
+        waitpid(pid, &status, 0);
+    }
+    return elapsed_us(&start) / launches;
+}
+
+static long count_syscalls(char **argv)
+{
+    /* every process of the tree stops at the entry to a system call and at
+    the exit from it; only the entries are counted */
+    long count = 0;
+    int status;
+    pid_t pid = fork(), stopped;
+    if (pid == 0) {
+        ptrace(PTRACE_TRACEME, 0, NULL, NULL);
+        raise(SIGSTOP);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+    if (pid == -1 || waitpid(pid, &status, 0) == -1)
+        return -1;
+    ptrace(PTRACE_SETOPTIONS, pid, NULL,
+        PTRACE_O_TRACESYSGOOD|PTRACE_O_TRACEFORK|PTRACE_O_TRACEVFORK|
+        PTRACE_O_TRACECLONE|PTRACE_O_TRACEEXEC|PTRACE_O_EXITKILL);
+    ptrace(PTRACE_SYSCALL, pid, NULL, NULL);
+    while ((stopped = waitpid(-1, &status, __WALL)) > 0) {
+        int sig = 0;
+        if (!WIFSTOPPED(status))
+            continue;
+        if (WSTOPSIG(status) == (SIGTRAP|0x80)) {
+            struct __ptrace_syscall_info info;
+            if (ptrace(PTRACE_GET_SYSCALL_INFO, stopped, sizeof(info), &info)
+                > 0 && info.op == PTRACE_SYSCALL_INFO_ENTRY)
+            {
+                count++;
+            }
+        } else
+        if (WSTOPSIG(status) != SIGTRAP && WSTOPSIG(status) != SIGSTOP)
+            /* a signal sent to the process is delivered */
+            sig = WSTOPSIG(status);
+        ptrace(PTRACE_SYSCALL, stopped, NULL, sig);
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    int launches;
+    double launch_us;
+    if (argc < 3 || (launches = atoi(argv[1])) < 1) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 2;
+    }
+    launch_us = average_launch_us(&argv[2], launches);
+    if (launch_us < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    printf(RESULT_FORMAT, launch_us, count_syscalls(&argv[2]));
+    return 0;
+}
@@ -0,0 +1,47 @@
+#!/usr/bin/env bash
+# Startup of `my_shell -c true`: the average wall time of a launch and the
+# system calls of one, measured by `startup_bench.c`. The shell is run with
+# no rc file, and with a generated one of aliases and functions, parsed at
+# every start and read from its cache. The shell is built here without the
+# sanitizers, which take most of the startup of the `make` build.
+
+launches=${BENCH_LAUNCHES:-500}
+aliases=${BENCH_ALIASES:-200}
+functions=${BENCH_FUNCTIONS:-100}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+gcc -O2 bench/startup_bench.c -o "$tmp_dir/startup_bench" || exit 1
+gcc -O2 -Iinclude -D EXEC_MODE $(ls src/*.c | grep -v parse_library.c) -lm \
+    -o "$tmp_dir/my_shell" || exit 1
+
+for ((i = 0; i < aliases; i++)); do
+    echo "alias a$i=\"echo alias $i\""
+done > "$tmp_dir/rc"
+for ((i = 0; i < functions; i++)); do
+    printf 'f%d() {\n    if true; then\n' "$i"
+    printf '        for x in 1 2 3; do echo %d; done\n    fi\n}\n' "$i"
+done >> "$tmp_dir/rc"
+cp "$tmp_dir/rc" "$tmp_dir/uncached_rc"
+# a directory in the place of the cache keeps it from being written
+mkdir "$tmp_dir/uncached_rc.cache"
+
+# prints the results of the command launched with the `rc` file
+row() {
+    local label=$1 rc=$2
+    shift 2
+    printf '%-32s' "$label"
+    MY_SHELL_RC=$rc "$tmp_dir/startup_bench" "$launches" "$@"
+}
+
+printf '%d launches; the rc file: %d aliases, %d functions, %d bytes\n\n' \
+    "$launches" "$aliases" "$functions" "$(wc -c < "$tmp_dir/rc")"
+row "/bin/true" "" /bin/true
+if command -v bash > /dev/null; then
+    row "bash -c true" "" bash -c true
+fi
+row "my_shell -c true, no rc" "$tmp_dir/none" "$tmp_dir/my_shell" -c true
+row "my_shell -c true, rc parsed" "$tmp_dir/uncached_rc" \
+    "$tmp_dir/my_shell" -c true
+row "my_shell -c true, rc cached" "$tmp_dir/rc" "$tmp_dir/my_shell" -c true
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+# Lines per second of a `while read` loop, which `my_shell` runs by itself
+# with `read` taking the lines from a buffer, against the same loop running a
+# `test` process for every line. The loops read a generated file.
+
+lines=${BENCH_LINES:-200000}
+# forking is much slower, fewer lines give the same precision
+fork_lines=${BENCH_FORK_LINES:-2000}
+runs=${BENCH_RUNS:-3}
+shell=./build/bin/my_shell
+bash_path=$(command -v bash)
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+seq 1 "$lines" > "$tmp_dir/lines"
+seq 1 "$fork_lines" > "$tmp_dir/fork_lines"
+
+# writes a script running the `loop` over the `input` file
+generate_script() {
+    local loop=$1 input=$2 file=$3
+    printf 'n=0\nwhile read line; do %s; done < %s\necho $n\n' \
+        "$loop" "$input" > "$file"
+}
+
+generate_script 'n=$((n + 1))' "$tmp_dir/lines" "$tmp_dir/count"
+generate_script 'x=$line' "$tmp_dir/lines" "$tmp_dir/assign"
+generate_script '/usr/bin/test $line -gt 0 && n=$((n + 1))' \
+    "$tmp_dir/fork_lines" "$tmp_dir/fork"
+
+# prints the best wall time of the `runs` in nanoseconds
+measure() {
+    local sh=$1 script=$2 best=""
+    for ((i = 0; i < runs; i++)); do
+        local start end
+        start=$(date +%s%N)
+        "$sh" < "$script" > /dev/null
+        end=$(date +%s%N)
+        local elapsed=$(( end - start ))
+        if [[ -z "$best" || "$elapsed" -lt "$best" ]]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+# prints the lines per second
+rate() {
+    echo $(( $2 * 1000000000 / $(measure "$1" "$3") ))
+}
+
+printf 'best of %d runs\n\n' "$runs"
+printf '%-45s %14s %14s\n' "loop body" "my_shell l/s" "bash l/s"
+printf '%-45s %14d %14d\n' 'n=$((n + 1))' \
+    "$(rate "$shell" "$lines" "$tmp_dir/count")" \
+    "$(rate "$bash_path" "$lines" "$tmp_dir/count")"
+printf '%-45s %14d %14d\n' 'x=$line' \
+    "$(rate "$shell" "$lines" "$tmp_dir/assign")" \
+    "$(rate "$bash_path" "$lines" "$tmp_dir/assign")"
+printf '%-45s %14d %14d\n' '/usr/bin/test $line -gt 0 && n=$((n + 1))' \
+    "$(rate "$shell" "$fork_lines" "$tmp_dir/fork")" \
+    "$(rate "$bash_path" "$fork_lines" "$tmp_dir/fork")"
@@ -0,0 +1,1384 @@
+/* in_process_cases.h */
+/* made by the `in_process_cases.sh`, don't edit. A token case is the input of
+the `print_tokens_test.sh` with the tokens it prints; a session case is a
+sequence of the `session_test.sh` run as a script by a fresh shell, with what
+it writes to `stdout` and `stderr`, the outputs of its commands one after
+another. Both are compared with the trailing newlines removed */
+
+static const token_case token_cases[] = {
+    {
+        "abra schwabra kadabra\n",
+        "[abra]\n"
+        "[schwabra]\n"
+        "[kadabra]"
+    },
+    {
+        "abra   ",
+        "[abra]"
+    },
+    {
+        "     abra\t\tschwabra \t \tkadabra",
+        "[abra]\n"
+        "[schwabra]\n"
+        "[kadabra]"
+    },
+    {
+        "abra \"schwabra kadabra\" \"foo    bar\"\n",
+        "[abra]\n"
+        "[schwabra kadabra]\n"
+        "[foo    bar]"
+    },
+    {
+        "abra schw\"abra ka\"dab\"ra\" foo\"    \"bar\n",
+        "[abra]\n"
+        "[schwabra kadabra]\n"
+        "[foo    bar]"
+    },
+    {
+        "\\\"abra\\\" \\\"schwabra\\\" \\\"kadabra\\\"",
+        "[\"abra\"]\n"
+        "[\"schwabra\"]\n"
+        "[\"kadabra\"]"
+    },
+    {
+        "\\\\abra\\\\ \\\\schwabra\\\\ \\\\kadabra\\\\",
+        "[\\abra\\]\n"
+        "[\\schwabra\\]\n"
+        "[\\kadabra\\]"
+    },
+    {
+        "abra \\\\s\\\"c\\\\h\\\"w\\\\a\\\"b\\\\r\\\"a\\\\ kadabra",
+        "[abra]\n"
+        "[\\s\"c\\h\"w\\a\"b\\r\"a\\]\n"
+        "[kadabra]"
+    },
+    {
+        "abra \\\\schw\"abra\\\\\\\"ka\"dab\"ra\\\"\" foo\"    \"bar",
+        "[abra]\n"
+        "[\\schwabra\\\"kadabra\"]\n"
+        "[foo    bar]"
+    },
+    {
+        "abra \\\\schw\"a\\\\b\\\\ra\\\"k\\\"a\"dab\"ra\\\"\" foo\"    \"bar",
+        "[abra]\n"
+        "[\\schwa\\b\\ra\"k\"adabra\"]\n"
+        "[foo    bar]"
+    },
+    {
+        "abra \\\\schw\"a\\\\b\\\"ra\\\\k\\\"a\"dab\"ra\\\"\" foo\"    \"bar",
+        "[abra]\n"
+        "[\\schwa\\b\"ra\\k\"adabra\"]\n"
+        "[foo    bar]"
+    },
+    {
+        "abra schwabra kadabra\"  foo bar",
+        "my_shell: Error: unmatched quotes"
+    },
+    {
+        "word \"",
+        "my_shell: Error: unmatched quotes"
+    },
+    {
+        "abra schw\"abraka\"dab\"ra\"\\ foo\"    \"bar",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "abra schw\"abra ka\"dab\"r\\a\" foo\"    \"bar",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "abra schw\"abra\\ ka\"dab\"ra\" foo\"    \"bar",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "abra schw\"abra ka\"dab\"ra\" f\\oo\"    \"bar",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "abra schw\\\"abra ka\"dab\"ra\" foo\"    \"bar",
+        "my_shell: Error: unmatched quotes"
+    },
+    {
+        "abraschwabrakadabra",
+        "[abraschwabrakadabra]"
+    },
+    {
+        "w\"  \"\"  \"ord",
+        "[w    ord]"
+    },
+    {
+        "w\"o \"\" r\"d",
+        "[wo  rd]"
+    },
+    {
+        "    ",
+        ""
+    },
+    {
+        " \t  \t  \t\t ",
+        ""
+    },
+    {
+        "\"\"",
+        "[]"
+    },
+    {
+        "\"\"\"\"",
+        "[]"
+    },
+    {
+        "\"\" \t\"\"",
+        "[]\n"
+        "[]"
+    },
+    {
+        " \"\" \t\"\" ",
+        "[]\n"
+        "[]"
+    },
+    {
+        "\"\" word1 word2",
+        "[]\n"
+        "[word1]\n"
+        "[word2]"
+    },
+    {
+        "word1 \"\" word2",
+        "[word1]\n"
+        "[]\n"
+        "[word2]"
+    },
+    {
+        "word1 word2 \"\" word3",
+        "[word1]\n"
+        "[word2]\n"
+        "[]\n"
+        "[word3]"
+    },
+    {
+        "word1 word2 \"\"",
+        "[word1]\n"
+        "[word2]\n"
+        "[]"
+    },
+    {
+        "word1 \"\"word2",
+        "[word1]\n"
+        "[word2]"
+    },
+    {
+        "word1 \"\"word2",
+        "[word1]\n"
+        "[word2]"
+    },
+    {
+        "w\"  \"\"  \"ord",
+        "[w    ord]"
+    },
+    {
+        "w\"o \"\" r\"d",
+        "[wo  rd]"
+    },
+    {
+        "word \"\"",
+        "[word]\n"
+        "[]"
+    },
+    {
+        "a \"It is a super long string, you see, I could actually overcome the bug where I unfortunately missed the issue that my tmp_wrd_array size was doubled only once, instead of being doubled every time the index value equals array size - 1. So lets see if everything is fine now.\" b",
+        "[a]\n"
+        "[It is a super long string, you see, I could actually overcome the bug where I unfortunately missed the issue that my tmp_wrd_array size was doubled only once, instead of being doubled every time the index value equals array size - 1. So lets see if everything is fine now.]\n"
+        "[b]"
+    },
+    {
+        "a & b",
+        "[a]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "a&b",
+        "[a]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "a && b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[b]"
+    },
+    {
+        "a&&b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[b]"
+    },
+    {
+        "a &&& b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "a&&&b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "a &&&& b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[and_operator]\n"
+        "[b]"
+    },
+    {
+        "a&&&&b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[and_operator]\n"
+        "[b]"
+    },
+    {
+        "a &&&&& b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[and_operator]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "a&&&&&b",
+        "[a]\n"
+        "[and_operator]\n"
+        "[and_operator]\n"
+        "[background_operator]\n"
+        "[b]"
+    },
+    {
+        "&",
+        "[background_operator]"
+    },
+    {
+        "&&",
+        "[and_operator]"
+    },
+    {
+        "&&&",
+        "[and_operator]\n"
+        "[background_operator]"
+    },
+    {
+        "&&&&",
+        "[and_operator]\n"
+        "[and_operator]"
+    },
+    {
+        "&&&&&",
+        "[and_operator]\n"
+        "[and_operator]\n"
+        "[background_operator]"
+    },
+    {
+        "a\"&\"b",
+        "[a&b]"
+    },
+    {
+        "a \"&\" b",
+        "[a]\n"
+        "[&]\n"
+        "[b]"
+    },
+    {
+        "a \\& b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\&",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "a > b",
+        "[a]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        "a>b",
+        "[a]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        "a >> b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[b]"
+    },
+    {
+        "a>>b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[b]"
+    },
+    {
+        "a >>> b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        "a>>>b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        "a >>>> b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_append_redirection]\n"
+        "[b]"
+    },
+    {
+        "a>>>>b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_append_redirection]\n"
+        "[b]"
+    },
+    {
+        "a >>>>> b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_append_redirection]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        "a>>>>>b",
+        "[a]\n"
+        "[output_append_redirection]\n"
+        "[output_append_redirection]\n"
+        "[output_redirection]\n"
+        "[b]"
+    },
+    {
+        ">",
+        "[output_redirection]"
+    },
+    {
+        ">>",
+        "[output_append_redirection]"
+    },
+    {
+        ">>>",
+        "[output_append_redirection]\n"
+        "[output_redirection]"
+    },
+    {
+        ">>>>",
+        "[output_append_redirection]\n"
+        "[output_append_redirection]"
+    },
+    {
+        ">>>>>",
+        "[output_append_redirection]\n"
+        "[output_append_redirection]\n"
+        "[output_redirection]"
+    },
+    {
+        "a\">\"b",
+        "[a>b]"
+    },
+    {
+        "a \">\" b",
+        "[a]\n"
+        "[>]\n"
+        "[b]"
+    },
+    {
+        "a \\> b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\>",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "a | b",
+        "[a]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a|b",
+        "[a]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a || b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[b]"
+    },
+    {
+        "a||b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[b]"
+    },
+    {
+        "a ||| b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a|||b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a |||| b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[or_operator]\n"
+        "[b]"
+    },
+    {
+        "a||||b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[or_operator]\n"
+        "[b]"
+    },
+    {
+        "a ||||| b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[or_operator]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a|||||b",
+        "[a]\n"
+        "[or_operator]\n"
+        "[or_operator]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "|",
+        "[pipe_operator]"
+    },
+    {
+        "||",
+        "[or_operator]"
+    },
+    {
+        "|||",
+        "[or_operator]\n"
+        "[pipe_operator]"
+    },
+    {
+        "||||",
+        "[or_operator]\n"
+        "[or_operator]"
+    },
+    {
+        "|||||",
+        "[or_operator]\n"
+        "[or_operator]\n"
+        "[pipe_operator]"
+    },
+    {
+        "a\"|\"b",
+        "[a|b]"
+    },
+    {
+        "a \"|\" b",
+        "[a]\n"
+        "[|]\n"
+        "[b]"
+    },
+    {
+        "a \\| b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\|",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "a < b",
+        "[a]\n"
+        "[input_redirection]\n"
+        "[b]"
+    },
+    {
+        "a<b",
+        "[a]\n"
+        "[input_redirection]\n"
+        "[b]"
+    },
+    {
+        "a << b\n"
+        "b",
+        "[a]\n"
+        "[here_document]\n"
+        "[]"
+    },
+    {
+        "a<<b\n"
+        "b",
+        "[a]\n"
+        "[here_document]\n"
+        "[]"
+    },
+    {
+        "<",
+        "[input_redirection]"
+    },
+    {
+        "<<",
+        "[here_document]"
+    },
+    {
+        "a\"<\"b",
+        "[a<b]"
+    },
+    {
+        "a \"<\" b",
+        "[a]\n"
+        "[<]\n"
+        "[b]"
+    },
+    {
+        "a \\< b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\<",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "a ; b",
+        "[a]\n"
+        "[command_separator]\n"
+        "[b]"
+    },
+    {
+        "a;b",
+        "[a]\n"
+        "[command_separator]\n"
+        "[b]"
+    },
+    {
+        "a ;; b",
+        "[a]\n"
+        "[command_separator]\n"
+        "[command_separator]\n"
+        "[b]"
+    },
+    {
+        "a;;b",
+        "[a]\n"
+        "[command_separator]\n"
+        "[command_separator]\n"
+        "[b]"
+    },
+    {
+        ";",
+        "[command_separator]"
+    },
+    {
+        ";;",
+        "[command_separator]\n"
+        "[command_separator]"
+    },
+    {
+        "a\";\"b",
+        "[a;b]"
+    },
+    {
+        "a \";\" b",
+        "[a]\n"
+        "[;]\n"
+        "[b]"
+    },
+    {
+        "a ( b",
+        "[a]\n"
+        "[open_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a(b",
+        "[a]\n"
+        "[open_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a (( b",
+        "[a]\n"
+        "[open_parenthesis]\n"
+        "[open_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a((b",
+        "[a]\n"
+        "[open_parenthesis]\n"
+        "[open_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "(",
+        "[open_parenthesis]"
+    },
+    {
+        "((",
+        "[open_parenthesis]\n"
+        "[open_parenthesis]"
+    },
+    {
+        "a\"(\"b",
+        "[a(b]"
+    },
+    {
+        "a \"(\" b",
+        "[a]\n"
+        "[(]\n"
+        "[b]"
+    },
+    {
+        "a \\( b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\(",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "a ) b",
+        "[a]\n"
+        "[close_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a)b",
+        "[a]\n"
+        "[close_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a )) b",
+        "[a]\n"
+        "[close_parenthesis]\n"
+        "[close_parenthesis]\n"
+        "[b]"
+    },
+    {
+        "a))b",
+        "[a]\n"
+        "[close_parenthesis]\n"
+        "[close_parenthesis]\n"
+        "[b]"
+    },
+    {
+        ")",
+        "[close_parenthesis]"
+    },
+    {
+        "))",
+        "[close_parenthesis]\n"
+        "[close_parenthesis]"
+    },
+    {
+        "a\")\"b",
+        "[a)b]"
+    },
+    {
+        "a \")\" b",
+        "[a]\n"
+        "[)]\n"
+        "[b]"
+    },
+    {
+        "a \\) b",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "\\)",
+        "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped"
+    },
+    {
+        "&>",
+        "[output_error_redirection]"
+    },
+    {
+        "&>|&",
+        "[output_error_redirection]\n"
+        "[pipe_operator]\n"
+        "[background_operator]"
+    },
+    {
+        "&\"&\"&",
+        "[background_operator]\n"
+        "[&]\n"
+        "[background_operator]"
+    },
+    {
+        "\"&>\"|&",
+        "[&>]\n"
+        "[pipe_operator]\n"
+        "[background_operator]"
+    },
+    {
+        "<;()",
+        "[input_redirection]\n"
+        "[command_separator]\n"
+        "[open_parenthesis]\n"
+        "[close_parenthesis]"
+    },
+    {
+        "<\";(\")",
+        "[input_redirection]\n"
+        "[;(]\n"
+        "[close_parenthesis]"
+    },
+    {
+        "a <<< b",
+        "[a]\n"
+        "[here_string]\n"
+        "[b]"
+    },
+    {
+        "a<<<b<c",
+        "[a]\n"
+        "[here_string]\n"
+        "[b]\n"
+        "[input_redirection]\n"
+        "[c]"
+    },
+    {
+        "a \"<<<\" b",
+        "[a]\n"
+        "[<<<]\n"
+        "[b]"
+    },
+    {
+        "a << end\n"
+        "first line\n"
+        "second line\n"
+        "end",
+        "[a]\n"
+        "[here_document]\n"
+        "[first line\n"
+        "second line\n"
+        "]"
+    },
+    {
+        "a<<end|b\n"
+        "line\n"
+        "end",
+        "[a]\n"
+        "[here_document]\n"
+        "[line\n"
+        "]\n"
+        "[pipe_operator]\n"
+        "[b]"
+    },
+    {
+        "a $(b c) d",
+        "[a]\n"
+        "[$(b c)]\n"
+        "[d]"
+    },
+    {
+        "a x$(b $(c) \")\")y",
+        "[a]\n"
+        "[x$(b $(c) \")\")y]"
+    },
+    {
+        "a $b $",
+        "[a]\n"
+        "[$b]\n"
+        "[$]"
+    },
+    {
+        "a $(b c",
+        "my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)"
+    },
+    {
+        "a ${b}c $d_1-e \"$f g\"",
+        "[a]\n"
+        "[${b}c]\n"
+        "[$d_1-e]\n"
+        "[$f g]"
+    },
+    {
+        "a ${b c} d",
+        "my_shell: Error: bad substitution"
+    },
+    {
+        "a \\$b \"\\$(c)\" \\${d}",
+        "[a]\n"
+        "[$b]\n"
+        "[$(c)]\n"
+        "[${d}]"
+    },
+    {
+        "a $((1 + (2 * b))) c$((d))",
+        "[a]\n"
+        "[$((1 + (2 * b)))]\n"
+        "[c$((d))]"
+    },
+    {
+        "a $((1 + 2) b",
+        "my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)"
+    },
+    {
+        "a <(b c) >(d) e<(f)",
+        "[a]\n"
+        "[<(b c)]\n"
+        "[>(d)]\n"
+        "[e]\n"
+        "[<(f)]"
+    },
+    {
+        "a < <(b) > >(c)",
+        "[a]\n"
+        "[input_redirection]\n"
+        "[<(b)]\n"
+        "[output_redirection]\n"
+        "[>(c)]"
+    },
+    {
+        "a \"<(b)\" >>(c)",
+        "[a]\n"
+        "[<(b)]\n"
+        "[output_append_redirection]\n"
+        "[open_parenthesis]\n"
+        "[c]\n"
+        "[close_parenthesis]"
+    },
+    {
+        "a 2> b 2>&1 >&- 3<> c",
+        "[a]\n"
+        "[output_redirection 2]\n"
+        "[b]\n"
+        "[duplication_redirection 2]\n"
+        "[1]\n"
+        "[duplication_redirection 1]\n"
+        "[-]\n"
+        "[input_output_redirection 3]\n"
+        "[c]"
+    },
+    {
+        "a&>b &>> c 0<&3 12>d \"2\">e",
+        "[a]\n"
+        "[output_error_redirection]\n"
+        "[b]\n"
+        "[output_error_append_redirection]\n"
+        "[c]\n"
+        "[duplication_redirection 0]\n"
+        "[3]\n"
+        "[12]\n"
+        "[output_redirection]\n"
+        "[d]\n"
+        "[2]\n"
+        "[output_redirection]\n"
+        "[e]"
+    },
+    {
+        "",
+        ""
+    },
+};
+
+static const session_case session_cases[] = {
+    {
+        "batch echo ::: one two three\n"
+        "echo two three | batch echo one\n"
+        "batch -P 2 echo one ::: two\n"
+        "seq 1 300000 | batch -P 4 printf %.0s. | wc -c\n"
+        "batch\n",
+        "one two three\n"
+        "one two three\n"
+        "one two\n"
+        "300000\n"
+        "my_shell: batch: usage: batch [-P N] command [args...] [::: items...]"
+    },
+    {
+        "parallel -k echo item {}.txt ::: one two three\n"
+        "seq 1 200 | parallel -j 8 echo | wc -l\n"
+        "parallel -j 2 sh -c \"exit {}\" ::: 0 3 0 5\n"
+        "parallel -j 2 sh -c ::: \"exec >&-; sleep 1\" \"sleep 0.1; echo fast\" > par_test.txt &\n"
+        "sleep 0.2; cat par_test.txt\n"
+        "sleep 1; rm par_test.txt\n"
+        "parallel -j 0 echo\n",
+        "item one.txt\n"
+        "item two.txt\n"
+        "item three.txt\n"
+        "200\n"
+        "my_shell: parallel: 2 of 4 jobs failed:\n"
+        "my_shell: parallel:     3 (status 3)\n"
+        "my_shell: parallel:     5 (status 5)\n"
+        "fast\n"
+        "my_shell: parallel: usage: parallel [-j N] [-k] command [args...] [::: items...]"
+    },
+    {
+        "cat LICENSE.txt > cat_test.txt\n"
+        "cat cat_test.txt | head -n 1\n"
+        "cat LICENSE.txt | tee tee_test.txt > tee_test_2.txt\n"
+        "cat tee_test.txt tee_test_2.txt | grep -c MIT\n"
+        "echo one | tee -a tee_test.txt | cat\n"
+        "tail -n 1 tee_test.txt\n"
+        "echo one | cat -n\n"
+        "echo two | tee --append tee_test.txt > /dev/null; tail -n 1 tee_test.txt\n"
+        "cat tee_test.txt >> tee_test.txt; echo $?\n"
+        "cat non_existing_file\n"
+        "rm cat_test.txt tee_test.txt tee_test_2.txt\n",
+        "MIT License\n"
+        "4\n"
+        "one\n"
+        "one\n"
+        "     1\tone\n"
+        "two\n"
+        "my_shell: cat: tee_test.txt: input file is output file\n"
+        "1\n"
+        "my_shell: cat: non_existing_file: No such file or directory"
+    },
+    {
+        "cat << EOF\n"
+        "first line\n"
+        "  second line\n"
+        "EOF\n"
+        "x=val\n"
+        "cat << EOF\n"
+        "a $x \"q\" \\$x $((1+1)) $(echo sub)\n"
+        "EOF\n"
+        "cat << \"EOF\"\n"
+        "b $x\n"
+        "EOF\n"
+        "wc -l << END | ./test/test_program\n"
+        "one\n"
+        "two\n"
+        "END\n"
+        "tr a-z A-Z <<< \"here string\"\n"
+        "cat <<< one < LICENSE.txt\n",
+        "first line\n"
+        "  second line\n"
+        "a val \"q\" $x 2 sub\n"
+        "b $x\n"
+        "(2)\n"
+        "HERE STRING\n"
+        "my_shell: Error: > or < used twice, or > together with >>"
+    },
+    {
+        "echo $(echo one   two) three\n"
+        "echo \"$(ls -d src test)\"\n"
+        "echo a$(echo b)c\n"
+        "echo $(echo $(echo nested) twice)\n"
+        "echo x$(cd test)y\n"
+        "ls -d test\n"
+        "wc -c <<< \"$(seq 1 200000)\"\n",
+        "one two three\n"
+        "src\n"
+        "test\n"
+        "abc\n"
+        "nested twice\n"
+        "xy\n"
+        "test\n"
+        "1288895"
+    },
+    {
+        "cat <(echo one) <(echo two)\n"
+        "paste <(seq 1 3) <(seq 4 6)\n"
+        "wc -l < <(seq 1 5)\n"
+        "echo three > >(tr a-z A-Z)\n"
+        "seq 1 4 | tee >(wc -l) > /dev/null\n"
+        "ls /proc/self/fd | wc -l\n",
+        "one\n"
+        "two\n"
+        "1\t4\n"
+        "2\t5\n"
+        "3\t6\n"
+        "5\n"
+        "THREE\n"
+        "4\n"
+        "4"
+    },
+    {
+        "x=\"one   two\"\n"
+        "echo $x\n"
+        "echo \"$x\" ${x}s\n"
+        "export Y=exported\n"
+        "printenv Y\n"
+        "export W; echo ${W-unset} ${W:-empty}; printenv W; echo $?\n"
+        "W=assigned; printenv W; echo ${W-unset}\n"
+        "v=\"p q\"; z=$v; x=$(echo a b); y=$v printenv y; echo [$z] [$x]\n"
+        "export FOO=outer; sh -c \"FOO=inner; echo \\$FOO\"; echo \\$FOO\n"
+        "Z=temporary printenv Z\n"
+        "printenv Z\n"
+        "unset x Y\n"
+        "echo [$x] [$Y] $\n"
+        "echo ${x y}\n"
+        "export 1x\n",
+        "one two\n"
+        "one   two one twos\n"
+        "exported\n"
+        "unset empty\n"
+        "1\n"
+        "assigned\n"
+        "assigned\n"
+        "p q\n"
+        "[p q] [a b]\n"
+        "inner\n"
+        "$FOO\n"
+        "temporary\n"
+        "[] [] $\n"
+        "my_shell: Error: bad substitution\n"
+        "my_shell: export: `1x': not a valid identifier"
+    },
+    {
+        "echo $((1 + 2 * 3)) $(( (1 + 2) * 3 )) $((-7 / 2)) $((-7 % 3)) $((0x10 + 010))\n"
+        "x=5\n"
+        "echo $((x * 2)) $(($x + 1)) $((x += 3)) $x $((x++)) $((--x)) $x\n"
+        "echo $((x > 1 ? 1 : (y = 9))) [$y] $((0 && (z = 1))) [$z] $((a = b = 4, a + b))\n"
+        "echo $((9223372036854775807 + 1)) $((1 << 65)) $((~0)) $((!5)) $((5 ^ 3))\n"
+        "echo $((1 / 0)) not printed\n"
+        "echo $((2 * (x %= 0))) not printed\n"
+        "echo $((1 +))\n",
+        "7 9 -3 -1 24\n"
+        "10 6 8 8 8 8 8\n"
+        "1 [] 0 [] 8\n"
+        "-9223372036854775808 2 -1 0 6\n"
+        "my_shell: 1 / 0: division by 0 (error token is \"/ 0\")\n"
+        "my_shell: 2 * (x %= 0): division by 0 (error token is \"%= 0)\")\n"
+        "my_shell: 1 +: operand expected (error token is \"\")"
+    },
+    {
+        "for i in 1 2 3; do echo i=$i; done\n"
+        "seq 1 5 > loop_test.txt\n"
+        "n=0; while read line; do n=$((n + line)); done < loop_test.txt; echo $n\n"
+        "x=out; seq 3 | while read x; do echo [$x]; done; echo $x\n"
+        "f() { cat loop_test.txt | while read x; do [ $x = 3 ] && break; echo $x; done; }; f; echo \"[$(seq 2 | { read a; read b; echo $b$a; })]\"\n"
+        "seq 2 | while read x; do echo $x; done | sort\n"
+        "if [ $n -gt 10 ]\n"
+        "then echo big\n"
+        "else echo small\n"
+        "fi\n"
+        "for a in 1 2 3; do for b in x y z; do if [ $b = y ]; then continue 2; fi; [ $a = 3 ] && break 2; echo $a$b; done; done\n"
+        "k=0; until [ $k -ge 3 ]; do k=$((k + 1)); done; echo k=$k\n"
+        "false || echo or && echo and; false && echo not printed\n"
+        "echo $(for w in a b; do echo $w$w; done)\n"
+        "read x y <<< \"one two three\"\n"
+        "echo [$x] [$y]\n"
+        "for w in 1 2; do v=\"[$w  x]\"; echo \"$v\" $v $((w * 10))$unset_var; done\n"
+        "while true; do done\n"
+        "rm loop_test.txt\n",
+        "i=1\n"
+        "i=2\n"
+        "i=3\n"
+        "15\n"
+        "[1]\n"
+        "[2]\n"
+        "[3]\n"
+        "out\n"
+        "1\n"
+        "2\n"
+        "[21]\n"
+        "my_shell: syntax error near unexpected token `|'\n"
+        "big\n"
+        "1x\n"
+        "2x\n"
+        "k=3\n"
+        "or\n"
+        "and\n"
+        "aa bb\n"
+        "[one] [two three]\n"
+        "[1  x] [1 x] 10\n"
+        "[2  x] [2 x] 20\n"
+        "my_shell: syntax error near unexpected token `done'"
+    },
+    {
+        "greet() { echo hello $1 of $#: $@; }\n"
+        "greet a b c\n"
+        "check()\n"
+        "{\n"
+        "if [ $1 = yes ]; then return 0; fi\n"
+        "return 3\n"
+        "}\n"
+        "check yes && echo passed; check no || echo failed\n"
+        "args() { for a; do echo arg $a; done; shift 2; echo $# left: $1; }\n"
+        "args x y z\n"
+        "{ echo one; echo two; } > group_test.txt; cat group_test.txt\n"
+        "greet piped | tr a-z A-Z\n"
+        "count() { if [ $1 -gt 0 ]; then echo -n $1; count $(($1 - 1)); fi; }\n"
+        "count 3; echo\n"
+        "alias say=\"echo said\"\n"
+        "say it twice\n"
+        "alias say\n"
+        "unalias say; alias say\n"
+        "return 1\n"
+        "rm group_test.txt\n",
+        "hello a of 3: a b c\n"
+        "passed\n"
+        "failed\n"
+        "arg x\n"
+        "arg y\n"
+        "arg z\n"
+        "1 left: z\n"
+        "one\n"
+        "two\n"
+        "HELLO PIPED OF 1: PIPED\n"
+        "321\n"
+        "said it twice\n"
+        "alias say='echo said'\n"
+        "my_shell: alias: say: not found\n"
+        "my_shell: return: can only `return' from a function"
+    },
+    {
+        "printf \"cut -d%s -f4 /proc/self/stat\" \"\\\" \\\"\" > exec_test.sh; echo >> exec_test.sh; echo readlink /proc/self >> exec_test.sh\n"
+        "./build/bin/my_shell exec_test.sh | uniq | wc -l\n"
+        "echo true >> exec_test.sh; ./build/bin/my_shell exec_test.sh | uniq | wc -l\n"
+        "printf \"echo %s0 %s1 %s#\" $ $ $ > exec_test.sh; echo >> exec_test.sh; echo exec echo replaced >> exec_test.sh; echo echo not printed >> exec_test.sh\n"
+        "./build/bin/my_shell exec_test.sh a b\n"
+        "./build/bin/my_shell -c \"exec > exec_test.txt; echo into file\"; cat exec_test.txt\n"
+        "./build/bin/my_shell -c \"exec no_such_command\"\n"
+        "./build/bin/my_shell no_such_script.sh\n"
+        "rm exec_test.sh exec_test.txt\n",
+        "1\n"
+        "2\n"
+        "exec_test.sh a 2\n"
+        "replaced\n"
+        "into file\n"
+        "my_shell: exec: no_such_command: No such file or directory\n"
+        "my_shell: no_such_script.sh: No such file or directory"
+    },
+    {
+        "false; echo $? ${?}\n"
+        "true | false | true; echo $PIPESTATUS $?\n"
+        "set -o pipefail; true | false | true; echo $?\n"
+        "set -o\n"
+        "set +o pipefail; false | true; echo $?\n"
+        "./build/bin/my_shell -c \"f() { exit 4; }; for i in 1 2; do f; echo not printed; done\"; echo $?\n"
+        "./build/bin/my_shell -c \"true | false\"; echo $?\n"
+        "set -o nope; echo $?\n",
+        "1 1\n"
+        "0 1 0 0\n"
+        "1\n"
+        "bgnice\toff\n"
+        "joblog\toff\n"
+        "pipefail\ton\n"
+        "0\n"
+        "4\n"
+        "1\n"
+        "my_shell: set: nope: invalid option name\n"
+        "2"
+    },
+    {
+        "mkdir -p glob_dir/sub glob_dir/other\n"
+        "touch glob_dir/a.txt glob_dir/b.txt glob_dir/ab.c glob_dir/.hidden glob_dir/sub/c.txt\n"
+        "echo glob_dir/*.txt glob_dir/?b.c glob_dir/[ab].txt\n"
+        "echo glob_dir/*\n"
+        "echo \"glob_dir/*\" glob_dir/*.none glob_dir/\"*\".txt\n"
+        "echo glob_dir/*/ glob_*/*/*.txt glob_dir/.*\n"
+        "for f in glob_dir/*.c; do echo f=$f; done; [ 1 = 1 ] && echo not a pattern\n"
+        "rm -r glob_dir\n",
+        "glob_dir/a.txt glob_dir/b.txt glob_dir/ab.c glob_dir/a.txt glob_dir/b.txt\n"
+        "glob_dir/a.txt glob_dir/ab.c glob_dir/b.txt glob_dir/other glob_dir/sub\n"
+        "glob_dir/* glob_dir/*.none glob_dir/*.txt\n"
+        "glob_dir/other/ glob_dir/sub/ glob_dir/sub/c.txt glob_dir/.hidden\n"
+        "f=glob_dir/ab.c\n"
+        "not a pattern"
+    },
+    {
+        "MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"echo a b | tr a-z A-Z; cd test; /bin/pwd | grep -o test; tr a-z A-Z <<< here\"\n"
+        "MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"X=1 env | grep ^X=; export Y=2; env | grep ^Y=; false || echo failed\"\n"
+        "MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"echo a | cat; cat < Makefile | head -n 1\"\n",
+        "A B\n"
+        "test\n"
+        "HERE\n"
+        "X=1\n"
+        "Y=2\n"
+        "failed\n"
+        "a\n"
+        "PROJECT := my_shell"
+    },
+    {
+        "printf \"echo one\\\\recho two\\\\r\\\\022on\\\\r\\\\033[A\\\\033[A\\\\r\\\\004\" > history_keys.txt\n"
+        "sh -c \"sleep 0.2; cat history_keys.txt\" | MY_SHELL_HISTFILE=history_test.txt script -qc ./build/bin/my_shell /dev/null > /dev/null &\n"
+        "sleep 0.3\n"
+        "cat history_test.txt; rm history_keys.txt history_test.txt history_test.txt.index\n",
+        "echo one\n"
+        "echo two\n"
+        "echo one\n"
+        "echo two"
+    },
+    {
+        "mkdir completion_bin; printf \"#!/bin/sh\\\\necho tool\\\\n\" > completion_bin/my_shell_tool_one; chmod +x completion_bin/my_shell_tool_one\n"
+        "printf \"my_shell_tool_o\\\\t>> completion_out.txt\\\\r\" > completion_keys_1.txt; printf \"my_shell_tool_t\\\\t>> completion_out.txt\\\\recho completion_bi\\\\tmy_shell_tool_o\\\\t>> completion_out.txt\\\\r\\\\004\" > completion_keys_2.txt\n"
+        "sh -c \"sleep 0.2; cat completion_keys_1.txt; cp completion_bin/my_shell_tool_one completion_bin/my_shell_tool_two; sleep 0.1; cat completion_keys_2.txt\" | PATH=$PWD/completion_bin:$PATH MY_SHELL_HISTFILE=completion_history.txt script -qc ./build/bin/my_shell /dev/null > /dev/null &\n"
+        "sleep 0.3\n"
+        "printf \"#!/bin/sh\\\\necho fake ls\\\\n\" > completion_bin/ls; chmod +x completion_bin/ls; printf \"PATH=$PWD/completion_bin ls\\\\nexit\\\\n\" | MY_SHELL_HISTFILE=completion_history.txt script -qc ./build/bin/my_shell /dev/null | grep -c \"fake ls\"\n"
+        "cat completion_out.txt; rm -r completion_bin completion_keys_1.txt completion_keys_2.txt completion_out.txt completion_history.txt completion_history.txt.index\n",
+        "1\n"
+        "tool\n"
+        "tool\n"
+        "completion_bin/my_shell_tool_one"
+    },
+    {
+        "pin 0 true | grep Cpus_allowed_list /proc/self/status | cut -f 2\n"
+        "pin auto grep -c Cpus_allowed_list /proc/self/status\n"
+        "pin 0-x true; echo $?\n"
+        "pin 0; echo $?\n",
+        "0\n"
+        "1\n"
+        "my_shell: pin: 0-x: invalid CPU list\n"
+        "2\n"
+        "my_shell: pin: usage: pin auto|CPU_LIST command...\n"
+        "2"
+    },
+    {
+        "printf \"echo \\\"a  b\\\" *.c | wc -l > out 2>&1 &\\\\ncat <<END; done\\\\nbody\\\\nEND\\\\n\" > dump_test.txt\n"
+        "./build/bin/my_shell --dump-tokens dump_test.txt\n"
+        "./build/bin/my_shell --dump-tokens=json < dump_test.txt\n"
+        "./build/bin/my_shell --dump-tokens=binary dump_test.txt | wc -c\n"
+        "./build/bin/my_shell --dump-tokens=xml dump_test.txt; echo $?; rm dump_test.txt\n",
+        "[echo]\n"
+        "[a  b]\n"
+        "[*.c]\n"
+        "[pipe_operator]\n"
+        "[wc]\n"
+        "[-l]\n"
+        "[output_redirection]\n"
+        "[out]\n"
+        "[duplication_redirection 2]\n"
+        "[1]\n"
+        "[background_operator]\n"
+        "[cat]\n"
+        "[here_document]\n"
+        "[body\n"
+        "]\n"
+        "[command_separator]\n"
+        "[done]\n"
+        "[\"echo\",\"a  b\",\"*.c\",{\"separator\":\"pipe_operator\"},\"wc\",\"-l\",{\"separator\":\"output_redirection\"},\"out\",{\"separator\":\"duplication_redirection\",\"fd\":2},\"1\",{\"separator\":\"background_operator\"}]\n"
+        "[\"cat\",{\"separator\":\"here_document\"},\"body\\n\",{\"separator\":\"command_separator\"},\"done\"]\n"
+        "95\n"
+        "my_shell: --dump-tokens: xml: unknown format, use text, json or binary\n"
+        "2"
+    },
+    {
+        "ls no_such_file 2> fd_test.txt; cat fd_test.txt | wc -l\n"
+        "ls no_such_file 2>&1 | wc -l\n"
+        "sh -c \"echo out; echo err >&2\" &> fd_test.txt; cat fd_test.txt\n"
+        "sh -c \"echo err >&2\" &>> fd_test.txt; sh -c \"echo three >&3\" 3> fd_test_2.txt; cat fd_test.txt fd_test_2.txt\n"
+        "echo new 1<> fd_test_2.txt; cat fd_test_2.txt\n"
+        "sh -c \"echo x >&3\" 3>&-; echo $?\n"
+        "echo a 2>&1 2> fd_test.txt\n"
+        "echo a >& fd_test.txt\n"
+        "for n in 3 4 5 6 7 8 9; do /bin/echo x >&$n; done; echo y >&9; echo $?\n"
+        "MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"/bin/echo hi >&3; echo one; /bin/echo two\"\n"
+        "exec 3> fd_test_3.txt; echo three >&3; exec 3>&-; cat fd_test_3.txt; rm fd_test.txt fd_test_2.txt fd_test_3.txt\n",
+        "1\n"
+        "1\n"
+        "out\n"
+        "err\n"
+        "out\n"
+        "err\n"
+        "err\n"
+        "three\n"
+        "new\n"
+        "e\n"
+        "sh: 1: 3: Bad file descriptor\n"
+        "2\n"
+        "my_shell: Error: > or < used twice, or > together with >>\n"
+        "my_shell: Error: a file descriptor or - expected after >& or <&\n"
+        "my_shell: 3: Bad file descriptor\n"
+        "my_shell: 4: Bad file descriptor\n"
+        "my_shell: 5: Bad file descriptor\n"
+        "my_shell: 6: Bad file descriptor\n"
+        "my_shell: 7: Bad file descriptor\n"
+        "my_shell: 8: Bad file descriptor\n"
+        "my_shell: 9: Bad file descriptor\n"
+        "my_shell: 9: Bad file descriptor\n"
+        "1\n"
+        "my_shell: 3: Bad file descriptor\n"
+        "one\n"
+        "two\n"
+        "three"
+    },
+    {
+        "printf \"alias say=echo\\\\ntwice() { say again; say again; }\\\\nset -o pipefail\\\\nexport RC_VAR=from_rc\\\\n\" > rc_test.txt\n"
+        "MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"twice; printenv RC_VAR; set -o\"\n"
+        "ls rc_test.txt*; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c twice\n"
+        "echo \"echo changed\" >> rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c twice\n"
+        "echo \"if true\" > rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"echo started\"\n"
+        "echo fi > rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"echo started\"; rm rc_test.txt rc_test.txt.cache\n",
+        "again\n"
+        "again\n"
+        "from_rc\n"
+        "bgnice\toff\n"
+        "joblog\toff\n"
+        "pipefail\ton\n"
+        "rc_test.txt\n"
+        "rc_test.txt.cache\n"
+        "again\n"
+        "again\n"
+        "changed\n"
+        "again\n"
+        "again\n"
+        "my_shell: rc_test.txt: syntax error: unexpected end of file\n"
+        "started\n"
+        "my_shell: syntax error near unexpected token `fi'\n"
+        "started"
+    },
+    {
+        "set -o joblog; echo hi &\n"
+        "sleep 0.2; joblog %1\n"
+        "sh -c \"sleep 0.1; echo bad; exit 3\" &\n"
+        "sleep 0.2\n"
+        "joblog\n"
+        "MY_SHELL_JOBLOG_SIZE=3; seq 10 &\n"
+        "sleep 0.2; joblog %3\n"
+        "MY_SHELL_JOBLOG_SIZE=x; echo no &\n"
+        "echo $?\n"
+        "joblog %9; joblog x\n"
+        "MY_SHELL_JOBLOG_SIZE=100; sh -c \"sleep 0.1; echo own\" &\n"
+        "/bin/echo injected >&3; sleep 0.2; joblog %4\n"
+        "sh -c \"sleep 0.1; exit 5\" &\n"
+        "batch sleep ::: 0.3\n"
+        "printf \"set -o joblog\\\\nsh -c \\\"sleep 0.1; echo late; echo written > jl_test.txt\\\" &\\\\nsleep 0.3\\\\n\" > jl_test.sh\n"
+        "./build/bin/my_shell jl_test.sh\n"
+        "cat jl_test.txt; rm jl_test.sh jl_test.txt\n",
+        "hi\n"
+        "[2] Exit 3\tsh -c sleep 0.1; echo bad; exit 3 &\n"
+        "bad\n"
+        "[1] Done\techo hi &\n"
+        "[2] Exit 3\tsh -c sleep 0.1; echo bad; exit 3 &\n"
+        "my_shell: joblog: %3: the first 18 bytes have been dropped\n"
+        "10\n"
+        "my_shell: MY_SHELL_JOBLOG_SIZE: x: invalid value\n"
+        "1\n"
+        "my_shell: joblog: %9: no such job\n"
+        "my_shell: joblog: usage: joblog [%N]\n"
+        "my_shell: 3: Bad file descriptor\n"
+        "own\n"
+        "[5] Exit 5\tsh -c sleep 0.1; exit 5 &\n"
+        "written"
+    },
+};
@@ -0,0 +1,69 @@
+aliases.o: src/aliases.c include/aliases.h include/constants.h \
+ include/constants.h
+arithmetic.o: src/arithmetic.c include/arithmetic.h include/variables.h
+batch_execution.o: src/batch_execution.c include/batch_execution.h \
+ include/cmd_execution.h include/constants.h include/constants.h \
+ include/error_handling.h include/io_util.h include/zombie_handling.h
+builtins.o: src/builtins.c include/aliases.h include/constants.h \
+ include/batch_execution.h include/builtins.h include/cmd_execution.h \
+ include/control_flow.h include/error_handling.h include/job_log.h \
+ include/line_reading.h include/stream_copying.h include/variables.h
+cmd_execution.o: src/cmd_execution.c include/aliases.h \
+ include/constants.h include/builtins.h include/cmd_execution.h \
+ include/cmd_line_building.h include/completion.h include/cpu_affinity.h \
+ include/error_handling.h include/io_util.h include/job_log.h \
+ include/job_priority.h include/token_dump.h include/variables.h \
+ include/zombie_handling.h include/zygote.h
+cmd_line_building.o: src/cmd_line_building.c include/cmd_line_building.h \
+ include/constants.h include/parse_allocation.h
+completion.o: src/completion.c include/completion.h include/io_util.h
+control_flow.o: src/control_flow.c include/cmd_execution.h \
+ include/constants.h include/control_flow.h include/error_handling.h \
+ include/str_parsing.h include/variables.h include/zombie_handling.h
+cpu_affinity.o: src/cpu_affinity.c include/constants.h \
+ include/cpu_affinity.h include/constants.h include/error_handling.h
+error_handling.o: src/error_handling.c include/error_handling.h
+fd_passing.o: src/fd_passing.c include/error_handling.h \
+ include/fd_passing.h
+globbing.o: src/globbing.c include/constants.h include/globbing.h \
+ include/constants.h
+history.o: src/history.c include/error_handling.h include/history.h \
+ include/io_util.h
+io_util.o: src/io_util.c include/constants.h include/error_handling.h \
+ include/io_util.h
+job_log.o: src/job_log.c include/error_handling.h include/io_util.h \
+ include/job_log.h include/constants.h include/variables.h
+job_priority.o: src/job_priority.c include/error_handling.h \
+ include/job_priority.h include/variables.h
+line_editing.o: src/line_editing.c include/completion.h \
+ include/constants.h include/history.h include/io_util.h \
+ include/job_log.h include/constants.h include/line_editing.h
+line_reading.o: src/line_reading.c include/constants.h \
+ include/error_handling.h include/line_reading.h include/variables.h \
+ include/zombie_handling.h
+main.o: src/main.c include/aliases.h include/constants.h \
+ include/cmd_execution.h include/control_flow.h include/str_parsing.h \
+ include/constants.h include/job_log.h include/line_editing.h \
+ include/line_reading.h include/rc_file.h include/server.h \
+ include/token_dump.h include/variables.h include/zombie_handling.h \
+ include/zygote.h
+rc_file.o: src/rc_file.c include/control_flow.h include/constants.h \
+ include/io_util.h include/rc_file.h
+server.o: src/server.c include/constants.h include/error_handling.h \
+ include/fd_passing.h include/server.h
+str_parsing.o: src/str_parsing.c include/arithmetic.h \
+ include/cmd_execution.h include/constants.h include/cmd_line_building.h \
+ include/control_flow.h include/error_handling.h include/globbing.h \
+ include/job_log.h include/line_editing.h include/str_parsing.h \
+ include/variables.h include/zombie_handling.h include/parse_allocation.h
+stream_copying.o: src/stream_copying.c include/error_handling.h \
+ include/io_util.h include/stream_copying.h
+token_dump.o: src/token_dump.c include/cmd_line_building.h \
+ include/constants.h include/error_handling.h include/io_util.h \
+ include/token_dump.h
+variables.o: src/variables.c include/cmd_execution.h include/constants.h \
+ include/constants.h include/variables.h
+zombie_handling.o: src/zombie_handling.c include/error_handling.h \
+ include/job_log.h include/constants.h include/zombie_handling.h
+zygote.o: src/zygote.c include/constants.h include/error_handling.h \
+ include/fd_passing.h include/io_util.h include/zygote.h
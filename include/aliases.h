@@ -0,0 +1,16 @@
+/* aliases.h */
+
+#ifndef ALIASES_H_INCLUDED
+#define ALIASES_H_INCLUDED
+
+#include "constants.h"
+
+void expand_alias(execvp_cmd_line *cmdline, curr_str_words_list *words);
+
+void free_aliases();
+
+int handle_alias_command(char **argv);
+
+int handle_unalias_command(char **argv);
+
+#endif
@@ -0,0 +1,11 @@
+/* arithmetic.h */
+
+#ifndef ARITHMETIC_H_INCLUDED
+#define ARITHMETIC_H_INCLUDED
+
+#include <stdbool.h>
+#include <stdint.h>
+
+bool evaluate_arithmetic(const char *expr, int64_t *result);
+
+#endif
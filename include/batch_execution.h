@@ -0,0 +1,10 @@
+/* batch_execution.h */
+
+#ifndef BATCH_EXECUTION_H_INCLUDED
+#define BATCH_EXECUTION_H_INCLUDED
+
+int handle_batch_command(char **argv);
+
+int handle_parallel_command(char **argv);
+
+#endif
@@ -0,0 +1,14 @@
+/* builtins.h */
+
+#ifndef BUILTINS_H_INCLUDED
+#define BUILTINS_H_INCLUDED
+
+#include <stdbool.h>
+
+typedef int (*builtin_func)(char **argv);
+
+builtin_func find_builtin(char **argv);
+
+bool streaming_builtin(char **argv);
+
+#endif
@@ -5,13 +5,36 @@
 
 #include "constants.h"
 #include <stdbool.h>
+#include <sys/types.h>
 
-void reset_cmd_line_item(execvp_cmd_line *item);
+int last_exit_status();
 
-void init_cmd_line_item(execvp_cmd_line *item);
+void set_last_exit_status(int status);
 
-bool words_list_is_empty(const string *str);
+const int *last_pipeline_statuses(int *len);
+
+void free_pipeline_statuses();
+
+int wait_for_process(pid_t pid);
+
+int save_standard_stream(int fd, bool redirection);
+
+void restore_standard_stream(int saved_fd, int fd);
+
+void read_captured_output(int fd, curr_word_dynamic_char_arr *output);
+
+int launch_simple_command(char **argv, int fd_output);
+
+pid_t launch_process_substitution(
+    pipeline_list *pipes, bool output_substitution, int *fd
+);
+
+void close_process_substitution_pipes(pipeline_list *pipes);
 
 void execute_command(string *str);
 
+int handle_exec_command(char **argv);
+
+int handle_set_command(char **argv);
+
 #endif
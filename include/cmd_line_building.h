@@ -0,0 +1,23 @@
+/* cmd_line_building.h */
+
+#ifndef CMD_LINE_BUILDING_H_INCLUDED
+#define CMD_LINE_BUILDING_H_INCLUDED
+
+#include "constants.h"
+#include <stdbool.h>
+
+void reset_cmd_line_item(execvp_cmd_line *item);
+
+void init_cmd_line_item(execvp_cmd_line *item);
+
+void free_cmd_line_item(execvp_cmd_line *item);
+
+bool words_list_is_empty(const string *str);
+
+int separator_descriptor(const word_item *separator);
+
+void drop_cmd_line_items_except_first(cmd_lines_list *cmdline);
+
+error_code transform_words_list_into_cmd_line_arr(string *str);
+
+#endif
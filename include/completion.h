@@ -0,0 +1,33 @@
+/* completion.h */
+
+#ifndef COMPLETION_H_INCLUDED
+#define COMPLETION_H_INCLUDED
+
+#include <stdbool.h>
+
+typedef struct tag_completion_matches {
+    /* the whole words the word being completed may become, sorted */
+    char **arr;
+    int len;
+    int arr_len;
+} completion_matches;
+
+void init_completion();
+
+void refresh_completion();
+
+char *find_command_path(const char *name);
+
+void complete_command_name(
+    const char *word, int len, completion_matches *matches
+);
+
+void complete_file_path(
+    const char *word, int len, completion_matches *matches
+);
+
+void free_completion_matches(completion_matches *matches);
+
+void free_completion();
+
+#endif
@@ -5,14 +5,26 @@
 
 #include <stdbool.h>
 
-extern char *environ;
+extern char **environ;
 
 enum consts {
     init_tmp_wrd_arr_len    = 16,
-    init_cmd_line_arr_len   = 8
+    init_cmd_line_arr_len   = 8,
+    init_fd_ops_arr_len     = 4,
+    /* file descriptors the shell keeps for itself are moved above it */
+    saved_fd_min            = 10,
+    /* the command substitution output is read in chunks of at least this
+    size from a pipe of the following capacity */
+    capture_read_len        = 65536,
+    capture_pipe_len        = 1048576,
+    /* the input refilled from a file is read in chunks of this size */
+    input_chunk_len         = 1048576
 };
 
 #define ERR_SMTH_STRANGE_HAPPEND    "%s, %d: Something went wrong\n"
+#define ERR_INCORRECT_CHAR_ESCAPING \
+    "my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped\n"
+#define ERR_UNMATCHED_QUOTES "my_shell: Error: unmatched quotes\n"
 #define ERR_NO_SUCH_FILE            "my_shell: %s: No such file or directory\n"
 #define ERR_BACKGROUND_OPERATOR_IN_THE_END_OF_STR \
     "my_shell: Error: & not in the end of string\n"
@@ -24,6 +36,12 @@ enum consts {
     "my_shell: Error: > or < used twice, or > together with >>\n"
 #define ERR_PIPE_OPERATOR_MISUSE \
     "my_shell: Error: | at start of the string or two | in a row\n"
+#define ERR_BAD_SUBSTITUTION "my_shell: Error: bad substitution\n"
+#define ERR_UNCLOSED_COMMAND_SUBSTITUTION \
+    "my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)\n"
+#define ERR_NOT_IMPLEMENTED_FEATURE "my_shell: feature not implemented yet\n"
+#define ERR_FD_DUPLICATION_TARGET \
+    "my_shell: Error: a file descriptor or - expected after >& or <&\n"
 
 typedef enum tag_error_code {
     no_error,
@@ -33,7 +51,12 @@ typedef enum tag_error_code {
     second_simple_word_right_after_input_or_output_redirecton,
     input_or_output_separator_used_in_line_twice,
     pipe_operator_at_start_of_str,
-    not_implemented_feature
+    unclosed_command_substitution,
+    bad_substitution,
+    arithmetic_error,
+    not_implemented_feature,
+    unmatched_quotes,
+    bad_fd_duplication_target
 } error_code;
 
 typedef enum tag_separator_type {
@@ -47,12 +70,25 @@ typedef enum tag_separator_type {
     input_redirection,
     command_separator,
     open_parenthesis,
-    close_parenthesis
+    close_parenthesis,
+    here_document,
+    here_string,
+    input_output_redirection,
+    duplication_redirection,
+    output_error_redirection,
+    output_error_append_redirection
 } separator_type;
 
+/* The word of a redirection separator is the operator as it's written, with
+the descriptor number before it, if any: `2>`, `<>`, `>&`, `&>>`. The file
+name, or the descriptor of `>&` and `<&`, is the next word */
+
 typedef struct tag_word_item {
     char *word;
     separator_type separator_val;
+    /* the word has a quoted or escaped part, the body of a here-document
+    whose delimiter it is isn't expanded then */
+    bool quoted;
     struct tag_word_item *next;
 } word_item;
 
@@ -68,19 +104,52 @@ typedef struct tag_curr_word_dynamic_char_arr {
     int arr_len;
 } curr_word_dynamic_char_arr;
 
-typedef struct tag_io_status {
-    bool redirection;
-    bool waiting_for_file;
+typedef enum tag_io_source {
+    file_source,
+    here_document_source,
+    here_string_source
+} io_source;
+
+typedef enum tag_open_mode {
+    read_mode,
+    overwrite_mode,
+    append_mode,
+    read_write_mode
+} open_mode;
+
+typedef enum tag_fd_operation_type {
+    /* the descriptor is the file opened in the `mode`, or the here-document
+    or the here-string */
+    open_fd_operation,
+    /* the descriptor is a copy of the `target_fd` */
+    duplicate_fd_operation,
+    close_fd_operation
+} fd_operation_type;
+
+typedef struct tag_fd_operation {
+    fd_operation_type type;
+    int fd;
+    open_mode mode;
+    io_source source;
+    /* the file name, or the data itself for here-documents and -strings */
     const char *redirection_file;
-} io_status;
+    int target_fd;
+    /* the file opened by the shell for the command being launched */
+    int file_fd;
+} fd_operation;
 
 typedef struct tag_execvp_cmd_line {
     char **arr;
     int arr_len;
     int pid;
-    io_status input;
-    io_status output_overwrite;
-    io_status output_append;
+    /* the exit status, once the process has been waited for */
+    int status;
+    /* the redirections, applied in order once the pipeline is set up */
+    fd_operation *fd_ops;
+    int fd_ops_len;
+    int fd_ops_arr_len;
+    /* the index of the redirection waiting for its file name, -1 if none */
+    int waiting_fd_op;
     struct tag_execvp_cmd_line *next;
 } execvp_cmd_line;
 
@@ -100,6 +169,27 @@ typedef struct tag_pipeline_list {
     pipeline_item *first;
 } pipeline_list;
 
+typedef struct tag_glob_positions {
+    /* the positions of the unquoted `*`, `?`, `[` and `]` in the word */
+    int *arr;
+    int len;
+    int arr_len;
+} glob_positions;
+
+/* the directories read by the glob patterns of a command line */
+typedef struct tag_directory_listing directory_listing;
+
+typedef struct tag_input_buffer {
+    /* the characters are read from this array, or from `stdin` if NULL */
+    const char *arr;
+    int idx;
+    int len;
+    /* the file the array is refilled from once it's read through, -1 if
+    none. It's read into the `chunk`, of the `input_chunk_len` */
+    int fd;
+    char *chunk;
+} input_buffer;
+
 typedef struct tag_string {
     bool word_ended, str_ended, quotation, char_escaping;
     int c;
@@ -112,6 +202,34 @@ typedef struct tag_string {
     cmd_lines_list cmd_line;
     /* contains the pipes linking processes into a pipeline */
     pipeline_list pipeline;
+    /* contains the pipes of the process substitutions, the shell's ends are
+    open until the command line is launched */
+    pipeline_list substitution_pipes;
+    /* contains the source of the characters being parsed */
+    input_buffer input;
+    /* if set, the output of the commands is collected here instead of being
+    written to `stdout` (the command substitution) */
+    curr_word_dynamic_char_arr *capture;
+    /* the words are only expanded, nothing is executed and the keywords of
+    the compound commands aren't recognized */
+    bool expansion_only;
+    /* the words are only split into tokens and handed to the token dump,
+    nothing is expanded or executed (`--dump-tokens`) */
+    bool tokens_only;
+    /* the input is a script (the `-c` string or a file), so its last command
+    line may replace the shell process instead of being forked */
+    bool non_interactive;
+    /* the command line being executed is the last one of the script */
+    bool last_command;
+    /* the word being formed is a glob pattern if it has any of these */
+    glob_positions glob;
+    directory_listing *dir_cache;
+    /* the word being formed has a quoted part, so it's never taken for the
+    descriptor number of a redirection */
+    bool word_quoted;
+    /* the text is the body of a here-document, in which only `$` and `\`
+    are special */
+    bool here_document_body;
 } string;
 
 #endif
@@ -0,0 +1,61 @@
+/* control_flow.h */
+
+#ifndef CONTROL_FLOW_H_INCLUDED
+#define CONTROL_FLOW_H_INCLUDED
+
+#include "constants.h"
+#include <stdbool.h>
+
+typedef struct tag_ast_node ast_node;
+
+typedef enum tag_compound_parse_status {
+    compound_complete,
+    /* the text ends before the command does, it goes on in the next line */
+    compound_incomplete,
+    compound_syntax_error
+} compound_parse_status;
+
+compound_parse_status parse_compound_command(
+    const char *text, ast_node **tree
+);
+
+void run_compound_command(
+    const ast_node *tree, curr_word_dynamic_char_arr *capture
+);
+
+/* the words of `str` are the commands before the `|`, the `tree` is the
+rest of the line from the compound command after it on */
+void run_compound_pipeline_stage(string *str, const ast_node *tree);
+
+void run_list_continuation(
+    ast_node *tree, separator_type separator,
+    curr_word_dynamic_char_arr *capture
+);
+
+void free_compound_command(ast_node *tree);
+
+/* the tree as bytes, which are valid only for the shells of the format
+version `serialized_tree_version` tells */
+const char *serialized_tree_version();
+void serialize_compound_command(
+    const ast_node *tree, curr_word_dynamic_char_arr *out
+);
+bool deserialize_compound_command(const char *data, int len, ast_node **tree);
+
+bool function_defined(const char *name);
+
+int call_function(char **argv);
+
+void free_functions();
+
+int handle_return_command(char **argv);
+
+int handle_exit_command(char **argv);
+
+bool shell_exit_requested();
+
+int handle_break_command(char **argv);
+
+int handle_continue_command(char **argv);
+
+#endif
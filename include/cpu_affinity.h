@@ -0,0 +1,24 @@
+/* cpu_affinity.h */
+
+#ifndef CPU_AFFINITY_H_INCLUDED
+#define CPU_AFFINITY_H_INCLUDED
+
+#include "constants.h"
+#include <stdbool.h>
+
+enum cpu_affinity_consts {
+    max_placement_cpus      = 1024
+};
+
+typedef struct tag_pipeline_placement {
+    /* the stage `i` of the pipeline is pinned to the `cpus[i % len]`, the
+    stages aren't pinned if the `len` is 0 */
+    int cpus[max_placement_cpus];
+    int len;
+} pipeline_placement;
+
+bool take_pin_prefix(execvp_cmd_line *first, pipeline_placement *placement);
+
+void pin_pipeline_stage(const pipeline_placement *placement, int stage);
+
+#endif
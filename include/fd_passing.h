@@ -0,0 +1,26 @@
+/* fd_passing.h */
+
+#ifndef FD_PASSING_H_INCLUDED
+#define FD_PASSING_H_INCLUDED
+
+#include <stdbool.h>
+
+/* the zygote's and the server's requests carry `stdin`, `stdout`, `stderr`
+and an fd of the working directory */
+enum fd_passing_consts {
+    passed_fds_count = 4
+};
+
+void open_standard_streams();
+
+int pack_string(char *buf, int buf_len, int len, const char *str);
+
+int pack_strings(char *buf, int buf_len, int len, char **strs, int *count);
+
+bool send_with_fds(int sock, const char *buf, int len, const int *fds);
+
+int receive_with_fds(int sock, char *buf, int buf_len, int *fds);
+
+bool adopt_passed_fds(const int *fds);
+
+#endif
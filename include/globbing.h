@@ -0,0 +1,22 @@
+/* globbing.h */
+
+#ifndef GLOBBING_H_INCLUDED
+#define GLOBBING_H_INCLUDED
+
+#include "constants.h"
+
+typedef struct tag_glob_matches {
+    char **arr;
+    int len;
+    int arr_len;
+} glob_matches;
+
+void expand_glob_pattern(
+    const char *pattern, directory_listing **cache, glob_matches *matches
+);
+
+void free_glob_matches(glob_matches *matches);
+
+void free_directory_cache(directory_listing **cache);
+
+#endif
@@ -0,0 +1,36 @@
+/* history.h */
+
+#ifndef HISTORY_H_INCLUDED
+#define HISTORY_H_INCLUDED
+
+#include <stdbool.h>
+
+/* an entry of the history, it points into the mapping of the file and stays
+valid until the next `refresh_history` */
+typedef struct tag_history_entry {
+    const char *arr;
+    int len;
+    /* the offset of the entry in the file, the position of the newer one
+    is after it */
+    long pos;
+} history_entry;
+
+void init_history();
+
+void refresh_history();
+
+long history_end();
+
+bool previous_history_entry(long pos, history_entry *entry);
+
+bool next_history_entry(long pos, history_entry *entry);
+
+bool search_history(
+    const char *query, int query_len, long pos, history_entry *entry
+);
+
+void add_history_entry(const char *line, int len);
+
+void free_history();
+
+#endif
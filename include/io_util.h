@@ -0,0 +1,17 @@
+/* io_util.h */
+
+#ifndef IO_UTIL_H_INCLUDED
+#define IO_UTIL_H_INCLUDED
+
+#include <stdbool.h>
+#include <stddef.h>
+
+int move_fd_above_user_range(int fd);
+
+bool write_whole_buffer(int fd, const char *buf, size_t len);
+
+char *shell_file_path(
+    const char *variable, const char *default_name, const char *suffix
+);
+
+#endif
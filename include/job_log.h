@@ -0,0 +1,28 @@
+/* job_log.h */
+
+#ifndef JOB_LOG_H_INCLUDED
+#define JOB_LOG_H_INCLUDED
+
+#include "constants.h"
+#include <stdbool.h>
+#include <sys/types.h>
+
+int open_job_log(const execvp_cmd_line *cmdline, int *job);
+
+void set_job_log_pid(int job, pid_t pid, int status);
+
+void note_background_exit(pid_t pid, int status);
+
+void feed_job_logs();
+
+bool job_logs_open();
+
+void report_finished_jobs();
+
+void wait_for_input(int fd);
+
+int handle_joblog_command(char **argv);
+
+void free_job_logs();
+
+#endif
@@ -0,0 +1,22 @@
+/* job_priority.h */
+
+#ifndef JOB_PRIORITY_H_INCLUDED
+#define JOB_PRIORITY_H_INCLUDED
+
+#include <stdbool.h>
+
+typedef struct tag_job_priority {
+    /* the children of the pipeline being launched are given the priority
+    below, nothing is changed if it isn't `enabled` */
+    bool enabled;
+    int policy;
+    int nice_increment;
+    /* the I/O class and level packed for `ioprio_set`, 0 to keep them */
+    int ioprio;
+} job_priority;
+
+bool read_background_priority(job_priority *priority);
+
+void lower_job_priority(const job_priority *priority);
+
+#endif
@@ -0,0 +1,18 @@
+/* line_editing.h */
+
+#ifndef LINE_EDITING_H_INCLUDED
+#define LINE_EDITING_H_INCLUDED
+
+#include <stdbool.h>
+
+void init_line_editing();
+
+bool line_editing_active();
+
+int read_edited_character();
+
+void print_prompt();
+
+void free_line_editing();
+
+#endif
@@ -0,0 +1,10 @@
+/* line_reading.h */
+
+#ifndef LINE_READING_H_INCLUDED
+#define LINE_READING_H_INCLUDED
+
+void init_line_reading();
+
+int handle_read_command(char **argv);
+
+#endif
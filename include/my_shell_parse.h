@@ -0,0 +1,60 @@
+/* my_shell_parse.h */
+
+#ifndef MY_SHELL_PARSE_H_INCLUDED
+#define MY_SHELL_PARSE_H_INCLUDED
+
+/* The tokenizer and the parser of the shell as a library, built by
+`make lib` into `libmy_shell_parse.a` and `libmy_shell_parse.so`. A parser
+splits a text into command lines, and those into words and separators, the
+way the shell does, but expands and runs nothing: `$x`, `$(...)` and the
+like are kept as they are written. Every parser has its own state, so any
+number of them may be used at once, from any threads */
+
+#include "constants.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct tag_parse_allocator {
+    /* acts as `realloc`, except that it frees the `ptr` if the `size` is 0.
+    The `ctx` is passed to it as is */
+    void *(*reallocate)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+} parse_allocator;
+
+typedef struct tag_parsed_line {
+    /* the command line in the text, with its here-document bodies */
+    const char *text;
+    int len;
+    /* the error the shell would report for the line */
+    error_code err;
+    /* the words and separators of the line, in order */
+    const word_item *words;
+    /* the stages of the pipeline, set if the plan has been asked for and the
+    line has no error. The `arr` of a stage is its `argv` ending with NULL,
+    the redirections are its `fd_ops`, in the order they are applied */
+    const execvp_cmd_line *stages;
+    int stages_len;
+    bool background_execution;
+} parsed_line;
+
+/* the line and everything it points to is valid until the function returns */
+typedef void (*parsed_line_handler)(const parsed_line *line, void *data);
+
+typedef struct tag_shell_parser shell_parser;
+
+shell_parser *new_shell_parser(const parse_allocator *allocator);
+
+int parse_shell_text(
+    shell_parser *parser, const char *text, int len, bool plan,
+    parsed_line_handler handler, void *data
+);
+
+error_code validate_shell_line(
+    shell_parser *parser, const char *line, int len
+);
+
+const char *parse_error_message(error_code err);
+
+void free_shell_parser(shell_parser *parser);
+
+#endif
@@ -0,0 +1,24 @@
+/* parse_allocation.h */
+
+#ifndef PARSE_ALLOCATION_H_INCLUDED
+#define PARSE_ALLOCATION_H_INCLUDED
+
+/* The modules built into the parsing library get their memory from the
+allocator of the parser running in the thread. The header is included after
+the system ones, so only the calls of the module itself are redirected */
+
+#if defined(PARSE_LIBRARY_MODE)
+#include <stddef.h>
+
+void *parse_malloc(size_t size);
+
+void *parse_realloc(void *ptr, size_t size);
+
+void parse_free(void *ptr);
+
+#define malloc(size) parse_malloc(size)
+#define realloc(ptr, size) parse_realloc(ptr, size)
+#define free(ptr) parse_free(ptr)
+#endif
+
+#endif
@@ -0,0 +1,8 @@
+/* rc_file.h */
+
+#ifndef RC_FILE_H_INCLUDED
+#define RC_FILE_H_INCLUDED
+
+void run_rc_file();
+
+#endif
@@ -0,0 +1,13 @@
+/* server.h */
+
+#ifndef SERVER_H_INCLUDED
+#define SERVER_H_INCLUDED
+
+#define SERVER_OPTION "--server"
+#define CONNECT_OPTION "--connect"
+
+const char *run_server(const char *path, int *exit_status);
+
+int run_client(const char *path, const char *text);
+
+#endif
@@ -5,10 +5,30 @@
 
 #include "constants.h"
 
+void init_str(string *str, const char *input_arr, int input_len);
+
+void free_str_memory(string *str);
+
+int read_next_character(string *str);
+
 void free_list_of_words(curr_str_words_list *link_list);
 
 void process_end_of_string(string *str);
 
 void process_character(string *str);
 
+void run_commands_from_text(
+    const char *text, int len, curr_word_dynamic_char_arr *output
+);
+
+void expand_words(const char *text, int len, curr_str_words_list *words);
+
+typedef struct tag_compiled_command compiled_command;
+
+compiled_command *compile_simple_command(const char *text, int len);
+
+void run_compiled_command(const compiled_command *cmd);
+
+void free_compiled_command(compiled_command *cmd);
+
 #endif
@@ -0,0 +1,18 @@
+/* stream_copying.h */
+
+#ifndef STREAM_COPYING_H_INCLUDED
+#define STREAM_COPYING_H_INCLUDED
+
+#include <stdbool.h>
+
+int copy_stream(int fd_in, int fd_out);
+
+bool cat_arguments_supported(char **argv);
+
+int handle_cat_command(char **argv);
+
+bool tee_arguments_supported(char **argv);
+
+int handle_tee_command(char **argv);
+
+#endif
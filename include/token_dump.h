@@ -0,0 +1,17 @@
+/* token_dump.h */
+
+#ifndef TOKEN_DUMP_H_INCLUDED
+#define TOKEN_DUMP_H_INCLUDED
+
+#include "constants.h"
+#include <stdbool.h>
+
+#define DUMP_TOKENS_OPTION "--dump-tokens"
+
+bool start_token_dump(const char *format);
+
+void dump_tokens(const curr_str_words_list *words);
+
+bool finish_token_dump();
+
+#endif
@@ -0,0 +1,50 @@
+/* variables.h */
+
+#ifndef VARIABLES_H_INCLUDED
+#define VARIABLES_H_INCLUDED
+
+#include <stdbool.h>
+
+typedef struct tag_positional_parameters {
+    /* `$1` is `arr[0]`, the array isn't copied */
+    char **arr;
+    int len;
+} positional_parameters;
+
+void init_variables();
+
+void free_variables();
+
+bool variable_name_character(int c, bool first);
+
+bool special_parameter_character(int c);
+
+const char *get_variable(const char *name);
+
+const char *get_parameter(const char *name);
+
+positional_parameters replace_positional_parameters(
+    positional_parameters new_params
+);
+
+positional_parameters current_positional_parameters();
+
+void set_script_name(const char *name);
+
+void assign_variable(const char *name, const char *value);
+
+bool assignment_word(const char *word);
+
+bool valid_variable_name(const char *name);
+
+void apply_assignment(const char *word, bool exported);
+
+void refresh_environment();
+
+int handle_export_command(char **argv);
+
+int handle_unset_command(char **argv);
+
+int handle_shift_command(char **argv);
+
+#endif
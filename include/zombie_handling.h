@@ -7,6 +7,12 @@ void handle_background_zombie_process(int sig_num);
 
 void set_signal_disposition(int signum, void (*handler)(int));
 
+void suspend_background_zombie_handling();
+
+void resume_background_zombie_handling();
+
+int wait_for_one_of_child_processes(const int *pids, int len, int *status);
+
 int getchar_signal_protected();
 
 #endif
@@ -0,0 +1,17 @@
+/* zygote.h */
+
+#ifndef ZYGOTE_H_INCLUDED
+#define ZYGOTE_H_INCLUDED
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+void start_zygote();
+
+bool zygote_running();
+
+pid_t spawn_with_zygote(char **argv, int fd_input, int fd_output);
+
+void stop_zygote();
+
+#endif
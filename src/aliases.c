@@ -0,0 +1,259 @@
+/* aliases.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "aliases.h"
+#include "constants.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(EXEC_MODE)
+#define ERR_ALIAS_NOT_FOUND "my_shell: %s: %s: not found\n"
+#define ERR_ALIAS_INVALID_NAME "my_shell: alias: `%s': invalid alias name\n"
+
+enum aliases_consts {
+    max_nested_aliases      = 16
+};
+
+typedef struct tag_alias_item {
+    char *name;
+    char *value;
+    /* the value split into words once, when the alias is defined */
+    char **words;
+    int words_len;
+    struct tag_alias_item *next;
+} alias_item;
+
+static alias_item *aliases = NULL;
+
+static char *copy_string(const char *src, int len)
+{
+    char *res = malloc(len + 1);
+    memcpy(res, src, len);
+    res[len] = '\0';
+    return res;
+}
+
+static void split_alias_value(alias_item *item)
+{
+    /* the words are separated by the blanks, the value isn't parsed any
+    further */
+    const char *p = item->value;
+    int arr_len = 4;
+    item->words = malloc(arr_len * sizeof(char*));
+    item->words_len = 0;
+    while (true) {
+        const char *start;
+        while (*p == ' ' || *p == '\t')
+            p++;
+        if (!*p)
+            break;
+        start = p;
+        while (*p && *p != ' ' && *p != '\t')
+            p++;
+        if (item->words_len == arr_len) {
+            arr_len *= 2;
+            item->words = realloc(item->words, arr_len * sizeof(char*));
+        }
+        item->words[item->words_len++] = copy_string(start, p - start);
+    }
+}
+
+static void free_alias_value(alias_item *item)
+{
+    int i;
+    for (i = 0; i < item->words_len; i++)
+        free(item->words[i]);
+    free(item->words);
+    free(item->value);
+}
+
+static alias_item **find_alias_link(const char *name, int name_len)
+{
+    alias_item **link;
+    for (link = &aliases; *link; link = &(*link)->next) {
+        if ((int)strlen((*link)->name) == name_len &&
+            0 == memcmp((*link)->name, name, name_len))
+        {
+            return link;
+        }
+    }
+    return link;
+}
+
+static void define_alias(const char *name, int name_len, const char *value)
+{
+    alias_item **link = find_alias_link(name, name_len);
+    if (*link)
+        free_alias_value(*link);
+    else {
+        *link = malloc(sizeof(alias_item));
+        (*link)->name = copy_string(name, name_len);
+        (*link)->next = NULL;
+    }
+    (*link)->value = copy_string(value, strlen(value));
+    split_alias_value(*link);
+}
+
+static void remove_alias(alias_item **link)
+{
+    alias_item *tmp = *link;
+    *link = tmp->next;
+    free_alias_value(tmp);
+    free(tmp->name);
+    free(tmp);
+}
+
+void free_aliases()
+{
+    while (aliases)
+        remove_alias(&aliases);
+}
+
+static void add_word_to_list(curr_str_words_list *words, char *word)
+{
+    word_item *item = malloc(sizeof(word_item));
+    item->word = word;
+    item->separator_val = none;
+    item->quoted = false;
+    item->next = NULL;
+    if (words->last)
+        words->last->next = item;
+    else
+        words->first = item;
+    words->last = item;
+    words->len++;
+}
+
+static void replace_first_word(
+    execvp_cmd_line *cmdline, const alias_item *alias,
+    curr_str_words_list *words
+)
+{
+    /* the copies of the alias words belong to the `words` of the command
+    line, so the alias may be redefined or removed by the command itself */
+    int old_len = 0, new_len, i;
+    char **arr;
+    while (cmdline->arr[old_len])
+        old_len++;
+    new_len = alias->words_len + old_len - 1;
+    arr = malloc((new_len + 1) * sizeof(char*));
+    for (i = 0; i < alias->words_len; i++) {
+        arr[i] = copy_string(alias->words[i], strlen(alias->words[i]));
+        add_word_to_list(words, arr[i]);
+    }
+    memcpy(&arr[i], &cmdline->arr[1], old_len * sizeof(char*));
+    free(cmdline->arr);
+    cmdline->arr = arr;
+    cmdline->arr_len = new_len + 1;
+}
+
+static bool alias_used(const alias_item **used, int used_len,
+    const alias_item *alias)
+{
+    int i;
+    for (i = 0; i < used_len; i++) {
+        if (used[i] == alias)
+            return true;
+    }
+    return false;
+}
+
+void expand_alias(execvp_cmd_line *cmdline, curr_str_words_list *words)
+{
+    /* the first word of each command of the pipeline is replaced. An alias
+    whose value starts with another alias is expanded again, as long as
+    no alias is used twice */
+    const alias_item *used[max_nested_aliases];
+    for (; cmdline; cmdline = cmdline->next) {
+        int used_len = 0;
+        while (cmdline->arr[0] && used_len < max_nested_aliases) {
+            const char *name = cmdline->arr[0];
+            const alias_item *alias = *find_alias_link(name, strlen(name));
+            if (!alias || !alias->words_len ||
+                alias_used(used, used_len, alias))
+            {
+                break;
+            }
+            used[used_len++] = alias;
+            replace_first_word(cmdline, alias, words);
+        }
+    }
+}
+
+static void print_alias(const alias_item *item)
+{
+    printf("alias %s='%s'\n", item->name, item->value);
+}
+
+static bool valid_alias_name(const char *name, int name_len)
+{
+    int i;
+    if (name_len == 0)
+        return false;
+    for (i = 0; i < name_len; i++) {
+        if (strchr(" \t\n;&|<>()$`\\\"'/", name[i]))
+            return false;
+    }
+    return true;
+}
+
+int handle_alias_command(char **argv)
+{
+    /* `alias [NAME[=VALUE]]...`, prints every alias if there are no
+    arguments */
+    int status = 0;
+    char **p;
+    if (!argv[1]) {
+        const alias_item *item;
+        for (item = aliases; item; item = item->next)
+            print_alias(item);
+        return 0;
+    }
+    for (p = &argv[1]; *p; p++) {
+        const char *eq = strchr(*p, '=');
+        if (eq) {
+            if (valid_alias_name(*p, eq - *p))
+                define_alias(*p, eq - *p, eq + 1);
+            else {
+                fprintf(stderr, ERR_ALIAS_INVALID_NAME, *p);
+                status = 1;
+            }
+        } else {
+            const alias_item *item = *find_alias_link(*p, strlen(*p));
+            if (item)
+                print_alias(item);
+            else {
+                fprintf(stderr, ERR_ALIAS_NOT_FOUND, argv[0], *p);
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
+
+int handle_unalias_command(char **argv)
+{
+    /* `unalias -a` removes every alias */
+    int status = 0;
+    char **p;
+    if (argv[1] && (0 == strcmp(argv[1], "-a"))) {
+        free_aliases();
+        return 0;
+    }
+    for (p = &argv[1]; *p; p++) {
+        alias_item **link = find_alias_link(*p, strlen(*p));
+        if (*link)
+            remove_alias(link);
+        else {
+            fprintf(stderr, ERR_ALIAS_NOT_FOUND, argv[0], *p);
+            status = 1;
+        }
+    }
+    return status;
+}
+#endif
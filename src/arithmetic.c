@@ -0,0 +1,468 @@
+/* arithmetic.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "arithmetic.h"
+#include "variables.h"
+#include <ctype.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(EXEC_MODE)
+#define ERR_ARITHMETIC "my_shell: %s: %s (error token is \"%s\")\n"
+
+enum arithmetic_consts {
+    /* the binary operators from the lowest precedence to the highest one */
+    logical_or_level,
+    logical_and_level,
+    bitwise_or_level,
+    bitwise_xor_level,
+    bitwise_and_level,
+    equality_level,
+    relational_level,
+    shift_level,
+    additive_level,
+    multiplicative_level,
+    unary_level,
+    max_number_len = 32
+};
+
+typedef struct tag_arith_parser {
+    const char *pos;
+    /* greater than 0 while parsing an operand that isn't evaluated: the right
+    one of `&&` and `||` or a branch of `?:`. Such operand has no side
+    effects and doesn't fail on division by zero */
+    int no_eval;
+    /* the description of the first error, and where it was found */
+    const char *err;
+    const char *err_pos;
+} arith_parser;
+
+typedef struct tag_binary_operator {
+    const char *token;
+    int level;
+} binary_operator;
+
+/* longer tokens go first, so `<<` isn't taken for `<`. The tokens followed
+by `=` are the compound assignments, which aren't binary operators */
+static const binary_operator binary_operators[] = {
+    { "||", logical_or_level },
+    { "&&", logical_and_level },
+    { "==", equality_level },
+    { "!=", equality_level },
+    { "<<", shift_level },
+    { ">>", shift_level },
+    { "<=", relational_level },
+    { ">=", relational_level },
+    { "|",  bitwise_or_level },
+    { "^",  bitwise_xor_level },
+    { "&",  bitwise_and_level },
+    { "<",  relational_level },
+    { ">",  relational_level },
+    { "+",  additive_level },
+    { "-",  additive_level },
+    { "*",  multiplicative_level },
+    { "/",  multiplicative_level },
+    { "%",  multiplicative_level },
+    { NULL, 0 }
+};
+
+static const char *const assignment_operators[] = {
+    "<<=", ">>=", "+=", "-=", "*=", "/=", "%=", "&=", "^=", "|=", "=", NULL
+};
+
+static int64_t parse_comma_expression(arith_parser *parser);
+static int64_t parse_assignment(arith_parser *parser);
+static int64_t parse_unary(arith_parser *parser);
+
+static void set_error_at(
+    arith_parser *parser, const char *err, const char *err_pos
+)
+{
+    if (!parser->err) {
+        parser->err = err;
+        parser->err_pos = err_pos;
+    }
+}
+
+static void set_error(arith_parser *parser, const char *err)
+{
+    set_error_at(parser, err, parser->pos);
+}
+
+static void skip_spaces(arith_parser *parser)
+{
+    while (isspace((unsigned char)*parser->pos))
+        parser->pos++;
+}
+
+static bool accept(arith_parser *parser, const char *token)
+{
+    int len = strlen(token);
+    skip_spaces(parser);
+    if (0 != strncmp(parser->pos, token, len))
+        return false;
+    parser->pos += len;
+    return true;
+}
+
+static int name_length(const char *p)
+{
+    int len = 0;
+    while (variable_name_character((unsigned char)p[len], (len == 0)))
+        len++;
+    return len;
+}
+
+static bool parse_number_text(const char *p, const char **end, int64_t *value)
+{
+    /* decimal, `0x` hexadecimal or `0` octal, wrapping around on overflow
+    like the rest of the 64-bit arithmetic */
+    uint64_t res = 0;
+    int base = 10;
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+        base = 16;
+        p += 2;
+    } else
+    if (p[0] == '0')
+        base = 8;
+    if (!isxdigit((unsigned char)*p) && base == 16)
+        return false;
+    for (; isalnum((unsigned char)*p); p++) {
+        int digit;
+        if (isdigit((unsigned char)*p))
+            digit = *p - '0';
+        else
+            digit = tolower((unsigned char)*p) - 'a' + 10;
+        if (digit >= base)
+            return false;
+        res = res*base + digit;
+    }
+    *end = p;
+    *value = (int64_t)res;
+    return true;
+}
+
+static int64_t variable_value(arith_parser *parser, const char *name)
+{
+    /* an unset or empty variable is 0 */
+    const char *value = get_parameter(name), *end;
+    int64_t res;
+    bool negative;
+    if (!value)
+        return 0;
+    while (isspace((unsigned char)*value))
+        value++;
+    if (*value == '\0')
+        return 0;
+    negative = (*value == '-');
+    if (*value == '-' || *value == '+')
+        value++;
+    if (!parse_number_text(value, &end, &res) || *end != '\0') {
+        set_error(parser, "variable value is not a number");
+        return 0;
+    }
+    return negative ? (int64_t)(0 - (uint64_t)res) : res;
+}
+
+static void assign_value(arith_parser *parser, const char *name, int64_t value)
+{
+    char text[max_number_len];
+    if (parser->no_eval || parser->err)
+        return;
+    sprintf(text, "%" PRId64, value);
+    assign_variable(name, text);
+}
+
+static char *parse_name(arith_parser *parser)
+{
+    /* returns the copy of the variable name at the current position (which
+    may start with a `$`, then it may be a parameter like `$1` or `$#`), or
+    NULL if there is no name */
+    const char *p;
+    char *name;
+    int len;
+    skip_spaces(parser);
+    p = parser->pos;
+    len = 0;
+    if (*p == '$') {
+        p++;
+        if (special_parameter_character((unsigned char)*p))
+            len = 1;
+    }
+    if (len == 0)
+        len = name_length(p);
+    if (len == 0)
+        return NULL;
+    name = malloc(len+1);
+    memcpy(name, p, len);
+    name[len] = '\0';
+    parser->pos = p + len;
+    return name;
+}
+
+static int64_t apply_binary_operator(
+    arith_parser *parser, const char *token, const char *token_pos,
+    int64_t left, int64_t right
+)
+{
+    /* signed overflow wraps around instead of being undefined. The division
+    by zero is reported at the `token_pos`, where the operator is written */
+    uint64_t l = left, r = right;
+    switch (token[0]) {
+        case ('+'):
+            return (int64_t)(l + r);
+        case ('-'):
+            return (int64_t)(l - r);
+        case ('*'):
+            return (int64_t)(l * r);
+        case ('/'):
+        case ('%'):
+            if (right == 0) {
+                if (!parser->no_eval)
+                    set_error_at(parser, "division by 0", token_pos);
+                return 0;
+            }
+            if (left == INT64_MIN && right == -1)
+                return (token[0] == '/') ? INT64_MIN : 0;
+            return (token[0] == '/') ? left / right : left % right;
+        case ('<'):
+            if (token[1] == '<')
+                return (int64_t)(l << (r & 63));
+            return (token[1] == '=') ? (left <= right) : (left < right);
+        case ('>'):
+            if (token[1] == '>')
+                return left >> (r & 63);
+            return (token[1] == '=') ? (left >= right) : (left > right);
+        case ('='):
+            return (left == right);
+        case ('!'):
+            return (left != right);
+        case ('&'):
+            return (token[1] == '&') ? (left && right) : (left & right);
+        case ('|'):
+            return (token[1] == '|') ? (left || right) : (left | right);
+        case ('^'):
+            return left ^ right;
+    }
+    return 0;
+}
+
+static const binary_operator *match_binary_operator(
+    arith_parser *parser, int level
+)
+{
+    const binary_operator *op;
+    skip_spaces(parser);
+    for (op = binary_operators; op->token; op++) {
+        int len = strlen(op->token);
+        if (0 != strncmp(parser->pos, op->token, len))
+            continue;
+        /* `a += 1` must not be taken for `a + (= 1)` */
+        if (parser->pos[len] == '=' && op->level != equality_level &&
+            op->level != relational_level)
+        {
+            return NULL;
+        }
+        return (op->level == level) ? op : NULL;
+    }
+    return NULL;
+}
+
+static int64_t parse_binary(arith_parser *parser, int level)
+{
+    int64_t left;
+    const binary_operator *op;
+    if (level == unary_level)
+        return parse_unary(parser);
+    left = parse_binary(parser, level+1);
+    while ((op = match_binary_operator(parser, level))) {
+        const char *op_pos = parser->pos;
+        int64_t right;
+        /* the right operand of `&&` and `||` is evaluated only if the left
+        one doesn't decide the result */
+        bool short_circuit =
+            (level == logical_and_level && !left) ||
+            (level == logical_or_level && left);
+        parser->pos += strlen(op->token);
+        parser->no_eval += short_circuit;
+        right = parse_binary(parser, level+1);
+        parser->no_eval -= short_circuit;
+        left = apply_binary_operator(parser, op->token, op_pos, left, right);
+    }
+    return left;
+}
+
+static int64_t parse_variable_reference(arith_parser *parser)
+{
+    /* a variable, optionally with the postfix `++` or `--` */
+    char *name = parse_name(parser);
+    int64_t value;
+    if (!name) {
+        set_error(parser, "variable name expected");
+        return 0;
+    }
+    value = variable_value(parser, name);
+    if (accept(parser, "++"))
+        assign_value(parser, name, (int64_t)((uint64_t)value + 1));
+    else
+    if (accept(parser, "--"))
+        assign_value(parser, name, (int64_t)((uint64_t)value - 1));
+    free(name);
+    return value;
+}
+
+static int64_t parse_primary(arith_parser *parser)
+{
+    int64_t value = 0;
+    skip_spaces(parser);
+    if (accept(parser, "(")) {
+        value = parse_comma_expression(parser);
+        if (!accept(parser, ")"))
+            set_error(parser, "missing `)'");
+        return value;
+    }
+    if (isdigit((unsigned char)*parser->pos)) {
+        const char *end;
+        if (!parse_number_text(parser->pos, &end, &value)) {
+            set_error(parser, "invalid number");
+            return 0;
+        }
+        parser->pos = end;
+        return value;
+    }
+    if (*parser->pos == '$' ||
+        variable_name_character((unsigned char)*parser->pos, true))
+    {
+        return parse_variable_reference(parser);
+    }
+    set_error(parser, "operand expected");
+    return 0;
+}
+
+static int64_t parse_prefix_increment(arith_parser *parser, int64_t step)
+{
+    char *name = parse_name(parser);
+    int64_t value;
+    if (!name) {
+        set_error(parser, "variable name expected");
+        return 0;
+    }
+    value = (int64_t)((uint64_t)variable_value(parser, name) + step);
+    assign_value(parser, name, value);
+    free(name);
+    return value;
+}
+
+static int64_t parse_unary(arith_parser *parser)
+{
+    if (accept(parser, "++"))
+        return parse_prefix_increment(parser, 1);
+    if (accept(parser, "--"))
+        return parse_prefix_increment(parser, -1);
+    if (accept(parser, "+"))
+        return parse_unary(parser);
+    if (accept(parser, "-"))
+        return (int64_t)(0 - (uint64_t)parse_unary(parser));
+    if (accept(parser, "!"))
+        return !parse_unary(parser);
+    if (accept(parser, "~"))
+        return ~parse_unary(parser);
+    return parse_primary(parser);
+}
+
+static int64_t parse_conditional(arith_parser *parser)
+{
+    /* only the chosen branch of `?:` is evaluated */
+    int64_t condition = parse_binary(parser, logical_or_level), left, right;
+    if (!accept(parser, "?"))
+        return condition;
+    parser->no_eval += !condition;
+    left = parse_assignment(parser);
+    parser->no_eval -= !condition;
+    if (!accept(parser, ":")) {
+        set_error(parser, "`:' expected for conditional expression");
+        return 0;
+    }
+    parser->no_eval += !!condition;
+    right = parse_conditional(parser);
+    parser->no_eval -= !!condition;
+    return condition ? left : right;
+}
+
+static const char *match_assignment_operator(arith_parser *parser)
+{
+    const char *const *op;
+    skip_spaces(parser);
+    for (op = assignment_operators; *op; op++) {
+        int len = strlen(*op);
+        if (0 != strncmp(parser->pos, *op, len))
+            continue;
+        /* `a == b` is a comparison */
+        if (0 == strcmp(*op, "=") && parser->pos[1] == '=')
+            return NULL;
+        return *op;
+    }
+    return NULL;
+}
+
+static int64_t parse_assignment(arith_parser *parser)
+{
+    /* `NAME op= value`, where the `op` is empty for the simple assignment,
+    otherwise the conditional expression */
+    const char *start = parser->pos, *op, *op_pos;
+    char *name = parse_name(parser);
+    int64_t value;
+    if (!name || !(op = match_assignment_operator(parser))) {
+        free(name);
+        parser->pos = start;
+        return parse_conditional(parser);
+    }
+    op_pos = parser->pos;
+    parser->pos += strlen(op);
+    value = parse_assignment(parser);
+    if (op[0] != '=') {
+        char token[3] = { op[0], op[1] != '=' ? op[1] : '\0', '\0' };
+        value = apply_binary_operator(
+            parser, token, op_pos, variable_value(parser, name), value
+        );
+    }
+    assign_value(parser, name, value);
+    free(name);
+    return value;
+}
+
+static int64_t parse_comma_expression(arith_parser *parser)
+{
+    int64_t value = parse_assignment(parser);
+    while (accept(parser, ","))
+        value = parse_assignment(parser);
+    return value;
+}
+
+bool evaluate_arithmetic(const char *expr, int64_t *result)
+{
+    /* the 64-bit integer arithmetic of C with its operator precedence and
+    the shell variables as operands. An empty expression is 0 */
+    arith_parser parser = { expr, 0, NULL, NULL };
+    skip_spaces(&parser);
+    *result = 0;
+    if (*parser.pos == '\0')
+        return true;
+    *result = parse_comma_expression(&parser);
+    skip_spaces(&parser);
+    if (!parser.err && *parser.pos != '\0')
+        set_error(&parser, "syntax error in expression");
+    if (parser.err) {
+        fprintf(stderr, ERR_ARITHMETIC, expr, parser.err, parser.err_pos);
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,560 @@
+/* batch_execution.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "batch_execution.h"
+#include "cmd_execution.h"
+#include "constants.h"
+#include "error_handling.h"
+#include "io_util.h"
+#include "zombie_handling.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+#define ERR_BATCH_USAGE \
+    "my_shell: batch: usage: batch [-P N] command [args...] [::: items...]\n"
+#define ERR_BATCH_ARG_TOO_LONG \
+    "my_shell: batch: argument list too long for a single item: %.32s...\n"
+#define ERR_PARALLEL_USAGE \
+    "my_shell: parallel: usage: parallel [-j N] [-k] command [args...] " \
+    "[::: items...]\n"
+#define ERR_PARALLEL_SUMMARY "my_shell: parallel: %d of %d jobs failed:\n"
+#define ERR_PARALLEL_FAILED_JOB "my_shell: parallel:     %s (status %d)\n"
+
+#define ITEM_PLACEHOLDER "{}"
+
+enum batch_consts {
+    /* POSIX recommends to leave 2048 bytes for the new process environment
+    changes (the same headroom is used by `xargs`) */
+    arg_max_headroom        = 2048,
+    init_items_arr_len      = 256,
+    stdin_read_block_size   = 65536,
+    batch_failure_status    = 123,
+    /* `parallel` exit status is the number of failed jobs, up to this value */
+    max_parallel_status     = 101,
+    init_job_output_len     = 4096
+};
+
+typedef struct tag_work_items {
+    char **arr;
+    int len;
+    int arr_len;
+    /* contains the raw `stdin` contents the items are pointing into */
+    char *buf;
+} work_items;
+
+typedef struct tag_parallel_job {
+    int pid;
+    /* the read end of the pipe the job's `stdout` is captured into, -1 once
+    it has been read to the end */
+    int fd;
+    int status;
+    bool done;
+    char *output;
+    size_t output_len;
+    size_t output_arr_len;
+} parallel_job;
+
+typedef struct tag_parallel_run {
+    parallel_job *jobs;
+    /* contains the indexes of the jobs which are still running */
+    int *running;
+    int running_len;
+    /* the first job which output hasn't been written yet */
+    int next_to_print;
+    bool keep_order;
+} parallel_run;
+
+static bool is_items_marker(const char *word)
+{
+    return (0 == strcmp(":::", word));
+}
+
+static int parse_max_procs_option(
+    char **argv, int *idx, const char *option, int *max_procs
+)
+{
+    /* accepts both the `-P N` and the `-PN` forms of the option */
+    size_t option_len = strlen(option);
+    const char *value;
+    if (0 != strncmp(argv[*idx], option, option_len))
+        return -1;
+    value = argv[*idx][option_len] ? &argv[*idx][option_len] : argv[++(*idx)];
+    if (!value)
+        return -1;
+    *max_procs = atoi(value);
+    return (*max_procs < 1) ? -1 : 0;
+}
+
+static int parse_batch_options(char **argv, int *max_procs)
+{
+    int idx = 1;
+    for (; argv[idx] && argv[idx][0] == '-'; idx++) {
+        if (parse_max_procs_option(argv, &idx, "-P", max_procs) == -1)
+            return -1;
+    }
+    if (!argv[idx] || is_items_marker(argv[idx]))
+        return -1;
+    return idx;
+}
+
+static void add_work_item(work_items *items, char *item)
+{
+    if (items->len == items->arr_len) {
+        items->arr_len *= 2;
+        items->arr = realloc(items->arr, items->arr_len * sizeof(char*));
+    }
+    items->arr[items->len] = item;
+    items->len++;
+}
+
+static char *read_whole_stdin()
+{
+    size_t len = 0, buf_len = stdin_read_block_size;
+    char *buf = malloc(buf_len + 1);
+    while (true) {
+        ssize_t res;
+        if (buf_len - len < stdin_read_block_size) {
+            buf_len *= 2;
+            buf = realloc(buf, buf_len + 1);
+        }
+        res = read(0, buf + len, buf_len - len);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        error_handling(res, __FILE__, __LINE__, "read");
+        if (res <= 0)
+            break;
+        len += res;
+    }
+    buf[len] = '\0';
+    return buf;
+}
+
+static void split_stdin_into_items(work_items *items, const char *delimiters)
+{
+    char *p;
+    items->buf = read_whole_stdin();
+    for (p = items->buf; *p;) {
+        while (*p && strchr(delimiters, *p))
+            *p++ = '\0';
+        if (!*p)
+            break;
+        add_work_item(items, p);
+        p += strcspn(p, delimiters);
+    }
+}
+
+static int collect_work_items(
+    char **argv, int cmd_idx, work_items *items, const char *delimiters
+)
+{
+    /* returns the number of fixed words: the command and its own args */
+    int idx;
+    items->len = 0;
+    items->arr_len = init_items_arr_len;
+    items->arr = malloc(items->arr_len * sizeof(char*));
+    items->buf = NULL;
+    for (idx = cmd_idx; argv[idx]; idx++) {
+        if (is_items_marker(argv[idx])) {
+            int i;
+            for (i = idx+1; argv[i]; i++)
+                add_work_item(items, argv[i]);
+            return idx - cmd_idx;
+        }
+    }
+    split_stdin_into_items(items, delimiters);
+    return idx - cmd_idx;
+}
+
+static void free_work_items(work_items *items)
+{
+    free(items->arr);
+    free(items->buf);
+}
+
+static long argument_space_available()
+{
+    /* `execve` fails with `E2BIG` if the arguments and the environment
+    together don't fit into `ARG_MAX` */
+    long env_size = 0;
+    char **env;
+    for (env = environ; *env; env++)
+        env_size += strlen(*env) + 1 + sizeof(char*);
+    return sysconf(_SC_ARG_MAX) - env_size - arg_max_headroom;
+}
+
+static long argument_size(const char *arg)
+{
+    return strlen(arg) + 1 + sizeof(char*);
+}
+
+static bool process_failed(int status)
+{
+    return (!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+}
+
+static bool reap_batch_process(int *pids, int *running)
+{
+    /* returns `true` if the reaped process failed. Only the batch's own
+    processes are waited for, the background ones are left to the handler */
+    int status, idx = wait_for_one_of_child_processes(pids, *running, &status);
+    if (idx == -1) {
+        *running = 0;
+        return true;
+    }
+    pids[idx] = pids[*running-1];
+    (*running)--;
+    return process_failed(status);
+}
+
+static int run_batches(
+    char **fixed, int fixed_len, const work_items *items, int max_procs
+)
+{
+    long budget = argument_space_available(), fixed_size = 0;
+    char **argv = malloc((fixed_len + items->len + 1) * sizeof(char*));
+    int *pids = malloc(max_procs * sizeof(int));
+    int i, idx = 0, running = 0;
+    bool failed = false;
+    for (i = 0; i < fixed_len; i++) {
+        argv[i] = fixed[i];
+        fixed_size += argument_size(fixed[i]);
+    }
+    suspend_background_zombie_handling();
+    do {
+        long size = fixed_size;
+        int len = fixed_len;
+        while (idx < items->len) {
+            long item_size = argument_size(items->arr[idx]);
+            if (size + item_size > budget)
+                break;
+            argv[len] = items->arr[idx];
+            size += item_size;
+            len++;
+            idx++;
+        }
+        if ((len == fixed_len) && (idx < items->len)) {
+            fprintf(stderr, ERR_BATCH_ARG_TOO_LONG, items->arr[idx]);
+            failed = true;
+            break;
+        }
+        argv[len] = NULL;
+        if (running == max_procs)
+            failed |= reap_batch_process(pids, &running);
+        pids[running] = launch_simple_command(argv, -1);
+        if (pids[running] > 0)
+            running++;
+        else
+            failed = true;
+    } while (idx < items->len);
+    while (running)
+        failed |= reap_batch_process(pids, &running);
+    resume_background_zombie_handling();
+    free(pids);
+    free(argv);
+    return failed ? batch_failure_status : 0;
+}
+
+int handle_batch_command(char **argv)
+{
+    work_items items;
+    int max_procs = 1, fixed_len, status;
+    int cmd_idx = parse_batch_options(argv, &max_procs);
+    if (cmd_idx == -1) {
+        fprintf(stderr, ERR_BATCH_USAGE);
+        return 1;
+    }
+    fixed_len = collect_work_items(argv, cmd_idx, &items, " \t\n");
+    status = run_batches(&argv[cmd_idx], fixed_len, &items, max_procs);
+    free_work_items(&items);
+    return status;
+}
+
+static int parse_parallel_options(char **argv, int *max_procs, bool *keep_order)
+{
+    int idx = 1;
+    for (; argv[idx] && argv[idx][0] == '-'; idx++) {
+        if (0 == strcmp(argv[idx], "-k"))
+            *keep_order = true;
+        else
+        if (parse_max_procs_option(argv, &idx, "-j", max_procs) == -1)
+            return -1;
+    }
+    if (!argv[idx] || is_items_marker(argv[idx]))
+        return -1;
+    return idx;
+}
+
+static char *substitute_item(const char *word, const char *item)
+{
+    /* replace every `{}` in the `word` with the `item` */
+    size_t item_len = strlen(item), len = strlen(word) + 1;
+    const char *p;
+    char *res, *dst;
+    for (p = strstr(word, ITEM_PLACEHOLDER); p; p = strstr(p+2, ITEM_PLACEHOLDER))
+        len += item_len;
+    res = malloc(len);
+    for (dst = res; *word;) {
+        if (0 == strncmp(word, ITEM_PLACEHOLDER, 2)) {
+            memcpy(dst, item, item_len);
+            dst += item_len;
+            word += 2;
+        } else
+            *dst++ = *word++;
+    }
+    *dst = '\0';
+    return res;
+}
+
+static char **build_job_argv(char **template, int template_len, const char *item)
+{
+    /* if the template has no `{}`, the item is appended as the last arg */
+    char **argv = malloc((template_len + 2) * sizeof(char*));
+    bool substituted = false;
+    int i;
+    for (i = 0; i < template_len; i++) {
+        if (strstr(template[i], ITEM_PLACEHOLDER)) {
+            argv[i] = substitute_item(template[i], item);
+            substituted = true;
+        } else
+            argv[i] = strdup(template[i]);
+    }
+    argv[i] = substituted ? NULL : strdup(item);
+    argv[i+1] = NULL;
+    return argv;
+}
+
+static void free_job_argv(char **argv)
+{
+    char **p;
+    for (p = argv; *p; p++)
+        free(*p);
+    free(argv);
+}
+
+static void start_parallel_job(
+    parallel_run *run, int job_idx, char **template, int template_len,
+    const char *item
+)
+{
+    parallel_job *job = &run->jobs[job_idx];
+    char **argv = build_job_argv(template, template_len, item);
+    int fd[2], res;
+    res = pipe2(fd, O_CLOEXEC);
+    error_handling(res, __FILE__, __LINE__, "pipe2");
+    job->pid = launch_simple_command(argv, fd[1]);
+    close(fd[1]);
+    free_job_argv(argv);
+    job->fd = fd[0];
+    job->done = false;
+    job->output_len = 0;
+    job->output_arr_len = init_job_output_len;
+    job->output = malloc(job->output_arr_len);
+    run->running[run->running_len] = job_idx;
+    run->running_len++;
+}
+
+static void print_job_output(parallel_job *job)
+{
+    if (!write_whole_buffer(1, job->output, job->output_len))
+        error_handling(-1, __FILE__, __LINE__, "write");
+    free(job->output);
+    job->output = NULL;
+}
+
+static void print_finished_jobs(parallel_run *run, int job_idx)
+{
+    /* unordered output is written as soon as a job ends; ordered output
+    waits for every previous job to be written first */
+    if (!run->keep_order) {
+        print_job_output(&run->jobs[job_idx]);
+        return;
+    }
+    while (run->jobs[run->next_to_print].done) {
+        print_job_output(&run->jobs[run->next_to_print]);
+        run->next_to_print++;
+    }
+}
+
+static void finish_parallel_job(parallel_run *run, int running_idx)
+{
+    int job_idx = run->running[running_idx];
+    run->jobs[job_idx].done = true;
+    run->running[running_idx] = run->running[run->running_len-1];
+    run->running_len--;
+    print_finished_jobs(run, job_idx);
+}
+
+static bool reap_parallel_jobs(parallel_run *run)
+{
+    /* the jobs whose output has ended are finished once they exit, the
+    others don't have to exit right after closing their `stdout`. Returns
+    `true` if any job has been finished */
+    bool reaped = false;
+    int i;
+    for (i = run->running_len-1; i >= 0; i--) {
+        parallel_job *job = &run->jobs[run->running[i]];
+        int res = -1;
+        if (job->fd != -1)
+            continue;
+        if (job->pid > 0) {
+            do
+                res = waitpid(job->pid, &job->status, WNOHANG);
+            while ((res == -1) && (errno == EINTR));
+            if (res == 0)
+                continue;
+            error_handling(res, __FILE__, __LINE__, "waitpid");
+        }
+        if (res == -1)
+            job->status = -1;
+        finish_parallel_job(run, i);
+        reaped = true;
+    }
+    return reaped;
+}
+
+static void read_job_output(parallel_run *run, int running_idx)
+{
+    parallel_job *job = &run->jobs[run->running[running_idx]];
+    ssize_t res;
+    if (job->output_arr_len - job->output_len < init_job_output_len) {
+        job->output_arr_len *= 2;
+        job->output = realloc(job->output, job->output_arr_len);
+    }
+    res = read(
+        job->fd, job->output + job->output_len,
+        job->output_arr_len - job->output_len
+    );
+    if ((res == -1) && (errno == EINTR))
+        return;
+    error_handling(res, __FILE__, __LINE__, "read");
+    if (res > 0)
+        job->output_len += res;
+    else {
+        close(job->fd);
+        job->fd = -1;
+    }
+}
+
+static void wake_up_on_child_exit(int sig_num)
+{
+    (void)sig_num;
+}
+
+static void collect_parallel_output(parallel_run *run, struct pollfd *fds)
+{
+    /* `SIGCHLD` is blocked but while waiting, so a job exiting after its
+    output has ended interrupts the waiting */
+    sigset_t child_signal, wait_mask;
+    int i, res;
+    sigemptyset(&child_signal);
+    sigaddset(&child_signal, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &child_signal, &wait_mask);
+    if (reap_parallel_jobs(run)) {
+        sigprocmask(SIG_SETMASK, &wait_mask, NULL);
+        return;
+    }
+    for (i = 0; i < run->running_len; i++) {
+        fds[i].fd = run->jobs[run->running[i]].fd;
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    res = ppoll(fds, run->running_len, NULL, &wait_mask);
+    sigprocmask(SIG_SETMASK, &wait_mask, NULL);
+    if ((res == -1) && (errno == EINTR))
+        return;
+    error_handling(res, __FILE__, __LINE__, "ppoll");
+    for (i = 0; i < run->running_len; i++) {
+        if (fds[i].revents)
+            read_job_output(run, i);
+    }
+}
+
+static int report_parallel_failures(
+    const parallel_run *run, const work_items *items
+)
+{
+    int i, failed = 0;
+    for (i = 0; i < items->len; i++)
+        failed += process_failed(run->jobs[i].status);
+    if (!failed)
+        return 0;
+    fprintf(stderr, ERR_PARALLEL_SUMMARY, failed, items->len);
+    for (i = 0; i < items->len; i++) {
+        int status = run->jobs[i].status;
+        if (!process_failed(status))
+            continue;
+        fprintf(
+            stderr, ERR_PARALLEL_FAILED_JOB, items->arr[i],
+            WIFEXITED(status) ? WEXITSTATUS(status) : 128+WTERMSIG(status)
+        );
+    }
+    return (failed > max_parallel_status) ? max_parallel_status : failed;
+}
+
+static int run_parallel_jobs(
+    char **template, int template_len, const work_items *items,
+    int max_procs, bool keep_order
+)
+{
+    parallel_run run;
+    struct pollfd *fds = malloc(max_procs * sizeof(struct pollfd));
+    int next_item = 0, status;
+    run.jobs = calloc(items->len + 1, sizeof(parallel_job));
+    run.running = malloc(max_procs * sizeof(int));
+    run.running_len = 0;
+    run.next_to_print = 0;
+    run.keep_order = keep_order;
+    fflush(stdout);
+    /* the handler only interrupts the waiting, the jobs aren't reaped by it */
+    set_signal_disposition(SIGCHLD, wake_up_on_child_exit);
+    while ((next_item < items->len) || (run.running_len > 0)) {
+        while ((run.running_len < max_procs) && (next_item < items->len)) {
+            start_parallel_job(
+                &run, next_item, template, template_len, items->arr[next_item]
+            );
+            next_item++;
+        }
+        collect_parallel_output(&run, fds);
+    }
+    resume_background_zombie_handling();
+    status = report_parallel_failures(&run, items);
+    free(run.running);
+    free(run.jobs);
+    free(fds);
+    return status;
+}
+
+int handle_parallel_command(char **argv)
+{
+    work_items items;
+    bool keep_order = false;
+    int max_procs = sysconf(_SC_NPROCESSORS_ONLN), template_len, status;
+    int cmd_idx = parse_parallel_options(argv, &max_procs, &keep_order);
+    if (cmd_idx == -1) {
+        fprintf(stderr, ERR_PARALLEL_USAGE);
+        return 1;
+    }
+    if (max_procs < 1)
+        max_procs = 1;
+    template_len = collect_work_items(argv, cmd_idx, &items, "\n");
+    status = run_parallel_jobs(
+        &argv[cmd_idx], template_len, &items, max_procs, keep_order
+    );
+    free_work_items(&items);
+    return status;
+}
+#endif
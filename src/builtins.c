@@ -0,0 +1,120 @@
+/* builtins.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "aliases.h"
+#include "batch_execution.h"
+#include "builtins.h"
+#include "cmd_execution.h"
+#include "control_flow.h"
+#include "error_handling.h"
+#include "job_log.h"
+#include "line_reading.h"
+#include "stream_copying.h"
+#include "variables.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+static void change_to_home_directory()
+{
+    int res;
+    const char *home_dir = getenv("HOME");
+    if (!home_dir) {
+        fprintf(stderr, "%s, %d, %s: ", __FILE__, __LINE__, "getenv");
+        perror("");
+        return;
+    }
+    res = chdir(home_dir);
+    error_handling(res, __FILE__, __LINE__, "chdir");
+}
+
+static int handle_change_dir_command(char **argv)
+{
+    if (!argv[1])
+        change_to_home_directory();
+    else
+    if (!argv[2]) {
+        int res = chdir(argv[1]);
+        error_handling(res, __FILE__, __LINE__, "chdir");
+        return (res == -1);
+    } else {
+        fprintf(stderr, "my_shell: cd: too many arguments\n");
+        return 1;
+    }
+    return 0;
+}
+
+typedef struct tag_builtin_item {
+    const char *name;
+    builtin_func func;
+    /* the builtin only moves data between its standard streams, so the
+    shell process itself may run it at the start or at the end of a
+    pipeline instead of forking a child for it */
+    bool streaming;
+    /* NULL if the builtin takes any arguments, or else the check of them:
+    the command line it doesn't support is left to the external command of
+    the same name */
+    bool (*supported)(char **argv);
+} builtin_item;
+
+static const builtin_item builtins[] = {
+    { "cd",       handle_change_dir_command, false, NULL },
+    { "batch",    handle_batch_command,      false, NULL },
+    { "parallel", handle_parallel_command,   false, NULL },
+    { "cat",      handle_cat_command,        true,  cat_arguments_supported },
+    { "tee",      handle_tee_command,        true,  tee_arguments_supported },
+    { "export",   handle_export_command,     false, NULL },
+    { "unset",    handle_unset_command,      false, NULL },
+    { "read",     handle_read_command,       false, NULL },
+    { "break",    handle_break_command,      false, NULL },
+    { "continue", handle_continue_command,   false, NULL },
+    { "return",   handle_return_command,     false, NULL },
+    { "shift",    handle_shift_command,      false, NULL },
+    { "alias",    handle_alias_command,      false, NULL },
+    { "unalias",  handle_unalias_command,    false, NULL },
+    { "exec",     handle_exec_command,       false, NULL },
+    { "exit",     handle_exit_command,       false, NULL },
+    { "set",      handle_set_command,        false, NULL },
+    { "joblog",   handle_joblog_command,     false, NULL },
+    { NULL,       NULL,                      false, NULL }
+};
+
+static const builtin_item *find_builtin_item(char **argv)
+{
+    /* the builtin of the `argv[0]` name, if it supports the arguments */
+    const builtin_item *p;
+    if (!argv[0])
+        return NULL;
+    for (p = builtins; p->name; p++) {
+        if (0 == strcmp(p->name, argv[0]))
+            return (!p->supported || (*p->supported)(argv)) ? p : NULL;
+    }
+    return NULL;
+}
+
+builtin_func find_builtin(char **argv)
+{
+    /* the functions are run by the shell process like the builtins, and
+    they take precedence over them */
+    const builtin_item *item;
+    if (function_defined(argv[0]))
+        return call_function;
+    item = find_builtin_item(argv);
+    return item ? item->func : NULL;
+}
+
+bool streaming_builtin(char **argv)
+{
+    const builtin_item *item;
+    if (function_defined(argv[0]))
+        return false;
+    item = find_builtin_item(argv);
+    return item ? item->streaming : false;
+}
+#endif
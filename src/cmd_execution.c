@@ -4,86 +4,120 @@
 #error Please define either EXEC_MODE or PRINT_TOKENS_MODE
 #endif
 
+#define _GNU_SOURCE
+#include "aliases.h"
+#include "builtins.h"
 #include "cmd_execution.h"
+#include "cmd_line_building.h"
+#include "completion.h"
+#include "cpu_affinity.h"
 #include "error_handling.h"
+#include "io_util.h"
+#include "job_log.h"
+#include "job_priority.h"
+#include "token_dump.h"
+#include "variables.h"
 #include "zombie_handling.h"
+#include "zygote.h"
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
-static void reset_io_status(io_status *io_stat)
-{
-    io_stat->redirection = false;
-    io_stat->waiting_for_file = false;
-    io_stat->redirection_file = NULL;
-}
+#define ERR_EXEC "my_shell: exec: %s: %s\n"
+#define ERR_BAD_FD "my_shell: %d: Bad file descriptor\n"
+#define ERR_SET_OPTION_NAME "my_shell: set: %s: invalid option name\n"
+#define ERR_SET_USAGE "my_shell: set: usage: set [-o|+o] [option]\n"
 
-void reset_cmd_line_item(execvp_cmd_line *item)
-{
-    item->pid = 0;
-    reset_io_status(&item->input);
-    reset_io_status(&item->output_overwrite);
-    reset_io_status(&item->output_append);
-    /* item->next = NULL; */
-}
+static int last_status = 0;
+#if defined(EXEC_MODE)
+/* the CPUs the stages of the pipeline being launched are pinned to */
+static pipeline_placement placement;
+/* the priority the children of the pipeline being launched are given */
+static job_priority priority;
+#endif
 
-void init_cmd_line_item(execvp_cmd_line *item)
+int last_exit_status()
 {
-    item->arr_len = init_cmd_line_arr_len;
-    item->arr = malloc(item->arr_len * sizeof(char*));
-    reset_cmd_line_item(item);
-    item->next = NULL;
+    return last_status;
 }
 
-bool words_list_is_empty(const string *str)
+void set_last_exit_status(int status)
 {
-    return (!str->words_list.first);
+    last_status = status;
 }
 
 #if defined(PRINT_TOKENS_MODE)
-static void print_separator_value(separator_type separator_val)
+static void print_separator(const word_item *separator)
 {
-    switch (separator_val) {
+    /* a redirection with a descriptor its name doesn't tell is followed by
+    it: `[output_redirection 2]` for the `2>` */
+    const char *name = NULL;
+    int fd = separator_descriptor(separator);
+    switch (separator->separator_val) {
         case (none):
             fprintf(stderr, "my_shell: Error: something went wrong :/\n");
-            break;
+            return;
         case (background_operator):
-            printf("[background_operator]\n");
+            name = "background_operator";
             break;
         case (and_operator):
-            printf("[and_operator]\n");
+            name = "and_operator";
             break;
         case (output_redirection):
-            printf("[output_redirection]\n");
+            name = "output_redirection";
             break;
         case (output_append_redirection):
-            printf("[output_append_redirection]\n");
+            name = "output_append_redirection";
             break;
         case (pipe_operator):
-            printf("[pipe_operator]\n");
+            name = "pipe_operator";
             break;
         case (or_operator):
-            printf("[or_operator]\n");
+            name = "or_operator";
             break;
         case (input_redirection):
-            printf("[input_redirection]\n");
+            name = "input_redirection";
             break;
         case (command_separator):
-            printf("[command_separator]\n");
+            name = "command_separator";
             break;
         case (open_parenthesis):
-            printf("[open_parenthesis]\n");
+            name = "open_parenthesis";
             break;
         case (close_parenthesis):
-            printf("[close_parenthesis]\n");
+            name = "close_parenthesis";
+            break;
+        case (here_document):
+            name = "here_document";
+            break;
+        case (here_string):
+            name = "here_string";
+            break;
+        case (input_output_redirection):
+            name = "input_output_redirection";
+            break;
+        case (duplication_redirection):
+            name = "duplication_redirection";
+            break;
+        case (output_error_redirection):
+            name = "output_error_redirection";
+            break;
+        case (output_error_append_redirection):
+            name = "output_error_append_redirection";
     }
+    if (fd == -1)
+        printf("[%s]\n", name);
+    else
+        printf("[%s %d]\n", name, fd);
 }
 
 static void print_list_of_words(const curr_str_words_list *words_list)
@@ -91,134 +125,13 @@ static void print_list_of_words(const curr_str_words_list *words_list)
     word_item *p = words_list->first;
     while (p) {
         if (p->separator_val != none)
-            print_separator_value(p->separator_val);
+            print_separator(p);
         else
             printf("[%s]\n", p->word ? p->word : "");
         p = p->next;
     }
 }
 #elif defined(EXEC_MODE)
-static void increase_cmd_line_array_length(execvp_cmd_line *cmdline)
-{
-    cmdline->arr_len *= 2;
-    cmdline->arr = realloc(cmdline->arr, cmdline->arr_len * sizeof(char*));
-}
-
-static bool pipe_operator_at_start_of_cmdline(
-    const word_item *curr_word, int cmdline_idx
-)
-{
-    return(
-        curr_word->separator_val == pipe_operator &&
-        cmdline_idx == 0
-    );
-}
-
-static bool separator_right_after_io_redirecton(
-    const string *str, const word_item *curr_word
-)
-{
-    const execvp_cmd_line *cmdline = str->cmd_line.last;
-
-    bool the_word_is_separator = (curr_word->separator_val != none);
-
-    bool io_redirection_waiting_for_file =
-        (cmdline->input.waiting_for_file ||
-        cmdline->output_overwrite.waiting_for_file ||
-        cmdline->output_append.waiting_for_file);
-
-    return (the_word_is_separator && io_redirection_waiting_for_file);
-}
-
-static bool second_simple_word_right_after_io_redirecton(
-    string *str, const word_item *curr_word 
-)
-{
-    const execvp_cmd_line *cmdline = str->cmd_line.last;
-
-    bool simple_word = (curr_word->separator_val == none);
-
-    bool at_least_one_io_redirection =
-        (cmdline->input.redirection ||
-        cmdline->output_overwrite.redirection ||
-        cmdline->output_append.redirection);
-
-    bool io_redirection_not_waiting_for_file =
-        (!cmdline->input.waiting_for_file &&
-        !cmdline->output_overwrite.waiting_for_file &&
-        !cmdline->output_append.waiting_for_file);
-
-    return(
-        simple_word &&
-        at_least_one_io_redirection &&
-        io_redirection_not_waiting_for_file
-    );
-}
-
-static void appoint_stream_redirection(
-    io_status *stream, execvp_cmd_line *cmdline,
-    const word_item *curr_word, int idx, bool *next_step
-)
-{
-    stream->redirection_file = curr_word->word;
-    stream->waiting_for_file = false;
-    cmdline->arr[idx] = NULL;
-    *next_step = true;
-}
-
-enum tag_status { error = -1, move_on, completed };
-
-static enum tag_status appoint_io_redirection_file(
-    string *str, const word_item *curr_word, int idx, bool *next_step
-)
-{
-    execvp_cmd_line *cmdline = str->cmd_line.last;
-    if (curr_word->separator_val == none) {
-        if (cmdline->input.waiting_for_file) {
-            appoint_stream_redirection(
-                &cmdline->input, cmdline, curr_word, idx, next_step
-            );
-            return completed;
-        } else
-        if (cmdline->output_overwrite.waiting_for_file) {
-            appoint_stream_redirection(
-                &cmdline->output_overwrite, cmdline, curr_word, idx, next_step
-            );
-            return completed;
-        } else
-        if (cmdline->output_append.waiting_for_file) {
-            appoint_stream_redirection(
-                &cmdline->output_append, cmdline, curr_word, idx, next_step
-            );
-            return completed;
-        } else
-            return move_on;
-    } else
-        return move_on;
-}
-
-static enum tag_status start_background_execution(
-    string *str, const word_item *curr_word, int idx, bool *next_step
-)
-{
-    if (curr_word->separator_val == background_operator) {
-        str->cmd_line.last->arr[idx] = NULL;
-        str->cmd_line.background_execution = true;
-        *next_step = true;
-        return completed;
-    } else
-        return move_on;
-}
-
-void add_new_cmd_line_item(cmd_lines_list *cmdline)
-{
-    /* add item at the end of `cmd_line` link list */
-    cmdline->last->next = malloc(sizeof(execvp_cmd_line));
-    cmdline->last = cmdline->last->next;
-    init_cmd_line_item(cmdline->last);
-    cmdline->list_len++;
-}
-
 void add_new_pipeline_item(pipeline_list *pipeline)
 {
     /* add item at the beginning of `pipeline` link list */
@@ -230,156 +143,11 @@ void add_new_pipeline_item(pipeline_list *pipeline)
     pipeline->first = tmp;
 }
 
-static enum tag_status split_cmdline_and_add_pipeline(
-    string *str, const word_item *curr_word, int *idx, bool *next_step
-)
+static void add_pipes_between_stages(string *str)
 {
-    if (curr_word->separator_val == pipe_operator) {
-        str->cmd_line.last->arr[*idx] = NULL;
-        add_new_cmd_line_item(&str->cmd_line);
+    int i;
+    for (i = 1; i < str->cmd_line.list_len; i++)
         add_new_pipeline_item(&str->pipeline);
-        (*idx) = -1;        /* on the next iteration it will be 0 */
-        *next_step = true;
-        return completed;
-    } else
-        return move_on;
-}
-
-static enum tag_status toggle_stream_redirection(
-    io_status *stream, execvp_cmd_line *cmdline,
-    bool error_condition, int idx, bool *next_step
-)
-{
-    if (error_condition)
-        return error;
-    stream->redirection = true;
-    stream->waiting_for_file = true;
-    cmdline->arr[idx] = NULL;
-    *next_step = true;
-    return completed;
-}
-
-static enum tag_status toggle_io_redirection(
-    string *str, const word_item *curr_word, int idx, bool *next_step
-)
-{
-    execvp_cmd_line *cmdline = str->cmd_line.last;
-    if (curr_word->separator_val == input_redirection) {
-        bool error_condition = (cmdline->input.redirection);
-        return toggle_stream_redirection(
-            &cmdline->input, cmdline, error_condition, idx, next_step
-        );
-    } else
-    if (curr_word->separator_val == output_redirection) {
-        bool error_condition = (
-            cmdline->output_overwrite.redirection ||
-            cmdline->output_append.redirection
-        );
-        return toggle_stream_redirection(
-            &cmdline->output_overwrite, cmdline, error_condition, idx, next_step
-        );
-    } else
-    if (curr_word->separator_val == output_append_redirection) {
-        bool error_condition = (
-            cmdline->output_overwrite.redirection ||
-            cmdline->output_append.redirection
-        );
-        return toggle_stream_redirection(
-            &cmdline->output_append, cmdline, error_condition, idx, next_step
-        );
-    } else
-        return move_on;
-}
-
-static error_code handle_possible_separator(
-    string *str, const word_item *curr_word, int *idx, bool *next_step
-)
-{
-    enum tag_status { error = -1, move_on, completed } status;
-    if (str->cmd_line.background_execution)
-        return background_operator_not_in_the_end_of_str;
-    if (pipe_operator_at_start_of_cmdline(curr_word, *idx))
-        return pipe_operator_at_start_of_str;
-    if (separator_right_after_io_redirecton(str, curr_word))
-        return separator_right_after_input_or_output_redirection;
-    if (second_simple_word_right_after_io_redirecton(str, curr_word))
-        return second_simple_word_right_after_input_or_output_redirecton;
-    status = split_cmdline_and_add_pipeline(str, curr_word, idx, next_step);
-    if (status == completed)
-        return no_error;
-    status = appoint_io_redirection_file(str, curr_word, *idx, next_step);
-    if (status == completed)
-        return no_error;
-    status = start_background_execution(str, curr_word, *idx, next_step);
-    if (status == completed)
-        return no_error;
-    status = toggle_io_redirection(str, curr_word, *idx, next_step);
-    if (status == completed)
-        return no_error;
-    if (status == error)
-        return input_or_output_separator_used_in_line_twice;
-    if (curr_word->separator_val != none)
-        return not_implemented_feature;
-    return no_error;
-}
-
-static error_code transform_words_list_into_cmd_line_arr(string *str)
-{
-    word_item *p = str->words_list.first;
-    int i = 0;
-    for (;; p=p->next, i++) {
-        if (str->cmd_line.last->arr_len == i)
-            increase_cmd_line_array_length(str->cmd_line.last);
-        if (!p) {
-            str->cmd_line.last->arr[i] = NULL;
-            break;
-        } else {
-            bool next_step = false;
-            error_code err;
-            err = handle_possible_separator(str, p, &i, &next_step);
-            if (err)
-                return err;
-            if (next_step)
-                continue;
-            str->cmd_line.last->arr[i] = p->word;
-        }
-    }
-    return 0;
-}
-
-static void change_to_home_directory()
-{
-    int res;
-    const char *home_dir = getenv("HOME");
-    if (!home_dir) {
-        fprintf(stderr, "%s, %d, %s: ", __FILE__, __LINE__, "getenv");
-        perror("");
-        return;
-    }
-    res = chdir(home_dir);
-    error_handling(res, __FILE__, __LINE__, "chdir");
-}
-
-static void handle_change_dir_command(const execvp_cmd_line *cmdline)
-{
-    if (!cmdline->arr[1])
-        change_to_home_directory();
-    else
-    if (!cmdline->arr[2]) {
-        int res = chdir(cmdline->arr[1]);
-        error_handling(res, __FILE__, __LINE__, "chdir");
-    } else
-        fprintf(stderr, "my_shell: cd: too many arguments\n");
-}
-
-static bool change_dir_command(const execvp_cmd_line *cmdline)
-{
-    if (!cmdline->arr[0])
-        return false;
-    if (0 == strcmp("cd", cmdline->arr[0]))
-        return true;
-    else
-        return false;
 }
 
 static void print_error(error_code err)
@@ -409,42 +177,134 @@ static void print_error(error_code err)
         case (pipe_operator_at_start_of_str):
             fprintf(stderr, ERR_PIPE_OPERATOR_MISUSE);
             break;
+        case (bad_fd_duplication_target):
+            fprintf(stderr, ERR_FD_DUPLICATION_TARGET);
+            break;
+        case (unclosed_command_substitution):
+        case (bad_substitution):
+        case (arithmetic_error):
+        case (unmatched_quotes):
+            /* this error had to be handled in main -> process_end_of_string ->
+            -> report_if_error */
+            fprintf(stderr, ERR_SMTH_STRANGE_HAPPEND, __FILE__, __LINE__);
+            break;
         case (not_implemented_feature):
-            fprintf(stderr, "my_shell: feature not implemented yet\n");
+            fprintf(stderr, ERR_NOT_IMPLEMENTED_FEATURE);
     }
 }
 
-static void wait_for_cmd_linde_item(const execvp_cmd_line *item)
+typedef struct tag_pipeline_statuses {
+    /* the statuses of the stages of the last foreground command line */
+    int *arr;
+    int len;
+    int arr_len;
+} pipeline_statuses;
+
+static pipeline_statuses statuses = { NULL, 0, 0 };
+
+/* `set -o pipefail`: a pipeline fails if any of its stages does */
+static bool pipefail = false;
+/* `set -o bgnice`: the background pipelines run with a lower priority */
+static bool bgnice = false;
+/* `set -o joblog`: the output of the background pipelines is kept in the
+logs of the jobs instead of going to the terminal */
+static bool joblog = false;
+
+typedef struct tag_shell_option {
+    const char *name;
+    bool *value;
+} shell_option;
+
+static const shell_option shell_options[] = {
+    { "bgnice",     &bgnice },
+    { "joblog",     &joblog },
+    { "pipefail",   &pipefail },
+    { NULL,         NULL }
+};
+
+static void record_pipeline_status(int status)
 {
-    int res;
-    if (item->pid != 0) {
-        res = waitpid(item->pid, NULL, WNOHANG);
-        if (res == 0)
-            /* the process exists */
-            do {
-                res = wait(NULL);
-                error_handling(res, __FILE__, __LINE__, "wait");
-            } while (res != item->pid);
-        else
-        if ((res == -1) && (errno == ECHILD))
-            /* the process has already been reaped earlier */
-            {}
-        else
-        if (res == -1)
-            /* handle an error */
-            error_handling(res, __FILE__, __LINE__, "waitpid");
-        else
-        if (res == item->pid)
-            /* we've just reaped the process */
-            {}
-    } else
-        /* there was an error in the `open_io_redirecton_files` function in
-        the `launch_process`. The process doesn't exist */
+    if (statuses.len == statuses.arr_len) {
+        statuses.arr_len = statuses.arr_len ? statuses.arr_len*2 : 8;
+        statuses.arr = realloc(statuses.arr, statuses.arr_len*sizeof(int));
+    }
+    statuses.arr[statuses.len] = status;
+    statuses.len++;
+}
+
+static void set_command_status(int status)
+{
+    /* the command line hasn't been run as a pipeline of children */
+    statuses.len = 0;
+    record_pipeline_status(status);
+    last_status = status;
+}
+
+static int pipeline_exit_status()
+{
+    /* the status of the last stage, or with the `pipefail` the one of the
+    last stage that has failed */
+    int i;
+    if (statuses.len == 0)
+        return 0;
+    if (pipefail) {
+        for (i = statuses.len-1; i >= 0; i--) {
+            if (statuses.arr[i] != 0)
+                return statuses.arr[i];
+        }
+    }
+    return statuses.arr[statuses.len-1];
+}
+
+const int *last_pipeline_statuses(int *len)
+{
+    *len = statuses.len;
+    return statuses.arr;
+}
+
+void free_pipeline_statuses()
+{
+    free(statuses.arr);
+    statuses.arr = NULL;
+    statuses.len = 0;
+    statuses.arr_len = 0;
+}
+
+int wait_for_process(pid_t pid)
+{
+    /* returns the exit status of the process the way the shells report it:
+    128 plus the signal number if it was killed by a signal */
+    int status, res;
+    do {
+        res = waitpid(pid, &status, 0);
+    } while ((res == -1) && (errno == EINTR));
+    if ((res == -1) && (errno == ECHILD))
+        /* the process has already been reaped earlier */
+        return 0;
+    error_handling(res, __FILE__, __LINE__, "waitpid");
+    if (res == -1)
+        return 1;
+    if (WIFSIGNALED(status))
+        return 128 + WTERMSIG(status);
+    return WEXITSTATUS(status);
+}
+
+static void wait_for_cmd_linde_item(execvp_cmd_line *item)
+{
+    /* the items are waited for in order, so their statuses are recorded in
+    the order of the pipeline stages */
+    if (item->pid != 0)
+        item->status = wait_for_process(item->pid);
+    else
+        /* either the shell process itself has run this pipeline stage, or
+        there was an error in the `open_redirection_files` function in the
+        `launch_process`. The status has been set already */
         {}
+    record_pipeline_status(item->status);
 }
 
 static void clean_up_the_rest_of_the_list(
-    execvp_cmd_line *item, void (*fptr)(const execvp_cmd_line *item)
+    execvp_cmd_line *item, void (*fptr)(execvp_cmd_line *item)
 )
 {
     while (item) {
@@ -454,13 +314,12 @@ static void clean_up_the_rest_of_the_list(
             (*fptr)(item);
         tmp = item;
         item = item->next;
-        free(tmp->arr);
-        free(tmp);
+        free_cmd_line_item(tmp);
     }
 }
 
 static void clean_up_cmdline_list_except_first_item(
-    execvp_cmd_line *first, void (*fptr)(const execvp_cmd_line *item)
+    execvp_cmd_line *first, void (*fptr)(execvp_cmd_line *item)
 )
 {
     if (fptr)
@@ -473,76 +332,150 @@ static void clean_up_cmdline_list_except_first_item(
 static void handle_zombies(cmd_lines_list *cmdline)
 {
     if (!cmdline->background_execution) {
-        /* temporarilly turn off the `SIGCHLD` signal desposition */
-        set_signal_disposition(SIGCHLD, SIG_DFL);
+        suspend_background_zombie_handling();
         /* wait for each process of the `cmdline` linked list */
         /* clean the linked list up, except for the first item */
+        statuses.len = 0;
         clean_up_cmdline_list_except_first_item(
             cmdline->first, &wait_for_cmd_linde_item
         );
-        /* turn the `SIGCHLD` signal desposition back on */
-        set_signal_disposition(SIGCHLD, handle_background_zombie_process);
-    } else
+        last_status = pipeline_exit_status();
+        resume_background_zombie_handling();
+    } else {
         /* clean up the `cmdline` linked list, except for the first item */
         /* zombie processes will be reaped by `SIGCHLD` signal handler func */
         clean_up_cmdline_list_except_first_item(cmdline->first, NULL);
+        set_command_status(0);
+    }
 }
 
-static int open_io_redirecton_files(
-    const execvp_cmd_line *cmdline, int *fd_input, int *fd_output
-)
+static void write_inline_input(int fd, const char *data, size_t len)
 {
-    const char *input_file = cmdline->input.redirection_file;
-    const char *output_overwrite_file =
-        cmdline->output_overwrite.redirection_file;
-    const char *output_append_file =
-        cmdline->output_append.redirection_file;
+    if (!write_whole_buffer(fd, data, len))
+        error_handling(-1, __FILE__, __LINE__, "write");
+}
 
-    if (cmdline->input.redirection) {
-        *fd_input = open(input_file, O_RDONLY);
-        if ((*fd_input == -1) && (errno == ENOENT)) {
-            fprintf(stderr, ERR_NO_SUCH_FILE, input_file);
+static int open_inline_input(const fd_operation *input)
+{
+    /* a payload that fits into the pipe buffer is put into a pipe; the
+    bigger ones go into an anonymous memory file, so the data never touches
+    the disk. A here-string gets a trailing newline */
+    const char *data = input->redirection_file;
+    bool here_string = (input->source == here_string_source);
+    size_t len = strlen(data);
+    int fd[2], res;
+    if (len + here_string <= PIPE_BUF) {
+        res = pipe2(fd, O_CLOEXEC);
+        error_handling(res, __FILE__, __LINE__, "pipe2");
+        if (res == -1)
             return -1;
-        }
+        write_inline_input(fd[1], data, len);
+        if (here_string)
+            write_inline_input(fd[1], "\n", 1);
+        close(fd[1]);
+        return fd[0];
     }
-    if (cmdline->output_overwrite.redirection)
-        *fd_output = open(output_overwrite_file, O_WRONLY|O_CREAT|O_TRUNC,0666);
-    if (cmdline->output_append.redirection)
-        *fd_output = open(output_append_file, O_WRONLY|O_CREAT|O_APPEND, 0666);
-    error_handling(*fd_input, __FILE__, __LINE__, "open");
-    error_handling(*fd_output, __FILE__, __LINE__, "open");
-    return 0;
+    fd[0] = memfd_create("my_shell_here_document", MFD_CLOEXEC);
+    error_handling(fd[0], __FILE__, __LINE__, "memfd_create");
+    if (fd[0] == -1)
+        return -1;
+    write_inline_input(fd[0], data, len);
+    if (here_string)
+        write_inline_input(fd[0], "\n", 1);
+    lseek(fd[0], 0, SEEK_SET);
+    return fd[0];
 }
 
-static void close_io_redirection_files(int fd_input, int fd_output)
+static int open_flags(open_mode mode)
 {
-    int res;
-    if (fd_input) {
-        res = close(fd_input);
-        error_handling(res, __FILE__, __LINE__, "close");
+    switch (mode) {
+        case (read_mode):
+            return O_RDONLY;
+        case (overwrite_mode):
+            return O_WRONLY|O_CREAT|O_TRUNC;
+        case (append_mode):
+            return O_WRONLY|O_CREAT|O_APPEND;
+        case (read_write_mode):
+            return O_RDWR|O_CREAT;
+    }
+    return O_RDONLY;
+}
+
+static int open_redirection_file(const fd_operation *op)
+{
+    /* the file is moved above the descriptors a redirection may set, so
+    applying one redirection can't replace the file of another */
+    int fd;
+    if (op->source != file_source)
+        fd = open_inline_input(op);
+    else {
+        fd = open(op->redirection_file, open_flags(op->mode)|O_CLOEXEC, 0666);
+        if ((fd == -1) && (errno == ENOENT)) {
+            fprintf(stderr, ERR_NO_SUCH_FILE, op->redirection_file);
+            return -1;
+        }
+        error_handling(fd, __FILE__, __LINE__, "open");
     }
-    if (fd_output) {
-        res = close(fd_output);
+    return move_fd_above_user_range(fd);
+}
+
+static void close_redirection_files(execvp_cmd_line *cmdline)
+{
+    int i, res;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        fd_operation *op = &cmdline->fd_ops[i];
+        if (op->file_fd == -1)
+            continue;
+        res = close(op->file_fd);
         error_handling(res, __FILE__, __LINE__, "close");
+        op->file_fd = -1;
     }
 }
 
-static void io_redirection(
-    const execvp_cmd_line *cmdline, int fd_input, int fd_output
-)
+static int open_redirection_files(execvp_cmd_line *cmdline)
 {
-    int res;
-    if (cmdline->input.redirection) {
-        res = dup2(fd_input, 0);
-        error_handling(res, __FILE__, __LINE__, "dup2");
+    /* the shell opens the files before the command is launched, so it
+    reports the errors itself. Returns -1 if one of them can't be opened */
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        fd_operation *op = &cmdline->fd_ops[i];
+        if (op->type != open_fd_operation)
+            continue;
+        op->file_fd = open_redirection_file(op);
+        if (op->file_fd == -1) {
+            close_redirection_files(cmdline);
+            return -1;
+        }
     }
-    if (cmdline->output_overwrite.redirection ||
-        cmdline->output_append.redirection)
-    {
-        res = dup2(fd_output, 1);
-        error_handling(res, __FILE__, __LINE__, "dup2");
+    return 0;
+}
+
+static bool apply_redirections(const execvp_cmd_line *cmdline)
+{
+    /* in order, so `> file 2>&1` sends both streams into the file, and
+    `2>&1 > file` only the `stdout`. The descriptors of the shell itself are
+    above the ones `>&N` may copy, false if `N` isn't open */
+    int i, res;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        const fd_operation *op = &cmdline->fd_ops[i];
+        switch (op->type) {
+            case (open_fd_operation):
+                res = dup2(op->file_fd, op->fd);
+                error_handling(res, __FILE__, __LINE__, "dup2");
+                break;
+            case (duplicate_fd_operation):
+                res = dup2(op->target_fd, op->fd);
+                if ((res == -1) && (errno == EBADF)) {
+                    fprintf(stderr, ERR_BAD_FD, op->target_fd);
+                    return false;
+                }
+                error_handling(res, __FILE__, __LINE__, "dup2");
+                break;
+            case (close_fd_operation):
+                close(op->fd);
+        }
     }
-    close_io_redirection_files(fd_input, fd_output);
+    return true;
 }
 
 static void close_and_free_all_pipes(pipeline_item *curr)
@@ -556,6 +489,42 @@ static void close_and_free_all_pipes(pipeline_item *curr)
     }
 }
 
+void close_process_substitution_pipes(pipeline_list *pipes)
+{
+    /* the children of the command line have inherited the shell's ends,
+    the other ends were closed when the substitutions were launched */
+    close_and_free_all_pipes(pipes->first);
+    pipes->first = NULL;
+}
+
+pid_t launch_process_substitution(
+    pipeline_list *pipes, bool output_substitution, int *fd
+)
+{
+    /* like `fork`, returns 0 in the child, which has its `stdout` (or its
+    `stdin` for `>(...)`) connected to the pipe and no other substitution
+    pipes open. The parent gets the other end of the pipe in the `fd` */
+    pipeline_item *item;
+    int child_end = output_substitution ? 0 : 1;
+    pid_t pid;
+    add_new_pipeline_item(pipes);
+    item = pipes->first;
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    error_handling(pid, __FILE__, __LINE__, "fork");
+    if (pid == 0) {
+        int res = dup2(item->fd[child_end], child_end);
+        error_handling(res, __FILE__, __LINE__, "dup2");
+        close_process_substitution_pipes(pipes);
+        return 0;
+    }
+    close(item->fd[child_end]);
+    item->fd[child_end] = -1;
+    *fd = item->fd[1-child_end];
+    return pid;
+}
+
 static void close_other_pipes_file_descriptors(
     const pipeline_item *prev, const pipeline_item *next,
     const pipeline_item *curr
@@ -595,19 +564,47 @@ static void set_up_pipeline(
     }
 }
 
+static char **apply_assignment_prefix(char **argv)
+{
+    /* `NAME=value cmd` puts the variable into the environment of the `cmd`
+    only, this runs in the forked child, so the shell isn't affected */
+    char **p = argv;
+    for (; *p && assignment_word(*p); p++)
+        apply_assignment(*p, true);
+    if (p != argv)
+        refresh_environment();
+    return p;
+}
+
 static void set_up_and_exec_child(
-    const execvp_cmd_line *cmdline, int fd_input, int fd_output,
-    const pipeline_item *prev_pipe, const pipeline_item *next_pipe,
-    const pipeline_item *first_pipe
+    execvp_cmd_line *cmdline, const pipeline_item *prev_pipe,
+    const pipeline_item *next_pipe, const pipeline_item *first_pipe
 )
 {
+    char **argv = apply_assignment_prefix(cmdline->arr);
+    builtin_func builtin = find_builtin(argv);
     set_up_pipeline(prev_pipe, next_pipe, first_pipe);
-    io_redirection(cmdline, fd_input, fd_output);
-    if (cmdline->arr[0]) {
-        execvp(cmdline->arr[0], cmdline->arr);
+    if (!apply_redirections(cmdline))
+        _exit(1);
+    close_redirection_files(cmdline);
+    if (builtin) {
+        /* builtins don't need `execvp`, the forked shell process runs them */
+        int status = (*builtin)(argv);
+        fflush(stdout);
+        _exit(status);
+    }
+    if (!argv[0] && (argv != cmdline->arr))
+        /* there were only the assignments */
+        _exit(0);
+    if (argv[0]) {
+        /* the path the line editor's command table has resolved, if any */
+        char *path = find_command_path(argv[0]);
+        if (path)
+            execv(path, argv);
+        execvp(argv[0], argv);
         fprintf(
             stderr, "%s, %d, %s: %s:",
-            __FILE__, __LINE__, "execvp", cmdline->arr[0]
+            __FILE__, __LINE__, "execvp", argv[0]
         );
         perror("");
         fflush(stderr);
@@ -615,32 +612,495 @@ static void set_up_and_exec_child(
     _exit(1);
 }
 
-static void launch_process(execvp_cmd_line *cmdline, pipeline_item **first_pipe)
+int launch_simple_command(char **argv, int fd_output)
+{
+    /* fork a child that runs `argv` with the shell's own standard streams,
+    except for `stdout` if the `fd_output` is given */
+    execvp_cmd_line item;
+    item.arr = argv;
+    item.fd_ops = NULL;
+    reset_cmd_line_item(&item);
+    item.next = NULL;
+    fflush(stdout);
+    fflush(stderr);
+    item.pid = fork();
+    error_handling(item.pid, __FILE__, __LINE__, "fork");
+    if (item.pid == 0) {
+        if (fd_output != -1) {
+            int res = dup2(fd_output, 1);
+            error_handling(res, __FILE__, __LINE__, "dup2");
+            close(fd_output);
+        }
+        set_up_and_exec_child(&item, NULL, NULL, NULL);
+    }
+    return item.pid;
+}
+
+int save_standard_stream(int fd, bool redirection)
+{
+    /* the copy is closed automatically in processes started by builtins */
+    int saved_fd;
+    if (!redirection)
+        return -1;
+    saved_fd = fcntl(fd, F_DUPFD_CLOEXEC, saved_fd_min);
+    error_handling(saved_fd, __FILE__, __LINE__, "fcntl");
+    return saved_fd;
+}
+
+void restore_standard_stream(int saved_fd, int fd)
+{
+    int res;
+    if (saved_fd == -1)
+        return;
+    res = dup2(saved_fd, fd);
+    error_handling(res, __FILE__, __LINE__, "dup2");
+    close(saved_fd);
+}
+
+static void discard_saved_standard_stream(int saved_fd)
+{
+    if (saved_fd != -1)
+        close(saved_fd);
+}
+
+static bool assignments_run_in_shell_process(const cmd_lines_list *cmdline)
+{
+    /* a command line of nothing but `NAME=value` words sets shell variables,
+    unless it's a part of a pipeline or is executed in the background */
+    char **p;
+    if (cmdline->list_len != 1 || cmdline->background_execution)
+        return false;
+    for (p = cmdline->first->arr; *p; p++) {
+        if (!assignment_word(*p))
+            return false;
+    }
+    return (p != cmdline->first->arr);
+}
+
+static void run_assignments_in_shell_process(const execvp_cmd_line *cmdline)
+{
+    char **p;
+    for (p = cmdline->arr; *p; p++)
+        apply_assignment(*p, false);
+    refresh_environment();
+}
+
+static bool builtin_runs_in_shell_process(const cmd_lines_list *cmdline)
+{
+    /* builtins which are part of a pipeline or are executed in the
+    background are run by a forked child in the `launch_process` */
+    return (
+        cmdline->list_len == 1 &&
+        !cmdline->background_execution &&
+        find_builtin(cmdline->first->arr)
+    );
+}
+
+static void move_pipe_end_to_standard_stream(int pipe_end, int fd)
+{
+    int res;
+    if (pipe_end == -1)
+        return;
+    res = dup2(pipe_end, fd);
+    error_handling(res, __FILE__, __LINE__, "dup2");
+    close(pipe_end);
+}
+
+/* set by the `exec` without a command, the redirections of the builtin
+aren't undone once it returns */
+static bool redirections_permanent = false;
+
+static int *save_redirected_streams(const execvp_cmd_line *cmdline)
+{
+    /* a copy of every descriptor the redirections replace, in the order of
+    the redirections, -1 for the ones that aren't open */
+    int *saved_fds = malloc((cmdline->fd_ops_len + 1) * sizeof(int));
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        saved_fds[i] =
+            fcntl(cmdline->fd_ops[i].fd, F_DUPFD_CLOEXEC, saved_fd_min);
+        if (saved_fds[i] == -1 && errno != EBADF)
+            error_handling(saved_fds[i], __FILE__, __LINE__, "fcntl");
+    }
+    return saved_fds;
+}
+
+static void restore_redirected_streams(
+    const execvp_cmd_line *cmdline, int *saved_fds, bool permanent
+)
+{
+    /* the descriptors that weren't open before the redirections are closed
+    again, unless the redirections are made permanent */
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        if (permanent)
+            discard_saved_standard_stream(saved_fds[i]);
+        else
+        if (saved_fds[i] == -1)
+            close(cmdline->fd_ops[i].fd);
+        else
+            restore_standard_stream(saved_fds[i], cmdline->fd_ops[i].fd);
+    }
+    free(saved_fds);
+}
+
+static int run_builtin_in_shell_process(
+    execvp_cmd_line *cmdline, int pipe_input, int pipe_output
+)
+{
+    /* `pipe_input` and `pipe_output` are the pipeline ends the builtin is
+    connected to, or -1 if it isn't a part of a pipeline */
+    int res, saved_stdin, saved_stdout, status;
+    int *saved_fds;
+    builtin_func builtin = find_builtin(cmdline->arr);
+    res = open_redirection_files(cmdline);
+    if (res == -1) {
+        if (pipe_input != -1)
+            close(pipe_input);
+        if (pipe_output != -1)
+            close(pipe_output);
+        return 1;
+    }
+    saved_stdin = save_standard_stream(0, pipe_input != -1);
+    saved_stdout = save_standard_stream(1, pipe_output != -1);
+    fflush(stdout);
+    move_pipe_end_to_standard_stream(pipe_input, 0);
+    move_pipe_end_to_standard_stream(pipe_output, 1);
+    saved_fds = save_redirected_streams(cmdline);
+    status = apply_redirections(cmdline) ? 0 : 1;
+    close_redirection_files(cmdline);
+    if (status == 0)
+        status = (*builtin)(cmdline->arr);
+    fflush(stdout);
+    restore_redirected_streams(cmdline, saved_fds, redirections_permanent);
+    if (redirections_permanent) {
+        redirections_permanent = false;
+        discard_saved_standard_stream(saved_stdin);
+        discard_saved_standard_stream(saved_stdout);
+    } else {
+        restore_standard_stream(saved_stdin, 0);
+        restore_standard_stream(saved_stdout, 1);
+    }
+    return status;
+}
+
+int handle_exec_command(char **argv)
+{
+    /* `exec cmd [arg]...` replaces the shell process with the `cmd`, which
+    inherits the redirections. Without a command, the redirections are kept
+    for the rest of the session */
+    if (!argv[1]) {
+        redirections_permanent = true;
+        return 0;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    execvp(argv[1], &argv[1]);
+    fprintf(stderr, ERR_EXEC, argv[1], strerror(errno));
+    return (errno == ENOENT) ? 127 : 126;
+}
+
+static void print_options()
+{
+    const shell_option *p;
+    for (p = shell_options; p->name; p++)
+        printf("%s\t%s\n", p->name, *p->value ? "on" : "off");
+}
+
+int handle_set_command(char **argv)
+{
+    /* `set -o pipefail` turns the option on, `set +o pipefail` turns it
+    off, `set -o` prints the options */
+    const shell_option *p;
+    bool value;
+    if (!argv[1]) {
+        print_options();
+        return 0;
+    }
+    if (0 != strcmp(argv[1], "-o") && 0 != strcmp(argv[1], "+o")) {
+        fprintf(stderr, ERR_SET_USAGE);
+        return 2;
+    }
+    value = (argv[1][0] == '-');
+    if (!argv[2]) {
+        print_options();
+        return 0;
+    }
+    for (p = shell_options; p->name; p++) {
+        if (0 == strcmp(argv[2], p->name)) {
+            *p->value = value;
+            return 0;
+        }
+    }
+    fprintf(stderr, ERR_SET_OPTION_NAME, argv[2]);
+    return 2;
+}
+
+static bool tail_exec_possible(const string *str)
+{
+    /* the last command of a script doesn't need the shell once it's
+    started, unless the shell has to feed the `>(...)` and `<(...)` pipes,
+    or to read the logs of the jobs still running: the exec would close
+    their pipes, and the jobs would be killed by `SIGPIPE` */
+    return (
+        str->last_command &&
+        str->cmd_line.list_len == 1 &&
+        !str->cmd_line.background_execution &&
+        !str->substitution_pipes.first &&
+        !job_logs_open()
+    );
+}
+
+static void exec_in_shell_process(execvp_cmd_line *cmdline)
+{
+    /* returns only if the redirection files can't be opened */
+    int res = open_redirection_files(cmdline);
+    if (res == -1) {
+        cmdline->status = 1;
+        return;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pin_pipeline_stage(&placement, 0);
+    set_up_and_exec_child(cmdline, NULL, NULL, NULL);
+}
+
+static execvp_cmd_line *pick_pipeline_stage_for_shell_process(
+    execvp_cmd_line *first, bool shell_stage_allowed
+)
+{
+    /* a streaming builtin at the end (or else at the start) of a foreground
+    pipeline is run by the shell process itself, which saves a `fork` */
+    execvp_cmd_line *last = first;
+    if (!shell_stage_allowed || !first->next)
+        return NULL;
+    while (last->next)
+        last = last->next;
+    if (streaming_builtin(last->arr))
+        return last;
+    if (streaming_builtin(first->arr))
+        return first;
+    return NULL;
+}
+
+static int duplicate_pipe_end(const pipeline_item *pipe, int end)
+{
+    int fd;
+    if (!pipe)
+        return -1;
+    fd = fcntl(pipe->fd[end], F_DUPFD_CLOEXEC, saved_fd_min);
+    error_handling(fd, __FILE__, __LINE__, "fcntl");
+    return fd;
+}
+
+static void run_pipeline_stage_in_shell_process(
+    execvp_cmd_line *cmdline, int pipe_input, int pipe_output
+)
+{
+    /* the rest of the pipeline may exit before the shell stops writing into
+    it, which mustn't kill the shell. The children have already been forked,
+    so their zombies are kept for the `handle_zombies` */
+    suspend_background_zombie_handling();
+    set_signal_disposition(SIGPIPE, SIG_IGN);
+    cmdline->status =
+        run_builtin_in_shell_process(cmdline, pipe_input, pipe_output);
+    set_signal_disposition(SIGPIPE, SIG_DFL);
+}
+
+static bool only_standard_streams_redirected(const execvp_cmd_line *cmdline)
+{
+    /* the files of `stdin` and `stdout`, the zygote is given those two
+    streams only */
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        const fd_operation *op = &cmdline->fd_ops[i];
+        if (op->type != open_fd_operation || op->fd > 1)
+            return false;
+    }
+    return true;
+}
+
+static bool zygote_can_launch(
+    const execvp_cmd_line *cmdline, bool zygote_allowed
+)
+{
+    /* only the external commands without the `NAME=value` prefix, the
+    rest need the state of the shell in the child. The pinned stages are
+    forked, the zygote doesn't place its children, nor lowers their
+    priority */
+    const char *name = cmdline->arr[0];
+    return (
+        zygote_allowed && zygote_running() && name &&
+        placement.len == 0 && !priority.enabled &&
+        !assignment_word(name) && !find_builtin(cmdline->arr) &&
+        only_standard_streams_redirected(cmdline)
+    );
+}
+
+static pid_t launch_with_zygote(
+    const execvp_cmd_line *cmdline,
+    const pipeline_item *prev_pipe, const pipeline_item *next_pipe
+)
+{
+    /* the streams are the ones the `set_up_pipeline` and
+    `apply_redirections` would give the forked child. Returns -1 if the
+    command is to be forked */
+    int child_input = prev_pipe ? prev_pipe->fd[0] : 0;
+    int child_output = next_pipe ? next_pipe->fd[1] : 1;
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        const fd_operation *op = &cmdline->fd_ops[i];
+        if (op->fd == 0)
+            child_input = op->file_fd;
+        else
+            child_output = op->file_fd;
+    }
+    return spawn_with_zygote(cmdline->arr, child_input, child_output);
+}
+
+static void launch_process(
+    execvp_cmd_line *cmdline, pipeline_item **first_pipe,
+    bool shell_stage_allowed, bool zygote_allowed
+)
 {
     pipeline_item *prev_pipe = NULL, *next_pipe = *first_pipe;
+    execvp_cmd_line *shell_stage =
+        pick_pipeline_stage_for_shell_process(cmdline, shell_stage_allowed);
+    const pipeline_item *shell_stage_prev = NULL, *shell_stage_next = NULL;
+    int shell_stage_input = -1, shell_stage_output = -1, stage = 0;
+    /* the children look the commands up in the shell's table */
+    refresh_completion();
     while (true) {
-        int fd_input = 0, fd_output = 0, res;
-        res = open_io_redirecton_files(cmdline, &fd_input, &fd_output);
-        if (res == -1)
+        int res;
+        if (cmdline == shell_stage) {
+            shell_stage_prev = prev_pipe;
+            shell_stage_next = next_pipe;
+            goto next_stage;
+        }
+        res = open_redirection_files(cmdline);
+        if (res == -1) {
+            cmdline->status = 1;
+            shell_stage = NULL;
             goto exit;
+        }
+        fflush(stdout);
         fflush(stderr);
-        cmdline->pid = fork();
-        error_handling(cmdline->pid, __FILE__, __LINE__, "fork");
+        cmdline->pid = zygote_can_launch(cmdline, zygote_allowed) ?
+            launch_with_zygote(cmdline, prev_pipe, next_pipe) : -1;
+        if (cmdline->pid == -1) {
+            cmdline->pid = fork();
+            error_handling(cmdline->pid, __FILE__, __LINE__, "fork");
+        }
         if (cmdline->pid == 0) {
-            set_up_and_exec_child(
-                cmdline, fd_input, fd_output, prev_pipe, next_pipe, *first_pipe
-            );
+            pin_pipeline_stage(&placement, stage);
+            lower_job_priority(&priority);
+            set_up_and_exec_child(cmdline, prev_pipe, next_pipe, *first_pipe);
         }
-        close_io_redirection_files(fd_input, fd_output);
+        close_redirection_files(cmdline);
+        next_stage:
+        stage++;
         cmdline = cmdline->next;
         if (!cmdline)
             break;
         prev_pipe = next_pipe;
         next_pipe = next_pipe->next;
     }
+    /* the pipe ends are taken once all the children are forked, so none of
+    them inherits a copy */
+    shell_stage_input = duplicate_pipe_end(shell_stage_prev, 0);
+    shell_stage_output = duplicate_pipe_end(shell_stage_next, 1);
     exit:
     close_and_free_all_pipes(*first_pipe);
     *first_pipe = NULL;
+    if (shell_stage) {
+        run_pipeline_stage_in_shell_process(
+            shell_stage, shell_stage_input, shell_stage_output
+        );
+    }
+}
+
+void read_captured_output(int fd, curr_word_dynamic_char_arr *output)
+{
+    /* the output is appended to the buffer with reads as large as its free
+    space, which is never less than `capture_read_len` */
+    while (true) {
+        ssize_t res;
+        while (output->arr_len - output->idx - 1 < capture_read_len) {
+            char *doubled_arr = realloc(output->arr, output->arr_len*2);
+            output->arr = doubled_arr;
+            output->arr_len *= 2;
+        }
+        res = read(
+            fd, &output->arr[output->idx], output->arr_len - output->idx - 1
+        );
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        error_handling(res, __FILE__, __LINE__, "read");
+        if (res <= 0)
+            break;
+        output->idx += res;
+    }
+    output->arr[output->idx] = '\0';
+}
+
+static void capture_command_output(string *str)
+{
+    /* the command substitution: the whole pipeline is forked with `stdout`
+    writing into a pipe, which is drained while the children run. Builtins
+    are forked too, so `cd` and the like don't affect the shell */
+    int capture_pipe[2], saved_stdout, res;
+    res = pipe2(capture_pipe, O_CLOEXEC);
+    error_handling(res, __FILE__, __LINE__, "pipe2");
+    if (res == -1) {
+        clean_up_cmdline_list_except_first_item(str->cmd_line.first, NULL);
+        return;
+    }
+    /* fewer context switches between the writers and the shell */
+    fcntl(capture_pipe[1], F_SETPIPE_SZ, capture_pipe_len);
+    fflush(stdout);
+    saved_stdout = save_standard_stream(1, true);
+    move_pipe_end_to_standard_stream(capture_pipe[1], 1);
+    suspend_background_zombie_handling();
+    launch_process(
+        str->cmd_line.first, &str->pipeline.first, false,
+        !str->substitution_pipes.first
+    );
+    close_process_substitution_pipes(&str->substitution_pipes);
+    restore_standard_stream(saved_stdout, 1);
+    read_captured_output(capture_pipe[0], str->capture);
+    close(capture_pipe[0]);
+    handle_zombies(&str->cmd_line);
+}
+
+static void launch_with_job_log(string *str)
+{
+    /* the background pipeline with `stdout` and `stderr` writing into the
+    pipe of its job's log. The zygote's children don't inherit the shell's
+    standard streams, so it isn't used */
+    const execvp_cmd_line *last;
+    int log_pipe, job, saved_stdout, saved_stderr, res;
+    log_pipe = open_job_log(str->cmd_line.first, &job);
+    if (log_pipe == -1) {
+        clean_up_cmdline_list_except_first_item(str->cmd_line.first, NULL);
+        close_process_substitution_pipes(&str->substitution_pipes);
+        set_command_status(1);
+        return;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    saved_stdout = save_standard_stream(1, true);
+    saved_stderr = save_standard_stream(2, true);
+    res = dup2(log_pipe, 1);
+    error_handling(res, __FILE__, __LINE__, "dup2");
+    move_pipe_end_to_standard_stream(log_pipe, 2);
+    launch_process(str->cmd_line.first, &str->pipeline.first, false, false);
+    close_process_substitution_pipes(&str->substitution_pipes);
+    restore_standard_stream(saved_stdout, 1);
+    restore_standard_stream(saved_stderr, 2);
+    for (last = str->cmd_line.first; last->next; last = last->next)
+        {}
+    set_job_log_pid(job, last->pid, last->status);
+    handle_zombies(&str->cmd_line);
 }
 #endif
 
@@ -652,16 +1112,67 @@ void execute_command(string *str)
     error_code err = 0;
     if (words_list_is_empty(str))
         return;
+    if (str->tokens_only) {
+        dump_tokens(&str->words_list);
+        return;
+    }
     err = transform_words_list_into_cmd_line_arr(str);
     if (err) {
         print_error(err);
+        set_command_status(2);
+        return;
+    }
+    expand_alias(str->cmd_line.first, &str->words_list);
+    if (!take_pin_prefix(str->cmd_line.first, &placement)) {
+        set_command_status(2);
+        return;
+    }
+    priority.enabled = false;
+    if (bgnice && str->cmd_line.background_execution &&
+        !read_background_priority(&priority))
+    {
+        set_command_status(2);
         return;
     }
-    if (change_dir_command(str->cmd_line.last)) {
-        handle_change_dir_command(str->cmd_line.last);
+    add_pipes_between_stages(str);
+    if (str->capture) {
+        capture_command_output(str);
         return;
     }
-    launch_process(str->cmd_line.first, &str->pipeline.first);
+    if (assignments_run_in_shell_process(&str->cmd_line)) {
+        run_assignments_in_shell_process(str->cmd_line.first);
+        set_command_status(0);
+        return;
+    }
+    if (builtin_runs_in_shell_process(&str->cmd_line)) {
+        set_command_status(
+            run_builtin_in_shell_process(str->cmd_line.first, -1, -1)
+        );
+        close_process_substitution_pipes(&str->substitution_pipes);
+        return;
+    }
+    if (tail_exec_possible(str)) {
+        exec_in_shell_process(str->cmd_line.first);
+        set_command_status(str->cmd_line.first->status);
+        return;
+    }
+    if (joblog && str->cmd_line.background_execution) {
+        launch_with_job_log(str);
+        return;
+    }
+    /* the foreground children mustn't be reaped by the signal handler
+    before their statuses are collected */
+    if (!str->cmd_line.background_execution)
+        suspend_background_zombie_handling();
+    /* the `<(...)` and `>(...)` pipes are inherited from the shell, so
+    their commands can't be started by the zygote */
+    launch_process(
+        str->cmd_line.first, &str->pipeline.first,
+        !str->cmd_line.background_execution, !str->substitution_pipes.first
+    );
+    /* the readers of the `>(...)` pipes get EOF once the command line is
+    done with them, not once the shell is done waiting for it */
+    close_process_substitution_pipes(&str->substitution_pipes);
     handle_zombies(&str->cmd_line);
 #endif
 }
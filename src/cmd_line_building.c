@@ -0,0 +1,371 @@
+/* cmd_line_building.c */
+
+#include "cmd_line_building.h"
+#include <stdlib.h>
+#include <string.h>
+#include "parse_allocation.h"
+
+void reset_cmd_line_item(execvp_cmd_line *item)
+{
+    item->pid = 0;
+    item->status = 0;
+    item->fd_ops_len = 0;
+    item->waiting_fd_op = -1;
+    /* item->next = NULL; */
+}
+
+void init_cmd_line_item(execvp_cmd_line *item)
+{
+    item->arr_len = init_cmd_line_arr_len;
+    item->arr = malloc(item->arr_len * sizeof(char*));
+    item->fd_ops = NULL;
+    item->fd_ops_arr_len = 0;
+    reset_cmd_line_item(item);
+    item->next = NULL;
+}
+
+void free_cmd_line_item(execvp_cmd_line *item)
+{
+    free(item->arr);
+    free(item->fd_ops);
+    free(item);
+}
+
+bool words_list_is_empty(const string *str)
+{
+    return (!str->words_list.first);
+}
+
+static void increase_cmd_line_array_length(execvp_cmd_line *cmdline)
+{
+    cmdline->arr_len *= 2;
+    cmdline->arr = realloc(cmdline->arr, cmdline->arr_len * sizeof(char*));
+}
+
+static bool pipe_operator_at_start_of_cmdline(
+    const word_item *curr_word, int cmdline_idx
+)
+{
+    return(
+        curr_word->separator_val == pipe_operator &&
+        cmdline_idx == 0
+    );
+}
+
+static bool separator_right_after_io_redirecton(
+    const string *str, const word_item *curr_word
+)
+{
+    const execvp_cmd_line *cmdline = str->cmd_line.last;
+    bool the_word_is_separator = (curr_word->separator_val != none);
+    return (the_word_is_separator && cmdline->waiting_fd_op != -1);
+}
+
+static bool second_simple_word_right_after_io_redirecton(
+    string *str, const word_item *curr_word 
+)
+{
+    const execvp_cmd_line *cmdline = str->cmd_line.last;
+
+    bool simple_word = (curr_word->separator_val == none);
+
+    bool at_least_one_io_redirection = (cmdline->fd_ops_len > 0);
+
+    bool io_redirection_not_waiting_for_file = (cmdline->waiting_fd_op == -1);
+
+    return(
+        simple_word &&
+        at_least_one_io_redirection &&
+        io_redirection_not_waiting_for_file
+    );
+}
+
+static bool set_duplication_target(fd_operation *op, const char *word)
+{
+    /* `>&N` and `<&N` copy the descriptor `N`, `>&-` and `<&-` close the
+    one redirected */
+    if (0 == strcmp(word, "-")) {
+        op->type = close_fd_operation;
+        return true;
+    }
+    if (word[0] < '0' || word[0] > '9' || word[1] != '\0')
+        return false;
+    op->target_fd = word[0] - '0';
+    return true;
+}
+
+enum tag_status { error = -1, move_on, completed };
+
+static enum tag_status appoint_io_redirection_file(
+    string *str, const word_item *curr_word, int idx, bool *next_step
+)
+{
+    execvp_cmd_line *cmdline = str->cmd_line.last;
+    fd_operation *op;
+    if (curr_word->separator_val != none || cmdline->waiting_fd_op == -1)
+        return move_on;
+    op = &cmdline->fd_ops[cmdline->waiting_fd_op];
+    if (op->type == duplicate_fd_operation) {
+        if (!set_duplication_target(op, curr_word->word))
+            return error;
+    } else
+        op->redirection_file = curr_word->word;
+    cmdline->waiting_fd_op = -1;
+    cmdline->arr[idx] = NULL;
+    *next_step = true;
+    return completed;
+}
+
+static enum tag_status start_background_execution(
+    string *str, const word_item *curr_word, int idx, bool *next_step
+)
+{
+    if (curr_word->separator_val == background_operator) {
+        str->cmd_line.last->arr[idx] = NULL;
+        str->cmd_line.background_execution = true;
+        *next_step = true;
+        return completed;
+    } else
+        return move_on;
+}
+
+static void add_new_cmd_line_item(cmd_lines_list *cmdline)
+{
+    /* add item at the end of `cmd_line` link list */
+    cmdline->last->next = malloc(sizeof(execvp_cmd_line));
+    cmdline->last = cmdline->last->next;
+    init_cmd_line_item(cmdline->last);
+    cmdline->list_len++;
+}
+
+
+static enum tag_status split_cmdline(
+    string *str, const word_item *curr_word, int *idx, bool *next_step
+)
+{
+    if (curr_word->separator_val == pipe_operator) {
+        str->cmd_line.last->arr[*idx] = NULL;
+        add_new_cmd_line_item(&str->cmd_line);
+        (*idx) = -1;        /* on the next iteration it will be 0 */
+        *next_step = true;
+        return completed;
+    } else
+        return move_on;
+}
+
+static fd_operation *add_fd_operation(
+    execvp_cmd_line *cmdline, fd_operation_type type, int fd
+)
+{
+    /* returns NULL if the descriptor is redirected by the command already */
+    fd_operation *op;
+    int i;
+    for (i = 0; i < cmdline->fd_ops_len; i++) {
+        if (cmdline->fd_ops[i].fd == fd)
+            return NULL;
+    }
+    if (cmdline->fd_ops_len == cmdline->fd_ops_arr_len) {
+        cmdline->fd_ops_arr_len = cmdline->fd_ops_arr_len ?
+            cmdline->fd_ops_arr_len*2 : init_fd_ops_arr_len;
+        cmdline->fd_ops = realloc(
+            cmdline->fd_ops, cmdline->fd_ops_arr_len * sizeof(fd_operation)
+        );
+    }
+    op = &cmdline->fd_ops[cmdline->fd_ops_len];
+    cmdline->fd_ops_len++;
+    op->type = type;
+    op->fd = fd;
+    op->mode = read_mode;
+    op->source = file_source;
+    op->redirection_file = NULL;
+    op->target_fd = -1;
+    op->file_fd = -1;
+    return op;
+}
+
+static int redirection_fd(const char *operator, int default_fd)
+{
+    /* the descriptor number written right before the operator */
+    if (operator[0] >= '0' && operator[0] <= '9')
+        return operator[0] - '0';
+    return default_fd;
+}
+
+int separator_descriptor(const word_item *separator)
+{
+    /* the descriptor a redirection written as `2>` applies to, or the one
+    `<&` and `>&` copy into, which their names alone don't tell. -1 for
+    the other separators */
+    const char *operator = separator->word ? separator->word : "";
+    if (separator->separator_val == duplication_redirection)
+        return redirection_fd(operator, (operator[0] == '<') ? 0 : 1);
+    return redirection_fd(operator, -1);
+}
+
+static io_source input_source(separator_type separator_val)
+{
+    switch (separator_val) {
+        case (here_document):
+            return here_document_source;
+        case (here_string):
+            return here_string_source;
+        default:
+            return file_source;
+    }
+}
+
+static fd_operation *add_open_operation(
+    execvp_cmd_line *cmdline, const char *operator, int default_fd,
+    open_mode mode
+)
+{
+    fd_operation *op = add_fd_operation(
+        cmdline, open_fd_operation, redirection_fd(operator, default_fd)
+    );
+    if (op)
+        op->mode = mode;
+    return op;
+}
+
+static enum tag_status toggle_io_redirection(
+    string *str, const word_item *curr_word, int idx, bool *next_step
+)
+{
+    /* the redirection waits for the next word, its file name. `&>` and
+    `&>>` redirect `stdout` into the file and make `stderr` its copy */
+    execvp_cmd_line *cmdline = str->cmd_line.last;
+    const char *operator = curr_word->word;
+    fd_operation *op;
+    switch (curr_word->separator_val) {
+        case (input_redirection):
+        case (here_document):
+        case (here_string):
+            op = add_open_operation(cmdline, operator, 0, read_mode);
+            if (op)
+                op->source = input_source(curr_word->separator_val);
+            break;
+        case (output_redirection):
+        case (output_error_redirection):
+            op = add_open_operation(cmdline, operator, 1, overwrite_mode);
+            break;
+        case (output_append_redirection):
+        case (output_error_append_redirection):
+            op = add_open_operation(cmdline, operator, 1, append_mode);
+            break;
+        case (input_output_redirection):
+            op = add_open_operation(cmdline, operator, 0, read_write_mode);
+            break;
+        case (duplication_redirection):
+            op = add_fd_operation(
+                cmdline, duplicate_fd_operation,
+                redirection_fd(operator, strchr(operator, '>') ? 1 : 0)
+            );
+            break;
+        default:
+            return move_on;
+    }
+    if (!op)
+        return error;
+    cmdline->waiting_fd_op = cmdline->fd_ops_len - 1;
+    if (curr_word->separator_val == output_error_redirection ||
+        curr_word->separator_val == output_error_append_redirection)
+    {
+        op = add_fd_operation(cmdline, duplicate_fd_operation, 2);
+        if (!op)
+            return error;
+        op->target_fd = 1;
+    }
+    cmdline->arr[idx] = NULL;
+    *next_step = true;
+    return completed;
+}
+
+static error_code handle_possible_separator(
+    string *str, const word_item *curr_word, int *idx, bool *next_step
+)
+{
+    enum tag_status { error = -1, move_on, completed } status;
+    if (str->cmd_line.background_execution)
+        return background_operator_not_in_the_end_of_str;
+    if (pipe_operator_at_start_of_cmdline(curr_word, *idx))
+        return pipe_operator_at_start_of_str;
+    if (separator_right_after_io_redirecton(str, curr_word))
+        return separator_right_after_input_or_output_redirection;
+    if (second_simple_word_right_after_io_redirecton(str, curr_word))
+        return second_simple_word_right_after_input_or_output_redirecton;
+    status = split_cmdline(str, curr_word, idx, next_step);
+    if (status == completed)
+        return no_error;
+    status = appoint_io_redirection_file(str, curr_word, *idx, next_step);
+    if (status == completed)
+        return no_error;
+    if (status == error)
+        return bad_fd_duplication_target;
+    status = start_background_execution(str, curr_word, *idx, next_step);
+    if (status == completed)
+        return no_error;
+    status = toggle_io_redirection(str, curr_word, *idx, next_step);
+    if (status == completed)
+        return no_error;
+    if (status == error)
+        return input_or_output_separator_used_in_line_twice;
+    if (curr_word->separator_val != none)
+        return not_implemented_feature;
+    return no_error;
+}
+
+void drop_cmd_line_items_except_first(cmd_lines_list *cmdline)
+{
+    execvp_cmd_line *item;
+    if (!cmdline->first)
+        return;
+    item = cmdline->first->next;
+    while (item) {
+        execvp_cmd_line *tmp = item;
+        item = item->next;
+        free_cmd_line_item(tmp);
+    }
+    cmdline->first->next = NULL;
+    cmdline->last = cmdline->first;
+    cmdline->list_len = 1;
+}
+
+error_code transform_words_list_into_cmd_line_arr(string *str)
+{
+    /* splits the words of the command line into the `argv` arrays of the
+    pipeline stages and their redirections. Nothing is opened or created, so
+    a line with an error leaves only the first item of the list */
+    word_item *p = str->words_list.first;
+    int i = 0;
+    if (!str->cmd_line.first) {
+        /* the first command line of the `string` */
+        str->cmd_line.first = malloc(sizeof(execvp_cmd_line));
+        init_cmd_line_item(str->cmd_line.first);
+        str->cmd_line.last = str->cmd_line.first;
+    }
+    for (;; p=p->next, i++) {
+        if (str->cmd_line.last->arr_len == i)
+            increase_cmd_line_array_length(str->cmd_line.last);
+        if (!p) {
+            str->cmd_line.last->arr[i] = NULL;
+            if (str->cmd_line.last->waiting_fd_op != -1) {
+                /* the line ends right after a redirection */
+                drop_cmd_line_items_except_first(&str->cmd_line);
+                return separator_right_after_input_or_output_redirection;
+            }
+            break;
+        } else {
+            bool next_step = false;
+            error_code err;
+            err = handle_possible_separator(str, p, &i, &next_step);
+            if (err) {
+                drop_cmd_line_items_except_first(&str->cmd_line);
+                return err;
+            }
+            if (next_step)
+                continue;
+            str->cmd_line.last->arr[i] = p->word;
+        }
+    }
+    return 0;
+}
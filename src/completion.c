@@ -0,0 +1,464 @@
+/* completion.c */
+
+#define _GNU_SOURCE
+#include "completion.h"
+#include "io_util.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* The names of the commands found in the `PATH` directories are kept in a
+prefix tree, made once and then kept up to date with `inotify`: an event in
+a directory has the name it's about checked again, so a new or removed
+command is seen without listing the directories anew. The tree gives the
+names the Tab completes a command name to, and the path a command is run
+from, the same one `execvp` would find. A change of the `PATH`, or events
+lost by `inotify`, has the tree made anew.
+
+The tree is made from the names the directories list, with no system call
+for each of them: a name is checked to be an executable file only once it's
+completed to or run, and the answer is kept until an event is about it */
+
+enum completion_consts {
+    init_matches_len        = 16,
+    init_name_len           = 64,
+    node_chunk_len          = 4096,
+    inotify_buf_len         = 4096
+};
+
+#define WATCH_MASK (IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO| \
+    IN_ATTRIB|IN_DELETE_SELF|IN_MOVE_SELF|IN_ONLYDIR)
+
+typedef struct tag_trie_node {
+    /* the children are sorted by the character, so are the names listed */
+    struct tag_trie_node *child;
+    struct tag_trie_node *next;
+    /* the index of the first directory of the `PATH` holding a command of
+    the name ending here, -1 if there is none */
+    int dir;
+    /* the `dir` holds an executable file, not just an entry of the name */
+    bool checked;
+    char c;
+} trie_node;
+
+typedef struct tag_node_chunk {
+    struct tag_node_chunk *next;
+    trie_node nodes[node_chunk_len];
+} node_chunk;
+
+typedef struct tag_command_table {
+    bool built;
+    /* the value of the `PATH` the table was made from, NULL if unset */
+    char *path_variable;
+    char **dirs;
+    int *watches;
+    int dirs_len;
+    /* the relative directories, the empty one among them, depend on the
+    current directory, so the commands are looked for by `execvp` then */
+    bool absolute_dirs;
+    int inotify_fd;
+    trie_node root;
+    /* the nodes are allocated in chunks, the last one is filled up */
+    node_chunk *chunks;
+    int chunk_used;
+} command_table;
+
+static command_table table = {
+    false, NULL, NULL, NULL, 0, false, -1,
+    { NULL, NULL, -1, false, '\0' }, NULL, 0
+};
+
+static trie_node *new_node()
+{
+    if (!table.chunks || table.chunk_used == node_chunk_len) {
+        node_chunk *chunk = malloc(sizeof(node_chunk));
+        chunk->next = table.chunks;
+        table.chunks = chunk;
+        table.chunk_used = 0;
+    }
+    table.chunk_used++;
+    return &table.chunks->nodes[table.chunk_used-1];
+}
+
+static void free_trie_nodes()
+{
+    while (table.chunks) {
+        node_chunk *tmp = table.chunks;
+        table.chunks = table.chunks->next;
+        free(tmp);
+    }
+    table.root.child = NULL;
+}
+
+static trie_node *find_node(const char *name, bool create)
+{
+    trie_node *node = &table.root;
+    for (; *name; name++) {
+        trie_node **p = &node->child;
+        while (*p && (unsigned char)(*p)->c < (unsigned char)*name)
+            p = &(*p)->next;
+        if (!*p || (*p)->c != *name) {
+            trie_node *tmp;
+            if (!create)
+                return NULL;
+            tmp = new_node();
+            tmp->child = NULL;
+            tmp->next = *p;
+            tmp->dir = -1;
+            tmp->checked = false;
+            tmp->c = *name;
+            *p = tmp;
+        }
+        node = *p;
+    }
+    return node;
+}
+
+static void add_directory_commands(int dir_idx)
+{
+    /* the commands already found in an earlier directory stay there */
+    DIR *dir = opendir(table.dirs[dir_idx]);
+    struct dirent *entry;
+    if (!dir)
+        return;
+    while ((entry = readdir(dir))) {
+        const char *name = entry->d_name;
+        trie_node *node;
+        if (0 == strcmp(name, ".") || 0 == strcmp(name, ".."))
+            continue;
+        if (entry->d_type == DT_DIR)
+            continue;
+        node = find_node(name, true);
+        if (node->dir == -1)
+            node->dir = dir_idx;
+    }
+    closedir(dir);
+}
+
+static void split_path_variable()
+{
+    /* the empty directory of the `PATH` is the current one */
+    char *p = table.path_variable;
+    int len = 1;
+    table.dirs_len = 0;
+    table.absolute_dirs = true;
+    if (!p) {
+        table.absolute_dirs = false;
+        return;
+    }
+    for (; *p; p++)
+        len += (*p == ':');
+    table.dirs = malloc(len * sizeof(char*));
+    table.watches = malloc(len * sizeof(int));
+    for (p = table.path_variable;; p++) {
+        char *end = strchrnul(p, ':');
+        table.dirs[table.dirs_len] = strndup(
+            (end == p) ? "." : p, (end == p) ? 1 : end - p
+        );
+        if (end == p || *p != '/')
+            table.absolute_dirs = false;
+        table.dirs_len++;
+        if (!*end)
+            break;
+        p = end;
+    }
+}
+
+static void watch_directories()
+{
+    /* a directory met twice in the `PATH` is watched for the first time it
+    appears, the later ones never hold the first command of a name */
+    int i, j;
+    /* above the descriptors `>&N` may copy, a command can't write to it */
+    table.inotify_fd =
+        move_fd_above_user_range(inotify_init1(IN_NONBLOCK|IN_CLOEXEC));
+    for (i = 0; i < table.dirs_len; i++) {
+        table.watches[i] = (table.inotify_fd == -1) ? -1 :
+            inotify_add_watch(table.inotify_fd, table.dirs[i], WATCH_MASK);
+        for (j = 0; j < i && table.watches[i] != -1; j++) {
+            if (table.watches[j] == table.watches[i])
+                table.watches[i] = -1;
+        }
+    }
+}
+
+static void clear_table()
+{
+    int i;
+    free_trie_nodes();
+    for (i = 0; i < table.dirs_len; i++)
+        free(table.dirs[i]);
+    free(table.dirs);
+    free(table.watches);
+    free(table.path_variable);
+    table.dirs = NULL;
+    table.watches = NULL;
+    table.dirs_len = 0;
+    table.path_variable = NULL;
+    if (table.inotify_fd != -1)
+        close(table.inotify_fd);
+    table.inotify_fd = -1;
+    table.built = false;
+}
+
+static void build_table()
+{
+    /* the directories are watched before they're listed, so a command
+    added meanwhile isn't missed */
+    const char *path = getenv("PATH");
+    int i;
+    clear_table();
+    table.path_variable = path ? strdup(path) : NULL;
+    split_path_variable();
+    watch_directories();
+    for (i = 0; i < table.dirs_len; i++)
+        add_directory_commands(i);
+    table.built = true;
+}
+
+void init_completion()
+{
+    build_table();
+}
+
+static bool executable_file(int dir, const char *name)
+{
+    char path[PATH_MAX];
+    struct stat st;
+    snprintf(path, sizeof(path), "%s/%s", table.dirs[dir], name);
+    return (
+        stat(path, &st) == 0 && S_ISREG(st.st_mode) &&
+        0 == faccessat(AT_FDCWD, path, X_OK, AT_EACCESS)
+    );
+}
+
+static int first_directory_holding(const char *name, int from)
+{
+    int i;
+    for (i = from; i < table.dirs_len; i++) {
+        if (executable_file(i, name))
+            return i;
+    }
+    return -1;
+}
+
+static int command_directory(trie_node *node, const char *name)
+{
+    /* the entry of the name may turn out not to be a command, then the
+    later directories are looked at */
+    if (node->dir != -1 && !node->checked) {
+        if (!executable_file(node->dir, name))
+            node->dir = first_directory_holding(name, node->dir+1);
+        node->checked = true;
+    }
+    return node->dir;
+}
+
+static void update_command(const char *name)
+{
+    /* the name is looked for in all the directories again, the event may
+    have uncovered the command of a later one */
+    int dir = first_directory_holding(name, 0);
+    trie_node *node = find_node(name, dir != -1);
+    if (node) {
+        node->dir = dir;
+        node->checked = true;
+    }
+}
+
+static bool handle_inotify_events()
+{
+    /* returns false if the table is to be made anew */
+    char buf[inotify_buf_len]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (true) {
+        const char *p;
+        ssize_t res = read(table.inotify_fd, buf, sizeof(buf));
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res <= 0)
+            return true;
+        for (p = buf; p < buf + res;) {
+            const struct inotify_event *event = (const void *)p;
+            if (event->mask & (IN_Q_OVERFLOW|IN_DELETE_SELF|IN_MOVE_SELF))
+                return false;
+            if (event->len > 0)
+                update_command(event->name);
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+}
+
+static bool table_path_current()
+{
+    /* the table is built from the `PATH` the shell has now */
+    const char *path = getenv("PATH");
+    return (!path && !table.path_variable) || (
+        path && table.path_variable && 0 == strcmp(path, table.path_variable)
+    );
+}
+
+void refresh_completion()
+{
+    if (!table.built)
+        return;
+    if (!table_path_current() || table.inotify_fd == -1 ||
+        !handle_inotify_events())
+    {
+        build_table();
+    }
+}
+
+char *find_command_path(const char *name)
+{
+    /* the path the command is run from, NULL if it's to be looked for by
+    `execvp`. The forked child only reads the table the shell has kept up
+    to date, a command gone meanwhile makes `execv` fail and `execvp` run.
+    So does a `PATH` the `PATH=dirs cmd` prefix has given the child */
+    trie_node *node;
+    char *path;
+    if (!table.built || !table.absolute_dirs || !name || !*name ||
+        strchr(name, '/') || !table_path_current())
+    {
+        return NULL;
+    }
+    node = find_node(name, false);
+    if (!node || command_directory(node, name) == -1)
+        return NULL;
+    path = malloc(strlen(table.dirs[node->dir]) + strlen(name) + 2);
+    sprintf(path, "%s/%s", table.dirs[node->dir], name);
+    return path;
+}
+
+static void add_match(completion_matches *matches, const char *word, int len)
+{
+    if (!matches->arr) {
+        matches->arr_len = init_matches_len;
+        matches->arr = malloc(matches->arr_len * sizeof(char*));
+    }
+    if (matches->len == matches->arr_len) {
+        matches->arr_len *= 2;
+        matches->arr =
+            realloc(matches->arr, matches->arr_len * sizeof(char*));
+    }
+    matches->arr[matches->len] = strndup(word, len);
+    matches->len++;
+}
+
+static void collect_names(
+    trie_node *node, char **name, int len, int *name_len,
+    completion_matches *matches
+)
+{
+    /* the `name` holds the characters on the way to the `node` */
+    trie_node *child;
+    (*name)[len] = '\0';
+    if (command_directory(node, *name) != -1)
+        add_match(matches, *name, len);
+    for (child = node->child; child; child = child->next) {
+        if (len+1 >= *name_len) {
+            *name_len *= 2;
+            *name = realloc(*name, *name_len);
+        }
+        (*name)[len] = child->c;
+        collect_names(child, name, len+1, name_len, matches);
+    }
+}
+
+void complete_command_name(
+    const char *word, int len, completion_matches *matches
+)
+{
+    char *name;
+    int name_len = init_name_len;
+    trie_node *node;
+    if (!table.built)
+        return;
+    name = strndup(word, len);
+    node = find_node(name, false);
+    if (node) {
+        while (name_len <= len)
+            name_len *= 2;
+        name = realloc(name, name_len);
+        collect_names(node, &name, len, &name_len, matches);
+    }
+    free(name);
+}
+
+static int compare_matches(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+static bool directory_entry(int dir_fd, const struct dirent *entry)
+{
+    struct stat st;
+    if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK)
+        return entry->d_type == DT_DIR;
+    return fstatat(dir_fd, entry->d_name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+}
+
+void complete_file_path(
+    const char *word, int len, completion_matches *matches
+)
+{
+    /* the entries of the directory the word names, the hidden ones only if
+    the word says so. A directory is completed with the slash */
+    const char *slash = memrchr(word, '/', len);
+    int dir_len = slash ? slash - word + 1 : 0;
+    const char *base = &word[dir_len];
+    int base_len = len - dir_len;
+    char *dir_path = strndup(word, dir_len);
+    char *match;
+    struct dirent *entry;
+    DIR *dir = opendir(dir_len ? dir_path : ".");
+    free(dir_path);
+    if (!dir)
+        return;
+    while ((entry = readdir(dir))) {
+        const char *name = entry->d_name;
+        int name_len = strlen(name);
+        if (0 == strcmp(name, ".") || 0 == strcmp(name, ".."))
+            continue;
+        if ((name[0] == '.' && (base_len == 0 || base[0] != '.')) ||
+            name_len < base_len || 0 != strncmp(name, base, base_len))
+        {
+            continue;
+        }
+        match = malloc(dir_len + name_len + 2);
+        memcpy(match, word, dir_len);
+        strcpy(&match[dir_len], name);
+        if (directory_entry(dirfd(dir), entry))
+            strcat(match, "/");
+        add_match(matches, match, strlen(match));
+        free(match);
+    }
+    closedir(dir);
+    if (matches->len > 1)
+        qsort(matches->arr, matches->len, sizeof(char*), compare_matches);
+}
+
+void free_completion_matches(completion_matches *matches)
+{
+    int i;
+    for (i = 0; i < matches->len; i++)
+        free(matches->arr[i]);
+    free(matches->arr);
+    matches->arr = NULL;
+    matches->len = 0;
+    matches->arr_len = 0;
+}
+
+void free_completion()
+{
+    clear_table();
+}
@@ -0,0 +1,1504 @@
+/* control_flow.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "cmd_execution.h"
+#include "control_flow.h"
+#include "error_handling.h"
+#include "str_parsing.h"
+#include "variables.h"
+#include "zombie_handling.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+#define ERR_SYNTAX_ERROR \
+    "my_shell: syntax error near unexpected token `%.*s'\n"
+#define ERR_AMBIGUOUS_REDIRECT "my_shell: %s: ambiguous redirect\n"
+#define ERR_ONLY_MEANINGFUL_IN_LOOP \
+    "my_shell: %s: only meaningful in a `for', `while', or `until' loop\n"
+#define ERR_LOOP_COUNT "my_shell: %s: %s: loop count out of range\n"
+#define ERR_RETURN_OUTSIDE_FUNCTION \
+    "my_shell: return: can only `return' from a function\n"
+#define ERR_NUMERIC_ARGUMENT "my_shell: %s: %s: numeric argument required\n"
+
+enum control_flow_consts {
+    init_tokens_arr_len = 64
+};
+
+typedef enum tag_token_type {
+    word_token,
+    newline_token,
+    semicolon_token,
+    and_token,
+    or_token,
+    pipe_token,
+    background_token,
+    input_redirection_token,
+    output_redirection_token,
+    output_append_token,
+    /* the operators that are a part of a simple command, like `<<` */
+    other_token,
+    end_token
+} token_type;
+
+typedef struct tag_token {
+    token_type type;
+    /* the token is `text[start]` ... `text[end-1]` */
+    int start;
+    int end;
+} token;
+
+typedef struct tag_operator_item {
+    const char *text;
+    token_type type;
+} operator_item;
+
+/* the longer operators go first */
+static const operator_item operators[] = {
+    { "&>>",    other_token },
+    { "&&",     and_token },
+    { "||",     or_token },
+    { "<<<",    other_token },
+    { "<<",     other_token },
+    { ">>",     output_append_token },
+    { "&>",     other_token },
+    { ">&",     other_token },
+    { "<&",     other_token },
+    { "<>",     other_token },
+    { "\n",     newline_token },
+    { ";",      semicolon_token },
+    { "&",      background_token },
+    { "|",      pipe_token },
+    { "<",      input_redirection_token },
+    { ">",      output_redirection_token },
+    { "(",      other_token },
+    { ")",      other_token },
+    { NULL,     end_token }
+};
+
+/* the values of the node types and of the connectors are written into the
+serialized trees */
+typedef enum tag_ast_node_type {
+    simple_command_node,
+    if_node,
+    while_node,
+    until_node,
+    for_node,
+    /* `{ list; }` */
+    group_node,
+    /* `name() compound-command` */
+    function_node,
+    /* `simple-command | compound-command` */
+    pipeline_node
+} ast_node_type;
+
+typedef enum tag_list_connector {
+    /* `;`, `&` or a newline: the command is run whatever the previous one
+    has returned */
+    sequence_connector,
+    and_connector,
+    or_connector
+} list_connector;
+
+struct tag_ast_node {
+    ast_node_type type;
+    /* how the node is joined to the previous one of its list */
+    list_connector connector;
+    /* the source of a simple command, ending with a newline so it can be run
+    as it is, or the words after the `in` of a `for` loop */
+    char *text;
+    int text_len;
+    /* the words of a simple command split once, so that a loop only expands
+    them, or NULL if its text is lexed each time it runs */
+    compiled_command *compiled;
+    /* the variable of a `for` loop, or the name of a function */
+    char *var_name;
+    /* the lists of an `if`, a `while`, an `until`, a `for` or a group. The
+    `else_part` of an `elif` is a list of a single `if` node. The `body` of
+    a function is a single compound command node, so is the `body` of a
+    pipeline, whose `condition` is the simple command writing into it */
+    ast_node *condition;
+    ast_node *body;
+    ast_node *else_part;
+    /* the words after the `<`, `>` or `>>` of a compound command */
+    char *input_file;
+    char *output_file;
+    bool output_append;
+    ast_node *next;
+};
+
+typedef struct tag_ast_parser {
+    const char *text;
+    token *tokens;
+    int tokens_len;
+    int tokens_arr_len;
+    /* the current token */
+    int idx;
+    compound_parse_status status;
+} ast_parser;
+
+typedef enum tag_loop_control_type {
+    no_loop_control,
+    break_loop,
+    continue_loop,
+    return_from_function,
+    exit_shell
+} loop_control_type;
+
+typedef struct tag_loop_control_state {
+    /* a `break`, a `continue` or a `return` that hasn't reached its loop or
+    its function yet, or an `exit` */
+    loop_control_type type;
+    /* the number of enclosing loops it is going to leave */
+    int count;
+    /* the status given to the `return` or to the `exit` */
+    int return_status;
+    /* the number of loops being run by the current function, and the number
+    of functions being run */
+    int loop_depth;
+    int function_depth;
+} loop_control_state;
+
+static loop_control_state loop_control = { no_loop_control, 0, 0, 0, 0 };
+
+typedef struct tag_function_body {
+    ast_node *tree;
+    /* the function table and every call being run hold a reference, so
+    a function may be redefined while it runs */
+    int refs;
+} function_body;
+
+typedef struct tag_function_item {
+    char *name;
+    function_body *body;
+    struct tag_function_item *next;
+} function_item;
+
+static function_item *functions = NULL;
+
+static const char *const no_keywords[] = { NULL };
+static const char *const then_keywords[] = { "then", NULL };
+static const char *const if_body_keywords[] = { "elif", "else", "fi", NULL };
+static const char *const fi_keywords[] = { "fi", NULL };
+static const char *const do_keywords[] = { "do", NULL };
+static const char *const done_keywords[] = { "done", NULL };
+static const char *const close_brace_keywords[] = { "}", NULL };
+/* the keywords that can't start a command */
+static const char *const reserved_words[] = {
+    "then", "elif", "else", "fi", "do", "done", "}", NULL
+};
+/* the keywords a function body may start with */
+static const char *const compound_keywords[] = {
+    "{", "if", "while", "until", "for", NULL
+};
+
+static void add_token(ast_parser *parser, token_type type, int start, int end)
+{
+    if (parser->tokens_len == parser->tokens_arr_len) {
+        parser->tokens_arr_len *= 2;
+        parser->tokens = realloc(
+            parser->tokens, parser->tokens_arr_len * sizeof(token)
+        );
+    }
+    parser->tokens[parser->tokens_len].type = type;
+    parser->tokens[parser->tokens_len].start = start;
+    parser->tokens[parser->tokens_len].end = end;
+    parser->tokens_len++;
+}
+
+static int skip_nested_text(const char *text, int i, char open, char close)
+{
+    /* `i` is right after the opening character, returns the index right
+    after the matching closing one, or -1 if the text ends first */
+    int depth = 1;
+    bool quotation = false, char_escaping = false;
+    for (; text[i]; i++) {
+        if (char_escaping)
+            char_escaping = false;
+        else
+        if (text[i] == '\\')
+            char_escaping = true;
+        else
+        if (text[i] == '"')
+            quotation = !quotation;
+        else
+        if (!quotation && (text[i] == open))
+            depth++;
+        else
+        if (!quotation && (text[i] == close) && (--depth == 0))
+            return i+1;
+    }
+    return -1;
+}
+
+static bool word_delimiter(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\n' || strchr(";&|<>()", c));
+}
+
+static int scan_word(const char *text, int i)
+{
+    /* returns the index right after the word starting at `i`, or -1 if
+    a quotation or a substitution in it isn't closed */
+    bool quotation = false;
+    if ((text[i] == '<' || text[i] == '>') && (text[i+1] == '('))
+        /* the process substitution */
+        return skip_nested_text(text, i+2, '(', ')');
+    while (text[i]) {
+        if (text[i] == '\\') {
+            if (!text[i+1])
+                return -1;
+            i += 2;
+        } else
+        if (text[i] == '"') {
+            quotation = !quotation;
+            i++;
+        } else
+        if (text[i] == '$' && (text[i+1] == '(' || text[i+1] == '{')) {
+            i = skip_nested_text(
+                text, i+2, text[i+1], (text[i+1] == '(') ? ')' : '}'
+            );
+            if (i == -1)
+                return -1;
+        } else
+        if (!quotation && word_delimiter(text[i]))
+            break;
+        else
+            i++;
+    }
+    return quotation ? -1 : i;
+}
+
+static const operator_item *find_operator(const char *text)
+{
+    const operator_item *p;
+    if ((text[0] == '<' || text[0] == '>') && (text[1] == '('))
+        return NULL;
+    for (p = operators; p->text; p++) {
+        if (0 == strncmp(text, p->text, strlen(p->text)))
+            return p;
+    }
+    return NULL;
+}
+
+static bool tokenize(ast_parser *parser)
+{
+    /* returns false if the text ends inside a quotation or a substitution */
+    const char *text = parser->text;
+    int i = 0;
+    while (true) {
+        const operator_item *operator;
+        while (text[i] == ' ' || text[i] == '\t')
+            i++;
+        if (!text[i])
+            break;
+        operator = find_operator(&text[i]);
+        if (operator) {
+            int len = strlen(operator->text);
+            add_token(parser, operator->type, i, i+len);
+            i += len;
+        } else {
+            int end = scan_word(text, i);
+            if (end == -1)
+                return false;
+            add_token(parser, word_token, i, end);
+            i = end;
+        }
+    }
+    add_token(parser, end_token, i, i);
+    return true;
+}
+
+static const token *current_token(const ast_parser *parser)
+{
+    return &parser->tokens[parser->idx];
+}
+
+static bool current_keyword(const ast_parser *parser, const char *keyword)
+{
+    const token *t = current_token(parser);
+    int len = t->end - t->start;
+    return (
+        t->type == word_token && len == (int)strlen(keyword) &&
+        0 == memcmp(&parser->text[t->start], keyword, len)
+    );
+}
+
+static bool current_keyword_in(
+    const ast_parser *parser, const char *const *keywords
+)
+{
+    for (; *keywords; keywords++) {
+        if (current_keyword(parser, *keywords))
+            return true;
+    }
+    return false;
+}
+
+static void syntax_error(ast_parser *parser)
+{
+    /* the end of the text means that the command goes on in the next line */
+    const token *t = current_token(parser);
+    if (parser->status != compound_complete)
+        return;
+    if (t->type == end_token) {
+        parser->status = compound_incomplete;
+        return;
+    }
+    parser->status = compound_syntax_error;
+    if (t->type == newline_token)
+        fprintf(stderr, ERR_SYNTAX_ERROR, 7, "newline");
+    else
+        fprintf(
+            stderr, ERR_SYNTAX_ERROR,
+            t->end - t->start, &parser->text[t->start]
+        );
+}
+
+static bool expect_keyword(ast_parser *parser, const char *keyword)
+{
+    if (!current_keyword(parser, keyword)) {
+        syntax_error(parser);
+        return false;
+    }
+    parser->idx++;
+    return true;
+}
+
+static void skip_newlines(ast_parser *parser)
+{
+    while (current_token(parser)->type == newline_token)
+        parser->idx++;
+}
+
+static char *copy_text(const char *text, int start, int end, bool newline)
+{
+    char *copy = malloc(end - start + newline + 1);
+    memcpy(copy, &text[start], end - start);
+    if (newline)
+        copy[end - start] = '\n';
+    copy[end - start + newline] = '\0';
+    return copy;
+}
+
+static ast_node *new_node(ast_node_type type)
+{
+    ast_node *node = malloc(sizeof(ast_node));
+    node->type = type;
+    node->connector = sequence_connector;
+    node->text = NULL;
+    node->text_len = 0;
+    node->compiled = NULL;
+    node->var_name = NULL;
+    node->condition = NULL;
+    node->body = NULL;
+    node->else_part = NULL;
+    node->input_file = NULL;
+    node->output_file = NULL;
+    node->output_append = false;
+    node->next = NULL;
+    return node;
+}
+
+void free_compound_command(ast_node *tree)
+{
+    while (tree) {
+        ast_node *tmp = tree;
+        tree = tree->next;
+        free_compound_command(tmp->condition);
+        free_compound_command(tmp->body);
+        free_compound_command(tmp->else_part);
+        free(tmp->text);
+        free_compiled_command(tmp->compiled);
+        free(tmp->var_name);
+        free(tmp->input_file);
+        free(tmp->output_file);
+        free(tmp);
+    }
+}
+
+static ast_node *parse_command(ast_parser *parser);
+
+static ast_node *parse_list(
+    ast_parser *parser, const char *const *terminators
+)
+{
+    /* the commands joined by `;`, `&`, `&&`, `||` and newlines, up to one of
+    the `terminators` keywords, which is left to the caller */
+    ast_node *first = NULL, **link = &first;
+    list_connector connector = sequence_connector;
+    skip_newlines(parser);
+    while (current_token(parser)->type != end_token &&
+        !current_keyword_in(parser, terminators))
+    {
+        const token *t;
+        ast_node *node = parse_command(parser);
+        if (!node)
+            break;
+        node->connector = connector;
+        *link = node;
+        link = &node->next;
+        connector = sequence_connector;
+        t = current_token(parser);
+        if (t->type == and_token || t->type == or_token) {
+            connector = (t->type == and_token) ? and_connector : or_connector;
+            parser->idx++;
+            skip_newlines(parser);
+            if (current_token(parser)->type == end_token ||
+                current_keyword_in(parser, terminators))
+            {
+                syntax_error(parser);
+                break;
+            }
+        } else
+        if (t->type == semicolon_token || t->type == newline_token) {
+            parser->idx++;
+            skip_newlines(parser);
+        } else
+        if (parser->tokens[parser->idx-1].type != background_token &&
+            t->type != end_token)
+        {
+            syntax_error(parser);
+            break;
+        }
+    }
+    if (!first)
+        syntax_error(parser);
+    if (parser->status != compound_complete) {
+        free_compound_command(first);
+        return NULL;
+    }
+    return first;
+}
+
+static bool token_is(const ast_parser *parser, int idx, const char *text)
+{
+    const token *t = &parser->tokens[idx];
+    int len = t->end - t->start;
+    return (
+        len == (int)strlen(text) &&
+        0 == memcmp(&parser->text[t->start], text, len)
+    );
+}
+
+static bool compound_stage_start(const ast_parser *parser)
+{
+    /* the `|` is followed by a compound command */
+    const char *const *p;
+    if (current_token(parser)->type != pipe_token ||
+        parser->tokens[parser->idx+1].type != word_token)
+    {
+        return false;
+    }
+    for (p = compound_keywords; *p; p++) {
+        if (token_is(parser, parser->idx+1, *p))
+            return true;
+    }
+    return false;
+}
+
+static ast_node *parse_simple_command(ast_parser *parser)
+{
+    /* the tokens up to the end of the command are kept as they are, `|` and
+    the redirections included, unless a compound command follows the `|` */
+    int first_idx = parser->idx;
+    ast_node *node;
+    while (true) {
+        token_type type = current_token(parser)->type;
+        if (type == end_token || type == newline_token ||
+            type == semicolon_token || type == and_token ||
+            type == or_token || compound_stage_start(parser))
+        {
+            break;
+        }
+        parser->idx++;
+        if (type == background_token)
+            break;
+    }
+    if (parser->idx == first_idx) {
+        syntax_error(parser);
+        return NULL;
+    }
+    node = new_node(simple_command_node);
+    node->text = copy_text(
+        parser->text, parser->tokens[first_idx].start,
+        parser->tokens[parser->idx-1].end, true
+    );
+    node->text_len = strlen(node->text);
+    node->compiled = compile_simple_command(node->text, node->text_len);
+    return node;
+}
+
+static ast_node *parse_if(ast_parser *parser, bool closed_with_fi)
+{
+    /* the `if` or the `elif` has been read. The `fi` closes the `elif`
+    parts along with their `if` */
+    ast_node *node = new_node(if_node);
+    node->condition = parse_list(parser, then_keywords);
+    if (node->condition && expect_keyword(parser, "then"))
+        node->body = parse_list(parser, if_body_keywords);
+    if (node->body && current_keyword(parser, "elif")) {
+        parser->idx++;
+        node->else_part = parse_if(parser, false);
+    } else
+    if (node->body && current_keyword(parser, "else")) {
+        parser->idx++;
+        node->else_part = parse_list(parser, fi_keywords);
+    }
+    if (parser->status == compound_complete && closed_with_fi)
+        expect_keyword(parser, "fi");
+    if (parser->status != compound_complete) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static void parse_loop_body(ast_parser *parser, ast_node *node)
+{
+    if (!expect_keyword(parser, "do"))
+        return;
+    node->body = parse_list(parser, done_keywords);
+    if (node->body)
+        expect_keyword(parser, "done");
+}
+
+static ast_node *parse_while(ast_parser *parser, ast_node_type type)
+{
+    /* the `while` or the `until` has been read */
+    ast_node *node = new_node(type);
+    node->condition = parse_list(parser, do_keywords);
+    if (node->condition)
+        parse_loop_body(parser, node);
+    if (parser->status != compound_complete) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static void parse_for_words(ast_parser *parser, ast_node *node)
+{
+    /* the words after the `in` up to the `;` or the newline */
+    int first_idx = parser->idx;
+    const token *t;
+    while (current_token(parser)->type == word_token)
+        parser->idx++;
+    t = current_token(parser);
+    node->text = copy_text(
+        parser->text, parser->tokens[first_idx].start,
+        (parser->idx == first_idx) ? t->start : (t-1)->end, false
+    );
+    node->text_len = strlen(node->text);
+    if (t->type != semicolon_token && t->type != newline_token) {
+        syntax_error(parser);
+        return;
+    }
+    parser->idx++;
+}
+
+static ast_node *parse_for(ast_parser *parser)
+{
+    /* the `for` has been read. Without the `in` part there are no words to
+    go through */
+    ast_node *node = new_node(for_node);
+    const token *t = current_token(parser);
+    if (t->type == word_token)
+        node->var_name = copy_text(parser->text, t->start, t->end, false);
+    if (!node->var_name || !valid_variable_name(node->var_name))
+        syntax_error(parser);
+    else {
+        parser->idx++;
+        skip_newlines(parser);
+        if (current_keyword(parser, "in")) {
+            parser->idx++;
+            parse_for_words(parser, node);
+        } else
+        if (current_token(parser)->type == semicolon_token)
+            parser->idx++;
+    }
+    if (parser->status == compound_complete) {
+        skip_newlines(parser);
+        parse_loop_body(parser, node);
+    }
+    if (parser->status != compound_complete) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static ast_node *parse_group(ast_parser *parser)
+{
+    /* the `{` has been read */
+    ast_node *node = new_node(group_node);
+    node->body = parse_list(parser, close_brace_keywords);
+    if (node->body)
+        expect_keyword(parser, "}");
+    if (parser->status != compound_complete) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static bool function_definition_start(const ast_parser *parser)
+{
+    /* `name ( )` */
+    int idx = parser->idx;
+    return (
+        parser->tokens[idx].type == word_token &&
+        parser->tokens[idx+1].type == other_token &&
+        token_is(parser, idx+1, "(") &&
+        parser->tokens[idx+2].type == other_token &&
+        token_is(parser, idx+2, ")")
+    );
+}
+
+static bool valid_function_name(const char *name)
+{
+    const char *p;
+    if (!*name || !variable_name_character((unsigned char)*name, true))
+        return false;
+    for (p = name; *p; p++) {
+        if (!variable_name_character((unsigned char)*p, false) &&
+            (*p != '-') && (*p != '.'))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static ast_node *parse_function(ast_parser *parser)
+{
+    /* the body of the function is a compound command, usually a group */
+    const token *t = current_token(parser);
+    ast_node *node = new_node(function_node);
+    node->var_name = copy_text(parser->text, t->start, t->end, false);
+    if (!valid_function_name(node->var_name))
+        syntax_error(parser);
+    else {
+        parser->idx += 3;
+        skip_newlines(parser);
+        if (current_keyword_in(parser, compound_keywords))
+            node->body = parse_command(parser);
+        else
+            syntax_error(parser);
+    }
+    if (parser->status != compound_complete) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static bool parse_redirections(ast_parser *parser, ast_node *node)
+{
+    /* a compound command may only be followed by its redirections: it can
+    only be the last command of a pipeline, and can't be run in the
+    background */
+    while (true) {
+        const token *t = current_token(parser);
+        char **file;
+        if (t->type == input_redirection_token)
+            file = &node->input_file;
+        else
+        if (t->type == output_redirection_token ||
+            t->type == output_append_token)
+        {
+            file = &node->output_file;
+            node->output_append = (t->type == output_append_token);
+        } else
+            break;
+        parser->idx++;
+        t = current_token(parser);
+        if (*file || t->type != word_token) {
+            syntax_error(parser);
+            return false;
+        }
+        *file = copy_text(parser->text, t->start, t->end, false);
+        parser->idx++;
+    }
+    switch (current_token(parser)->type) {
+        case (word_token):
+        case (pipe_token):
+        case (background_token):
+        case (other_token):
+            syntax_error(parser);
+            return false;
+        default:
+            return true;
+    }
+}
+
+static ast_node *parse_compound_stage(ast_parser *parser, ast_node *input)
+{
+    /* the compound command after the `|`, the `input` is the simple command
+    before it */
+    ast_node *node = new_node(pipeline_node);
+    node->condition = input;
+    parser->idx++;
+    node->body = parse_command(parser);
+    if (!node->body) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+static ast_node *parse_command(ast_parser *parser)
+{
+    ast_node *node;
+    if (current_keyword(parser, "if")) {
+        parser->idx++;
+        node = parse_if(parser, true);
+    } else
+    if (current_keyword(parser, "while") || current_keyword(parser, "until")) {
+        ast_node_type type =
+            current_keyword(parser, "while") ? while_node : until_node;
+        parser->idx++;
+        node = parse_while(parser, type);
+    } else
+    if (current_keyword(parser, "for")) {
+        parser->idx++;
+        node = parse_for(parser);
+    } else
+    if (current_keyword(parser, "{")) {
+        parser->idx++;
+        node = parse_group(parser);
+    } else
+    if (function_definition_start(parser))
+        return parse_function(parser);
+    else
+    if (current_keyword_in(parser, reserved_words)) {
+        syntax_error(parser);
+        return NULL;
+    } else {
+        node = parse_simple_command(parser);
+        if (node && compound_stage_start(parser))
+            return parse_compound_stage(parser, node);
+        return node;
+    }
+    if (node && !parse_redirections(parser, node)) {
+        free_compound_command(node);
+        return NULL;
+    }
+    return node;
+}
+
+compound_parse_status parse_compound_command(
+    const char *text, ast_node **tree
+)
+{
+    /* the syntax errors are reported here, the `tree` is set only if the
+    whole text has been parsed */
+    ast_parser parser = {
+        NULL, NULL, 0, init_tokens_arr_len, 0, compound_complete
+    };
+    parser.text = text;
+    parser.tokens = malloc(parser.tokens_arr_len * sizeof(token));
+    *tree = NULL;
+    if (tokenize(&parser))
+        *tree = parse_list(&parser, no_keywords);
+    else
+        parser.status = compound_incomplete;
+    free(parser.tokens);
+    return parser.status;
+}
+
+/* The tree is written as bytes by `serialize_compound_command`, node after
+node, and read back by `deserialize_compound_command` without parsing the
+text again. Every node of a list is preceded by a nonzero byte, the list ends
+with a zero one. A string is its length, -1 for NULL, and its characters */
+
+/* bumped with every change of the nodes, of the values of their types and
+connectors, or of their byte layout. The simple commands are kept as their
+text, so the changes of the lexer don't need it */
+#define SERIALIZED_TREE_VERSION "2"
+
+const char *serialized_tree_version()
+{
+    return SERIALIZED_TREE_VERSION;
+}
+
+static void append_bytes(
+    curr_word_dynamic_char_arr *out, const void *data, int len
+)
+{
+    while (out->idx + len > out->arr_len) {
+        out->arr_len *= 2;
+        out->arr = realloc(out->arr, out->arr_len);
+    }
+    memcpy(&out->arr[out->idx], data, len);
+    out->idx += len;
+}
+
+static void serialize_text(
+    curr_word_dynamic_char_arr *out, const char *text, int len
+)
+{
+    int32_t text_len = text ? len : -1;
+    append_bytes(out, &text_len, sizeof(text_len));
+    if (text)
+        append_bytes(out, text, len);
+}
+
+void serialize_compound_command(
+    const ast_node *tree, curr_word_dynamic_char_arr *out
+)
+{
+    const ast_node *node;
+    unsigned char end = 0;
+    for (node = tree; node; node = node->next) {
+        unsigned char fields[4] = {
+            1, node->type, node->connector, node->output_append
+        };
+        append_bytes(out, fields, sizeof(fields));
+        serialize_text(out, node->text, node->text_len);
+        serialize_text(out, node->var_name,
+            node->var_name ? strlen(node->var_name) : 0);
+        serialize_text(out, node->input_file,
+            node->input_file ? strlen(node->input_file) : 0);
+        serialize_text(out, node->output_file,
+            node->output_file ? strlen(node->output_file) : 0);
+        serialize_compound_command(node->condition, out);
+        serialize_compound_command(node->body, out);
+        serialize_compound_command(node->else_part, out);
+    }
+    append_bytes(out, &end, sizeof(end));
+}
+
+typedef struct tag_tree_reader {
+    const char *pos;
+    const char *end;
+    /* cleared once the data turns out to be cut or damaged */
+    bool ok;
+} tree_reader;
+
+static const char *read_bytes(tree_reader *reader, int len)
+{
+    const char *bytes = reader->pos;
+    if (!reader->ok || len < 0 || reader->end - reader->pos < len) {
+        reader->ok = false;
+        return NULL;
+    }
+    reader->pos += len;
+    return bytes;
+}
+
+static char *deserialize_text(tree_reader *reader, int *len)
+{
+    int32_t text_len;
+    const char *bytes = read_bytes(reader, sizeof(text_len));
+    if (!bytes)
+        return NULL;
+    memcpy(&text_len, bytes, sizeof(text_len));
+    if (text_len == -1)
+        return NULL;
+    bytes = read_bytes(reader, text_len);
+    if (!bytes)
+        return NULL;
+    if (len)
+        *len = text_len;
+    return copy_text(bytes, 0, text_len, false);
+}
+
+static ast_node *deserialize_list(tree_reader *reader)
+{
+    ast_node *first = NULL, **link = &first;
+    const unsigned char *fields;
+    while ((fields = (const unsigned char *)read_bytes(reader, 1)) &&
+        fields[0])
+    {
+        ast_node *node;
+        fields = (const unsigned char *)read_bytes(reader, 3);
+        if (!fields || fields[0] > pipeline_node || fields[1] > or_connector)
+        {
+            reader->ok = false;
+            break;
+        }
+        node = new_node(fields[0]);
+        node->connector = fields[1];
+        node->output_append = fields[2];
+        *link = node;
+        link = &node->next;
+        node->text = deserialize_text(reader, &node->text_len);
+        if (node->text && (node->type == simple_command_node))
+            node->compiled =
+                compile_simple_command(node->text, node->text_len);
+        node->var_name = deserialize_text(reader, NULL);
+        node->input_file = deserialize_text(reader, NULL);
+        node->output_file = deserialize_text(reader, NULL);
+        node->condition = deserialize_list(reader);
+        node->body = deserialize_list(reader);
+        node->else_part = deserialize_list(reader);
+    }
+    return first;
+}
+
+bool deserialize_compound_command(const char *data, int len, ast_node **tree)
+{
+    /* returns false, with no `tree`, if the data isn't a whole tree */
+    tree_reader reader = { data, data + len, true };
+    *tree = deserialize_list(&reader);
+    if (reader.ok && reader.pos == reader.end)
+        return true;
+    free_compound_command(*tree);
+    *tree = NULL;
+    return false;
+}
+
+static int open_redirection_file(const char *file_text, int flags)
+{
+    curr_str_words_list words;
+    const char *name;
+    int fd;
+    expand_words(file_text, strlen(file_text), &words);
+    if (!words.first || words.first->next ||
+        words.first->separator_val != none)
+    {
+        fprintf(stderr, ERR_AMBIGUOUS_REDIRECT, file_text);
+        free_list_of_words(&words);
+        return -1;
+    }
+    name = words.first->word;
+    fd = open(name, flags|O_CLOEXEC, 0666);
+    if ((fd == -1) && (errno == ENOENT))
+        fprintf(stderr, ERR_NO_SUCH_FILE, name);
+    else
+        error_handling(fd, __FILE__, __LINE__, "open");
+    free_list_of_words(&words);
+    return fd;
+}
+
+static bool redirect_standard_stream(
+    const char *file_text, int flags, int fd, int *saved_fd
+)
+{
+    int file_fd, res;
+    *saved_fd = -1;
+    if (!file_text)
+        return true;
+    file_fd = open_redirection_file(file_text, flags);
+    if (file_fd == -1)
+        return false;
+    fflush(stdout);
+    *saved_fd = save_standard_stream(fd, true);
+    res = dup2(file_fd, fd);
+    error_handling(res, __FILE__, __LINE__, "dup2");
+    close(file_fd);
+    return true;
+}
+
+static bool loop_interrupted()
+{
+    /* called by a loop once its body or condition has been run, returns
+    true if a `break`, a `continue`, a `return` or an `exit` makes it stop */
+    if (loop_control.type == no_loop_control)
+        return false;
+    if (loop_control.type == return_from_function ||
+        loop_control.type == exit_shell)
+    {
+        return true;
+    }
+    loop_control.count--;
+    if (loop_control.count > 0)
+        /* it's meant for an outer loop */
+        return true;
+    if (loop_control.type == break_loop) {
+        loop_control.type = no_loop_control;
+        return true;
+    }
+    loop_control.type = no_loop_control;
+    return false;
+}
+
+static int run_node(const ast_node *node);
+
+static int run_list(const ast_node *node)
+{
+    /* the first node of a list is joined to the command run before it only
+    by the `run_list_continuation` */
+    int status = last_exit_status();
+    for (; node; node = node->next) {
+        if (node->connector == and_connector && status != 0)
+            continue;
+        if (node->connector == or_connector && status == 0)
+            continue;
+        status = run_node(node);
+        if (loop_control.type != no_loop_control)
+            break;
+    }
+    return status;
+}
+
+static int run_if(const ast_node *node)
+{
+    /* the status is 0 if no branch has been taken */
+    int status = run_list(node->condition);
+    if (loop_control.type != no_loop_control)
+        return status;
+    if (status == 0)
+        return run_list(node->body);
+    return run_list(node->else_part);
+}
+
+static int run_while(const ast_node *node)
+{
+    int status = 0;
+    loop_control.loop_depth++;
+    while (true) {
+        int condition_status = run_list(node->condition);
+        if (loop_interrupted())
+            break;
+        if ((condition_status == 0) != (node->type == while_node))
+            break;
+        status = run_list(node->body);
+        if (loop_interrupted())
+            break;
+    }
+    loop_control.loop_depth--;
+    return status;
+}
+
+static bool run_for_iteration(const ast_node *node, const char *word, int *status)
+{
+    /* returns false if the loop has to stop */
+    assign_variable(node->var_name, word);
+    *status = run_list(node->body);
+    return !loop_interrupted();
+}
+
+static int run_for(const ast_node *node)
+{
+    /* the words are expanded once, before the first iteration. Without the
+    `in` part, the loop goes through the positional parameters */
+    curr_str_words_list words = { NULL, NULL, 1 };
+    positional_parameters params = current_positional_parameters();
+    const word_item *p;
+    int status = 0, i;
+    loop_control.loop_depth++;
+    if (node->text) {
+        expand_words(node->text, node->text_len, &words);
+        for (p = words.first; p; p = p->next) {
+            if (p->separator_val != none)
+                continue;
+            if (!run_for_iteration(node, p->word, &status))
+                break;
+        }
+    } else {
+        for (i = 0; i < params.len; i++) {
+            if (!run_for_iteration(node, params.arr[i], &status))
+                break;
+        }
+    }
+    loop_control.loop_depth--;
+    free_list_of_words(&words);
+    return status;
+}
+
+static void release_function_body(function_body *body)
+{
+    body->refs--;
+    if (body->refs > 0)
+        return;
+    free_compound_command(body->tree);
+    free(body);
+}
+
+static function_item *find_function(const char *name)
+{
+    function_item *item;
+    for (item = functions; item; item = item->next) {
+        if (0 == strcmp(item->name, name))
+            return item;
+    }
+    return NULL;
+}
+
+static char *duplicate_text(const char *text)
+{
+    return text ? copy_text(text, 0, strlen(text), false) : NULL;
+}
+
+static ast_node *copy_tree(const ast_node *node)
+{
+    ast_node *first = NULL, **link = &first;
+    for (; node; node = node->next) {
+        ast_node *copy = malloc(sizeof(ast_node));
+        *copy = *node;
+        copy->text = duplicate_text(node->text);
+        copy->compiled = (node->type == simple_command_node) ?
+            compile_simple_command(copy->text, copy->text_len) : NULL;
+        copy->var_name = duplicate_text(node->var_name);
+        copy->input_file = duplicate_text(node->input_file);
+        copy->output_file = duplicate_text(node->output_file);
+        copy->condition = copy_tree(node->condition);
+        copy->body = copy_tree(node->body);
+        copy->else_part = copy_tree(node->else_part);
+        copy->next = NULL;
+        *link = copy;
+        link = &copy->next;
+    }
+    return first;
+}
+
+static void define_function(const ast_node *node)
+{
+    /* the function keeps its own copy of the tree, the tree of the command
+    line it is defined in is freed once the line has been run */
+    function_item *item = find_function(node->var_name);
+    function_body *body = malloc(sizeof(function_body));
+    body->tree = copy_tree(node->body);
+    body->refs = 1;
+    if (item)
+        release_function_body(item->body);
+    else {
+        item = malloc(sizeof(function_item));
+        item->name = duplicate_text(node->var_name);
+        item->next = functions;
+        functions = item;
+    }
+    item->body = body;
+}
+
+bool function_defined(const char *name)
+{
+    return (name && find_function(name));
+}
+
+int call_function(char **argv)
+{
+    /* the function is run by the current process, the arguments are its
+    positional parameters. Its loops are separate from the caller's ones */
+    function_body *body = find_function(argv[0])->body;
+    positional_parameters args = { &argv[1], 0 }, saved_params;
+    int saved_loop_depth = loop_control.loop_depth, status;
+    while (args.arr[args.len])
+        args.len++;
+    saved_params = replace_positional_parameters(args);
+    body->refs++;
+    loop_control.loop_depth = 0;
+    loop_control.function_depth++;
+    status = run_node(body->tree);
+    if (loop_control.type == return_from_function) {
+        loop_control.type = no_loop_control;
+        status = loop_control.return_status;
+    }
+    loop_control.function_depth--;
+    loop_control.loop_depth = saved_loop_depth;
+    release_function_body(body);
+    replace_positional_parameters(saved_params);
+    return status;
+}
+
+void free_functions()
+{
+    while (functions) {
+        function_item *tmp = functions;
+        functions = functions->next;
+        release_function_body(tmp->body);
+        free(tmp->name);
+        free(tmp);
+    }
+}
+
+static pid_t fork_pipeline_side(int pipe_end, int fd)
+{
+    /* the child has the `pipe_end` as its `fd` */
+    pid_t pid = fork();
+    error_handling(pid, __FILE__, __LINE__, "fork");
+    if (pid == 0) {
+        int res = dup2(pipe_end, fd);
+        error_handling(res, __FILE__, __LINE__, "dup2");
+        close(pipe_end);
+    }
+    return pid;
+}
+
+static int run_compound_pipeline(
+    const ast_node *stage, const ast_node *input_node, string *input_str,
+    curr_word_dynamic_char_arr *output
+)
+{
+    /* the compound command that ends a pipeline is run by a forked copy of
+    the shell, so its `read`, `break` and assignments don't affect the
+    shell, the commands before the `|` by another one. They are given as a
+    simple command node or as the words of a line, whose `output` is read
+    if it's captured. Both children are waited for before the signal handler
+    is turned back on, so it can't reap them */
+    int stage_pipe[2], capture_pipe[2] = { -1, -1 }, res, status = 1;
+    pid_t input_pid, stage_pid = -1;
+    res = pipe2(stage_pipe, O_CLOEXEC);
+    error_handling(res, __FILE__, __LINE__, "pipe2");
+    if (res == -1)
+        return 1;
+    if (output) {
+        res = pipe2(capture_pipe, O_CLOEXEC);
+        error_handling(res, __FILE__, __LINE__, "pipe2");
+    }
+    fflush(stdout);
+    fflush(stderr);
+    suspend_background_zombie_handling();
+    if (res != -1) {
+        input_pid = fork_pipeline_side(stage_pipe[1], 1);
+        if (input_pid == 0) {
+            close(stage_pipe[0]);
+            if (output) {
+                close(capture_pipe[0]);
+                close(capture_pipe[1]);
+            }
+            if (input_str) {
+                input_str->capture = NULL;
+                execute_command(input_str);
+            } else
+                run_node(input_node);
+            fflush(stdout);
+            _exit(last_exit_status());
+        }
+        close(stage_pipe[1]);
+        stage_pid = fork_pipeline_side(stage_pipe[0], 0);
+        if (stage_pid == 0) {
+            if (output) {
+                res = dup2(capture_pipe[1], 1);
+                error_handling(res, __FILE__, __LINE__, "dup2");
+                close(capture_pipe[0]);
+                close(capture_pipe[1]);
+            }
+            status = run_node(stage);
+            fflush(stdout);
+            _exit(status);
+        }
+        close(stage_pipe[0]);
+        if (output) {
+            close(capture_pipe[1]);
+            if (stage_pid != -1)
+                read_captured_output(capture_pipe[0], output);
+            close(capture_pipe[0]);
+        }
+        if (stage_pid != -1)
+            status = wait_for_process(stage_pid);
+        if (input_pid != -1)
+            wait_for_process(input_pid);
+    } else {
+        close(stage_pipe[0]);
+        close(stage_pipe[1]);
+    }
+    resume_background_zombie_handling();
+    return status;
+}
+
+static int run_compound_node(const ast_node *node)
+{
+    switch (node->type) {
+        case (if_node):
+            return run_if(node);
+        case (while_node):
+        case (until_node):
+            return run_while(node);
+        case (for_node):
+            return run_for(node);
+        case (group_node):
+            return run_list(node->body);
+        case (function_node):
+            define_function(node);
+            return 0;
+        case (pipeline_node):
+            return run_compound_pipeline(
+                node->body, node->condition, NULL, NULL
+            );
+        default:
+            return 0;
+    }
+}
+
+static int run_node(const ast_node *node)
+{
+    /* the simple commands are parsed, expanded and executed by the same code
+    as the lines of `stdin`, the ones split into words beforehand are only
+    expanded */
+    int saved_stdin, saved_stdout, status = 1;
+    int output_flags =
+        O_WRONLY|O_CREAT|(node->output_append ? O_APPEND : O_TRUNC);
+    if (node->type == simple_command_node) {
+        if (node->compiled)
+            run_compiled_command(node->compiled);
+        else
+            run_commands_from_text(node->text, node->text_len, NULL);
+        return last_exit_status();
+    }
+    if (redirect_standard_stream(node->input_file, O_RDONLY, 0, &saved_stdin))
+    {
+        if (redirect_standard_stream(
+            node->output_file, output_flags, 1, &saved_stdout))
+        {
+            status = run_compound_node(node);
+            fflush(stdout);
+            restore_standard_stream(saved_stdout, 1);
+        }
+        restore_standard_stream(saved_stdin, 0);
+    }
+    set_last_exit_status(status);
+    return status;
+}
+
+static int capture_compound_command_output(
+    const ast_node *tree, curr_word_dynamic_char_arr *output
+)
+{
+    /* inside `$(...)` the commands are run by a forked copy of the shell
+    with `stdout` writing into a pipe: `read`, `break` and the assignments
+    have to work between them, but mustn't affect the shell */
+    int capture_pipe[2], res, status;
+    pid_t pid;
+    res = pipe2(capture_pipe, O_CLOEXEC);
+    error_handling(res, __FILE__, __LINE__, "pipe2");
+    if (res == -1)
+        return 1;
+    fflush(stdout);
+    fflush(stderr);
+    suspend_background_zombie_handling();
+    pid = fork();
+    error_handling(pid, __FILE__, __LINE__, "fork");
+    if (pid == 0) {
+        res = dup2(capture_pipe[1], 1);
+        error_handling(res, __FILE__, __LINE__, "dup2");
+        close(capture_pipe[0]);
+        close(capture_pipe[1]);
+        status = run_list(tree);
+        fflush(stdout);
+        _exit(status);
+    }
+    close(capture_pipe[1]);
+    if (pid != -1)
+        read_captured_output(capture_pipe[0], output);
+    close(capture_pipe[0]);
+    status = (pid == -1) ? 1 : wait_for_process(pid);
+    resume_background_zombie_handling();
+    return status;
+}
+
+void run_compound_command(
+    const ast_node *tree, curr_word_dynamic_char_arr *capture
+)
+{
+    int status;
+    if (capture)
+        status = capture_compound_command_output(tree, capture);
+    else
+        status = run_list(tree);
+    set_last_exit_status(status);
+}
+
+void run_compound_pipeline_stage(string *str, const ast_node *tree)
+{
+    /* the first node of the `tree` is the stage, the rest of the list is
+    joined to the pipeline */
+    set_last_exit_status(
+        run_compound_pipeline(tree, NULL, str, str->capture)
+    );
+    if (tree->next)
+        run_compound_command(tree->next, str->capture);
+}
+
+void run_list_continuation(
+    ast_node *tree, separator_type separator,
+    curr_word_dynamic_char_arr *capture
+)
+{
+    /* the `tree` is the rest of a line, following the `separator` */
+    if (separator == and_operator)
+        tree->connector = and_connector;
+    else
+    if (separator == or_operator)
+        tree->connector = or_connector;
+    run_compound_command(tree, capture);
+}
+
+static int handle_loop_control_command(char **argv, loop_control_type type)
+{
+    int count = 1;
+    if (argv[1]) {
+        char *end;
+        long res = strtol(argv[1], &end, 10);
+        if (*end || (end == argv[1]) || (res < 1)) {
+            fprintf(stderr, ERR_LOOP_COUNT, argv[0], argv[1]);
+            return 1;
+        }
+        count = (res > loop_control.loop_depth) ?
+            loop_control.loop_depth : res;
+    }
+    if (loop_control.loop_depth == 0) {
+        fprintf(stderr, ERR_ONLY_MEANINGFUL_IN_LOOP, argv[0]);
+        return 0;
+    }
+    loop_control.type = type;
+    loop_control.count = count;
+    return 0;
+}
+
+static int status_argument(char **argv)
+{
+    /* `return [N]` and `exit [N]`, the status is the one of the last
+    command by default */
+    char *end;
+    long res;
+    if (!argv[1])
+        return last_exit_status();
+    res = strtol(argv[1], &end, 10);
+    if (*end || (end == argv[1])) {
+        fprintf(stderr, ERR_NUMERIC_ARGUMENT, argv[0], argv[1]);
+        res = 2;
+    }
+    return res & 0xff;
+}
+
+int handle_return_command(char **argv)
+{
+    int status = status_argument(argv);
+    if (loop_control.function_depth == 0) {
+        fprintf(stderr, ERR_RETURN_OUTSIDE_FUNCTION);
+        return 1;
+    }
+    loop_control.type = return_from_function;
+    loop_control.return_status = status;
+    return status;
+}
+
+int handle_exit_command(char **argv)
+{
+    /* the commands being run are left the way a `return` leaves a function,
+    then the shell stops reading its input */
+    int status = status_argument(argv);
+    loop_control.type = exit_shell;
+    loop_control.return_status = status;
+    return status;
+}
+
+bool shell_exit_requested()
+{
+    return (loop_control.type == exit_shell);
+}
+
+int handle_break_command(char **argv)
+{
+    return handle_loop_control_command(argv, break_loop);
+}
+
+int handle_continue_command(char **argv)
+{
+    return handle_loop_control_command(argv, continue_loop);
+}
+#endif
@@ -0,0 +1,254 @@
+/* cpu_affinity.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "constants.h"
+#include "cpu_affinity.h"
+#include "error_handling.h"
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(EXEC_MODE)
+/* `pin auto|CPU_LIST pipeline` pins the stages of the pipeline to CPUs,
+each one to its own, so the data going through the pipes stays in the
+caches the stages share. The CPU list is like `0,2-5`, its CPUs are given
+to the stages in turn. With `auto`, the CPUs are the ones sharing the
+smallest cache with the CPU the shell runs on that has room for all the
+stages: the L2, then the L3 cache, then the NUMA node */
+
+#define PIN_PREFIX "pin"
+#define AUTO_PLACEMENT "auto"
+#define CACHE_PATH "/sys/devices/system/cpu/cpu%d/cache/index%d/%s"
+#define NODE_CPUS_PATH "/sys/devices/system/node/node%d/cpulist"
+#define ERR_PIN_USAGE "my_shell: pin: usage: pin auto|CPU_LIST command...\n"
+#define ERR_PIN_CPU_LIST "my_shell: pin: %s: invalid CPU list\n"
+
+enum cpu_affinity_file_consts {
+    sysfs_line_len          = 4096,
+    max_cache_indexes       = 16,
+    max_numa_nodes          = 1024
+};
+
+static bool parse_cpu_number(const char **p, int *cpu)
+{
+    long value = 0;
+    if (**p < '0' || **p > '9')
+        return false;
+    for (; **p >= '0' && **p <= '9'; (*p)++) {
+        value = value*10 + (**p - '0');
+        if (value >= max_placement_cpus)
+            return false;
+    }
+    *cpu = value;
+    return true;
+}
+
+static bool parse_cpu_list(const char *text, pipeline_placement *placement)
+{
+    /* the CPUs are taken in the order they are listed */
+    const char *p = text;
+    placement->len = 0;
+    while (true) {
+        int first, last;
+        if (!parse_cpu_number(&p, &first))
+            return false;
+        last = first;
+        if (*p == '-') {
+            p++;
+            if (!parse_cpu_number(&p, &last) || last < first)
+                return false;
+        }
+        for (; first <= last; first++) {
+            if (placement->len == max_placement_cpus)
+                return false;
+            placement->cpus[placement->len] = first;
+            placement->len++;
+        }
+        if (*p != ',')
+            break;
+        p++;
+    }
+    return *p == '\0' || *p == '\n';
+}
+
+static bool read_cpu_list_file(const char *path, pipeline_placement *cpus)
+{
+    char line[sysfs_line_len];
+    FILE *file = fopen(path, "re");
+    bool res;
+    if (!file)
+        return false;
+    res = fgets(line, sizeof(line), file) && parse_cpu_list(line, cpus);
+    fclose(file);
+    return res;
+}
+
+static int read_cache_level(int cpu, int index)
+{
+    char path[sizeof(CACHE_PATH) + 64];
+    FILE *file;
+    int level = -1;
+    snprintf(path, sizeof(path), CACHE_PATH, cpu, index, "level");
+    file = fopen(path, "re");
+    if (!file)
+        return -1;
+    if (fscanf(file, "%d", &level) != 1)
+        level = -1;
+    fclose(file);
+    return level;
+}
+
+static bool contains_cpu(const pipeline_placement *cpus, int cpu)
+{
+    int i;
+    for (i = 0; i < cpus->len; i++) {
+        if (cpus->cpus[i] == cpu)
+            return true;
+    }
+    return false;
+}
+
+static void keep_allowed_cpus(
+    pipeline_placement *cpus, const cpu_set_t *allowed, int first_cpu
+)
+{
+    /* the CPUs the shell may run on, starting from the `first_cpu`, so the
+    stages are next to the shell and to each other */
+    int i, len = 0, start = 0;
+    pipeline_placement tmp = *cpus;
+    for (i = 0; i < tmp.len; i++) {
+        if (tmp.cpus[i] == first_cpu)
+            start = i;
+    }
+    for (i = 0; i < tmp.len; i++) {
+        int cpu = tmp.cpus[(start + i) % tmp.len];
+        if (CPU_ISSET(cpu, allowed))
+            cpus->cpus[len++] = cpu;
+    }
+    cpus->len = len;
+}
+
+static bool choose_cache_group(
+    int cpu, int stages, const cpu_set_t *allowed, pipeline_placement *group
+)
+{
+    /* the caches of a CPU are listed from the smallest to the largest, the
+    first level ones are private to the core */
+    char path[sizeof(CACHE_PATH) + 64];
+    int i, level;
+    for (i = 0; i < max_cache_indexes; i++) {
+        level = read_cache_level(cpu, i);
+        if (level == -1)
+            break;
+        snprintf(path, sizeof(path), CACHE_PATH, cpu, i, "shared_cpu_list");
+        if (level < 2 || !read_cpu_list_file(path, group))
+            continue;
+        keep_allowed_cpus(group, allowed, cpu);
+        if (group->len >= stages)
+            return true;
+    }
+    return false;
+}
+
+static bool choose_numa_node(
+    int cpu, int stages, const cpu_set_t *allowed, pipeline_placement *group
+)
+{
+    char path[sizeof(NODE_CPUS_PATH) + 16];
+    int node;
+    for (node = 0; node < max_numa_nodes; node++) {
+        snprintf(path, sizeof(path), NODE_CPUS_PATH, node);
+        if (!read_cpu_list_file(path, group) || !contains_cpu(group, cpu))
+            continue;
+        keep_allowed_cpus(group, allowed, cpu);
+        return group->len >= stages;
+    }
+    return false;
+}
+
+static void choose_automatic_placement(
+    const execvp_cmd_line *first, const cpu_set_t *allowed,
+    pipeline_placement *placement
+)
+{
+    /* with no group large enough, every allowed CPU is used */
+    int stages = 0, cpu = sched_getcpu(), i;
+    for (; first; first = first->next)
+        stages++;
+    if (cpu != -1 && choose_cache_group(cpu, stages, allowed, placement))
+        return;
+    if (cpu != -1 && choose_numa_node(cpu, stages, allowed, placement))
+        return;
+    placement->len = 0;
+    for (i = 0; i < max_placement_cpus; i++) {
+        if (CPU_ISSET(i, allowed))
+            placement->cpus[placement->len++] = i;
+    }
+    keep_allowed_cpus(placement, allowed, cpu);
+}
+
+static bool cpus_allowed(
+    const pipeline_placement *placement, const cpu_set_t *allowed
+)
+{
+    int i;
+    for (i = 0; i < placement->len; i++) {
+        if (!CPU_ISSET(placement->cpus[i], allowed))
+            return false;
+    }
+    return true;
+}
+
+bool take_pin_prefix(execvp_cmd_line *first, pipeline_placement *placement)
+{
+    /* the `pin` and its argument are taken off the first command. Returns
+    false if they are wrong, after the message is printed */
+    char **argv = first->arr;
+    cpu_set_t allowed;
+    int len = 0;
+    placement->len = 0;
+    if (!argv[0] || 0 != strcmp(argv[0], PIN_PREFIX))
+        return true;
+    if (!argv[1] || !argv[2]) {
+        fprintf(stderr, ERR_PIN_USAGE);
+        return false;
+    }
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == -1) {
+        error_handling(-1, __FILE__, __LINE__, "sched_getaffinity");
+        return false;
+    }
+    if (0 == strcmp(argv[1], AUTO_PLACEMENT)) {
+        choose_automatic_placement(first, &allowed, placement);
+    } else
+    if (!parse_cpu_list(argv[1], placement) ||
+        !cpus_allowed(placement, &allowed))
+    {
+        fprintf(stderr, ERR_PIN_CPU_LIST, argv[1]);
+        placement->len = 0;
+        return false;
+    }
+    while (argv[len])
+        len++;
+    memmove(argv, &argv[2], (len - 1) * sizeof(char*));
+    return true;
+}
+
+void pin_pipeline_stage(const pipeline_placement *placement, int stage)
+{
+    /* runs in the forked child of the stage */
+    cpu_set_t set;
+    int res;
+    if (placement->len == 0)
+        return;
+    CPU_ZERO(&set);
+    CPU_SET(placement->cpus[stage % placement->len], &set);
+    res = sched_setaffinity(0, sizeof(set), &set);
+    error_handling(res, __FILE__, __LINE__, "sched_setaffinity");
+}
+#endif
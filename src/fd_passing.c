@@ -0,0 +1,121 @@
+/* fd_passing.c */
+
+#define _GNU_SOURCE
+#include "error_handling.h"
+#include "fd_passing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/* A request is a single message over a `SOCK_SEQPACKET` socket, the
+`passed_fds_count` fds go in its `SCM_RIGHTS`. The strings of the request
+are packed one after another, each one with its terminating zero */
+
+typedef union tag_passed_fds_control {
+    char buf[CMSG_SPACE(sizeof(int)*passed_fds_count)];
+    struct cmsghdr align;
+} passed_fds_control;
+
+void open_standard_streams()
+{
+    /* the fds received in the requests mustn't get the numbers 0 to 2,
+    which `adopt_passed_fds` dups them onto */
+    int fd;
+    for (fd = 0; fd <= 2; fd++) {
+        if (fcntl(fd, F_GETFD) == -1)
+            open("/dev/null", O_RDWR);
+    }
+}
+
+int pack_string(char *buf, int buf_len, int len, const char *str)
+{
+    /* appends the string to the `len` bytes of the `buf`, returns their new
+    length or -1 if it doesn't fit */
+    int s_len = strlen(str) + 1;
+    if (len + s_len > buf_len)
+        return -1;
+    memcpy(&buf[len], str, s_len);
+    return len + s_len;
+}
+
+int pack_strings(char *buf, int buf_len, int len, char **strs, int *count)
+{
+    for (*count = 0; strs[*count] && (len != -1); (*count)++)
+        len = pack_string(buf, buf_len, len, strs[*count]);
+    return len;
+}
+
+bool send_with_fds(int sock, const char *buf, int len, const int *fds)
+{
+    struct iovec iov = { (char *)buf, len };
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    passed_fds_control control;
+    ssize_t res;
+    memset(&msg, 0, sizeof(msg));
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int)*passed_fds_count);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int)*passed_fds_count);
+    do {
+        res = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while ((res == -1) && (errno == EINTR));
+    return (res == len);
+}
+
+int receive_with_fds(int sock, char *buf, int buf_len, int *fds)
+{
+    /* returns the length of the request, 0 once the other end of the socket
+    has been closed, -1 if the request doesn't carry the fds */
+    struct iovec iov = { buf, buf_len };
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    passed_fds_control control;
+    ssize_t res;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+    do {
+        res = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while ((res == -1) && (errno == EINTR));
+    if (res <= 0)
+        return 0;
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || (cmsg->cmsg_type != SCM_RIGHTS) ||
+        (cmsg->cmsg_len != CMSG_LEN(sizeof(int)*passed_fds_count)))
+    {
+        return -1;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int)*passed_fds_count);
+    return res;
+}
+
+bool adopt_passed_fds(const int *fds)
+{
+    /* the received fds become the standard streams and the working
+    directory of the process, and are closed */
+    int i, res;
+    for (i = 0; i <= 2; i++) {
+        res = dup2(fds[i], i);
+        error_handling(res, __FILE__, __LINE__, "dup2");
+        if (res == -1)
+            return false;
+    }
+    res = fchdir(fds[3]);
+    error_handling(res, __FILE__, __LINE__, "fchdir");
+    for (i = 0; i < passed_fds_count; i++)
+        close(fds[i]);
+    return (res != -1);
+}
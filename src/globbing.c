@@ -0,0 +1,281 @@
+/* globbing.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "constants.h"
+#include "globbing.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+enum globbing_consts {
+    init_names_len          = 4096,
+    init_entries_len        = 64,
+    init_matches_len        = 16
+};
+
+struct tag_directory_listing {
+    /* the directory path the way it's written in the pattern, "" for the
+    current directory */
+    char *path;
+    /* the names of the entries one after another, each ending with '\0' */
+    char *names;
+    int names_len;
+    int *offsets;
+    /* the `d_type` of the entries, tells which ones may be directories */
+    unsigned char *types;
+    int len;
+    struct tag_directory_listing *next;
+};
+
+typedef struct tag_glob_state {
+    /* the path of the match being built */
+    curr_word_dynamic_char_arr path;
+    directory_listing **cache;
+    glob_matches *matches;
+} glob_state;
+
+static void add_entry(
+    directory_listing *listing, const char *name, unsigned char type,
+    int *names_arr_len, int *entries_arr_len
+)
+{
+    int name_len = strlen(name) + 1;
+    while (listing->names_len + name_len > *names_arr_len) {
+        *names_arr_len *= 2;
+        listing->names = realloc(listing->names, *names_arr_len);
+    }
+    if (listing->len == *entries_arr_len) {
+        *entries_arr_len *= 2;
+        listing->offsets =
+            realloc(listing->offsets, *entries_arr_len * sizeof(int));
+        listing->types = realloc(listing->types, *entries_arr_len);
+    }
+    memcpy(&listing->names[listing->names_len], name, name_len);
+    listing->offsets[listing->len] = listing->names_len;
+    listing->types[listing->len] = type;
+    listing->names_len += name_len;
+    listing->len++;
+}
+
+static void read_directory(directory_listing *listing)
+{
+    /* a directory that can't be opened has no entries, so nothing matches
+    inside it */
+    int names_arr_len = init_names_len, entries_arr_len = init_entries_len;
+    const char *path = listing->path[0] ? listing->path : ".";
+    struct dirent *entry;
+    DIR *dir;
+    int fd = openat(AT_FDCWD, path, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+    listing->names = malloc(names_arr_len);
+    listing->offsets = malloc(entries_arr_len * sizeof(int));
+    listing->types = malloc(entries_arr_len);
+    if (fd == -1)
+        return;
+    dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        return;
+    }
+    while ((entry = readdir(dir))) {
+        if (0 == strcmp(entry->d_name, ".") || 0 == strcmp(entry->d_name, ".."))
+            continue;
+        add_entry(
+            listing, entry->d_name, entry->d_type,
+            &names_arr_len, &entries_arr_len
+        );
+    }
+    closedir(dir);
+}
+
+static const directory_listing *get_directory_listing(
+    directory_listing **cache, const char *path
+)
+{
+    /* each directory is read once per command line, however many patterns
+    refer to it */
+    directory_listing *listing;
+    for (listing = *cache; listing; listing = listing->next) {
+        if (0 == strcmp(listing->path, path))
+            return listing;
+    }
+    listing = malloc(sizeof(directory_listing));
+    listing->path = strdup(path);
+    listing->names_len = 0;
+    listing->len = 0;
+    read_directory(listing);
+    listing->next = *cache;
+    *cache = listing;
+    return listing;
+}
+
+void free_directory_cache(directory_listing **cache)
+{
+    while (*cache) {
+        directory_listing *tmp = *cache;
+        *cache = tmp->next;
+        free(tmp->path);
+        free(tmp->names);
+        free(tmp->offsets);
+        free(tmp->types);
+        free(tmp);
+    }
+}
+
+static bool glob_characters(const char *component, int len)
+{
+    /* the pattern characters which aren't escaped by a backslash */
+    int i;
+    for (i = 0; i < len; i++) {
+        if (component[i] == '\\')
+            i++;
+        else
+        if (component[i] == '*' || component[i] == '?' || component[i] == '[')
+            return true;
+    }
+    return false;
+}
+
+static void add_to_path(glob_state *g, const char *text, int len, bool unescape)
+{
+    int i;
+    for (i = 0; i < len; i++) {
+        if (unescape && (text[i] == '\\') && (i+1 < len))
+            i++;
+        if (g->path.idx == g->path.arr_len-1) {
+            g->path.arr_len *= 2;
+            g->path.arr = realloc(g->path.arr, g->path.arr_len);
+        }
+        g->path.arr[g->path.idx] = text[i];
+        g->path.idx++;
+    }
+    g->path.arr[g->path.idx] = '\0';
+}
+
+static void add_match(glob_state *g)
+{
+    glob_matches *matches = g->matches;
+    if (matches->len == matches->arr_len) {
+        matches->arr_len *= 2;
+        matches->arr =
+            realloc(matches->arr, matches->arr_len * sizeof(char*));
+    }
+    matches->arr[matches->len] = strdup(g->path.arr);
+    matches->len++;
+}
+
+static bool path_exists(const char *path)
+{
+    struct stat st;
+    return (0 == fstatat(AT_FDCWD, path, &st, AT_SYMLINK_NOFOLLOW));
+}
+
+static bool may_be_directory(unsigned char type)
+{
+    return (type == DT_DIR || type == DT_LNK || type == DT_UNKNOWN);
+}
+
+static void match_component(glob_state *g, const char *rest);
+
+static void match_entries(
+    glob_state *g, const char *component, const char *rest
+)
+{
+    /* `rest` is the part of the pattern after the `component`, or NULL if
+    it is the last one */
+    int path_len = g->path.idx, i;
+    const directory_listing *listing =
+        get_directory_listing(g->cache, g->path.arr);
+    for (i = 0; i < listing->len; i++) {
+        const char *name = &listing->names[listing->offsets[i]];
+        if (0 != fnmatch(component, name, FNM_PERIOD))
+            continue;
+        if (rest && !may_be_directory(listing->types[i]))
+            continue;
+        g->path.idx = path_len;
+        add_to_path(g, name, strlen(name), false);
+        if (!rest)
+            add_match(g);
+        else {
+            add_to_path(g, "/", 1, false);
+            match_component(g, rest);
+        }
+    }
+    g->path.idx = path_len;
+    g->path.arr[path_len] = '\0';
+}
+
+static void match_component(glob_state *g, const char *rest)
+{
+    /* the `path` is the directory matched so far, ending with a `/` (or
+    empty for the current directory) */
+    const char *slash = strchr(rest, '/');
+    int len = slash ? (slash - rest) : (int)strlen(rest), path_len;
+    char *component;
+    if (!glob_characters(rest, len)) {
+        path_len = g->path.idx;
+        add_to_path(g, rest, len, true);
+        if (slash) {
+            add_to_path(g, "/", 1, false);
+            match_component(g, slash+1);
+        } else
+        if (path_exists(g->path.arr))
+            add_match(g);
+        g->path.idx = path_len;
+        g->path.arr[path_len] = '\0';
+        return;
+    }
+    component = malloc(len + 1);
+    memcpy(component, rest, len);
+    component[len] = '\0';
+    match_entries(g, component, slash ? slash+1 : NULL);
+    free(component);
+}
+
+static int compare_matches(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+void expand_glob_pattern(
+    const char *pattern, directory_listing **cache, glob_matches *matches
+)
+{
+    /* the `pattern` is matched one path component at a time, a backslash
+    escapes the pattern character following it. The matches are sorted */
+    glob_state g = {
+        { NULL, 0, init_tmp_wrd_arr_len }, cache, matches
+    };
+    matches->len = 0;
+    matches->arr_len = init_matches_len;
+    matches->arr = malloc(matches->arr_len * sizeof(char*));
+    g.path.arr = malloc(g.path.arr_len);
+    g.path.arr[0] = '\0';
+    if (pattern[0] == '/') {
+        add_to_path(&g, "/", 1, false);
+        pattern++;
+    }
+    match_component(&g, pattern);
+    free(g.path.arr);
+    qsort(matches->arr, matches->len, sizeof(char*), compare_matches);
+}
+
+void free_glob_matches(glob_matches *matches)
+{
+    int i;
+    for (i = 0; i < matches->len; i++)
+        free(matches->arr[i]);
+    free(matches->arr);
+    matches->arr = NULL;
+    matches->len = 0;
+}
+#endif
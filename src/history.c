@@ -0,0 +1,398 @@
+/* history.c */
+
+#define _GNU_SOURCE
+#include "error_handling.h"
+#include "history.h"
+#include "io_util.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* The history is a file of the command lines, one per line, which the
+shells only append to. Each line is added with a single `write` to the file
+opened with `O_APPEND`, so the lines of several shells running at once never
+interleave. The file is mapped into memory rather than read, so a long
+history costs nothing at startup: the previous entries are found by
+scanning the mapping back from its end, only as far as the user goes.
+
+The search is helped by an index kept next to the history, in the file
+with the `.index` suffix. For every complete block of the history it holds
+a filter, the bitset of the hashes of the two- and three-character
+substrings of the block. A block is scanned only if the filters say it may
+contain all such substrings of the query. The shells index the blocks added
+since the last time at the startup; a filter depends only on its block, so
+the shells writing the same record at once write the same bytes.
+
+Both files are kept open on descriptors above the ones `>&N` may copy, so a
+command can't write into them */
+
+#define HISTORY_FILE_VARIABLE "MY_SHELL_HISTFILE"
+#define DEFAULT_HISTORY_FILE ".my_shell_history"
+#define INDEX_FILE_SUFFIX ".index"
+
+enum history_consts {
+    /* the search looks through a block in windows going back from its end,
+    each one twice as long as the previous one */
+    init_search_window_len  = 4096,
+    index_block_len         = 16384,
+    filter_bits_log2        = 14,
+    filter_len              = (1 << filter_bits_log2) / 8,
+    bigram_marker           = 1 << 24
+};
+
+typedef struct tag_history_file {
+    int fd;
+    const char *map;
+    long map_len;
+    /* the end of the last complete line of the mapping */
+    long end;
+} history_file;
+
+typedef struct tag_history_index {
+    int fd;
+    const unsigned char *map;
+    long blocks;
+} history_index;
+
+static history_file history = { -1, NULL, 0, 0 };
+static history_index index_file = { -1, NULL, 0 };
+
+static char *history_file_path(const char *suffix)
+{
+    return shell_file_path(
+        HISTORY_FILE_VARIABLE, DEFAULT_HISTORY_FILE, suffix
+    );
+}
+
+void init_history()
+{
+    char *path = history_file_path("");
+    if (!path)
+        return;
+    history.fd = move_fd_above_user_range(
+        open(path, O_RDWR|O_CREAT|O_APPEND|O_CLOEXEC, 0600)
+    );
+    free(path);
+    if (history.fd == -1)
+        return;
+    path = history_file_path(INDEX_FILE_SUFFIX);
+    index_file.fd = move_fd_above_user_range(
+        open(path, O_RDWR|O_CREAT|O_CLOEXEC, 0600)
+    );
+    free(path);
+    refresh_history();
+}
+
+static unsigned substring_hash(const char *s, int len)
+{
+    /* of a substring of two or three characters */
+    uint32_t key = (len == 2) ?
+        (bigram_marker | (unsigned char)s[0] << 8 | (unsigned char)s[1]) :
+        ((unsigned char)s[0] << 16 | (unsigned char)s[1] << 8 |
+            (unsigned char)s[2]);
+    return (key * 2654435761u) >> (32 - filter_bits_log2);
+}
+
+static void add_to_filter(unsigned char *filter, unsigned hash)
+{
+    filter[hash / 8] |= 1 << (hash % 8);
+}
+
+static void make_block_filter(long block, unsigned char *filter)
+{
+    /* the substrings starting in the block, the last ones end in the next
+    one */
+    long pos = block*index_block_len, end = pos + index_block_len;
+    memset(filter, 0, filter_len);
+    for (; pos < end && pos+1 < history.end; pos++) {
+        add_to_filter(filter, substring_hash(&history.map[pos], 2));
+        if (pos+2 < history.end)
+            add_to_filter(filter, substring_hash(&history.map[pos], 3));
+    }
+}
+
+static void unmap_index()
+{
+    if (index_file.map)
+        munmap((void *)index_file.map, index_file.blocks*filter_len);
+    index_file.map = NULL;
+    index_file.blocks = 0;
+}
+
+static void update_index()
+{
+    /* indexes the complete blocks of the history added since the last
+    time. The index of a history which has been cut is made anew */
+    long blocks = history.end / index_block_len, indexed;
+    unsigned char *filter;
+    struct stat st;
+    void *map;
+    if (index_file.fd == -1 || fstat(index_file.fd, &st) == -1)
+        return;
+    if (blocks == index_file.blocks)
+        return;
+    unmap_index();
+    indexed = st.st_size / filter_len;
+    if (indexed > blocks) {
+        ftruncate(index_file.fd, 0);
+        indexed = 0;
+    }
+    filter = malloc(filter_len);
+    for (; indexed < blocks; indexed++) {
+        make_block_filter(indexed, filter);
+        if (pwrite(index_file.fd, filter, filter_len, indexed*filter_len) !=
+            filter_len)
+        {
+            break;
+        }
+    }
+    free(filter);
+    if (indexed == 0)
+        return;
+    map = mmap(NULL, indexed*filter_len, PROT_READ, MAP_SHARED,
+        index_file.fd, 0);
+    error_handling(map == MAP_FAILED ? -1 : 0, __FILE__, __LINE__, "mmap");
+    if (map == MAP_FAILED)
+        return;
+    index_file.map = map;
+    index_file.blocks = indexed;
+}
+
+static void unmap_history()
+{
+    if (history.map)
+        munmap((void *)history.map, history.map_len);
+    history.map = NULL;
+    history.map_len = 0;
+    history.end = 0;
+}
+
+void refresh_history()
+{
+    /* maps the file again if it has grown, with the lines appended by this
+    shell or by the others */
+    struct stat st;
+    const char *last_newline;
+    void *map;
+    if (history.fd == -1 || fstat(history.fd, &st) == -1)
+        return;
+    if (st.st_size == history.map_len)
+        return;
+    unmap_history();
+    if (st.st_size > 0) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, history.fd, 0);
+        error_handling(
+            map == MAP_FAILED ? -1 : 0, __FILE__, __LINE__, "mmap"
+        );
+        if (map != MAP_FAILED) {
+            history.map = map;
+            history.map_len = st.st_size;
+            last_newline = memrchr(history.map, '\n', history.map_len);
+            if (last_newline)
+                history.end = last_newline - history.map + 1;
+        }
+    }
+    update_index();
+}
+
+long history_end()
+{
+    return history.end;
+}
+
+static void set_entry(long start, long end, history_entry *entry)
+{
+    entry->arr = &history.map[start];
+    entry->len = end - start;
+    entry->pos = start;
+}
+
+static long line_start(long pos)
+{
+    /* the start of the line the `pos` belongs to */
+    const char *newline = memrchr(history.map, '\n', pos);
+    return newline ? (newline - history.map + 1) : 0;
+}
+
+bool previous_history_entry(long pos, history_entry *entry)
+{
+    /* the entry right before the `pos`, which is the start of an entry or
+    the `history_end` */
+    if (pos <= 0 || pos > history.end)
+        return false;
+    set_entry(line_start(pos-1), pos-1, entry);
+    return true;
+}
+
+bool next_history_entry(long pos, history_entry *entry)
+{
+    /* the entry right after the one starting at the `pos` */
+    const char *newline, *next_newline;
+    if (pos < 0 || pos >= history.end)
+        return false;
+    newline = memchr(&history.map[pos], '\n', history.end - pos);
+    if (!newline || newline - history.map + 1 >= history.end)
+        return false;
+    pos = newline - history.map + 1;
+    next_newline = memchr(&history.map[pos], '\n', history.end - pos);
+    set_entry(pos, next_newline - history.map, entry);
+    return true;
+}
+
+static const char *last_occurrence(
+    const char *query, int query_len, long start, long end
+)
+{
+    const char *found = NULL, *p = &history.map[start];
+    if (query_len == 1)
+        return memrchr(p, query[0], end - start);
+    while ((p = memmem(p, &history.map[end] - p, query, query_len))) {
+        found = p;
+        p++;
+    }
+    return found;
+}
+
+static const char *search_range(
+    const char *query, int query_len, long low, long end
+)
+{
+    /* the last occurrence starting at the `low` or later, and ending before
+    the `end` */
+    long window_len = init_search_window_len;
+    while (end - low >= query_len) {
+        long start = (end - low > window_len) ? end - window_len : low;
+        const char *found = last_occurrence(query, query_len, start, end);
+        if (found)
+            return found;
+        if (start == low)
+            break;
+        /* the windows overlap, an occurrence may cross their border */
+        end = start + query_len - 1;
+        window_len *= 2;
+    }
+    return NULL;
+}
+
+static bool block_may_contain(
+    long block, const unsigned *hashes, int hashes_len
+)
+{
+    /* an occurrence starting in the block may end in the next one, so the
+    filters of both are looked at. The last indexed block is always
+    scanned, the block after it isn't indexed yet */
+    const unsigned char *filter = &index_file.map[block*filter_len];
+    int i;
+    if (block+1 >= index_file.blocks)
+        return true;
+    for (i = 0; i < hashes_len; i++) {
+        unsigned byte = hashes[i] / 8, bit = 1 << (hashes[i] % 8);
+        if (!(filter[byte] & bit) && !(filter[filter_len + byte] & bit))
+            return false;
+    }
+    return true;
+}
+
+static const char *search_indexed_blocks(
+    const char *query, int query_len, long end
+)
+{
+    /* a query of a single character has nothing to look for in the
+    filters, a longer one is looked for by its three-character substrings,
+    or by itself if it's two characters long */
+    int hashes_len = (query_len > 2) ? query_len-2 : query_len-1, i;
+    unsigned *hashes = malloc((hashes_len+1)*sizeof(unsigned));
+    const char *found = NULL;
+    long block;
+    for (i = 0; i < hashes_len; i++)
+        hashes[i] = substring_hash(&query[i], (query_len > 2) ? 3 : 2);
+    for (block = (end-1) / index_block_len; block >= 0 && !found; block--) {
+        long block_end = (block+1)*index_block_len + query_len-1;
+        if (!block_may_contain(block, hashes, hashes_len))
+            continue;
+        found = search_range(
+            query, query_len, block*index_block_len,
+            (block_end < end) ? block_end : end
+        );
+    }
+    free(hashes);
+    return found;
+}
+
+bool search_history(
+    const char *query, int query_len, long pos, history_entry *entry
+)
+{
+    /* the newest entry containing the `query` before the `pos`. A query
+    has no newlines, so it's always found within a single entry */
+    long end = (pos > history.end) ? history.end : pos;
+    long indexed_end = index_file.blocks*index_block_len;
+    const char *found = NULL, *newline;
+    long found_pos;
+    if (query_len == 0)
+        return false;
+    if (end > indexed_end)
+        found = search_range(query, query_len, indexed_end, end);
+    if (!found && end > 0 && indexed_end > 0) {
+        found = search_indexed_blocks(
+            query, query_len, (end < indexed_end) ? end : indexed_end
+        );
+    }
+    if (!found)
+        return false;
+    found_pos = found - history.map;
+    newline = memchr(found, '\n', history.end - found_pos);
+    set_entry(line_start(found_pos), newline - history.map, entry);
+    return true;
+}
+
+static bool blank_line(const char *line, int len)
+{
+    int i;
+    for (i = 0; i < len; i++) {
+        if (line[i] != ' ' && line[i] != '\t')
+            return false;
+    }
+    return true;
+}
+
+void add_history_entry(const char *line, int len)
+{
+    /* a line repeating the newest entry isn't added again */
+    history_entry newest;
+    char *buf;
+    ssize_t res;
+    if (history.fd == -1 || blank_line(line, len))
+        return;
+    refresh_history();
+    if (previous_history_entry(history.end, &newest) &&
+        newest.len == len && 0 == memcmp(newest.arr, line, len))
+    {
+        return;
+    }
+    buf = malloc(len + 1);
+    memcpy(buf, line, len);
+    buf[len] = '\n';
+    res = write(history.fd, buf, len + 1);
+    error_handling(res, __FILE__, __LINE__, "write");
+    free(buf);
+}
+
+void free_history()
+{
+    unmap_history();
+    unmap_index();
+    if (history.fd != -1)
+        close(history.fd);
+    if (index_file.fd != -1)
+        close(index_file.fd);
+    history.fd = -1;
+    index_file.fd = -1;
+}
@@ -0,0 +1,64 @@
+/* io_util.c */
+
+#define _GNU_SOURCE
+#include "constants.h"
+#include "error_handling.h"
+#include "io_util.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+int move_fd_above_user_range(int fd)
+{
+    /* the descriptors the shell keeps open are moved to `saved_fd_min` or
+    above, out of reach of the `>&N` and `<&N` of the commands. The copy is
+    closed on `exec`. Returns it, or -1 with the `fd` closed */
+    int moved_fd;
+    if (fd == -1 || fd >= saved_fd_min)
+        return fd;
+    moved_fd = fcntl(fd, F_DUPFD_CLOEXEC, saved_fd_min);
+    error_handling(moved_fd, __FILE__, __LINE__, "fcntl");
+    close(fd);
+    return moved_fd;
+}
+
+bool write_whole_buffer(int fd, const char *buf, size_t len)
+{
+    /* a write cut short by a signal or by a full pipe is resumed. Returns
+    false, with the `errno` of the failed write, if it isn't written whole */
+    while (len > 0) {
+        ssize_t res = write(fd, buf, len);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res == -1)
+            return false;
+        buf += res;
+        len -= res;
+    }
+    return true;
+}
+
+char *shell_file_path(
+    const char *variable, const char *default_name, const char *suffix
+)
+{
+    /* the file named by the environment `variable`, or the `default_name`
+    one in the home directory, with the `suffix` appended. Returns NULL if
+    neither is set, the path is freed by the caller */
+    const char *path = getenv(variable);
+    const char *home = getenv("HOME");
+    char *res;
+    if (path && *path) {
+        res = malloc(strlen(path) + strlen(suffix) + 1);
+        sprintf(res, "%s%s", path, suffix);
+        return res;
+    }
+    if (!home)
+        return NULL;
+    res = malloc(strlen(home) + strlen(default_name) + strlen(suffix) + 2);
+    sprintf(res, "%s/%s%s", home, default_name, suffix);
+    return res;
+}
@@ -0,0 +1,532 @@
+/* job_log.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "error_handling.h"
+#include "io_util.h"
+#include "job_log.h"
+#include "variables.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* With `set -o joblog`, the `stdout` and `stderr` of a background pipeline
+go into a pipe instead of the terminal. The shell keeps the last bytes read
+from it in a ring buffer of the job, of at most `MY_SHELL_JOBLOG_SIZE`
+bytes (64 KiB by default), read when the job is started; the older bytes are
+dropped. The pipes are non-blocking and are read after every command line
+and while the shell waits for a key of the line editor, so a job only blocks
+if it fills its pipe while the shell is busy with a foreground command.
+
+`joblog` lists the jobs, `joblog %N` prints the log of the job N. A job that
+fails has its log printed to `stderr` once it's done, before the next
+prompt. The logs of the last `max_job_logs` jobs are kept, the log of the
+oldest job done is dropped for a new one */
+
+#define SIZE_VARIABLE "MY_SHELL_JOBLOG_SIZE"
+#define ERR_SIZE_VARIABLE "my_shell: %s: %s: invalid value\n"
+#define ERR_TOO_MANY_JOBS \
+    "my_shell: joblog: %d jobs are being logged, none of them is done\n"
+#define ERR_NO_SUCH_JOB "my_shell: joblog: %s: no such job\n"
+#define ERR_JOBLOG_USAGE "my_shell: joblog: usage: joblog [%%N]\n"
+#define ERR_BYTES_DROPPED \
+    "my_shell: joblog: %%%d: the first %ld bytes have been dropped\n"
+
+enum job_log_consts {
+    max_job_logs        = 32,
+    default_log_size    = 65536,
+    max_log_size        = 1 << 30,
+    init_log_arr_len    = 4096,
+    /* a pipe is read no further than this in one go, so a job writing all
+    the time doesn't keep the shell reading */
+    max_feed_len        = 1048576,
+    read_chunk_len      = 16384,
+    /* the processes reaped before their jobs know their pids */
+    recent_exits_len    = 64,
+    /* the process has been reaped by a wait for any child */
+    unknown_status      = -1
+};
+
+typedef struct tag_job_log {
+    /* 0 for a free slot, the `SIGCHLD` handler reads it */
+    volatile sig_atomic_t number;
+    /* the words of the stages, for the list of the jobs */
+    char *command;
+    /* the read end of the pipe, -1 once the job has closed the write end */
+    int fd;
+    /* the ring buffer of the last bytes, `len` of them from the `start`.
+    The array grows up to the `size`, it wraps around only then */
+    char *arr;
+    long arr_len;
+    long size;
+    long start;
+    long len;
+    long dropped;
+    /* the last stage of the pipeline, its status is set by the `SIGCHLD`
+    handler */
+    volatile pid_t pid;
+    volatile int status;
+    volatile sig_atomic_t exited;
+    /* the failure of the job has been reported */
+    bool reported;
+} job_log;
+
+typedef struct tag_process_exit {
+    pid_t pid;
+    int status;
+} process_exit;
+
+static job_log logs[max_job_logs];
+static int last_job_number = 0;
+static process_exit recent_exits[recent_exits_len];
+static volatile sig_atomic_t recent_exits_idx = 0;
+
+static int shell_exit_status(int wait_status)
+{
+    /* 128 plus the signal number for a process killed by a signal */
+    if (WIFSIGNALED(wait_status))
+        return 128 + WTERMSIG(wait_status);
+    return WEXITSTATUS(wait_status);
+}
+
+void note_background_exit(pid_t pid, int status)
+{
+    /* called by the `SIGCHLD` handler for every process it reaps */
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (logs[i].number && logs[i].pid == pid) {
+            logs[i].status = shell_exit_status(status);
+            logs[i].exited = 1;
+            return;
+        }
+    }
+    recent_exits[recent_exits_idx % recent_exits_len].pid = pid;
+    recent_exits[recent_exits_idx % recent_exits_len].status = status;
+    recent_exits_idx++;
+}
+
+static void block_child_signal(bool block, sigset_t *saved_mask)
+{
+    sigset_t mask;
+    if (!block) {
+        sigprocmask(SIG_SETMASK, saved_mask, NULL);
+        return;
+    }
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &mask, saved_mask);
+}
+
+static bool job_done(const job_log *log)
+{
+    return (log->exited && log->fd == -1);
+}
+
+static job_log *find_job_log(int number)
+{
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (number > 0 && logs[i].number == number)
+            return &logs[i];
+    }
+    return NULL;
+}
+
+static job_log *next_job_log(int number)
+{
+    /* the log of the first job after the `number`, in the order the jobs
+    have been started */
+    job_log *next = NULL;
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (logs[i].number > number &&
+            (!next || logs[i].number < next->number))
+        {
+            next = &logs[i];
+        }
+    }
+    return next;
+}
+
+static void release_job_log(job_log *log)
+{
+    log->number = 0;
+    if (log->fd != -1)
+        close(log->fd);
+    log->fd = -1;
+    free(log->command);
+    log->command = NULL;
+    free(log->arr);
+    log->arr = NULL;
+}
+
+static job_log *take_free_job_log()
+{
+    /* a free slot, or the one of the oldest job done */
+    job_log *oldest = NULL;
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (!logs[i].number)
+            return &logs[i];
+        if (job_done(&logs[i]) && logs[i].reported &&
+            (!oldest || logs[i].number < oldest->number))
+        {
+            oldest = &logs[i];
+        }
+    }
+    if (oldest)
+        release_job_log(oldest);
+    return oldest;
+}
+
+static bool read_log_size(long *size)
+{
+    const char *value = get_variable(SIZE_VARIABLE);
+    char *end;
+    long res;
+    if (!value) {
+        *size = default_log_size;
+        return true;
+    }
+    errno = 0;
+    res = strtol(value, &end, 10);
+    if (!*value || *end || errno || res < 1 || res > max_log_size) {
+        fprintf(stderr, ERR_SIZE_VARIABLE, SIZE_VARIABLE, value);
+        return false;
+    }
+    *size = res;
+    return true;
+}
+
+static char *job_command_text(const execvp_cmd_line *cmdline)
+{
+    /* `sleep 1 | cat &`, the redirections are left out */
+    const execvp_cmd_line *item;
+    char **word, *text;
+    size_t len = sizeof("&");
+    for (item = cmdline; item; item = item->next) {
+        for (word = item->arr; *word; word++)
+            len += strlen(*word) + 1;
+        len += sizeof("| ") - 1;
+    }
+    text = malloc(len);
+    text[0] = '\0';
+    for (item = cmdline; item; item = item->next) {
+        if (item != cmdline)
+            strcat(text, "| ");
+        for (word = item->arr; *word; word++) {
+            strcat(text, *word);
+            strcat(text, " ");
+        }
+    }
+    strcat(text, "&");
+    return text;
+}
+
+int open_job_log(const execvp_cmd_line *cmdline, int *job)
+{
+    /* returns the write end of the pipe of the new job's log, or -1 after
+    the message is printed */
+    int fds[2], res;
+    long size;
+    job_log *log;
+    sigset_t saved_mask;
+    if (!read_log_size(&size))
+        return -1;
+    res = pipe2(fds, O_CLOEXEC);
+    error_handling(res, __FILE__, __LINE__, "pipe2");
+    if (res == -1)
+        return -1;
+    /* above the descriptors `>&N` may copy, so no other command writes
+    into the log */
+    fds[0] = move_fd_above_user_range(fds[0]);
+    if (fds[0] == -1) {
+        close(fds[1]);
+        return -1;
+    }
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    /* fewer stops of the job while the shell runs other commands */
+    fcntl(fds[0], F_SETPIPE_SZ, capture_pipe_len);
+    /* the handler sees the slot either free or filled in */
+    block_child_signal(true, &saved_mask);
+    log = take_free_job_log();
+    if (!log) {
+        block_child_signal(false, &saved_mask);
+        close(fds[0]);
+        close(fds[1]);
+        fprintf(stderr, ERR_TOO_MANY_JOBS, max_job_logs);
+        return -1;
+    }
+    log->command = job_command_text(cmdline);
+    log->fd = fds[0];
+    log->arr = NULL;
+    log->arr_len = 0;
+    log->size = size;
+    log->start = 0;
+    log->len = 0;
+    log->dropped = 0;
+    log->pid = 0;
+    log->status = 0;
+    log->exited = 0;
+    log->reported = false;
+    last_job_number++;
+    log->number = last_job_number;
+    *job = log->number;
+    block_child_signal(false, &saved_mask);
+    return fds[1];
+}
+
+void set_job_log_pid(int job, pid_t pid, int status)
+{
+    /* the pid of the last stage, 0 if the shell hasn't started it, with its
+    `status` then. It may have been reaped already */
+    job_log *log = find_job_log(job);
+    sigset_t saved_mask;
+    int i;
+    if (!log)
+        return;
+    if (pid == 0) {
+        log->status = status;
+        log->exited = 1;
+        return;
+    }
+    block_child_signal(true, &saved_mask);
+    log->pid = pid;
+    for (i = 0; i < recent_exits_len; i++) {
+        if (recent_exits[i].pid == pid) {
+            log->status = shell_exit_status(recent_exits[i].status);
+            log->exited = 1;
+            recent_exits[i].pid = 0;
+        }
+    }
+    block_child_signal(false, &saved_mask);
+}
+
+static void add_to_log(job_log *log, const char *data, long len)
+{
+    long end, first_len;
+    if (len >= log->size) {
+        /* only the end of the data is kept */
+        log->dropped += log->len + len - log->size;
+        data += len - log->size;
+        len = log->size;
+        log->start = 0;
+        log->len = 0;
+    }
+    while (log->arr_len < log->size && log->len + len > log->arr_len) {
+        log->arr_len = log->arr_len ? log->arr_len*2 : init_log_arr_len;
+        if (log->arr_len > log->size)
+            log->arr_len = log->size;
+        log->arr = realloc(log->arr, log->arr_len);
+    }
+    if (log->len + len > log->arr_len) {
+        long drop_len = log->len + len - log->arr_len;
+        log->start = (log->start + drop_len) % log->arr_len;
+        log->len -= drop_len;
+        log->dropped += drop_len;
+    }
+    end = (log->start + log->len) % log->arr_len;
+    first_len = (len < log->arr_len - end) ? len : log->arr_len - end;
+    memcpy(&log->arr[end], data, first_len);
+    memcpy(log->arr, &data[first_len], len - first_len);
+    log->len += len;
+}
+
+static void feed_job_log(job_log *log)
+{
+    char chunk[read_chunk_len];
+    long fed = 0;
+    while (log->fd != -1 && fed < max_feed_len) {
+        ssize_t res = read(log->fd, chunk, sizeof(chunk));
+        if (res > 0) {
+            add_to_log(log, chunk, res);
+            fed += res;
+            continue;
+        }
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if ((res == -1) && (errno == EAGAIN))
+            return;
+        /* all the processes of the job have closed the pipe */
+        close(log->fd);
+        log->fd = -1;
+    }
+}
+
+void feed_job_logs()
+{
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (logs[i].number)
+            feed_job_log(&logs[i]);
+    }
+}
+
+bool job_logs_open()
+{
+    /* some logged job may still write into its pipe */
+    int i;
+    feed_job_logs();
+    for (i = 0; i < max_job_logs; i++) {
+        if (logs[i].number && logs[i].fd != -1)
+            return true;
+    }
+    return false;
+}
+
+static void check_job_exit(job_log *log)
+{
+    /* the process may have been reaped by a wait for any child, as the
+    `batch` does, then its status is unknown */
+    sigset_t saved_mask;
+    int status;
+    pid_t res;
+    if (log->exited || log->fd != -1 || log->pid <= 0)
+        return;
+    block_child_signal(true, &saved_mask);
+    res = waitpid(log->pid, &status, WNOHANG);
+    if (res > 0) {
+        log->status = shell_exit_status(status);
+        log->exited = 1;
+    } else
+    if ((res == -1) && (errno == ECHILD) && !log->exited) {
+        log->status = unknown_status;
+        log->exited = 1;
+    }
+    block_child_signal(false, &saved_mask);
+}
+
+static bool job_failed(const job_log *log)
+{
+    return (job_done(log) && log->status != 0 &&
+        log->status != unknown_status);
+}
+
+static void print_job(const job_log *log, FILE *out)
+{
+    if (!job_done(log))
+        fprintf(out, "[%d] Running\t%s\n", log->number, log->command);
+    else
+    if (job_failed(log))
+        fprintf(out, "[%d] Exit %d\t%s\n",
+            log->number, log->status, log->command);
+    else
+        fprintf(out, "[%d] Done\t%s\n", log->number, log->command);
+}
+
+static void print_job_log(const job_log *log, FILE *out)
+{
+    long first_len;
+    if (log->dropped > 0)
+        fprintf(stderr, ERR_BYTES_DROPPED, log->number, log->dropped);
+    if (log->len == 0)
+        return;
+    first_len = (log->len < log->arr_len - log->start) ?
+        log->len : log->arr_len - log->start;
+    fwrite(&log->arr[log->start], 1, first_len, out);
+    fwrite(log->arr, 1, log->len - first_len, out);
+    fflush(out);
+}
+
+void report_finished_jobs()
+{
+    /* the jobs that have failed since the last time, with their logs */
+    job_log *log;
+    int number = 0;
+    feed_job_logs();
+    while ((log = next_job_log(number))) {
+        number = log->number;
+        check_job_exit(log);
+        if (!job_done(log) || log->reported)
+            continue;
+        log->reported = true;
+        if (job_failed(log)) {
+            fflush(stdout);
+            print_job(log, stderr);
+            print_job_log(log, stderr);
+        }
+    }
+}
+
+void wait_for_input(int fd)
+{
+    /* returns once the `fd` can be read, the logs are fed meanwhile */
+    struct pollfd fds[max_job_logs + 1];
+    while (true) {
+        int len = 1, i, res;
+        fds[0].fd = fd;
+        fds[0].events = POLLIN;
+        for (i = 0; i < max_job_logs; i++) {
+            if (logs[i].number && logs[i].fd != -1) {
+                fds[len].fd = logs[i].fd;
+                fds[len].events = POLLIN;
+                len++;
+            }
+        }
+        if (len == 1)
+            return;
+        res = poll(fds, len, -1);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res == -1)
+            /* the read reports the error */
+            return;
+        for (i = 1; i < len && !fds[i].revents; i++)
+            {}
+        if (i < len)
+            feed_job_logs();
+        if (fds[0].revents)
+            return;
+    }
+}
+
+int handle_joblog_command(char **argv)
+{
+    /* `joblog` lists the jobs, `joblog %N` prints the log of the job N */
+    const job_log *log;
+    char *end;
+    long number;
+    feed_job_logs();
+    if (!argv[1]) {
+        int last = 0;
+        while ((log = next_job_log(last))) {
+            check_job_exit((job_log *)log);
+            print_job(log, stdout);
+            last = log->number;
+        }
+        return 0;
+    }
+    if (argv[2] || argv[1][0] != '%') {
+        fprintf(stderr, ERR_JOBLOG_USAGE);
+        return 2;
+    }
+    number = strtol(&argv[1][1], &end, 10);
+    log = (*end || end == &argv[1][1]) ? NULL : find_job_log(number);
+    if (!log) {
+        fprintf(stderr, ERR_NO_SUCH_JOB, argv[1]);
+        return 1;
+    }
+    print_job_log(log, stdout);
+    return 0;
+}
+
+void free_job_logs()
+{
+    int i;
+    for (i = 0; i < max_job_logs; i++) {
+        if (logs[i].number)
+            release_job_log(&logs[i]);
+    }
+}
+#endif
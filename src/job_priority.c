@@ -0,0 +1,167 @@
+/* job_priority.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "error_handling.h"
+#include "job_priority.h"
+#include "variables.h"
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* With `set -o bgnice`, the background pipelines are started with a lower
+priority, so they don't slow down the commands run in the foreground. The
+children are given the scheduling policy of the `MY_SHELL_BG_SCHED` (batch,
+idle or other), the nice value of the shell increased by the
+`MY_SHELL_BG_NICE` (0 to 19), and the I/O class of the `MY_SHELL_BG_IOPRIO`
+(idle, best-effort, best-effort:LEVEL with the LEVEL from 0 to 7, or none).
+The variables are read at the launch, an unset one has the default value */
+
+#define SCHED_VARIABLE "MY_SHELL_BG_SCHED"
+#define NICE_VARIABLE "MY_SHELL_BG_NICE"
+#define IOPRIO_VARIABLE "MY_SHELL_BG_IOPRIO"
+#define BEST_EFFORT_CLASS "best-effort"
+#define ERR_BG_VARIABLE "my_shell: %s: %s: invalid value\n"
+
+enum job_priority_consts {
+    default_nice_increment  = 10,
+    max_nice_increment      = 19,
+    /* the lowest priority of the best-effort I/O class */
+    default_ioprio_level    = 7,
+    max_ioprio_level        = 7,
+    /* from `linux/ioprio.h` */
+    ioprio_who_process      = 1,
+    ioprio_class_best_effort = 2,
+    ioprio_class_idle       = 3,
+    ioprio_class_shift      = 13
+};
+
+static int ioprio_value(int class, int level)
+{
+    return class << ioprio_class_shift | level;
+}
+
+static bool read_policy(const char *value, int *policy)
+{
+    if (!value || 0 == strcmp(value, "batch"))
+        *policy = SCHED_BATCH;
+    else
+    if (0 == strcmp(value, "idle"))
+        *policy = SCHED_IDLE;
+    else
+    if (0 == strcmp(value, "other"))
+        *policy = SCHED_OTHER;
+    else
+        return false;
+    return true;
+}
+
+static bool read_number(const char *value, int max, int *number)
+{
+    char *end;
+    long res;
+    if (!*value)
+        return false;
+    errno = 0;
+    res = strtol(value, &end, 10);
+    if (*end || errno || res < 0 || res > max)
+        return false;
+    *number = res;
+    return true;
+}
+
+static bool read_nice_increment(const char *value, int *increment)
+{
+    if (!value) {
+        *increment = default_nice_increment;
+        return true;
+    }
+    return read_number(value, max_nice_increment, increment);
+}
+
+static bool read_ioprio(const char *value, int *ioprio)
+{
+    int class_len = sizeof(BEST_EFFORT_CLASS) - 1, level;
+    if (!value) {
+        *ioprio =
+            ioprio_value(ioprio_class_best_effort, default_ioprio_level);
+        return true;
+    }
+    if (0 == strcmp(value, "none")) {
+        *ioprio = 0;
+        return true;
+    }
+    if (0 == strcmp(value, "idle")) {
+        *ioprio = ioprio_value(ioprio_class_idle, 0);
+        return true;
+    }
+    if (0 != strncmp(value, BEST_EFFORT_CLASS, class_len))
+        return false;
+    if (value[class_len] == '\0')
+        level = default_ioprio_level;
+    else
+    if (value[class_len] != ':' ||
+        !read_number(&value[class_len+1], max_ioprio_level, &level))
+    {
+        return false;
+    }
+    *ioprio = ioprio_value(ioprio_class_best_effort, level);
+    return true;
+}
+
+bool read_background_priority(job_priority *priority)
+{
+    /* returns false if a variable has a wrong value, after the message is
+    printed */
+    const char *sched_text = get_variable(SCHED_VARIABLE);
+    const char *nice_text = get_variable(NICE_VARIABLE);
+    const char *ioprio_text = get_variable(IOPRIO_VARIABLE);
+    priority->enabled = false;
+    if (!read_policy(sched_text, &priority->policy)) {
+        fprintf(stderr, ERR_BG_VARIABLE, SCHED_VARIABLE, sched_text);
+        return false;
+    }
+    if (!read_nice_increment(nice_text, &priority->nice_increment)) {
+        fprintf(stderr, ERR_BG_VARIABLE, NICE_VARIABLE, nice_text);
+        return false;
+    }
+    if (!read_ioprio(ioprio_text, &priority->ioprio)) {
+        fprintf(stderr, ERR_BG_VARIABLE, IOPRIO_VARIABLE, ioprio_text);
+        return false;
+    }
+    priority->enabled = true;
+    return true;
+}
+
+void lower_job_priority(const job_priority *priority)
+{
+    /* runs in the forked child, before the `exec` */
+    struct sched_param param = { 0 };
+    int res;
+    if (!priority->enabled)
+        return;
+    if (priority->nice_increment > 0) {
+        errno = 0;
+        res = nice(priority->nice_increment);
+        error_handling(
+            (res == -1 && errno) ? -1 : 0, __FILE__, __LINE__, "nice"
+        );
+    }
+    if (priority->policy != SCHED_OTHER) {
+        res = sched_setscheduler(0, priority->policy, &param);
+        error_handling(res, __FILE__, __LINE__, "sched_setscheduler");
+    }
+    if (priority->ioprio) {
+        res = syscall(SYS_ioprio_set, ioprio_who_process, 0, priority->ioprio);
+        error_handling(res, __FILE__, __LINE__, "ioprio_set");
+    }
+}
+#endif
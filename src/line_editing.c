@@ -0,0 +1,607 @@
+/* line_editing.c */
+
+#define _GNU_SOURCE
+#include "completion.h"
+#include "constants.h"
+#include "history.h"
+#include "io_util.h"
+#include "job_log.h"
+#include "line_editing.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* If both `stdin` and `stdout` are a terminal, the shell reads the command
+lines through a line editor: the terminal is put into the raw mode while a
+line is typed, the line is redrawn after every key, and the finished line is
+handed to the parser character by character. The lines are kept in the
+history, browsed with the arrows and searched with ^R. Tab completes the
+command names and the file paths */
+
+#define PROMPT "> "
+#define SEARCH_PROMPT "(reverse-i-search)`"
+#define FAILED_SEARCH_PROMPT "(failed reverse-i-search)`"
+#define SEARCH_PROMPT_END "': "
+/* the characters the word being completed starts after */
+#define WORD_DELIMITERS " |;&<>()"
+#define COMMAND_SEPARATORS "|;&("
+
+enum line_editing_consts {
+    default_terminal_width  = 80
+};
+
+enum keys {
+    no_key                  = 0,
+    ctrl_a                  = 1,
+    ctrl_b                  = 2,
+    ctrl_c                  = 3,
+    ctrl_d                  = 4,
+    ctrl_e                  = 5,
+    ctrl_f                  = 6,
+    ctrl_g                  = 7,
+    ctrl_h                  = 8,
+    tab_key                 = 9,
+    ctrl_k                  = 11,
+    ctrl_l                  = 12,
+    enter_key               = 13,
+    ctrl_n                  = 14,
+    ctrl_p                  = 16,
+    ctrl_r                  = 18,
+    ctrl_u                  = 21,
+    ctrl_w                  = 23,
+    escape_key              = 27,
+    backspace_key           = 127,
+    /* the escape sequences are translated into the codes above the bytes */
+    arrow_up                = 256,
+    arrow_down,
+    arrow_right,
+    arrow_left,
+    home_key,
+    end_key,
+    delete_key
+};
+
+typedef struct tag_line_editor {
+    curr_word_dynamic_char_arr line;
+    int cursor;
+    const char *prompt;
+    /* the position of the history entry shown, or the `history_end` for
+    the line being typed, which is kept in the `saved_line` meanwhile */
+    long history_pos;
+    curr_word_dynamic_char_arr saved_line;
+} line_editor;
+
+static bool active = false;
+static bool prompt_pending = false;
+static struct termios saved_termios;
+static line_editor editor;
+/* the edited lines not yet read by the parser */
+static curr_word_dynamic_char_arr pending = { NULL, 0, init_tmp_wrd_arr_len };
+static int pending_pos = 0;
+/* the whole redrawn line is written at once */
+static curr_word_dynamic_char_arr output = { NULL, 0, init_tmp_wrd_arr_len };
+
+static void init_dynamic_arr(curr_word_dynamic_char_arr *arr)
+{
+    arr->idx = 0;
+    arr->arr_len = init_tmp_wrd_arr_len;
+    arr->arr = malloc(arr->arr_len);
+}
+
+static void add_data(
+    curr_word_dynamic_char_arr *arr, const char *data, int len
+)
+{
+    while (arr->idx + len > arr->arr_len-1) {
+        arr->arr = realloc(arr->arr, arr->arr_len*2);
+        arr->arr_len *= 2;
+    }
+    memcpy(&arr->arr[arr->idx], data, len);
+    arr->idx += len;
+}
+
+void init_line_editing()
+{
+    const char *term = getenv("TERM");
+    if (!isatty(0) || !isatty(1) || (term && 0 == strcmp(term, "dumb")))
+        return;
+    if (tcgetattr(0, &saved_termios) == -1)
+        return;
+    active = true;
+    init_dynamic_arr(&editor.line);
+    init_dynamic_arr(&editor.saved_line);
+    init_dynamic_arr(&pending);
+    init_dynamic_arr(&output);
+    init_history();
+    init_completion();
+}
+
+bool line_editing_active()
+{
+    return active;
+}
+
+void print_prompt()
+{
+    /* the line editor draws the prompt itself, once the next line is read */
+    if (active) {
+        prompt_pending = true;
+        return;
+    }
+    printf(PROMPT);
+    fflush(stdout);
+}
+
+static void enable_raw_mode()
+{
+    struct termios raw = saved_termios;
+    raw.c_iflag &= ~(BRKINT|ICRNL|INPCK|ISTRIP|IXON);
+    raw.c_cflag |= CS8;
+    /* the output processing stays, so `\n` still moves to the line start */
+    raw.c_lflag &= ~(ECHO|ICANON|IEXTEN|ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(0, TCSADRAIN, &raw);
+}
+
+static void disable_raw_mode()
+{
+    tcsetattr(0, TCSADRAIN, &saved_termios);
+}
+
+static int read_byte()
+{
+    unsigned char c;
+    ssize_t res;
+#if defined(EXEC_MODE)
+    /* the logs of the background jobs are read while the user types */
+    wait_for_input(0);
+#endif
+    do {
+        res = read(0, &c, 1);
+    } while ((res == -1) && (errno == EINTR));
+    return (res == 1) ? c : EOF;
+}
+
+static int read_escape_sequence()
+{
+    /* `ESC [ A`, `ESC O H`, `ESC [ 3 ~` and the like */
+    int c = read_byte();
+    if (c != '[' && c != 'O')
+        return escape_key;
+    c = read_byte();
+    if (c >= '0' && c <= '9') {
+        if (read_byte() != '~')
+            return no_key;
+        switch (c) {
+            case '1': case '7': return home_key;
+            case '4': case '8': return end_key;
+            case '3':           return delete_key;
+        }
+        return no_key;
+    }
+    switch (c) {
+        case 'A': return arrow_up;
+        case 'B': return arrow_down;
+        case 'C': return arrow_right;
+        case 'D': return arrow_left;
+        case 'H': return home_key;
+        case 'F': return end_key;
+    }
+    return no_key;
+}
+
+static int read_key()
+{
+    int c = read_byte();
+    return (c == escape_key) ? read_escape_sequence() : c;
+}
+
+static int terminal_width()
+{
+    struct winsize ws;
+    if (ioctl(1, TIOCGWINSZ, &ws) == -1 || ws.ws_col == 0)
+        return default_terminal_width;
+    return ws.ws_col;
+}
+
+static void write_output()
+{
+    write_whole_buffer(1, output.arr, output.idx);
+    output.idx = 0;
+}
+
+static void draw(
+    const char *prompt, int prompt_len, const char *text, int len,
+    int cursor
+)
+{
+    /* the text is scrolled sideways if it doesn't fit into the line of the
+    terminal, so the cursor stays visible */
+    char move[32];
+    int room = terminal_width() - prompt_len - 1, start = 0, shown;
+    if (room < 1)
+        room = 1;
+    if (cursor > room)
+        start = cursor - room;
+    shown = (len - start < room) ? len - start : room;
+    add_data(&output, "\r", 1);
+    add_data(&output, prompt, prompt_len);
+    add_data(&output, &text[start], shown);
+    /* erase the rest of the old line, then put the cursor in its place */
+    add_data(&output, "\x1b[K\r", 4);
+    if (prompt_len + cursor - start > 0) {
+        sprintf(move, "\x1b[%dC", prompt_len + cursor - start);
+        add_data(&output, move, strlen(move));
+    }
+    write_output();
+}
+
+static void refresh_line()
+{
+    draw(
+        editor.prompt, strlen(editor.prompt), editor.line.arr,
+        editor.line.idx, editor.cursor
+    );
+}
+
+static void set_line(const char *text, int len)
+{
+    editor.line.idx = 0;
+    add_data(&editor.line, text, len);
+    editor.cursor = len;
+}
+
+static void insert_character(char c)
+{
+    add_data(&editor.line, &c, 1);
+    memmove(
+        &editor.line.arr[editor.cursor+1], &editor.line.arr[editor.cursor],
+        editor.line.idx - editor.cursor - 1
+    );
+    editor.line.arr[editor.cursor] = c;
+    editor.cursor++;
+}
+
+static void delete_characters(int from, int to)
+{
+    memmove(
+        &editor.line.arr[from], &editor.line.arr[to], editor.line.idx - to
+    );
+    editor.line.idx -= to - from;
+    if (editor.cursor > to)
+        editor.cursor -= to - from;
+    else
+    if (editor.cursor > from)
+        editor.cursor = from;
+}
+
+static void delete_previous_word()
+{
+    int start = editor.cursor;
+    while (start > 0 && editor.line.arr[start-1] == ' ')
+        start--;
+    while (start > 0 && editor.line.arr[start-1] != ' ')
+        start--;
+    delete_characters(start, editor.cursor);
+}
+
+static void show_previous_history_entry()
+{
+    history_entry entry;
+    if (!previous_history_entry(editor.history_pos, &entry))
+        return;
+    if (editor.history_pos == history_end()) {
+        editor.saved_line.idx = 0;
+        add_data(&editor.saved_line, editor.line.arr, editor.line.idx);
+    }
+    editor.history_pos = entry.pos;
+    set_line(entry.arr, entry.len);
+}
+
+static void show_next_history_entry()
+{
+    history_entry entry;
+    if (editor.history_pos == history_end())
+        return;
+    if (next_history_entry(editor.history_pos, &entry)) {
+        editor.history_pos = entry.pos;
+        set_line(entry.arr, entry.len);
+        return;
+    }
+    editor.history_pos = history_end();
+    set_line(editor.saved_line.arr, editor.saved_line.idx);
+}
+
+static int completed_word_start()
+{
+    int start = editor.cursor;
+    while (start > 0 && !strchr(WORD_DELIMITERS, editor.line.arr[start-1]))
+        start--;
+    return start;
+}
+
+static bool command_name_position(int start)
+{
+    /* only the blanks separate the word from the start of the line, or of
+    a command after a control operator */
+    while (start > 0 && editor.line.arr[start-1] == ' ')
+        start--;
+    return start == 0 || strchr(COMMAND_SEPARATORS, editor.line.arr[start-1]);
+}
+
+static int common_prefix_len(const completion_matches *matches)
+{
+    int len = strlen(matches->arr[0]), i, j;
+    for (i = 1; i < matches->len; i++) {
+        j = 0;
+        while (j < len && matches->arr[i][j] == matches->arr[0][j])
+            j++;
+        len = j;
+    }
+    return len;
+}
+
+static void list_matches(const completion_matches *matches, int shown_from)
+{
+    /* the matches are listed under the line, without the directory part of
+    the word, in rows as wide as the terminal */
+    int width = terminal_width(), column = 0, i;
+    add_data(&output, "\r\n", 2);
+    for (i = 0; i < matches->len; i++) {
+        const char *name = &matches->arr[i][shown_from];
+        int len = strlen(name);
+        if (column > 0 && column + 2 + len > width) {
+            add_data(&output, "\r\n", 2);
+            column = 0;
+        } else
+        if (column > 0) {
+            add_data(&output, "  ", 2);
+            column += 2;
+        }
+        add_data(&output, name, len);
+        column += len;
+    }
+    add_data(&output, "\r\n", 2);
+    write_output();
+}
+
+static void complete_word(bool listing)
+{
+    /* the word is completed as far as all the matches agree, a single
+    match is followed by a space. Tab pressed twice lists the matches */
+    int start = completed_word_start(), len = editor.cursor - start, i;
+    const char *word = &editor.line.arr[start];
+    const char *slash = memrchr(word, '/', len);
+    completion_matches matches = { NULL, 0, 0 };
+    int common, shown_from = slash ? slash - word + 1 : 0;
+    refresh_completion();
+    if (command_name_position(start) && !slash)
+        complete_command_name(word, len, &matches);
+    else
+        complete_file_path(word, len, &matches);
+    if (matches.len == 0) {
+        add_data(&output, "\a", 1);
+        return;
+    }
+    common = common_prefix_len(&matches);
+    if (common > len || matches.len == 1) {
+        delete_characters(start, editor.cursor);
+        for (i = 0; i < common; i++)
+            insert_character(matches.arr[0][i]);
+        if (matches.len == 1 && matches.arr[0][common-1] != '/')
+            insert_character(' ');
+    } else
+    if (listing) {
+        list_matches(&matches, shown_from);
+    }
+    free_completion_matches(&matches);
+}
+
+static void draw_search(
+    const curr_word_dynamic_char_arr *query, bool failed,
+    const history_entry *match
+)
+{
+    curr_word_dynamic_char_arr prompt;
+    const char *start = failed ? FAILED_SEARCH_PROMPT : SEARCH_PROMPT;
+    init_dynamic_arr(&prompt);
+    add_data(&prompt, start, strlen(start));
+    add_data(&prompt, query->arr, query->idx);
+    add_data(&prompt, SEARCH_PROMPT_END, strlen(SEARCH_PROMPT_END));
+    if (match)
+        draw(prompt.arr, prompt.idx, match->arr, match->len, match->len);
+    else
+        draw(prompt.arr, prompt.idx, "", 0, 0);
+    free(prompt.arr);
+}
+
+static int reverse_search()
+{
+    /* ^R: each character typed narrows the search down, starting from the
+    current match, so only the older entries are scanned; ^R again looks
+    for an older match. Returns the key that has ended the search, with the
+    match put into the line, or `no_key` if the search was cancelled */
+    curr_word_dynamic_char_arr query;
+    history_entry match;
+    bool found = false, failed = false;
+    int key;
+    init_dynamic_arr(&query);
+    while (true) {
+        draw_search(&query, failed, found ? &match : NULL);
+        key = read_key();
+        if (key == ctrl_r && found) {
+            failed = !search_history(query.arr, query.idx, match.pos, &match);
+        } else
+        if (key >= ' ' && key < backspace_key) {
+            char c = key;
+            long pos = found ? match.pos + match.len : history_end();
+            add_data(&query, &c, 1);
+            /* a longer query can't be found where the shorter one wasn't */
+            if (!failed) {
+                failed = !search_history(query.arr, query.idx, pos, &match);
+                found = found || !failed;
+            }
+        } else
+        if ((key == backspace_key || key == ctrl_h) && query.idx > 0) {
+            query.idx--;
+            failed = !search_history(
+                query.arr, query.idx, history_end(), &match
+            );
+            found = !failed;
+        } else
+        if (key == ctrl_g || key == ctrl_c) {
+            key = no_key;
+            break;
+        } else
+        if (key != ctrl_r && key != backspace_key && key != ctrl_h) {
+            if (found) {
+                set_line(match.arr, match.len);
+                editor.history_pos = match.pos;
+            }
+            break;
+        }
+    }
+    free(query.arr);
+    return key;
+}
+
+static bool edit_line()
+{
+    /* returns false if `stdin` has ended, or on ^D in an empty line */
+    int prev_key = no_key;
+    editor.line.idx = 0;
+    editor.cursor = 0;
+    editor.history_pos = history_end();
+    refresh_line();
+    while (true) {
+        int key = read_key();
+        if (key == ctrl_r)
+            key = reverse_search();
+        switch (key) {
+            case EOF:
+                return false;
+            case enter_key:
+            case '\n':
+                editor.cursor = editor.line.idx;
+                refresh_line();
+                add_data(&output, "\n", 1);
+                write_output();
+                return true;
+            case ctrl_c:
+                add_data(&output, "^C\n", 3);
+                write_output();
+                editor.line.idx = 0;
+                editor.cursor = 0;
+                editor.history_pos = history_end();
+                break;
+            case ctrl_d:
+                if (editor.line.idx == 0)
+                    return false;
+                /* fall through */
+            case delete_key:
+                if (editor.cursor < editor.line.idx)
+                    delete_characters(editor.cursor, editor.cursor+1);
+                break;
+            case backspace_key:
+            case ctrl_h:
+                if (editor.cursor > 0)
+                    delete_characters(editor.cursor-1, editor.cursor);
+                break;
+            case arrow_left:
+            case ctrl_b:
+                if (editor.cursor > 0)
+                    editor.cursor--;
+                break;
+            case arrow_right:
+            case ctrl_f:
+                if (editor.cursor < editor.line.idx)
+                    editor.cursor++;
+                break;
+            case home_key:
+            case ctrl_a:
+                editor.cursor = 0;
+                break;
+            case end_key:
+            case ctrl_e:
+                editor.cursor = editor.line.idx;
+                break;
+            case ctrl_u:
+                delete_characters(0, editor.cursor);
+                break;
+            case ctrl_k:
+                delete_characters(editor.cursor, editor.line.idx);
+                break;
+            case ctrl_w:
+                delete_previous_word();
+                break;
+            case arrow_up:
+            case ctrl_p:
+                show_previous_history_entry();
+                break;
+            case arrow_down:
+            case ctrl_n:
+                show_next_history_entry();
+                break;
+            case ctrl_l:
+                add_data(&output, "\x1b[H\x1b[2J", 7);
+                break;
+            case tab_key:
+                complete_word(prev_key == tab_key);
+                break;
+            default:
+                if (key >= ' ' && key < 256 && key != backspace_key)
+                    insert_character(key);
+        }
+        refresh_line();
+        prev_key = key;
+    }
+}
+
+static bool read_edited_line()
+{
+    bool line_read;
+    fflush(stdout);
+    editor.prompt = prompt_pending ? PROMPT : "";
+    prompt_pending = false;
+    /* the entries added by the other shells are seen as well */
+    refresh_history();
+    enable_raw_mode();
+    line_read = edit_line();
+    disable_raw_mode();
+    if (!line_read)
+        return false;
+    add_history_entry(editor.line.arr, editor.line.idx);
+    add_data(&pending, editor.line.arr, editor.line.idx);
+    add_data(&pending, "\n", 1);
+    return true;
+}
+
+int read_edited_character()
+{
+    if (pending_pos == pending.idx) {
+        pending.idx = 0;
+        pending_pos = 0;
+        if (!read_edited_line())
+            return EOF;
+    }
+    return (unsigned char)pending.arr[pending_pos++];
+}
+
+void free_line_editing()
+{
+    if (!active)
+        return;
+    free(editor.line.arr);
+    free(editor.saved_line.arr);
+    free(pending.arr);
+    free(output.arr);
+    free_history();
+    free_completion();
+    active = false;
+}
@@ -0,0 +1,242 @@
+/* line_reading.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "constants.h"
+#include "error_handling.h"
+#include "line_reading.h"
+#include "variables.h"
+#include "zombie_handling.h"
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+#define ERR_READ_NOT_VALID_IDENTIFIER \
+    "my_shell: read: `%s': not a valid identifier\n"
+#define ERR_READ_INVALID_OPTION "my_shell: read: %s: invalid option\n"
+
+enum line_reading_consts {
+    stdin_reader_buf_len    = 65536
+};
+
+typedef struct tag_file_identity {
+    dev_t dev;
+    ino_t ino;
+} file_identity;
+
+typedef struct tag_stdin_reader {
+    /* the data read from `stdin` ahead of the lines handed out so far */
+    char buf[stdin_reader_buf_len];
+    int pos;
+    int len;
+    /* the file the data comes from */
+    file_identity file;
+    bool valid;
+    /* for a regular file, the offset of the `buf[0]`. The offset of the file
+    is moved back to the end of the last line handed out, so the commands
+    reading the same file don't miss anything */
+    bool seekable;
+    off_t buf_offset;
+} stdin_reader;
+
+static stdin_reader reader;
+
+/* the file the shell reads its commands from, through the `stdin` stream */
+static file_identity script_input = { 0, 0 };
+
+static bool get_stdin_identity(file_identity *file, bool *seekable)
+{
+    struct stat st;
+    int res = fstat(0, &st);
+    error_handling(res, __FILE__, __LINE__, "fstat");
+    if (res == -1)
+        return false;
+    file->dev = st.st_dev;
+    file->ino = st.st_ino;
+    if (seekable)
+        *seekable = S_ISREG(st.st_mode);
+    return true;
+}
+
+void init_line_reading()
+{
+    get_stdin_identity(&script_input, NULL);
+}
+
+static bool same_file(const file_identity *a, const file_identity *b)
+{
+    return (a->dev == b->dev && a->ino == b->ino);
+}
+
+static void add_data_to_line(
+    curr_word_dynamic_char_arr *line, const char *data, int len
+)
+{
+    while (line->idx + len > line->arr_len-1) {
+        line->arr = realloc(line->arr, line->arr_len*2);
+        line->arr_len *= 2;
+    }
+    memcpy(&line->arr[line->idx], data, len);
+    line->idx += len;
+}
+
+static bool read_line_from_script_input(curr_word_dynamic_char_arr *line)
+{
+    /* the commands coming after the `read` are already in the buffer of the
+    `stdin` stream, so the line is taken from there as well */
+    int c;
+    while (((c=getchar_signal_protected()) != '\n') && (c != EOF)) {
+        char chr = c;
+        add_data_to_line(line, &chr, 1);
+    }
+    return (c == '\n');
+}
+
+static void sync_reader_with_stdin(const file_identity *file, bool seekable)
+{
+    /* the buffered data is dropped if `stdin` is another file now, or if
+    something else has read the file since */
+    off_t offset = seekable ? lseek(0, 0, SEEK_CUR) : 0;
+    if (reader.valid && same_file(&reader.file, file) &&
+        (!seekable || (offset == reader.buf_offset + reader.pos)))
+    {
+        return;
+    }
+    reader.valid = true;
+    reader.file = *file;
+    reader.seekable = seekable;
+    reader.buf_offset = offset;
+    reader.pos = 0;
+    reader.len = 0;
+}
+
+static bool fill_reader()
+{
+    ssize_t res;
+    if (reader.pos < reader.len)
+        return true;
+    reader.buf_offset += reader.len;
+    reader.pos = 0;
+    reader.len = 0;
+    do {
+        res = read(0, reader.buf, sizeof(reader.buf));
+    } while ((res == -1) && (errno == EINTR));
+    error_handling(res, __FILE__, __LINE__, "read");
+    if (res <= 0)
+        return false;
+    reader.len = res;
+    return true;
+}
+
+static bool read_buffered_line(curr_word_dynamic_char_arr *line)
+{
+    bool line_ended = false;
+    while (!line_ended && fill_reader()) {
+        const char *start = &reader.buf[reader.pos];
+        const char *newline = memchr(start, '\n', reader.len - reader.pos);
+        int len = newline ? (newline - start) : (reader.len - reader.pos);
+        add_data_to_line(line, start, len);
+        reader.pos += len + (newline != NULL);
+        line_ended = (newline != NULL);
+    }
+    if (reader.seekable)
+        lseek(0, reader.buf_offset + reader.pos, SEEK_SET);
+    return line_ended;
+}
+
+static bool read_line(curr_word_dynamic_char_arr *line)
+{
+    /* returns false if `stdin` has ended before the newline */
+    file_identity file;
+    bool seekable;
+    if (!get_stdin_identity(&file, &seekable))
+        return false;
+    if (same_file(&file, &script_input))
+        return read_line_from_script_input(line);
+    sync_reader_with_stdin(&file, seekable);
+    return read_buffered_line(line);
+}
+
+static const char *read_field(
+    const char *src, bool rest_of_line, bool raw, char *value
+)
+{
+    /* copies the next field of the line into the `value`, returns the
+    position after it. The last field takes the rest of the line, except
+    for the trailing whitespace */
+    int len = 0, kept_len = 0;
+    while (*src == ' ' || *src == '\t')
+        src++;
+    while (*src) {
+        if (!raw && (src[0] == '\\') && src[1]) {
+            value[len++] = src[1];
+            kept_len = len;
+            src += 2;
+            continue;
+        }
+        if ((*src == ' ' || *src == '\t') && !rest_of_line)
+            break;
+        value[len++] = *src;
+        if (*src != ' ' && *src != '\t')
+            kept_len = len;
+        src++;
+    }
+    value[kept_len] = '\0';
+    return src;
+}
+
+static bool valid_read_arguments(char **names)
+{
+    char **p;
+    for (p = names; *p; p++) {
+        if (!valid_variable_name(*p)) {
+            fprintf(stderr, ERR_READ_NOT_VALID_IDENTIFIER, *p);
+            return false;
+        }
+    }
+    return true;
+}
+
+int handle_read_command(char **argv)
+{
+    /* `read [-r] [NAME]...`, the line is split into fields on whitespace.
+    Returns 1 at the end of `stdin` */
+    static char *default_names[] = { "REPLY", NULL };
+    curr_word_dynamic_char_arr line = { NULL, 0, init_tmp_wrd_arr_len };
+    char **names = &argv[1], **p, *value;
+    const char *src;
+    bool raw = false, line_ended;
+    if (*names && (0 == strcmp(*names, "-r"))) {
+        raw = true;
+        names++;
+    }
+    if (*names && (*names)[0] == '-') {
+        fprintf(stderr, ERR_READ_INVALID_OPTION, *names);
+        return 2;
+    }
+    if (!valid_read_arguments(names))
+        return 1;
+    if (!*names)
+        names = default_names;
+    line.arr = malloc(line.arr_len);
+    line_ended = read_line(&line);
+    line.arr[line.idx] = '\0';
+    value = malloc(line.idx + 1);
+    src = line.arr;
+    for (p = names; *p; p++) {
+        src = read_field(src, !p[1], raw, value);
+        assign_variable(*p, value);
+    }
+    free(value);
+    free(line.arr);
+    return line_ended ? 0 : 1;
+}
+#endif
@@ -4,55 +4,246 @@
 #error Please define either EXEC_MODE or PRINT_TOKENS_MODE
 #endif
 
+#include "aliases.h"
 #include "cmd_execution.h"
+#include "control_flow.h"
 #include "str_parsing.h"
 #include "constants.h"
+#include "job_log.h"
+#include "line_editing.h"
+#include "line_reading.h"
+#include "rc_file.h"
+#include "server.h"
+#include "token_dump.h"
+#include "variables.h"
 #include "zombie_handling.h"
+#include "zygote.h"
 #include <errno.h>
+#include <fcntl.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
+#include <unistd.h>
 
-static void init_str(string *str)
+#define ERR_OPTION_ARGUMENT "my_shell: -c: option requires an argument\n"
+/* set in the environment, it makes the shell start the commands through a
+zygote process */
+#define ZYGOTE_VARIABLE "MY_SHELL_ZYGOTE"
+
+static void add_text_to_script(
+    curr_word_dynamic_char_arr *script, const char *text, int len
+)
+{
+    while (script->idx + len > script->arr_len-1) {
+        script->arr = realloc(script->arr, script->arr_len*2);
+        script->arr_len *= 2;
+    }
+    memcpy(&script->arr[script->idx], text, len);
+    script->idx += len;
+}
+
+static bool read_script_file(
+    const char *path, curr_word_dynamic_char_arr *script
+)
+{
+    char buf[4096];
+    size_t len;
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "my_shell: %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    while ((len = fread(buf, 1, sizeof(buf), file)) > 0)
+        add_text_to_script(script, buf, len);
+    fclose(file);
+    return true;
+}
+
+static int load_script(
+    char **argv, const char *session_text, curr_word_dynamic_char_arr *script
+)
+{
+    /* `my_shell -c text` or `my_shell file`, the whole script is read at
+    once, so the shell knows which command line is the last one. Returns
+    the exit status of the shell if it can't be read. A text given at once
+    is copied into the array of its size */
+    const char *text = session_text;
+    if (!text && 0 == strcmp(argv[1], "-c")) {
+        text = argv[2];
+        if (!text) {
+            fprintf(stderr, ERR_OPTION_ARGUMENT);
+            return 2;
+        }
+    }
+    if (text)
+        script->arr_len = strlen(text) + 2;
+    script->arr = malloc(script->arr_len);
+    if (text)
+        /* the `-c` text, or the command text of a `my_shell --connect`
+        client */
+        add_text_to_script(script, text, strlen(text));
+    else
+    if (!read_script_file(argv[1], script))
+        return 127;
+    if (script->idx == 0 || script->arr[script->idx-1] != '\n')
+        add_text_to_script(script, "\n", 1);
+    return 0;
+}
+
+static bool exit_requested()
+{
+#if defined(EXEC_MODE)
+    return shell_exit_requested();
+#else
+    return false;
+#endif
+}
+
+static int exit_status()
+{
+    /* the status of the last command, or the one given to the `exit` */
+#if defined(EXEC_MODE)
+    return last_exit_status();
+#else
+    return 0;
+#endif
+}
+
+#if defined(EXEC_MODE)
+static bool dump_tokens_option(const char *arg, const char **format)
+{
+    /* `--dump-tokens` or `--dump-tokens=FORMAT` */
+    int len = strlen(DUMP_TOKENS_OPTION);
+    if (0 != strncmp(arg, DUMP_TOKENS_OPTION, len))
+        return false;
+    if (arg[len] != '\0' && arg[len] != '=')
+        return false;
+    *format = (arg[len] == '=') ? &arg[len+1] : NULL;
+    return true;
+}
+
+static int run_token_dump(int argc, char **argv, const char *format)
 {
-    string init_str = {
-        false, false, false, false, 0, no_error,
-        { NULL, 0, init_tmp_wrd_arr_len },
-        { NULL, NULL, 1 },
-        { NULL, NULL, 1, false },
-        { NULL }
-    };
-    init_str.tmp_wrd.arr = malloc(init_str.tmp_wrd.arr_len * sizeof(char));
-    init_str.cmd_line.first = malloc(sizeof(execvp_cmd_line));
-    init_cmd_line_item(init_str.cmd_line.first);
-    init_str.cmd_line.last = init_str.cmd_line.first;
-    *str = init_str;
+    /* `my_shell --dump-tokens[=FORMAT] [file]`: the file, or `stdin`, is
+    read in chunks as it goes rather than at once, so it may be of any
+    size */
+    string str;
+    int fd = 0, last_c = '\n';
+    if (argc > 2 && (fd = open(argv[2], O_RDONLY|O_CLOEXEC)) == -1) {
+        fprintf(stderr, "my_shell: %s: %s\n", argv[2], strerror(errno));
+        return 127;
+    }
+    if (!start_token_dump(format)) {
+        close(fd);
+        return 2;
+    }
+    init_str(&str, NULL, 0);
+    str.input.chunk = malloc(input_chunk_len);
+    str.input.arr = str.input.chunk;
+    str.input.fd = fd;
+    str.tokens_only = true;
+    /* the keywords of the compound commands and the lists aren't
+    recognized either, they are tokens as any other */
+    str.expansion_only = true;
+    while ((str.c=read_next_character(&str)) != EOF) {
+        last_c = str.c;
+        process_character(&str);
+        if (str.str_ended)
+            process_end_of_string(&str);
+    }
+    /* the last line may have no newline at its end */
+    if (last_c != '\n') {
+        str.c = '\n';
+        process_character(&str);
+        process_end_of_string(&str);
+    }
+    free_str_memory(&str);
+    free(str.input.chunk);
+    close(fd);
+    return finish_token_dump() ? 0 : 1;
 }
 
-static void free_memory(string *str)
+static void set_script_arguments(int argc, char **argv)
 {
-    free_list_of_words(&str->words_list);
-    free(str->tmp_wrd.arr);
-    str->tmp_wrd.arr = NULL;
-    free(str->cmd_line.first->arr);
-    free(str->cmd_line.first);
-    str->cmd_line.first = NULL;
-    str->cmd_line.last = NULL;
+    /* `my_shell -c text [name [arg]...]` or `my_shell file [arg]...` */
+    int first = (0 == strcmp(argv[1], "-c")) ? 3 : 1;
+    positional_parameters args;
+    if (first >= argc)
+        return;
+    set_script_name(argv[first]);
+    args.arr = &argv[first+1];
+    args.len = argc - first - 1;
+    replace_positional_parameters(args);
 }
+#endif
 
-int main()
+int main(int argc, char **argv)
 {
     string str;
-    init_str(&str);
+    curr_word_dynamic_char_arr script = { NULL, 0, init_tmp_wrd_arr_len };
+    bool interactive = (argc < 2);
+    const char *session_text = NULL;
+#if defined(EXEC_MODE)
+    const char *dump_format;
+    if (!interactive && dump_tokens_option(argv[1], &dump_format))
+        return run_token_dump(argc, argv, dump_format);
+    /* before anything is allocated, so the zygote stays small */
+    if (getenv(ZYGOTE_VARIABLE))
+        start_zygote();
+    if (!interactive && 0 == strcmp(argv[1], CONNECT_OPTION))
+        return run_client(argv[2], argv[2] ? argv[3] : NULL);
+    if (!interactive && 0 == strcmp(argv[1], SERVER_OPTION)) {
+        /* the server returns only in the session processes it forks */
+        int status;
+        session_text = run_server(argv[2], &status);
+        if (!session_text)
+            return status;
+    }
+#endif
+    if (!interactive) {
+        int status = load_script(argv, session_text, &script);
+        if (status) {
+            free(script.arr);
+            return status;
+        }
+    }
+    init_str(&str, script.arr, script.idx);
+    str.non_interactive = !interactive;
+#if defined(EXEC_MODE)
+    init_variables();
+    if (interactive)
+        init_line_reading();
+    else
+    if (!session_text)
+        set_script_arguments(argc, argv);
+#endif
     set_signal_disposition(SIGCHLD, handle_background_zombie_process);
-    printf("> ");
-    while ((str.c=getchar_signal_protected()) != EOF) {
+#if defined(EXEC_MODE)
+    run_rc_file();
+#endif
+    if (interactive) {
+        init_line_editing();
+        print_prompt();
+    }
+    while (!exit_requested() && (str.c=read_next_character(&str)) != EOF) {
         process_character(&str);
         if (str.str_ended)
             process_end_of_string(&str);
     }
-    free_memory(&str);
-    printf("^D\n");
-    return 0;
+    free_str_memory(&str);
+    free(script.arr);
+    free_line_editing();
+#if defined(EXEC_MODE)
+    free_functions();
+    free_aliases();
+    free_variables();
+    free_pipeline_statuses();
+    free_job_logs();
+    stop_zygote();
+#endif
+    if (interactive && !exit_requested())
+        printf("^D\n");
+    return exit_status();
 }
@@ -0,0 +1,197 @@
+/* parse_library.c */
+
+#if !defined(PARSE_LIBRARY_MODE)
+#error The module is built only into the parsing library, see `make lib`
+#endif
+
+#include "cmd_execution.h"
+#include "cmd_line_building.h"
+#include "my_shell_parse.h"
+#include "str_parsing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "parse_allocation.h"
+
+/* The library is the lexer of `str_parsing.c` built in the token printing
+mode, with the command lines handed by `execute_command` to the user
+instead of being printed. The parser is found by the `string` the lexer
+passes, which is its first member */
+
+struct tag_shell_parser {
+    string str;
+    parse_allocator allocator;
+    bool plan;
+    parsed_line_handler handler;
+    void *data;
+    /* the start of the command line being parsed in the text */
+    int line_start;
+    int errors;
+};
+
+/* the allocator of the parser working in the thread, NULL for the libc one */
+static _Thread_local const parse_allocator *current_allocator = NULL;
+
+/* the names of the libc functions are parenthesized, the macros of the
+`parse_allocation.h` don't replace them then */
+void *parse_realloc(void *ptr, size_t size)
+{
+    if (!current_allocator)
+        return (realloc)(ptr, size);
+    return current_allocator->reallocate(current_allocator->ctx, ptr, size);
+}
+
+void *parse_malloc(size_t size)
+{
+    return parse_realloc(NULL, size);
+}
+
+void parse_free(void *ptr)
+{
+    if (!ptr)
+        return;
+    if (!current_allocator)
+        (free)(ptr);
+    else
+        current_allocator->reallocate(current_allocator->ctx, ptr, 0);
+}
+
+static const parse_allocator *enter_parser(const parse_allocator *allocator)
+{
+    /* returns the allocator to be restored on leaving, the handler of a
+    line may use another parser */
+    const parse_allocator *previous = current_allocator;
+    current_allocator =
+        (allocator && allocator->reallocate) ? allocator : NULL;
+    return previous;
+}
+
+shell_parser *new_shell_parser(const parse_allocator *allocator)
+{
+    const parse_allocator *previous = enter_parser(allocator);
+    shell_parser *parser = malloc(sizeof(shell_parser));
+    init_str(&parser->str, NULL, 0);
+    parser->allocator.reallocate = allocator ? allocator->reallocate : NULL;
+    parser->allocator.ctx = allocator ? allocator->ctx : NULL;
+    parser->plan = false;
+    parser->handler = NULL;
+    parser->data = NULL;
+    parser->line_start = 0;
+    parser->errors = 0;
+    current_allocator = previous;
+    return parser;
+}
+
+void execute_command(string *str)
+{
+    /* the lexer hands every command line here, an empty one too */
+    shell_parser *parser = (shell_parser *)str;
+    const input_buffer *input = &str->input;
+    int end = (input->idx < input->len) ? input->idx : input->len;
+    parsed_line line;
+    line.text = &input->arr[parser->line_start];
+    line.len = end - parser->line_start;
+    parser->line_start = end;
+    line.err = str->err_code;
+    if (line.err == no_error && words_list_is_empty(str))
+        return;
+    if (line.err == no_error && parser->plan)
+        line.err = transform_words_list_into_cmd_line_arr(str);
+    line.words = str->words_list.first;
+    line.stages = NULL;
+    line.stages_len = 0;
+    line.background_execution = false;
+    if (line.err == no_error && parser->plan) {
+        line.stages = str->cmd_line.first;
+        line.stages_len = str->cmd_line.list_len;
+        line.background_execution = str->cmd_line.background_execution;
+    }
+    if (line.err != no_error)
+        parser->errors++;
+    if (parser->handler)
+        parser->handler(&line, parser->data);
+    drop_cmd_line_items_except_first(&str->cmd_line);
+}
+
+int parse_shell_text(
+    shell_parser *parser, const char *text, int len, bool plan,
+    parsed_line_handler handler, void *data
+)
+{
+    /* hands the command lines of the text to the `handler` one by one, and
+    returns the number of those with an error. The plan of the pipelines is
+    made only if asked for, the tokens are enough for the most uses */
+    const parse_allocator *previous = enter_parser(&parser->allocator);
+    string *str = &parser->str;
+    input_buffer input = { text, 0, len, -1, NULL };
+    str->input = input;
+    parser->plan = plan;
+    parser->handler = handler;
+    parser->data = data;
+    parser->line_start = 0;
+    parser->errors = 0;
+    while ((str->c=read_next_character(str)) != EOF) {
+        process_character(str);
+        if (str->str_ended)
+            process_end_of_string(str);
+    }
+    str->input.arr = NULL;
+    current_allocator = previous;
+    return parser->errors;
+}
+
+static void record_first_error(const parsed_line *line, void *data)
+{
+    error_code *err = data;
+    if (*err == no_error)
+        *err = line->err;
+}
+
+error_code validate_shell_line(shell_parser *parser, const char *line, int len)
+{
+    error_code err = no_error;
+    parse_shell_text(parser, line, len, true, record_first_error, &err);
+    return err;
+}
+
+const char *parse_error_message(error_code err)
+{
+    /* the message the shell prints for the error, NULL for no error */
+    switch (err) {
+        case (no_error):
+            return NULL;
+        case (incorrect_char_escaping):
+            return ERR_INCORRECT_CHAR_ESCAPING;
+        case (background_operator_not_in_the_end_of_str):
+            return ERR_BACKGROUND_OPERATOR_IN_THE_END_OF_STR;
+        case (separator_right_after_input_or_output_redirection):
+            return ERR_SEPARATOR_AFTER_IO_REDIRECTION;
+        case (second_simple_word_right_after_input_or_output_redirecton):
+            return ERR_2ND_FILE_NAME_AFTER_IO_REDIRECTION;
+        case (input_or_output_separator_used_in_line_twice):
+            return ERR_IO_REDIRECTION_USED_TWICE;
+        case (pipe_operator_at_start_of_str):
+            return ERR_PIPE_OPERATOR_MISUSE;
+        case (unclosed_command_substitution):
+            return ERR_UNCLOSED_COMMAND_SUBSTITUTION;
+        case (bad_substitution):
+            return ERR_BAD_SUBSTITUTION;
+        case (arithmetic_error):
+            /* the arithmetic isn't evaluated by the parser */
+            return NULL;
+        case (not_implemented_feature):
+            return ERR_NOT_IMPLEMENTED_FEATURE;
+        case (unmatched_quotes):
+            return ERR_UNMATCHED_QUOTES;
+        case (bad_fd_duplication_target):
+            return ERR_FD_DUPLICATION_TARGET;
+    }
+    return NULL;
+}
+
+void free_shell_parser(shell_parser *parser)
+{
+    const parse_allocator *previous = enter_parser(&parser->allocator);
+    free_str_memory(&parser->str);
+    free(parser);
+    current_allocator = previous;
+}
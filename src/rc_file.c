@@ -0,0 +1,197 @@
+/* rc_file.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "control_flow.h"
+#include "io_util.h"
+#include "rc_file.h"
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* The rc file, `~/.my_shellrc` or the one of the `MY_SHELL_RC`, is run by
+every shell before its first command, so it's a place for the aliases, the
+functions and the `set -o` options. The file is mapped into memory and
+parsed as a whole into the tree of a compound command, then run the way the
+body of a function is, with the simple commands expanded as they're run.
+
+The tree is cached in the file with the `.cache` suffix next to the rc
+file, along with the format version of the tree and the identity of the
+rc file: its inode, size and modification time. A shell of the same format
+version finding the rc file unchanged reads the tree from the cache and
+doesn't parse the text. The cache is written to a temporary
+file renamed over it, so a shell starting at the same time reads either the
+old cache or the new one. A cache that can't be written is no error */
+
+#define RC_FILE_VARIABLE "MY_SHELL_RC"
+#define DEFAULT_RC_FILE ".my_shellrc"
+#define CACHE_FILE_SUFFIX ".cache"
+#define TMP_FILE_SUFFIX ".XXXXXX"
+#define RC_CACHE_MAGIC "MYSHRC2"
+#define ERR_RC_UNEXPECTED_EOF \
+    "my_shell: %s: syntax error: unexpected end of file\n"
+
+typedef struct tag_rc_cache_header {
+    char magic[8];
+    /* the format version of the tree */
+    char version[32];
+    /* the rc file the tree has been parsed from */
+    uint64_t dev;
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+} rc_cache_header;
+
+static char *rc_file_path(const char *suffix)
+{
+    return shell_file_path(RC_FILE_VARIABLE, DEFAULT_RC_FILE, suffix);
+}
+
+static void make_cache_header(const struct stat *st, rc_cache_header *header)
+{
+    /* zeroed first, so the padding is the same in every header */
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, RC_CACHE_MAGIC, sizeof(RC_CACHE_MAGIC));
+    strncpy(
+        header->version, serialized_tree_version(), sizeof(header->version) - 1
+    );
+    header->dev = st->st_dev;
+    header->ino = st->st_ino;
+    header->size = st->st_size;
+    header->mtime_sec = st->st_mtim.tv_sec;
+    header->mtime_nsec = st->st_mtim.tv_nsec;
+}
+
+static ast_node *read_rc_cache(const char *cache_path, const struct stat *st)
+{
+    /* returns NULL if there is no cache of the rc file as it is now */
+    rc_cache_header header;
+    struct stat cache_st;
+    ast_node *tree = NULL;
+    const char *map;
+    int fd = open(cache_path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1)
+        return NULL;
+    if (fstat(fd, &cache_st) == -1 ||
+        cache_st.st_size <= (off_t)sizeof(rc_cache_header))
+    {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, cache_st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+    make_cache_header(st, &header);
+    if (0 == memcmp(map, &header, sizeof(header))) {
+        deserialize_compound_command(
+            map + sizeof(header), cache_st.st_size - sizeof(header), &tree
+        );
+    }
+    munmap((void *)map, cache_st.st_size);
+    return tree;
+}
+
+static void write_rc_cache(
+    const char *cache_path, const struct stat *st, const ast_node *tree
+)
+{
+    curr_word_dynamic_char_arr data = { NULL, 0, sizeof(rc_cache_header) };
+    rc_cache_header header;
+    char *tmp_path = malloc(strlen(cache_path) + sizeof(TMP_FILE_SUFFIX));
+    int fd;
+    sprintf(tmp_path, "%s%s", cache_path, TMP_FILE_SUFFIX);
+    fd = mkostemp(tmp_path, O_CLOEXEC);
+    if (fd == -1) {
+        free(tmp_path);
+        return;
+    }
+    make_cache_header(st, &header);
+    data.arr = malloc(data.arr_len);
+    memcpy(data.arr, &header, sizeof(header));
+    data.idx = sizeof(header);
+    serialize_compound_command(tree, &data);
+    if (!write_whole_buffer(fd, data.arr, data.idx) || close(fd) == -1 ||
+        rename(tmp_path, cache_path) == -1)
+    {
+        unlink(tmp_path);
+    }
+    free(data.arr);
+    free(tmp_path);
+}
+
+static ast_node *parse_rc_file(int fd, const struct stat *st, const char *path)
+{
+    /* the parser needs the text to end with '\0', which the mapping has
+    after the end of the file unless the file fills its last page */
+    ast_node *tree = NULL;
+    compound_parse_status status;
+    const char *text;
+    char *copy = NULL;
+    void *map = mmap(NULL, st->st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        perror(path);
+        return NULL;
+    }
+    text = map;
+    if (st->st_size % sysconf(_SC_PAGESIZE) == 0) {
+        copy = malloc(st->st_size + 1);
+        memcpy(copy, map, st->st_size);
+        copy[st->st_size] = '\0';
+        text = copy;
+    }
+    /* a blank text isn't parsed, it's no command rather than an incomplete
+    one */
+    status = (text[strspn(text, " \t\n")] == '\0') ?
+        compound_complete : parse_compound_command(text, &tree);
+    if (status == compound_incomplete)
+        fprintf(stderr, ERR_RC_UNEXPECTED_EOF, path);
+    free(copy);
+    munmap(map, st->st_size);
+    return tree;
+}
+
+void run_rc_file()
+{
+    /* an rc file that doesn't exist is no error */
+    char *path = rc_file_path(""), *cache_path;
+    struct stat st;
+    ast_node *tree;
+    int fd;
+    if (!path)
+        return;
+    fd = open(path, O_RDONLY|O_CLOEXEC);
+    if (fd == -1 || fstat(fd, &st) == -1 || st.st_size == 0) {
+        if (fd != -1)
+            close(fd);
+        free(path);
+        return;
+    }
+    cache_path = rc_file_path(CACHE_FILE_SUFFIX);
+    tree = read_rc_cache(cache_path, &st);
+    if (!tree) {
+        tree = parse_rc_file(fd, &st, path);
+        if (tree)
+            write_rc_cache(cache_path, &st, tree);
+    }
+    close(fd);
+    free(cache_path);
+    free(path);
+    if (tree) {
+        run_compound_command(tree, NULL);
+        free_compound_command(tree);
+    }
+}
+#endif
@@ -0,0 +1,362 @@
+/* server.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "constants.h"
+#include "error_handling.h"
+#include "fd_passing.h"
+#include "server.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* `my_shell --server PATH` listens on a Unix socket and forks a session
+process for every client. A session is the shell running the command text
+of the client as `my_shell -c` would, with the client's standard streams,
+working directory and environment. Once it exits, the server sends its exit
+status back to the client. `my_shell --connect PATH TEXT` is such a client.
+
+The protocol, over a `SOCK_SEQPACKET` socket: the client sends one message,
+a `session_request_header`, the command text and the environment strings,
+each one with its terminating zero. The message carries `stdin`, `stdout`,
+`stderr` and an fd of the working directory in the `SCM_RIGHTS`. The
+server replies with the exit status as an `int` */
+
+#define ERR_OPTION_ARGUMENT "my_shell: %s: option requires an argument\n"
+#define ERR_SOCKET "my_shell: %s: %s\n"
+#define ERR_REQUEST_TOO_LONG "my_shell: %s: the request is too long\n"
+#define ERR_BAD_REQUEST "my_shell: %s: a malformed request\n"
+
+enum server_consts {
+    /* the largest request, the text and the environment together */
+    session_request_len     = 65536,
+    session_env_max         = 4096,
+    listen_backlog          = 128,
+    init_sessions_arr_len   = 16
+};
+
+typedef struct tag_session_request_header {
+    int envc;
+} session_request_header;
+
+typedef struct tag_session_item {
+    pid_t pid;
+    /* the connection the exit status is sent into */
+    int fd;
+} session_item;
+
+typedef struct tag_sessions_list {
+    session_item *arr;
+    int len;
+    int arr_len;
+} sessions_list;
+
+static char request[session_request_len];
+/* the session's environment, `init_variables` copies it */
+static char *session_env[session_env_max+1];
+
+static bool make_socket_address(const char *path, struct sockaddr_un *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path)) {
+        fprintf(stderr, ERR_SOCKET, path, strerror(ENAMETOOLONG));
+        return false;
+    }
+    strcpy(addr->sun_path, path);
+    return true;
+}
+
+static int open_listening_socket(const char *path)
+{
+    /* a socket left by a server that was killed is replaced */
+    struct sockaddr_un addr;
+    struct stat st;
+    int fd, res;
+    if (!make_socket_address(path, &addr))
+        return -1;
+    if ((0 == lstat(path, &st)) && S_ISSOCK(st.st_mode))
+        unlink(path);
+    fd = socket(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0);
+    error_handling(fd, __FILE__, __LINE__, "socket");
+    if (fd == -1)
+        return -1;
+    res = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (res == 0)
+        res = listen(fd, listen_backlog);
+    if (res == -1) {
+        fprintf(stderr, ERR_SOCKET, path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static const char *unpack_request(int len)
+{
+    /* returns the command text, the `environ` is set to the environment of
+    the request. Returns NULL if the request is malformed */
+    session_request_header header;
+    char *text = &request[sizeof(header)], *p, *end = &request[len];
+    int i;
+    if (len <= (int)sizeof(header) || request[len-1] != '\0')
+        return NULL;
+    memcpy(&header, request, sizeof(header));
+    if (header.envc < 0 || header.envc > session_env_max)
+        return NULL;
+    p = text + strlen(text) + 1;
+    for (i = 0; i < header.envc; i++) {
+        if (p >= end)
+            return NULL;
+        session_env[i] = p;
+        p += strlen(p) + 1;
+    }
+    session_env[header.envc] = NULL;
+    environ = session_env;
+    return text;
+}
+
+static const char *start_session(int connection)
+{
+    /* runs in the forked session process, returns the command text */
+    int fds[passed_fds_count];
+    const char *text = NULL;
+    int len = receive_with_fds(connection, request, sizeof(request), fds);
+    if (len > 0) {
+        text = unpack_request(len);
+        if (!adopt_passed_fds(fds))
+            text = NULL;
+    }
+    close(connection);
+    if (!text) {
+        fprintf(stderr, ERR_BAD_REQUEST, SERVER_OPTION);
+        _exit(2);
+    }
+    return text;
+}
+
+static void add_session(sessions_list *sessions, pid_t pid, int fd)
+{
+    if (sessions->len == sessions->arr_len) {
+        sessions->arr_len *= 2;
+        sessions->arr = realloc(
+            sessions->arr, sessions->arr_len*sizeof(session_item)
+        );
+    }
+    sessions->arr[sessions->len].pid = pid;
+    sessions->arr[sessions->len].fd = fd;
+    sessions->len++;
+}
+
+static void report_session_status(sessions_list *sessions, pid_t pid, int st)
+{
+    /* the status is reported the way the shell reports it for commands */
+    int i, status = WIFSIGNALED(st) ? 128 + WTERMSIG(st) : WEXITSTATUS(st);
+    for (i = 0; i < sessions->len; i++) {
+        if (sessions->arr[i].pid != pid)
+            continue;
+        send(sessions->arr[i].fd, &status, sizeof(status), MSG_NOSIGNAL);
+        close(sessions->arr[i].fd);
+        sessions->arr[i] = sessions->arr[sessions->len-1];
+        sessions->len--;
+        return;
+    }
+}
+
+static void reap_sessions(sessions_list *sessions)
+{
+    pid_t pid;
+    int status;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+        report_session_status(sessions, pid, status);
+}
+
+static bool handle_signals(int signal_fd, sessions_list *sessions)
+{
+    /* returns false once the server is asked to terminate */
+    struct signalfd_siginfo info;
+    bool terminate = false;
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+        if (info.ssi_signo != SIGCHLD)
+            terminate = true;
+    }
+    reap_sessions(sessions);
+    return !terminate;
+}
+
+static void close_sessions(sessions_list *sessions)
+{
+    /* the clients of the running sessions get EOF instead of the status */
+    int i;
+    for (i = 0; i < sessions->len; i++)
+        close(sessions->arr[i].fd);
+    free(sessions->arr);
+}
+
+static const char *accept_client(
+    int listen_fd, int signal_fd, const sigset_t *saved_mask,
+    sessions_list *sessions
+)
+{
+    /* returns the command text in the forked session process, NULL in the
+    server */
+    int connection = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+    pid_t pid;
+    if (connection == -1)
+        return NULL;
+    pid = fork();
+    error_handling(pid, __FILE__, __LINE__, "fork");
+    if (pid == 0) {
+        close(listen_fd);
+        close(signal_fd);
+        close_sessions(sessions);
+        sigprocmask(SIG_SETMASK, saved_mask, NULL);
+        return start_session(connection);
+    }
+    if (pid == -1) {
+        close(connection);
+        return NULL;
+    }
+    add_session(sessions, pid, connection);
+    return NULL;
+}
+
+const char *run_server(const char *path, int *exit_status)
+{
+    /* returns only in the session processes, with the command text of the
+    client, or if the server terminates, with NULL */
+    sessions_list sessions = { NULL, 0, init_sessions_arr_len };
+    struct pollfd pfds[2];
+    sigset_t mask, saved_mask;
+    const char *text = NULL;
+    *exit_status = 1;
+    if (!path) {
+        fprintf(stderr, ERR_OPTION_ARGUMENT, SERVER_OPTION);
+        *exit_status = 2;
+        return NULL;
+    }
+    open_standard_streams();
+    pfds[0].fd = open_listening_socket(path);
+    if (pfds[0].fd == -1)
+        return NULL;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &mask, &saved_mask);
+    pfds[1].fd = signalfd(-1, &mask, SFD_NONBLOCK|SFD_CLOEXEC);
+    error_handling(pfds[1].fd, __FILE__, __LINE__, "signalfd");
+    pfds[0].events = POLLIN;
+    pfds[1].events = POLLIN;
+    sessions.arr = malloc(sessions.arr_len*sizeof(session_item));
+    while (pfds[1].fd != -1) {
+        int res = poll(pfds, 2, -1);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        error_handling(res, __FILE__, __LINE__, "poll");
+        if (res == -1)
+            break;
+        if (pfds[1].revents & POLLIN) {
+            if (!handle_signals(pfds[1].fd, &sessions)) {
+                *exit_status = 0;
+                break;
+            }
+        }
+        if (pfds[0].revents & POLLIN) {
+            text = accept_client(
+                pfds[0].fd, pfds[1].fd, &saved_mask, &sessions
+            );
+            if (text)
+                return text;
+        }
+    }
+    close_sessions(&sessions);
+    close(pfds[0].fd);
+    if (pfds[1].fd != -1)
+        close(pfds[1].fd);
+    unlink(path);
+    sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+    return NULL;
+}
+
+static int pack_request(const char *text)
+{
+    /* returns the length of the request, -1 if it doesn't fit */
+    session_request_header header = { 0 };
+    int len = pack_string(request, sizeof(request), sizeof(header), text);
+    if (len != -1)
+        len = pack_strings(
+            request, sizeof(request), len, environ, &header.envc
+        );
+    memcpy(request, &header, sizeof(header));
+    return len;
+}
+
+static int connect_to_server(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd, res;
+    if (!make_socket_address(path, &addr))
+        return -1;
+    fd = socket(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0);
+    error_handling(fd, __FILE__, __LINE__, "socket");
+    if (fd == -1)
+        return -1;
+    res = connect(fd, (struct sockaddr *)&addr, sizeof(addr));
+    if (res == -1) {
+        fprintf(stderr, ERR_SOCKET, path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int run_client(const char *path, const char *text)
+{
+    /* `my_shell --connect PATH TEXT`, returns the exit status of the
+    session, or 1 if the server can't be reached */
+    int fds[passed_fds_count] = { 0, 1, 2, -1 }, fd, len, status = 1;
+    ssize_t res;
+    if (!path || !text) {
+        fprintf(stderr, ERR_OPTION_ARGUMENT, CONNECT_OPTION);
+        return 2;
+    }
+    len = pack_request(text);
+    if (len == -1) {
+        fprintf(stderr, ERR_REQUEST_TOO_LONG, CONNECT_OPTION);
+        return 1;
+    }
+    fd = connect_to_server(path);
+    if (fd == -1)
+        return 1;
+    fds[3] = open(".", O_PATH|O_DIRECTORY|O_CLOEXEC);
+    error_handling(fds[3], __FILE__, __LINE__, "open");
+    if ((fds[3] != -1) && send_with_fds(fd, request, len, fds)) {
+        do {
+            res = recv(fd, &status, sizeof(status), 0);
+        } while ((res == -1) && (errno == EINTR));
+        if (res != sizeof(status))
+            status = 1;
+    }
+    if (fds[3] != -1)
+        close(fds[3]);
+    close(fd);
+    return status;
+}
+#endif
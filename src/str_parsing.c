@@ -1,14 +1,120 @@
 /* str_parsing.c */
 
+#include "arithmetic.h"
 #include "cmd_execution.h"
+#include "cmd_line_building.h"
+#include "control_flow.h"
+#include "error_handling.h"
+#include "globbing.h"
+#include "job_log.h"
+#include "line_editing.h"
 #include "str_parsing.h"
+#include "variables.h"
 #include "zombie_handling.h"
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include "parse_allocation.h"
 
-#define ESC_ERR \
-    "my_shell: Error: only the characters `\"` and `\\` can be escaped\n"
+#define WARN_HERE_DOCUMENT_AT_EOF \
+    "my_shell: warning: here-document delimited by end-of-file (wanted `%s')\n"
+#define ERR_UNEXPECTED_EOF "my_shell: syntax error: unexpected end of file\n"
+#define ERR_UNEXPECTED_SEPARATOR \
+    "my_shell: syntax error near unexpected token `%s'\n"
+
+void init_str(string *str, const char *input_arr, int input_len)
+{
+    /* `input_arr` is the text to be parsed, or NULL to parse `stdin` */
+    string init_str = {
+        false, false, false, false, 0, no_error,
+        { NULL, 0, init_tmp_wrd_arr_len },
+        { NULL, NULL, 1 },
+        { NULL, NULL, 1, false },
+        { NULL },
+        { NULL },
+        { input_arr, 0, input_len, -1, NULL },
+        NULL,
+        false,
+        false,
+        false,
+        false,
+        { NULL, 0, 0 },
+        NULL,
+        false,
+        false
+    };
+    /* the array of the word and the list of the command lines are allocated
+    by the first word and by the first command line, the `string` of a text
+    with none costs nothing */
+    *str = init_str;
+}
+
+void free_str_memory(string *str)
+{
+    free_list_of_words(&str->words_list);
+    free(str->tmp_wrd.arr);
+    str->tmp_wrd.arr = NULL;
+    if (str->cmd_line.first)
+        free_cmd_line_item(str->cmd_line.first);
+    str->cmd_line.first = NULL;
+    str->cmd_line.last = NULL;
+    free(str->glob.arr);
+    str->glob.arr = NULL;
+#if defined(EXEC_MODE)
+    free_directory_cache(&str->dir_cache);
+#endif
+}
+
+#if defined(EXEC_MODE)
+static void refill_input(input_buffer *input)
+{
+    ssize_t res;
+    do
+        res = read(input->fd, input->chunk, input_chunk_len);
+    while (res == -1 && errno == EINTR);
+    error_handling(res, __FILE__, __LINE__, "read");
+    input->arr = input->chunk;
+    input->idx = 0;
+    input->len = (res > 0) ? res : 0;
+    if (res <= 0)
+        input->fd = -1;
+}
+#endif
+
+int read_next_character(string *str)
+{
+    input_buffer *input = &str->input;
+#if !defined(PARSE_LIBRARY_MODE)
+    if (!input->arr) {
+        return line_editing_active() ?
+            read_edited_character() : getchar_signal_protected();
+    }
+#endif
+#if defined(EXEC_MODE)
+    if (input->idx == input->len && input->fd != -1)
+        refill_input(input);
+#endif
+#if defined(PARSE_LIBRARY_MODE)
+    /* a text not ending with a newline is read as if it did, the way the
+    shell reads its scripts */
+    if (input->idx == input->len && input->len > 0 &&
+        input->arr[input->len-1] != '\n')
+    {
+        input->idx++;
+        return '\n';
+    }
+    if (input->idx >= input->len)
+        return EOF;
+#else
+    if (input->idx == input->len)
+        return EOF;
+#endif
+    return (unsigned char)input->arr[input->idx++];
+}
 
 void free_list_of_words(curr_str_words_list *link_list)
 {
@@ -28,8 +134,10 @@ static void toggle_quotation(string *str)
 {
     if (str->quotation)
         str->quotation = false;
-    else
+    else {
         str->quotation = true;
+        str->word_quoted = true;
+    }
 }
 
 static void add_empty_item_to_list_of_words(curr_str_words_list *list)
@@ -43,6 +151,7 @@ static void add_empty_item_to_list_of_words(curr_str_words_list *list)
     }
     list->last->word = NULL;
     list->last->separator_val = none;
+    list->last->quoted = false;
     list->last->next = NULL;
     list->len += 1;
 }
@@ -56,9 +165,16 @@ static void double_tmp_wrd_arr(curr_word_dynamic_char_arr *tmp_wrd)
     tmp_wrd->arr_len *= 2;
 }
 
+static void allocate_tmp_wrd(curr_word_dynamic_char_arr *tmp_wrd)
+{
+    if (!tmp_wrd->arr)
+        tmp_wrd->arr = malloc(tmp_wrd->arr_len * sizeof(char));
+}
+
 static void add_character_to_word(string *str)
 {
     str->word_ended = false;
+    allocate_tmp_wrd(&str->tmp_wrd);
     /* if we haven't started to write the `tmp_wrd` yet */
     if (str->tmp_wrd.idx == 0)
         add_empty_item_to_list_of_words(&str->words_list);
@@ -68,12 +184,108 @@ static void add_character_to_word(string *str)
     (str->tmp_wrd.idx)++;
 }
 
+static void add_glob_position(string *str)
+{
+    glob_positions *glob = &str->glob;
+    if (glob->len == glob->arr_len) {
+        glob->arr_len = glob->arr_len ? glob->arr_len*2 : init_tmp_wrd_arr_len;
+        glob->arr = realloc(glob->arr, glob->arr_len * sizeof(int));
+    }
+    glob->arr[glob->len] = str->tmp_wrd.idx;
+    glob->len++;
+}
+
+#if defined(EXEC_MODE)
+static bool glob_pattern(const string *str)
+{
+    /* a `[` without a `]` after it is an ordinary character, and so is
+    a `]` alone: `[ $x = 1 ]` isn't a pattern */
+    const char *word = str->words_list.last->word;
+    bool bracket_opened = false;
+    int i;
+    if (assignment_word(word))
+        return false;
+    for (i = 0; i < str->glob.len; i++) {
+        char c = word[str->glob.arr[i]];
+        if (c == '*' || c == '?' || (c == ']' && bracket_opened))
+            return true;
+        if (c == '[')
+            bracket_opened = true;
+    }
+    return false;
+}
+
+static char *build_glob_pattern(const string *str)
+{
+    /* the pattern characters that were quoted, or came from an expansion,
+    are escaped, and so are the backslashes */
+    const char *word = str->words_list.last->word;
+    char *pattern = malloc(strlen(word)*2 + 1);
+    int i, j = 0, k = 0;
+    for (i = 0; word[i]; i++) {
+        if (k < str->glob.len && str->glob.arr[k] == i)
+            k++;
+        else
+        if (strchr("*?[]\\", word[i]))
+            pattern[j++] = '\\';
+        pattern[j++] = word[i];
+    }
+    pattern[j] = '\0';
+    return pattern;
+}
+
+static void expand_glob_word(string *str)
+{
+    /* the word is replaced by the paths it matches, it's kept as it is if
+    there are none */
+    glob_matches matches;
+    char *pattern;
+    int i;
+    if (!glob_pattern(str))
+        return;
+    pattern = build_glob_pattern(str);
+    expand_glob_pattern(pattern, &str->dir_cache, &matches);
+    free(pattern);
+    if (matches.len == 0) {
+        free_glob_matches(&matches);
+        return;
+    }
+    free(str->words_list.last->word);
+    str->words_list.last->word = matches.arr[0];
+    for (i = 1; i < matches.len; i++) {
+        add_empty_item_to_list_of_words(&str->words_list);
+        str->words_list.last->word = matches.arr[i];
+    }
+    free(matches.arr);
+}
+#endif
+
+static bool expansions_kept_as_written(const string *str)
+{
+    /* the token printing mode and the `--dump-tokens` option expand and run
+    nothing, `$x`, `$(...)`, the glob patterns and the like are kept as
+    they are written */
+#if defined(PRINT_TOKENS_MODE)
+    (void)str;
+    return true;
+#else
+    return str->tokens_only;
+#endif
+}
+
 static void process_end_of_word(string *str)
 {
+    /* the word may be an empty `""`, with no character added */
+    allocate_tmp_wrd(&str->tmp_wrd);
     str->tmp_wrd.arr[str->tmp_wrd.idx] = '\0';
     str->words_list.last->word = malloc((str->tmp_wrd.idx + 1) * sizeof(char));
     strcpy(str->words_list.last->word, str->tmp_wrd.arr);
     str->tmp_wrd.idx = 0;
+#if defined(EXEC_MODE)
+    if (str->glob.len > 0 && !expansions_kept_as_written(str))
+        expand_glob_word(str);
+#endif
+    str->glob.len = 0;
 }
 
 static void reset_str_variables(string *str)
@@ -86,69 +298,458 @@ static void reset_str_variables(string *str)
     str->words_list.len = 1;
     str->tmp_wrd.idx = 0;
     /* --- */
-    reset_cmd_line_item(str->cmd_line.first);
-    str->cmd_line.first->next = NULL;
+    if (str->cmd_line.first) {
+        reset_cmd_line_item(str->cmd_line.first);
+        str->cmd_line.first->next = NULL;
+    }
     str->cmd_line.last = str->cmd_line.first;
+    str->cmd_line.list_len = 1;
     str->cmd_line.background_execution = false;
     str->pipeline.first = NULL;
     /* --- */
+    str->last_command = false;
+    str->glob.len = 0;
+    str->word_quoted = false;
 }
 
+#if defined(PARSE_LIBRARY_MODE)
+static bool report_if_error(string *str)
+{
+    /* the library leaves the reporting to its user, who gets the code of
+    the error, the unmatched quotes included */
+    if (str->err_code == no_error && str->quotation)
+        str->err_code = unmatched_quotes;
+    return (str->err_code != no_error);
+}
+#else
 static bool report_if_error(const string *str)
 {
     bool error = true;
     if (str->err_code == incorrect_char_escaping)
-        fprintf(stderr, "%s", ESC_ERR);
+        fprintf(stderr, "%s", ERR_INCORRECT_CHAR_ESCAPING);
+    else
+    if (str->err_code == unclosed_command_substitution)
+        fprintf(stderr, "%s", ERR_UNCLOSED_COMMAND_SUBSTITUTION);
+    else
+    if (str->err_code == bad_substitution)
+        fprintf(stderr, "%s", ERR_BAD_SUBSTITUTION);
+    else
+    if (str->err_code == arithmetic_error)
+        /* the error has already been reported by the `evaluate_arithmetic` */
+        {}
     else
     /* check this error condition before last */
     /* the `stdin_cleanup` function, which could be called if previous errors
     were detected, could break the balance of quote signs */
     if (str->quotation)
-        fprintf(stderr, "my_shell: Error: unmatched quotes\n");
+        fprintf(stderr, "%s", ERR_UNMATCHED_QUOTES);
     else
     /* check this error condition last */
     if (str->err_code == no_error)
         error = false;
     return error;
 }
+#endif
 
-static void stdin_cleanup()
+static void stdin_cleanup(string *str)
 {
     int c;
-    while ((c=getchar_signal_protected() != '\n') && (c != EOF))
+    while (((c=read_next_character(str)) != '\n') && (c != EOF))
         ;
 }
 
+static bool here_document_delimiter_line(
+    const curr_word_dynamic_char_arr *body, int line_start,
+    const char *delimiter
+)
+{
+    int line_len = body->idx - line_start;
+    return (
+        line_len == (int)strlen(delimiter) &&
+        0 == memcmp(&body->arr[line_start], delimiter, line_len)
+    );
+}
+
+static char *read_here_document_body(string *str, const char *delimiter)
+{
+    /* the body consists of the lines following the command line, up to the
+    line that is equal to the delimiter */
+    curr_word_dynamic_char_arr body = { NULL, 0, init_tmp_wrd_arr_len };
+    int line_start = 0;
+    body.arr = malloc(body.arr_len);
+    while (true) {
+        int c = read_next_character(str);
+        if ((c == '\n') || (c == EOF)) {
+            if (here_document_delimiter_line(&body, line_start, delimiter)) {
+                body.idx = line_start;
+                break;
+            }
+            if (c == EOF) {
+#if !defined(PARSE_LIBRARY_MODE)
+                fprintf(stderr, WARN_HERE_DOCUMENT_AT_EOF, delimiter);
+#endif
+                break;
+            }
+        }
+        if (body.idx == body.arr_len-1)
+            double_tmp_wrd_arr(&body);
+        body.arr[body.idx] = c;
+        body.idx++;
+        if (c == '\n')
+            line_start = body.idx;
+    }
+    body.arr[body.idx] = '\0';
+    return body.arr;
+}
+
+#if defined(EXEC_MODE)
+static char *expand_here_document(const char *body);
+#endif
+
+static bool read_here_documents(string *str)
+{
+    /* the delimiter word following every `<<` is replaced by the body, which
+    is expanded unless a part of the delimiter is quoted. False if the
+    expansion of a body has failed, all of them are read anyway */
+    bool success = true;
+    word_item *p;
+    for (p = str->words_list.first; p; p = p->next) {
+        char *body;
+        if (p->separator_val != here_document)
+            continue;
+        if (!p->next || p->next->separator_val != none)
+            continue;
+        body = read_here_document_body(str, p->next->word);
+#if defined(EXEC_MODE)
+        if (!p->next->quoted && !expansions_kept_as_written(str)) {
+            char *expanded = expand_here_document(body);
+            free(body);
+            body = expanded;
+            if (!body) {
+                success = false;
+                body = strdup("");
+            }
+        }
+#endif
+        free(p->next->word);
+        p->next->word = body;
+    }
+    return success;
+}
+
+static bool rest_of_input_blank(const input_buffer *input)
+{
+    int i;
+    if (!input->arr)
+        return false;
+    for (i = input->idx; i < input->len; i++) {
+        if (input->arr[i] != ' ' && input->arr[i] != '\t' &&
+            input->arr[i] != '\n')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
 void process_end_of_string(string *str)
 {
     bool error = report_if_error(str);
+    if (!error)
+        error = !read_here_documents(str);
+    str->last_command =
+        str->non_interactive && rest_of_input_blank(&str->input);
+#if defined(PARSE_LIBRARY_MODE)
+    /* the lines with an error are handed to the library user as well */
+    execute_command(str);
+#else
     if (!error)
         execute_command(str);
+#endif
+#if defined(EXEC_MODE)
+    else
+        set_last_exit_status(2);
+    close_process_substitution_pipes(&str->substitution_pipes);
+    /* the logged jobs that have failed meanwhile, before the next prompt */
+    report_finished_jobs();
+#endif
     free_list_of_words(&str->words_list);
+#if defined(EXEC_MODE)
+    free_directory_cache(&str->dir_cache);
+#endif
     reset_str_variables(str);
-    printf("> ");
+#if !defined(PARSE_LIBRARY_MODE)
+    if (!str->input.arr && !str->tokens_only)
+        print_prompt();
+#endif
 }
 
 static void complete_word(string *str)
 {
+    bool quoted = str->word_quoted;
+    str->word_quoted = false;
     if (!str->word_ended && !words_list_is_empty(str)) {
+        str->words_list.last->quoted = quoted;
         process_end_of_word(str);
         str->word_ended = true;
     }
 }
 
+#if defined(EXEC_MODE)
+static bool compound_keyword(const word_item *word)
+{
+    /* the word `if`, `while`, `until`, `for` or `{` */
+    static const char *const keywords[] = {
+        "if", "while", "until", "for", "{", NULL
+    };
+    const char *const *p;
+    if (word->separator_val != none)
+        return false;
+    for (p = keywords; *p; p++) {
+        if (0 == strcmp(word->word, *p))
+            return true;
+    }
+    return false;
+}
+
+static bool compound_command_keyword(const string *str)
+{
+    /* the line starts with a compound command */
+    const word_item *first = str->words_list.first;
+    if (str->expansion_only || !first || (first != str->words_list.last))
+        return false;
+    return compound_keyword(first);
+}
+
+static bool compound_pipeline_stage_keyword(const string *str)
+{
+    /* a compound command follows a `|` */
+    const word_item *p = str->words_list.first, *prev = NULL;
+    if (str->expansion_only || !p)
+        return false;
+    for (; p != str->words_list.last; p = p->next)
+        prev = p;
+    return (
+        prev && (prev->separator_val == pipe_operator) && compound_keyword(p)
+    );
+}
+
+static void add_character_to_text(curr_word_dynamic_char_arr *text, int c)
+{
+    if (text->idx == text->arr_len-1)
+        double_tmp_wrd_arr(text);
+    text->arr[text->idx] = c;
+    text->idx++;
+}
+
+static bool blank_text(const curr_word_dynamic_char_arr *text)
+{
+    int i;
+    for (i = 0; i < text->idx; i++) {
+        if (text->arr[i] != ' ' && text->arr[i] != '\t' &&
+            text->arr[i] != '\n')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static compound_parse_status read_compound_command(
+    string *str, curr_word_dynamic_char_arr *text, ast_node **tree,
+    bool blank_allowed
+)
+{
+    /* the lines are read as they are, until the text makes up a whole
+    compound command (with the rest of the line its `fi` or `done` is on).
+    If `blank_allowed`, an empty rest of the line gives no `tree` */
+    int c = str->c;
+    while (true) {
+        if ((c == '\n') || (c == EOF)) {
+            compound_parse_status status;
+            text->arr[text->idx] = '\0';
+            if (blank_allowed && blank_text(text))
+                return compound_complete;
+            status = parse_compound_command(text->arr, tree);
+            if ((status != compound_incomplete) || (c == EOF))
+                return status;
+        }
+        c = read_next_character(str);
+        if (c != EOF)
+            add_character_to_text(text, c);
+    }
+}
+
+static void process_compound_command(string *str)
+{
+    /* the compound command is parsed into a tree once, the expansions are
+    made by the simple commands inside it every time they're run */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    compound_parse_status status;
+    ast_node *tree = NULL;
+    const char *keyword = str->words_list.first->word;
+    text.arr = malloc(text.arr_len);
+    for (; *keyword; keyword++)
+        add_character_to_text(&text, *keyword);
+    add_character_to_text(&text, str->c);
+    status = read_compound_command(str, &text, &tree, false);
+    if (status == compound_complete)
+        run_compound_command(tree, str->capture);
+    else {
+        if (status == compound_incomplete)
+            fprintf(stderr, ERR_UNEXPECTED_EOF);
+        set_last_exit_status(2);
+    }
+    free_compound_command(tree);
+    free(text.arr);
+    free_list_of_words(&str->words_list);
+    str->str_ended = true;
+}
+
+static bool function_definition_start(
+    const string *str, separator_type separator
+)
+{
+    /* the line starts with `name(` */
+    const word_item *first = str->words_list.first;
+    return (
+        !str->expansion_only && (separator == open_parenthesis) &&
+        first && (first->separator_val == none) &&
+        first->next && (first->next == str->words_list.last)
+    );
+}
+
+static bool list_operator(const string *str, separator_type separator)
+{
+    /* right after another separator it's left to the command line checks,
+    which report the misuse */
+    const word_item *p = str->words_list.first, *prev = NULL;
+    if (str->expansion_only)
+        return false;
+    if (separator != command_separator && separator != and_operator &&
+        separator != or_operator)
+    {
+        return false;
+    }
+    for (; p != str->words_list.last; p = p->next)
+        prev = p;
+    return (!prev || prev->separator_val == none);
+}
+
+static void remove_last_word(curr_str_words_list *list)
+{
+    word_item **p = &list->first;
+    while ((*p)->next)
+        p = &(*p)->next;
+    free((*p)->word);
+    free(*p);
+    *p = NULL;
+    list->last = NULL;
+    for (p = &list->first; *p; p = &(*p)->next)
+        list->last = *p;
+    list->len -= 1;
+}
+
+static void process_rest_of_list(string *str, separator_type separator)
+{
+    /* the command before the `;`, `&&` or `||` is run right away, the rest
+    of the line is read as it is and run as a list, so its expansions are
+    made after the previous commands have run, and only if they have to */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    compound_parse_status status;
+    ast_node *tree = NULL;
+    remove_last_word(&str->words_list);
+    text.arr = malloc(text.arr_len);
+    status = read_compound_command(
+        str, &text, &tree, (separator == command_separator)
+    );
+    if (words_list_is_empty(str) && (status != compound_incomplete)) {
+        const char *operator_text = (separator == command_separator) ? ";" :
+            (separator == and_operator) ? "&&" : "||";
+        fprintf(stderr, ERR_UNEXPECTED_SEPARATOR, operator_text);
+        status = compound_syntax_error;
+    }
+    if (status == compound_complete) {
+        if (!report_if_error(str)) {
+            if (read_here_documents(str))
+                execute_command(str);
+            else
+                set_last_exit_status(2);
+        }
+        close_process_substitution_pipes(&str->substitution_pipes);
+        if (tree)
+            run_list_continuation(tree, separator, str->capture);
+    } else {
+        if (status == compound_incomplete)
+            fprintf(stderr, ERR_UNEXPECTED_EOF);
+        set_last_exit_status(2);
+    }
+    free_compound_command(tree);
+    free(text.arr);
+    free_list_of_words(&str->words_list);
+    str->str_ended = true;
+}
+
+static void process_compound_pipeline_stage(string *str)
+{
+    /* the compound command after the `|` is read up to its end along with
+    the rest of the line, which is run once the pipeline is done */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    compound_parse_status status;
+    ast_node *tree = NULL;
+    const char *keyword = str->words_list.last->word;
+    text.arr = malloc(text.arr_len);
+    for (; *keyword; keyword++)
+        add_character_to_text(&text, *keyword);
+    add_character_to_text(&text, str->c);
+    status = read_compound_command(str, &text, &tree, false);
+    remove_last_word(&str->words_list);
+    remove_last_word(&str->words_list);
+    if (status == compound_complete) {
+        if (!report_if_error(str)) {
+            read_here_documents(str);
+            run_compound_pipeline_stage(str, tree);
+        }
+        close_process_substitution_pipes(&str->substitution_pipes);
+    } else {
+        if (status == compound_incomplete)
+            fprintf(stderr, ERR_UNEXPECTED_EOF);
+        set_last_exit_status(2);
+    }
+    free_compound_command(tree);
+    free(text.arr);
+    free_list_of_words(&str->words_list);
+    str->str_ended = true;
+}
+#endif
+
+static void complete_possible_keyword(string *str)
+{
+    /* a compound command is read up to its end before anything is executed,
+    the token printing mode keeps its keywords as simple words */
+    complete_word(str);
+#if defined(EXEC_MODE)
+    if (compound_command_keyword(str))
+        process_compound_command(str);
+    else
+    if (compound_pipeline_stage_keyword(str))
+        process_compound_pipeline_stage(str);
+#endif
+}
+
 static void process_space_character(string *str)
 {
     if (str->quotation)
         add_character_to_word(str);
     else
-        complete_word(str);
+        complete_possible_keyword(str);
 }
 
 static void process_escaped_character(string *str)
 {
     add_character_to_word(str);
     str->char_escaping = false;
+    str->word_quoted = true;
 }
 
 static void process_escape_character(string *str)
@@ -209,14 +810,29 @@ static separator_type get_double_separator_val(char c)
     }
 }
 
+#if defined(EXEC_MODE)
+static void process_rest_of_list(string *str, separator_type separator);
+
+static bool list_operator(const string *str, separator_type separator);
+#endif
+
 static void add_separator(string *str, separator_type separator)
 {
     str->words_list.last->separator_val = separator;
     complete_word(str);
+#if defined(EXEC_MODE)
+    if (list_operator(str, separator))
+        process_rest_of_list(str, separator);
+    else
+    if (function_definition_start(str, separator))
+        process_compound_command(str);
+#endif
 }
 
 void process_character(string *str);
 
+static void process_process_substitution(string *str, char direction);
+
 static void process_separator(string *str)
 {
     if (str->quotation)
@@ -229,19 +845,58 @@ static void process_separator(string *str)
     }
 }
 
+static bool redirection_fd_prefix(const string *str)
+{
+    /* a single digit right before the `<` or `>` is the descriptor being
+    redirected, as in `2>`. It's kept in the word of the operator */
+    return (
+        !str->word_ended && str->tmp_wrd.idx == 1 && str->glob.len == 0 &&
+        !str->word_quoted && isdigit((unsigned char)str->tmp_wrd.arr[0])
+    );
+}
+
+static void process_output_error_redirection(string *str)
+{
+    /* `&>` or `&>>`, the `&` is in the word already and the `>` is read */
+    add_character_to_word(str);
+    str->c = read_next_character(str);
+    if (str->c == '>') {
+        add_character_to_word(str);
+        add_separator(str, output_error_append_redirection);
+        return;
+    }
+    add_separator(str, output_error_redirection);
+    process_character(str);
+}
+
 static void process_possible_double_separator(string *str)
 {
     if (str->quotation)
         add_character_to_word(str);
     else {
         char chr = str->c;
+        int next_c;
+        bool fd_prefix = (chr == '>') && redirection_fd_prefix(str);
         /* complete the previous word */
-        complete_word(str);
+        if (!fd_prefix)
+            complete_word(str);
+        next_c = read_next_character(str);
+        if ((chr == '>') && (next_c == '(') && !fd_prefix) {
+            process_process_substitution(str, chr);
+            return;
+        }
         add_character_to_word(str);
-        str->c = getchar_signal_protected();
+        str->c = next_c;
         if (str->c == chr) {
             add_character_to_word(str);
             add_separator(str, get_double_separator_val(str->c));
+        } else
+        if ((chr == '>') && (str->c == '&')) {
+            add_character_to_word(str);
+            add_separator(str, duplication_redirection);
+        } else
+        if ((chr == '&') && (str->c == '>')) {
+            process_output_error_redirection(str);
         } else {
             add_separator(str, get_separator_val(chr));
             process_character(str);
@@ -249,20 +904,560 @@ static void process_possible_double_separator(string *str)
     }
 }
 
+static void process_input_redirection_separator(string *str)
+{
+    /* `<` redirects the input from a file, `<<` starts a here-document,
+    `<<<` starts a here-string and `<(` starts a process substitution. `<>`
+    opens the file for reading and writing, `<&` duplicates a descriptor */
+    int next_c;
+    bool fd_prefix;
+    if (str->quotation) {
+        add_character_to_word(str);
+        return;
+    }
+    fd_prefix = redirection_fd_prefix(str);
+    /* complete the previous word */
+    if (!fd_prefix)
+        complete_word(str);
+    next_c = read_next_character(str);
+    if ((next_c == '(') && !fd_prefix) {
+        process_process_substitution(str, '<');
+        return;
+    }
+    add_character_to_word(str);
+    str->c = next_c;
+    if ((str->c == '>') || (str->c == '&')) {
+        add_character_to_word(str);
+        add_separator(
+            str,
+            (str->c == '>') ? input_output_redirection : duplication_redirection
+        );
+        return;
+    }
+    if (str->c != '<') {
+        add_separator(str, input_redirection);
+        process_character(str);
+        return;
+    }
+    add_character_to_word(str);
+    str->c = read_next_character(str);
+    if (str->c != '<') {
+        add_separator(str, here_document);
+        process_character(str);
+        return;
+    }
+    add_character_to_word(str);
+    add_separator(str, here_string);
+}
+
+static bool read_command_substitution_text(
+    string *str, int c, curr_word_dynamic_char_arr *text
+)
+{
+    /* the text starts with the `c` and runs up to the `)` matching the
+    already read `$(`; the parentheses inside quotes or escaped characters
+    don't count */
+    int depth = 1;
+    bool quotation = false, char_escaping = false;
+    for (;; c = read_next_character(str)) {
+        if (c == EOF)
+            return false;
+        if (char_escaping)
+            char_escaping = false;
+        else
+        if (c == '\\')
+            char_escaping = true;
+        else
+        if (c == '"')
+            quotation = !quotation;
+        else
+        if (!quotation && (c == '('))
+            depth++;
+        else
+        if (!quotation && (c == ')') && (--depth == 0))
+            break;
+        if (text->idx == text->arr_len-1)
+            double_tmp_wrd_arr(text);
+        text->arr[text->idx] = c;
+        text->idx++;
+    }
+    /* the last line of the text must end, so that it gets executed */
+    text->arr[text->idx] = '\n';
+    text->idx++;
+    return true;
+}
+
+static void add_text_to_word(string *str, const char *text, int len)
+{
+    int i;
+    for (i = 0; i < len; i++) {
+        str->c = (unsigned char)text[i];
+        add_character_to_word(str);
+    }
+}
+
+#if defined(EXEC_MODE)
+void run_commands_from_text(
+    const char *text, int len, curr_word_dynamic_char_arr *output
+)
+{
+    /* the text is parsed and executed line by line just like the `stdin`,
+    if the `output` is given, the commands' output is collected in it */
+    string inner_str;
+    init_str(&inner_str, text, len);
+    inner_str.capture = output;
+    while ((inner_str.c=read_next_character(&inner_str)) != EOF) {
+        process_character(&inner_str);
+        if (inner_str.str_ended)
+            process_end_of_string(&inner_str);
+    }
+    free_str_memory(&inner_str);
+}
+
+void expand_words(const char *text, int len, curr_str_words_list *words)
+{
+    /* the text is split into words and expanded, but not executed. On an
+    error, which is reported, there are no words */
+    string inner_str;
+    init_str(&inner_str, text, len);
+    inner_str.expansion_only = true;
+    while (!inner_str.str_ended &&
+        ((inner_str.c=read_next_character(&inner_str)) != EOF))
+    {
+        process_character(&inner_str);
+    }
+    complete_word(&inner_str);
+    if (report_if_error(&inner_str))
+        free_list_of_words(&inner_str.words_list);
+    close_process_substitution_pipes(&inner_str.substitution_pipes);
+    *words = inner_str.words_list;
+    inner_str.words_list.first = NULL;
+    inner_str.words_list.last = NULL;
+    free_str_memory(&inner_str);
+}
+
+static char *expand_here_document(const char *body)
+{
+    /* the parameters, the substitutions and the arithmetic expansions of the
+    body are expanded as in a quoted word, NULL on an error, which is
+    reported */
+    string inner_str;
+    char *expanded = NULL;
+    init_str(&inner_str, body, strlen(body));
+    inner_str.expansion_only = true;
+    inner_str.here_document_body = true;
+    inner_str.quotation = true;
+    while (!inner_str.str_ended &&
+        ((inner_str.c=read_next_character(&inner_str)) != EOF))
+    {
+        process_character(&inner_str);
+    }
+    if (inner_str.char_escaping) {
+        inner_str.c = '\\';
+        add_character_to_word(&inner_str);
+    }
+    complete_word(&inner_str);
+    inner_str.quotation = false;
+    if (!report_if_error(&inner_str)) {
+        expanded = inner_str.words_list.first ?
+            inner_str.words_list.first->word : "";
+        expanded = strdup(expanded);
+    }
+    close_process_substitution_pipes(&inner_str.substitution_pipes);
+    free_str_memory(&inner_str);
+    return expanded;
+}
+
+static bool assignment_value_started(const string *str)
+{
+    /* the word being formed is a `NAME=value` one before the command name,
+    every word of the command before it is an assignment too */
+    const word_item *p, *start = str->words_list.first;
+    const char *word = str->tmp_wrd.arr;
+    int i;
+    if (str->tmp_wrd.idx == 0)
+        return false;
+    for (i = 0; (i < str->tmp_wrd.idx) && (word[i] != '='); i++) {
+        if (!variable_name_character((unsigned char)word[i], (i == 0)))
+            return false;
+    }
+    if ((i == 0) || (i == str->tmp_wrd.idx))
+        return false;
+    for (p = str->words_list.first; p; p = p->next) {
+        if (p->separator_val != none)
+            start = p->next;
+    }
+    for (p = start; p && (p != str->words_list.last); p = p->next) {
+        if (!assignment_word(p->word))
+            return false;
+    }
+    return true;
+}
+
+static void add_expanded_text(string *str, const char *text, int len)
+{
+    /* the text is split into words on whitespace unless it's quoted or is
+    the value of an assignment, and is never interpreted as quotes or
+    separators */
+    bool split = !str->quotation && !assignment_value_started(str);
+    int i;
+    for (i = 0; i < len; i++) {
+        str->c = (unsigned char)text[i];
+        if (split && (str->c == ' ' || str->c == '\t' || str->c == '\n'))
+            complete_word(str);
+        else
+            add_character_to_word(str);
+    }
+}
+
+static void start_process_substitution(
+    string *str, const curr_word_dynamic_char_arr *text,
+    bool output_substitution
+)
+{
+    /* the commands run in a forked copy of the shell, concurrently with the
+    rest of the command line, which gets the `/dev/fd/N` name of the shell's
+    end of the pipe instead */
+    char fd_name[32];
+    int fd;
+    pid_t pid = launch_process_substitution(
+        &str->substitution_pipes, output_substitution, &fd
+    );
+    if (pid == 0) {
+        run_commands_from_text(text->arr, text->idx, NULL);
+        fflush(stdout);
+        _exit(0);
+    }
+    if (pid == -1)
+        return;
+    sprintf(fd_name, "/dev/fd/%d", fd);
+    add_text_to_word(str, fd_name, strlen(fd_name));
+}
+#endif
+
+static void handle_unclosed_substitution(string *str, int c)
+{
+    str->err_code = unclosed_command_substitution;
+    str->str_ended = true;
+    if ((c != '\n') && (c != EOF))
+        stdin_cleanup(str);
+}
+
+static bool read_substitution_text(
+    string *str, int c, curr_word_dynamic_char_arr *text
+)
+{
+    text->arr = malloc(text->arr_len);
+    if (read_command_substitution_text(str, c, text))
+        return true;
+    handle_unclosed_substitution(str, EOF);
+    free(text->arr);
+    return false;
+}
+
+static void process_command_substitution(string *str, int c)
+{
+    /* `$(...)` is replaced by the output of the commands inside, or kept as
+    it is if nothing is executed */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    if (!read_substitution_text(str, c, &text))
+        return;
+    if (expansions_kept_as_written(str)) {
+        add_text_to_word(str, "$(", 2);
+        add_text_to_word(str, text.arr, text.idx-1);
+        add_text_to_word(str, ")", 1);
+    }
+#if defined(EXEC_MODE)
+    else {
+        curr_word_dynamic_char_arr output = { NULL, 0, init_tmp_wrd_arr_len };
+        output.arr = malloc(output.arr_len);
+        run_commands_from_text(text.arr, text.idx, &output);
+        /* the trailing newlines of the output are dropped */
+        while ((output.idx > 0) && (output.arr[output.idx-1] == '\n'))
+            output.idx--;
+        add_expanded_text(str, output.arr, output.idx);
+        free(output.arr);
+    }
+#endif
+    free(text.arr);
+}
+
+static void process_process_substitution(string *str, char direction)
+{
+    /* `<(...)` is replaced by a file name the output of the commands inside
+    can be read from, and `>(...)` by one their input can be written to */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    if (!read_substitution_text(str, read_next_character(str), &text))
+        return;
+    if (expansions_kept_as_written(str)) {
+        str->c = direction;
+        add_character_to_word(str);
+        add_text_to_word(str, "(", 1);
+        add_text_to_word(str, text.arr, text.idx-1);
+        add_text_to_word(str, ")", 1);
+    }
+#if defined(EXEC_MODE)
+    else {
+        start_process_substitution(str, &text, (direction == '>'));
+    }
+#endif
+    free(text.arr);
+}
+
+static void add_character_to_name(curr_word_dynamic_char_arr *name, int c)
+{
+    if (name->idx == name->arr_len-1)
+        double_tmp_wrd_arr(name);
+    name->arr[name->idx] = c;
+    name->idx++;
+}
+
+static int read_variable_name(
+    string *str, int c, curr_word_dynamic_char_arr *name, bool braces
+)
+{
+    /* returns the first character after the name. A special parameter is
+    a single character, except for a positional one in braces: `${10}` */
+    if (special_parameter_character(c)) {
+        bool digits = isdigit(c);
+        do {
+            add_character_to_name(name, c);
+            c = read_next_character(str);
+        } while (braces && digits && (c != EOF) && isdigit(c));
+        name->arr[name->idx] = '\0';
+        return c;
+    }
+    while (variable_name_character(c, (name->idx == 0))) {
+        add_character_to_name(name, c);
+        c = read_next_character(str);
+    }
+    name->arr[name->idx] = '\0';
+    return c;
+}
+
+static void handle_bad_substitution(string *str, int c)
+{
+    str->err_code = bad_substitution;
+    str->str_ended = true;
+    if ((c != '\n') && (c != EOF))
+        stdin_cleanup(str);
+}
+
+static int read_default_word(
+    string *str, int c, curr_word_dynamic_char_arr *word, bool *null_too
+)
+{
+    /* the `word` of `${NAME-word}` and `${NAME:-word}`, taken as it is
+    written. Returns the character after it, `}` unless the text ends */
+    *null_too = (c == ':');
+    if (*null_too)
+        c = read_next_character(str);
+    if (c != '-')
+        return c;
+    c = read_next_character(str);
+    while ((c != '}') && (c != '\n') && (c != EOF)) {
+        add_character_to_name(word, c);
+        c = read_next_character(str);
+    }
+    word->arr[word->idx] = '\0';
+    return c;
+}
+
+static void process_parameter_expansion(string *str, int next_c)
+{
+    /* `$NAME` and `${NAME}` are replaced by the value of the variable, an
+    unset one expands to nothing, or to the `word` of `${NAME-word}` (of
+    `${NAME:-word}` if empty too). The token printing mode keeps the text */
+    curr_word_dynamic_char_arr name = { NULL, 0, init_tmp_wrd_arr_len };
+    curr_word_dynamic_char_arr word = { NULL, 0, init_tmp_wrd_arr_len };
+    bool braces = (next_c == '{'), default_word = false, null_too = false;
+    name.arr = malloc(name.arr_len);
+    word.arr = malloc(word.arr_len);
+    word.arr[0] = '\0';
+    if (braces)
+        next_c = read_next_character(str);
+    next_c = read_variable_name(str, next_c, &name, braces);
+    if (braces && (name.idx > 0) && ((next_c == '-') || (next_c == ':'))) {
+        default_word = true;
+        next_c = read_default_word(str, next_c, &word, &null_too);
+    }
+    if (braces && ((next_c != '}') || (name.idx == 0))) {
+        handle_bad_substitution(str, next_c);
+        free(name.arr);
+        free(word.arr);
+        return;
+    }
+    if (expansions_kept_as_written(str)) {
+        add_text_to_word(str, braces ? "${" : "$", braces ? 2 : 1);
+        add_text_to_word(str, name.arr, name.idx);
+        if (default_word) {
+            add_text_to_word(str, null_too ? ":-" : "-", null_too ? 2 : 1);
+            add_text_to_word(str, word.arr, word.idx);
+        }
+        if (braces)
+            add_text_to_word(str, "}", 1);
+    }
+#if defined(EXEC_MODE)
+    else {
+        const char *value = get_parameter(name.arr);
+        if (default_word && (!value || (null_too && !*value)))
+            value = word.arr;
+        if (value)
+            add_expanded_text(str, value, strlen(value));
+    }
+#endif
+    free(name.arr);
+    free(word.arr);
+    if (braces)
+        next_c = read_next_character(str);
+    str->c = next_c;
+    if (str->c != EOF)
+        process_character(str);
+}
+
+static int read_arithmetic_text(string *str, curr_word_dynamic_char_arr *text)
+{
+    /* the text runs up to the `))` matching the already read `$((`. Returns
+    the last character read, which is `)` unless the text isn't closed */
+    int depth = 0, c;
+    while (true) {
+        c = read_next_character(str);
+        if (c == EOF)
+            break;
+        if (c == '(')
+            depth++;
+        else
+        if ((c == ')') && (depth > 0))
+            depth--;
+        else
+        if (c == ')') {
+            c = read_next_character(str);
+            break;
+        }
+        if (text->idx == text->arr_len-1)
+            double_tmp_wrd_arr(text);
+        text->arr[text->idx] = c;
+        text->idx++;
+    }
+    text->arr[text->idx] = '\0';
+    return c;
+}
+
+static void process_arithmetic_expansion(string *str)
+{
+    /* `$((...))` is replaced by the value of the expression, which is
+    evaluated by the shell itself. The token printing mode keeps the text */
+    curr_word_dynamic_char_arr text = { NULL, 0, init_tmp_wrd_arr_len };
+    int c;
+    text.arr = malloc(text.arr_len);
+    c = read_arithmetic_text(str, &text);
+    if (c != ')') {
+        handle_unclosed_substitution(str, c);
+        free(text.arr);
+        return;
+    }
+    if (expansions_kept_as_written(str)) {
+        add_text_to_word(str, "$((", 3);
+        add_text_to_word(str, text.arr, text.idx);
+        add_text_to_word(str, "))", 2);
+    }
+#if defined(EXEC_MODE)
+    else {
+        char value_text[32];
+        int64_t value;
+        if (!evaluate_arithmetic(text.arr, &value)) {
+            str->err_code = arithmetic_error;
+            str->str_ended = true;
+            stdin_cleanup(str);
+            free(text.arr);
+            return;
+        }
+        sprintf(value_text, "%" PRId64, value);
+        add_text_to_word(str, value_text, strlen(value_text));
+    }
+#endif
+    free(text.arr);
+}
+
+static void process_dollar_character(string *str)
+{
+    int next_c = read_next_character(str);
+    if (next_c == '(') {
+        next_c = read_next_character(str);
+        if (next_c == '(')
+            process_arithmetic_expansion(str);
+        else
+            process_command_substitution(str, next_c);
+        return;
+    }
+    if ((next_c == '{') || variable_name_character(next_c, true) ||
+        special_parameter_character(next_c))
+    {
+        process_parameter_expansion(str, next_c);
+        return;
+    }
+    add_character_to_word(str);
+    str->c = next_c;
+    if (str->c != EOF)
+        process_character(str);
+}
+
 static bool incorrect_character_escaping(const string *str)
 {
-    return ((str->char_escaping) && (str->c != '\\') && (str->c != '"'));
+    /* `\$` is the only way to pass a literal `$NAME` on, there are no single
+    quotes */
+    return (
+        (str->char_escaping) &&
+        (str->c != '\\') && (str->c != '"') && (str->c != '$')
+    );
 }
 
 static void handle_incorrect_character_escaping(string *str)
 {
     str->err_code = incorrect_char_escaping;
     str->str_ended = true;
-    stdin_cleanup();
+    stdin_cleanup(str);
+}
+
+static void process_pattern_character(string *str)
+{
+    /* an unquoted `*`, `?`, `[` or `]` may make the word a glob pattern */
+    if (!str->quotation)
+        add_glob_position(str);
+    add_character_to_word(str);
+}
+
+static void process_here_document_character(string *str)
+{
+    /* the backslash escapes only `$`, itself and the newline, which is
+    removed with it, and is kept before any other character */
+    int c = str->c;
+    if (str->char_escaping) {
+        str->char_escaping = false;
+        if (c == '\n')
+            return;
+        if ((c != '$') && (c != '\\')) {
+            str->c = '\\';
+            add_character_to_word(str);
+            str->c = c;
+        }
+        add_character_to_word(str);
+    } else
+    if (c == '\\')
+        str->char_escaping = true;
+    else
+    if (c == '$')
+        process_dollar_character(str);
+    else
+        add_character_to_word(str);
 }
 
 void process_character(string *str)
 {
+    if (str->here_document_body) {
+        process_here_document_character(str);
+        return;
+    }
     if (incorrect_character_escaping(str)) {
         handle_incorrect_character_escaping(str);
         return;
@@ -273,7 +1468,7 @@ void process_character(string *str)
             process_space_character(str);
             break;
         case ('\n'):
-            complete_word(str);
+            complete_possible_keyword(str);
             str->str_ended = true;
             break;
         case ('\\'):
@@ -283,6 +1478,14 @@ void process_character(string *str)
             process_quotation_mark_character(str);
             break;
         case ('<'):
+            process_input_redirection_separator(str);
+            break;
+        case ('$'):
+            if (str->char_escaping)
+                process_escaped_character(str);
+            else
+                process_dollar_character(str);
+            break;
         case (';'):
         case ('('):
         case (')'):
@@ -293,6 +1496,12 @@ void process_character(string *str)
         case ('|'):
             process_possible_double_separator(str);
             break;
+        case ('*'):
+        case ('?'):
+        case ('['):
+        case (']'):
+            process_pattern_character(str);
+            break;
         default:
             add_character_to_word(str);
     }
@@ -301,13 +1510,271 @@ void process_character(string *str)
 static void possible_case_of_adding_empty_word(string *str)
 {
     if ((!str->words_list.last) || (str->word_ended)) {
-        str->c = getchar_signal_protected();
+        str->c = read_next_character(str);
         if (str->c == '"') {
             toggle_quotation(str);
-            str->c = getchar_signal_protected();
+            str->c = read_next_character(str);
             if (str->c == ' ' || str->c == '\t' || str->c == '\n')
                 add_empty_item_to_list_of_words(&str->words_list);
         }
         process_character(str);
     }
 }
+
+#if defined(EXEC_MODE)
+typedef enum tag_segment_type {
+    literal_segment,
+    parameter_segment,
+    arithmetic_segment
+} segment_type;
+
+typedef struct tag_command_segment {
+    segment_type type;
+    /* the literal text, the name of the parameter or the expression */
+    char *text;
+    int len;
+    bool quoted;
+    /* the segment is the last one of its word */
+    bool word_end;
+} command_segment;
+
+struct tag_compiled_command {
+    command_segment *segments;
+    int len, arr_len;
+};
+
+static command_segment *add_segment(
+    compiled_command *cmd, segment_type type, const char *text, int len,
+    bool quoted
+)
+{
+    command_segment *segment;
+    if (cmd->len == cmd->arr_len) {
+        cmd->arr_len *= 2;
+        cmd->segments =
+            realloc(cmd->segments, cmd->arr_len * sizeof(command_segment));
+    }
+    segment = &cmd->segments[cmd->len];
+    cmd->len++;
+    segment->type = type;
+    segment->text = malloc(len + 1);
+    memcpy(segment->text, text, len);
+    segment->text[len] = '\0';
+    segment->len = len;
+    segment->quoted = quoted;
+    segment->word_end = false;
+    return segment;
+}
+
+static void add_literal_character(compiled_command *cmd, char c, bool quoted)
+{
+    /* the characters of a literal run are gathered into a single segment */
+    command_segment *last = cmd->len ? &cmd->segments[cmd->len-1] : NULL;
+    if (!last || last->word_end || last->type != literal_segment ||
+        last->quoted != quoted)
+    {
+        add_segment(cmd, literal_segment, &c, 1, quoted);
+        return;
+    }
+    last->text = realloc(last->text, last->len + 2);
+    last->text[last->len] = c;
+    last->len++;
+    last->text[last->len] = '\0';
+}
+
+static int compile_arithmetic_expansion(
+    compiled_command *cmd, const char *text, int len, int i, bool quoted
+)
+{
+    /* `i` is just after the `$((`, returns the index after the matching
+    `))`, or -1 if it isn't closed */
+    int start = i, depth = 0;
+    for (; i < len; i++) {
+        if (text[i] == '(')
+            depth++;
+        else
+        if ((text[i] == ')') && (depth > 0))
+            depth--;
+        else
+        if (text[i] == ')') {
+            if ((i+1 == len) || (text[i+1] != ')'))
+                return -1;
+            add_segment(cmd, arithmetic_segment, text+start, i-start, quoted);
+            return i+2;
+        }
+    }
+    return -1;
+}
+
+static int compile_dollar_character(
+    compiled_command *cmd, const char *text, int len, int i, bool quoted
+)
+{
+    /* `i` is just after the `$`, returns the index after the expansion, or
+    -1 if it's one that the lexer is left with */
+    bool braces = (i < len) && (text[i] == '{');
+    int start;
+    if ((i+1 < len) && (text[i] == '(')) {
+        if (text[i+1] != '(')
+            return -1;
+        return compile_arithmetic_expansion(cmd, text, len, i+2, quoted);
+    }
+    if (braces)
+        i++;
+    start = i;
+    if ((i < len) && special_parameter_character((unsigned char)text[i])) {
+        do
+            i++;
+        while (braces && (i < len) && isdigit((unsigned char)text[i]) &&
+            isdigit((unsigned char)text[start]));
+    } else {
+        while ((i < len) &&
+            variable_name_character((unsigned char)text[i], (i == start)))
+        {
+            i++;
+        }
+    }
+    if (!braces && (i == start)) {
+        /* a lone `$` is taken literally */
+        add_literal_character(cmd, '$', quoted);
+        return i;
+    }
+    if (braces && ((i == start) || (i == len) || (text[i] != '}')))
+        return -1;
+    add_segment(cmd, parameter_segment, text+start, i-start, quoted);
+    return braces ? i+1 : i;
+}
+
+static void end_compiled_word(compiled_command *cmd, int *words)
+{
+    if (cmd->len && !cmd->segments[cmd->len-1].word_end) {
+        cmd->segments[cmd->len-1].word_end = true;
+        (*words)++;
+    }
+}
+
+static bool first_word_may_be_keyword(const compiled_command *cmd)
+{
+    /* an expansion or a quote could make the first word a keyword of a
+    compound command, unless it has a literal `=` like an assignment. The
+    parser has taken the plain keywords already */
+    const command_segment *first = &cmd->segments[0];
+    int i;
+    for (i = 0; i < cmd->len; i++) {
+        const command_segment *segment = &cmd->segments[i];
+        if ((segment->type == literal_segment) &&
+            memchr(segment->text, '=', segment->len))
+        {
+            return false;
+        }
+        if (segment->word_end)
+            break;
+    }
+    return !first->word_end || first->quoted ||
+        (first->type != literal_segment);
+}
+
+compiled_command *compile_simple_command(const char *text, int len)
+{
+    /* a command of literal words, quotes and the expansions of parameters
+    and arithmetic is split into words once, running it only expands them.
+    Returns NULL for the rest, the separators, redirections, escapes, glob
+    patterns and substitutions are left to the lexer */
+    compiled_command *cmd = malloc(sizeof(compiled_command));
+    bool quoted = false, ok = true;
+    int i = 0, words = 0;
+    cmd->len = 0;
+    cmd->arr_len = 4;
+    cmd->segments = malloc(cmd->arr_len * sizeof(command_segment));
+    while (ok && (i < len)) {
+        char c = text[i];
+        if (c == '"') {
+            /* an empty `""` word is left to the lexer */
+            ok = quoted || (i+1 == len) || (text[i+1] != '"');
+            quoted = !quoted;
+            i++;
+        } else
+        if (c == '$') {
+            i = compile_dollar_character(cmd, text, len, i+1, quoted);
+            ok = (i != -1);
+        } else
+        if (!quoted && ((c == ' ') || (c == '\t') || (c == '\n'))) {
+            end_compiled_word(cmd, &words);
+            ok = (c != '\n') || (i+1 == len);
+            i++;
+        } else
+        if ((c == '\n') || (c == '\\') ||
+            (!quoted && strchr("<>;()&|*?[]", c)))
+        {
+            ok = false;
+        } else {
+            add_literal_character(cmd, c, quoted);
+            i++;
+        }
+    }
+    end_compiled_word(cmd, &words);
+    if (!ok || quoted || (words == 0) || first_word_may_be_keyword(cmd)) {
+        free_compiled_command(cmd);
+        return NULL;
+    }
+    return cmd;
+}
+
+static bool expand_segment(string *str, const command_segment *segment)
+{
+    /* the expansions are done as the lexer does them, false on an error */
+    const char *value;
+    int64_t number;
+    char number_text[32];
+    str->quotation = segment->quoted;
+    if (segment->quoted)
+        str->word_quoted = true;
+    switch (segment->type) {
+        case (literal_segment):
+            add_text_to_word(str, segment->text, segment->len);
+            break;
+        case (parameter_segment):
+            value = get_parameter(segment->text);
+            if (value)
+                add_expanded_text(str, value, strlen(value));
+            break;
+        case (arithmetic_segment):
+            if (!evaluate_arithmetic(segment->text, &number)) {
+                str->err_code = arithmetic_error;
+                return false;
+            }
+            sprintf(number_text, "%" PRId64, number);
+            add_text_to_word(str, number_text, strlen(number_text));
+            break;
+    }
+    str->quotation = false;
+    return true;
+}
+
+void run_compiled_command(const compiled_command *cmd)
+{
+    string inner_str;
+    int i;
+    init_str(&inner_str, "", 0);
+    for (i = 0; i < cmd->len; i++) {
+        if (!expand_segment(&inner_str, &cmd->segments[i]))
+            break;
+        if (cmd->segments[i].word_end)
+            complete_possible_keyword(&inner_str);
+    }
+    inner_str.str_ended = true;
+    process_end_of_string(&inner_str);
+    free_str_memory(&inner_str);
+}
+
+void free_compiled_command(compiled_command *cmd)
+{
+    int i;
+    if (!cmd)
+        return;
+    for (i = 0; i < cmd->len; i++)
+        free(cmd->segments[i].text);
+    free(cmd->segments);
+    free(cmd);
+}
+#endif
@@ -0,0 +1,401 @@
+/* stream_copying.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "error_handling.h"
+#include "io_util.h"
+#include "stream_copying.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+#define ERR_TEE_USAGE "my_shell: tee: usage: tee [-a] [files...]\n"
+#define ERR_INPUT_IS_OUTPUT "my_shell: cat: %s: input file is output file\n"
+
+enum stream_copying_consts {
+    /* the largest chunk the kernel is asked to move at once */
+    max_transfer_len    = 1 << 30,
+    rw_buffer_len       = 131072,
+    max_tee_outputs     = 64
+};
+
+typedef enum tag_copy_res {
+    copy_failed = -1,
+    copy_completed,
+    /* the method isn't supported for the given kind of file descriptors,
+    the copying should go on with another one */
+    copy_unsupported
+} copy_res;
+
+typedef ssize_t (*transfer_func)(int fd_in, int fd_out, size_t len);
+
+static bool transfer_unsupported(int err)
+{
+    return (
+        err == EINVAL || err == EXDEV || err == ENOSYS ||
+        err == EOPNOTSUPP || err == EBADF || err == ESPIPE
+    );
+}
+
+static ssize_t transfer_with_copy_file_range(int fd_in, int fd_out, size_t len)
+{
+    return copy_file_range(fd_in, NULL, fd_out, NULL, len, 0);
+}
+
+static ssize_t transfer_with_splice(int fd_in, int fd_out, size_t len)
+{
+    return splice(fd_in, NULL, fd_out, NULL, len, SPLICE_F_MOVE);
+}
+
+static ssize_t transfer_with_sendfile(int fd_in, int fd_out, size_t len)
+{
+    return sendfile(fd_out, fd_in, NULL, len);
+}
+
+static copy_res copy_in_kernel(int fd_in, int fd_out, transfer_func transfer)
+{
+    /* file offsets are moved by the kernel, so if the method stops being
+    supported half way through, the next one carries on from that place */
+    while (true) {
+        ssize_t res = (*transfer)(fd_in, fd_out, max_transfer_len);
+        if (res > 0)
+            continue;
+        if (res == 0)
+            return copy_completed;
+        if (errno == EINTR)
+            continue;
+        if (transfer_unsupported(errno))
+            return copy_unsupported;
+        return copy_failed;
+    }
+}
+
+static copy_res copy_in_user_space(int fd_in, int fd_out)
+{
+    char *buf = malloc(rw_buffer_len);
+    copy_res status = copy_completed;
+    while (true) {
+        ssize_t res = read(fd_in, buf, rw_buffer_len);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res == -1) {
+            status = copy_failed;
+            break;
+        }
+        if (res == 0)
+            break;
+        if (!write_whole_buffer(fd_out, buf, res)) {
+            status = copy_failed;
+            break;
+        }
+    }
+    free(buf);
+    return status;
+}
+
+static bool is_pipe(int fd)
+{
+    struct stat st;
+    return ((fstat(fd, &st) == 0) && S_ISFIFO(st.st_mode));
+}
+
+static bool is_regular_file(int fd)
+{
+    struct stat st;
+    return ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode));
+}
+
+int copy_stream(int fd_in, int fd_out)
+{
+    /* pick the cheapest way to move the data the file types allow:
+    `copy_file_range` between files, `splice` when one side is a pipe,
+    `sendfile` from a file to anything, and `read`/`write` otherwise */
+    copy_res res = copy_unsupported;
+    if (is_regular_file(fd_in) && is_regular_file(fd_out))
+        res = copy_in_kernel(fd_in, fd_out, transfer_with_copy_file_range);
+    if ((res == copy_unsupported) && (is_pipe(fd_in) || is_pipe(fd_out)))
+        res = copy_in_kernel(fd_in, fd_out, transfer_with_splice);
+    if ((res == copy_unsupported) && is_regular_file(fd_in))
+        res = copy_in_kernel(fd_in, fd_out, transfer_with_sendfile);
+    if (res == copy_unsupported)
+        res = copy_in_user_space(fd_in, fd_out);
+    return (res == copy_completed) ? 0 : -1;
+}
+
+static bool option_word(const char *word)
+{
+    return (word[0] == '-' && word[1] != '\0');
+}
+
+bool cat_arguments_supported(char **argv)
+{
+    /* file names and `-` only, the options are left to the external `cat` */
+    char **p;
+    for (p = &argv[1]; *p; p++) {
+        if (option_word(*p))
+            return false;
+    }
+    return true;
+}
+
+static bool input_is_output(int fd_in, int fd_out)
+{
+    /* the input file would grow as fast as it's read, so the copying would
+    never end. As in the coreutils `cat`, a file read from its end is no
+    error */
+    struct stat st_in, st_out;
+    off_t offset;
+    if (fstat(fd_in, &st_in) == -1 || fstat(fd_out, &st_out) == -1)
+        return false;
+    if (!S_ISREG(st_out.st_mode) || st_in.st_dev != st_out.st_dev ||
+        st_in.st_ino != st_out.st_ino)
+    {
+        return false;
+    }
+    offset = lseek(fd_in, 0, SEEK_CUR);
+    return (offset != -1 && offset < st_in.st_size);
+}
+
+static int cat_file(int fd, const char *name)
+{
+    if (input_is_output(fd, 1)) {
+        fprintf(stderr, ERR_INPUT_IS_OUTPUT, name);
+        return 1;
+    }
+    if (copy_stream(fd, 1) == -1) {
+        /* the reader has gone, just like the killed by `SIGPIPE` `cat` */
+        if (errno != EPIPE)
+            fprintf(stderr, "my_shell: cat: %s: %s\n", name, strerror(errno));
+        return 1;
+    }
+    return 0;
+}
+
+int handle_cat_command(char **argv)
+{
+    int status = 0;
+    char **p;
+    if (!argv[1])
+        return cat_file(0, "-");
+    for (p = &argv[1]; *p; p++) {
+        int fd = (0 == strcmp(*p, "-")) ? 0 : open(*p, O_RDONLY|O_CLOEXEC);
+        if (fd == -1) {
+            fprintf(stderr, "my_shell: cat: %s: %s\n", *p, strerror(errno));
+            status = 1;
+            continue;
+        }
+        if (cat_file(fd, *p) != 0)
+            status = 1;
+        if (fd != 0)
+            close(fd);
+    }
+    return status;
+}
+
+typedef struct tag_tee_outputs {
+    int fd[max_tee_outputs];
+    int len;
+} tee_outputs;
+
+bool tee_arguments_supported(char **argv)
+{
+    /* `-a` and the file names, up to the `max_tee_outputs`; the rest is left
+    to the external `tee` */
+    int idx = 1;
+    if (argv[idx] && (0 == strcmp(argv[idx], "-a")))
+        idx++;
+    for (; argv[idx]; idx++) {
+        if (option_word(argv[idx]) || idx >= max_tee_outputs)
+            return false;
+    }
+    return true;
+}
+
+static int open_tee_outputs(char **argv, tee_outputs *outputs)
+{
+    /* `stdout` is the first output. The `-a` files aren't opened with
+    `O_APPEND`: the kernel refuses to `splice` into such files, so the
+    offset is moved to the end of the file instead */
+    bool append = false;
+    int idx = 1, status = 0;
+    outputs->fd[0] = 1;
+    outputs->len = 1;
+    if (argv[idx] && (0 == strcmp(argv[idx], "-a"))) {
+        append = true;
+        idx++;
+    }
+    for (; argv[idx]; idx++) {
+        int flags = O_WRONLY|O_CREAT|O_CLOEXEC|(append ? 0 : O_TRUNC);
+        int fd;
+        if (outputs->len == max_tee_outputs) {
+            fprintf(stderr, ERR_TEE_USAGE);
+            return -1;
+        }
+        fd = open(argv[idx], flags, 0666);
+        if ((fd != -1) && append)
+            lseek(fd, 0, SEEK_END);
+        if (fd == -1) {
+            fprintf(stderr, "my_shell: tee: %s: %s\n", argv[idx], strerror(errno));
+            status = 1;
+            continue;
+        }
+        outputs->fd[outputs->len] = fd;
+        outputs->len++;
+    }
+    return status;
+}
+
+static void close_tee_outputs(const tee_outputs *outputs)
+{
+    int i;
+    for (i = 1; i < outputs->len; i++)
+        close(outputs->fd[i]);
+}
+
+static bool drain_pipe(int fd_in, int fd_out, size_t len)
+{
+    while (len > 0) {
+        ssize_t res = splice(fd_in, NULL, fd_out, NULL, len, SPLICE_F_MOVE);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res <= 0)
+            return false;
+        len -= res;
+    }
+    return true;
+}
+
+static ssize_t duplicate_into_output(
+    int fd_out, size_t len, const int *scratch_pipe, bool first
+)
+{
+    /* the first output gets the data straight from `tee` if it's a pipe and
+    defines the chunk length; the other ones get it through the empty
+    scratch pipe, so `tee` is never short for them */
+    ssize_t res;
+    bool direct = first && is_pipe(fd_out);
+    do
+        res = tee(0, direct ? fd_out : scratch_pipe[1], len, 0);
+    while ((res == -1) && (errno == EINTR));
+    if (res <= 0 || direct)
+        return res;
+    return drain_pipe(scratch_pipe[0], fd_out, res) ? res : -1;
+}
+
+static copy_res tee_in_kernel(const tee_outputs *outputs)
+{
+    /* every chunk is duplicated into all the outputs but the last one with
+    `tee`, which doesn't consume the input, and then `splice`d into the last
+    output, which does */
+    int scratch_pipe[2], res, i;
+    copy_res status = copy_completed;
+    res = pipe2(scratch_pipe, O_CLOEXEC);
+    if (res == -1)
+        return copy_unsupported;
+    fcntl(scratch_pipe[1], F_SETPIPE_SZ, fcntl(0, F_GETPIPE_SZ));
+    while (status == copy_completed) {
+        ssize_t len = max_transfer_len;
+        for (i = 0; i < outputs->len-1; i++) {
+            ssize_t dup_len = duplicate_into_output(
+                outputs->fd[i], len, scratch_pipe, (i == 0)
+            );
+            if (dup_len == 0)
+                goto exit;
+            if (dup_len == -1) {
+                status = transfer_unsupported(errno) ?
+                    copy_unsupported : copy_failed;
+                goto exit;
+            }
+            len = dup_len;
+        }
+        if (outputs->len == 1) {
+            do
+                len = splice(0, NULL, 1, NULL, len, SPLICE_F_MOVE);
+            while ((len == -1) && (errno == EINTR));
+            if (len == 0)
+                break;
+            if (len == -1)
+                status = transfer_unsupported(errno) ?
+                    copy_unsupported : copy_failed;
+        } else
+        if (!drain_pipe(0, outputs->fd[outputs->len-1], len))
+            status = copy_failed;
+    }
+    exit:
+    close(scratch_pipe[0]);
+    close(scratch_pipe[1]);
+    return status;
+}
+
+static bool tee_in_kernel_possible(const tee_outputs *outputs)
+{
+    int i;
+    if (!is_pipe(0))
+        return false;
+    for (i = 0; i < outputs->len; i++) {
+        if (!is_pipe(outputs->fd[i]) && !is_regular_file(outputs->fd[i]))
+            return false;
+        if (fcntl(outputs->fd[i], F_GETFL) & O_APPEND)
+            return false;
+    }
+    return true;
+}
+
+static copy_res tee_in_user_space(const tee_outputs *outputs)
+{
+    char *buf = malloc(rw_buffer_len);
+    copy_res status = copy_completed;
+    while (status == copy_completed) {
+        int i;
+        ssize_t res = read(0, buf, rw_buffer_len);
+        if ((res == -1) && (errno == EINTR))
+            continue;
+        if (res <= 0) {
+            status = (res == 0) ? copy_completed : copy_failed;
+            break;
+        }
+        for (i = 0; i < outputs->len; i++) {
+            if (!write_whole_buffer(outputs->fd[i], buf, res))
+                status = copy_failed;
+        }
+    }
+    free(buf);
+    return status;
+}
+
+int handle_tee_command(char **argv)
+{
+    tee_outputs outputs;
+    copy_res res = copy_unsupported;
+    int status = open_tee_outputs(argv, &outputs);
+    if (status == -1) {
+        close_tee_outputs(&outputs);
+        return 1;
+    }
+    fflush(stdout);
+    if (tee_in_kernel_possible(&outputs))
+        res = tee_in_kernel(&outputs);
+    /* `tee` and `splice` fail on the first chunk if they are unsupported, so
+    no data has been consumed yet */
+    if (res == copy_unsupported)
+        res = tee_in_user_space(&outputs);
+    if (res == copy_failed) {
+        if (errno != EPIPE)
+            fprintf(stderr, "my_shell: tee: %s\n", strerror(errno));
+        status = 1;
+    }
+    close_tee_outputs(&outputs);
+    return status;
+}
+#endif
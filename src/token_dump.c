@@ -0,0 +1,247 @@
+/* token_dump.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "cmd_line_building.h"
+#include "error_handling.h"
+#include "io_util.h"
+#include "token_dump.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* `my_shell --dump-tokens[=text|json|binary] [file]` writes out the tokens
+of the command lines, which are neither expanded nor run. The formats:
+
+    text    the one of the token printing build, `[word]` or
+            `[separator_name]` on a line of its own;
+    json    a JSON array per command line on a line of its own, the words
+            are strings and the separators `{"separator":"separator_name"}`;
+    binary  a byte per token with its `separator_type`, 0 for a word, which
+            is followed by its length, 4 bytes little-endian, and its bytes.
+            A separator is followed by a byte of its descriptor, 255 if it
+            has none. A command line ends with the byte 255.
+
+The descriptor of a redirection written as `2>`, or the one `<&` and `>&`
+copy into, which the separator name doesn't tell, comes after the name:
+`[output_redirection 2]` and `{"separator":"output_redirection","fd":2}`.
+
+The output is collected in a large buffer, written out once it's full */
+
+#define ERR_DUMP_FORMAT \
+    "my_shell: --dump-tokens: %s: unknown format, use text, json or binary\n"
+
+enum token_dump_consts {
+    dump_buffer_len         = 1 << 20,
+    binary_line_end         = 255,
+    binary_no_descriptor    = 255
+};
+
+typedef enum tag_dump_format {
+    text_format,
+    json_format,
+    binary_format
+} dump_format;
+
+typedef struct tag_dump_buffer {
+    char *arr;
+    int len;
+    dump_format format;
+    /* a write has failed, the rest of the output is dropped */
+    bool failed;
+} dump_buffer;
+
+static dump_buffer dump = { NULL, 0, text_format, false };
+
+static const char *const separator_names[] = {
+    "none", "background_operator", "and_operator", "output_redirection",
+    "output_append_redirection", "pipe_operator", "or_operator",
+    "input_redirection", "command_separator", "open_parenthesis",
+    "close_parenthesis", "here_document", "here_string",
+    "input_output_redirection", "duplication_redirection",
+    "output_error_redirection", "output_error_append_redirection"
+};
+
+bool start_token_dump(const char *format)
+{
+    /* the `format` is the part of the option after the `=`, or NULL */
+    if (!format || 0 == strcmp(format, "text"))
+        dump.format = text_format;
+    else
+    if (0 == strcmp(format, "json"))
+        dump.format = json_format;
+    else
+    if (0 == strcmp(format, "binary"))
+        dump.format = binary_format;
+    else {
+        fprintf(stderr, ERR_DUMP_FORMAT, format);
+        return false;
+    }
+    dump.arr = malloc(dump_buffer_len);
+    dump.len = 0;
+    dump.failed = false;
+    return true;
+}
+
+static void write_out(const char *data, int len)
+{
+    /* once a write has failed, the rest of the dump is dropped */
+    if (dump.failed || write_whole_buffer(1, data, len))
+        return;
+    error_handling(-1, __FILE__, __LINE__, "write");
+    dump.failed = true;
+}
+
+static void flush_dump()
+{
+    write_out(dump.arr, dump.len);
+    dump.len = 0;
+}
+
+static void add_to_dump(const char *data, int len)
+{
+    if (dump.len + len > dump_buffer_len)
+        flush_dump();
+    if (len > dump_buffer_len) {
+        /* a word longer than the buffer is written out past it */
+        write_out(data, len);
+        return;
+    }
+    memcpy(&dump.arr[dump.len], data, len);
+    dump.len += len;
+}
+
+static void add_char_to_dump(char c)
+{
+    if (dump.len == dump_buffer_len)
+        flush_dump();
+    dump.arr[dump.len] = c;
+    dump.len++;
+}
+
+static void add_json_string(const char *s)
+{
+    /* the bytes other than the quote, the backslash and the control
+    characters are copied as they are, in runs */
+    const char *run = s;
+    add_char_to_dump('"');
+    for (; *s; s++) {
+        unsigned char c = *s;
+        char escaped[8];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        add_to_dump(run, s - run);
+        run = s + 1;
+        if (c == '"' || c == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = c;
+            add_to_dump(escaped, 2);
+        } else
+        if (c == '\n')
+            add_to_dump("\\n", 2);
+        else
+        if (c == '\t')
+            add_to_dump("\\t", 2);
+        else
+            add_to_dump(escaped, sprintf(escaped, "\\u%04x", c));
+    }
+    add_to_dump(run, s - run);
+    add_char_to_dump('"');
+}
+
+static void dump_text_token(const word_item *p)
+{
+    char descriptor[16];
+    const char *text = (p->separator_val != none) ?
+        separator_names[p->separator_val] : (p->word ? p->word : "");
+    int fd = (p->separator_val != none) ? separator_descriptor(p) : -1;
+    add_char_to_dump('[');
+    add_to_dump(text, strlen(text));
+    if (fd != -1)
+        add_to_dump(descriptor, sprintf(descriptor, " %d", fd));
+    add_to_dump("]\n", 2);
+}
+
+static void dump_json_token(const word_item *p, bool first)
+{
+    char descriptor[16];
+    int fd;
+    if (!first)
+        add_char_to_dump(',');
+    if (p->separator_val == none) {
+        add_json_string(p->word ? p->word : "");
+        return;
+    }
+    add_to_dump("{\"separator\":\"", 14);
+    add_to_dump(
+        separator_names[p->separator_val],
+        strlen(separator_names[p->separator_val])
+    );
+    add_char_to_dump('"');
+    fd = separator_descriptor(p);
+    if (fd != -1)
+        add_to_dump(descriptor, sprintf(descriptor, ",\"fd\":%d", fd));
+    add_char_to_dump('}');
+}
+
+static void dump_binary_token(const word_item *p)
+{
+    unsigned len;
+    unsigned char header[5];
+    header[0] = p->separator_val;
+    if (p->separator_val != none) {
+        int fd = separator_descriptor(p);
+        header[1] = (fd == -1) ? binary_no_descriptor : fd;
+        add_to_dump((const char *)header, 2);
+        return;
+    }
+    len = p->word ? strlen(p->word) : 0;
+    header[1] = len & 0xff;
+    header[2] = (len >> 8) & 0xff;
+    header[3] = (len >> 16) & 0xff;
+    header[4] = (len >> 24) & 0xff;
+    add_to_dump((const char *)header, sizeof(header));
+    add_to_dump(p->word, len);
+}
+
+void dump_tokens(const curr_str_words_list *words)
+{
+    const word_item *p;
+    if (!words->first)
+        return;
+    if (dump.format == json_format)
+        add_char_to_dump('[');
+    for (p = words->first; p; p = p->next) {
+        switch (dump.format) {
+            case (text_format):
+                dump_text_token(p);
+                break;
+            case (json_format):
+                dump_json_token(p, p == words->first);
+                break;
+            case (binary_format):
+                dump_binary_token(p);
+        }
+    }
+    if (dump.format == json_format)
+        add_to_dump("]\n", 2);
+    else
+    if (dump.format == binary_format)
+        add_char_to_dump((char)binary_line_end);
+}
+
+bool finish_token_dump()
+{
+    /* false if the output couldn't be written */
+    bool res;
+    flush_dump();
+    res = !dump.failed;
+    free(dump.arr);
+    dump.arr = NULL;
+    return res;
+}
+#endif
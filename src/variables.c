@@ -0,0 +1,471 @@
+/* variables.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#include "cmd_execution.h"
+#include "constants.h"
+#include "variables.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+bool variable_name_character(int c, bool first)
+{
+    if (c == '_' || (c != EOF && isalpha(c)))
+        return true;
+    return (!first && c != EOF && isdigit(c));
+}
+
+bool special_parameter_character(int c)
+{
+    /* `$1` ... `$9`, `$#`, `$*`, `$@` and `$?` */
+    return (
+        c != EOF &&
+        (isdigit(c) || c == '#' || c == '*' || c == '@' || c == '?')
+    );
+}
+
+#if defined(EXEC_MODE)
+#define ERR_NOT_VALID_IDENTIFIER \
+    "my_shell: %s: `%s': not a valid identifier\n"
+#define ERR_SHIFT_COUNT "my_shell: shift: %s: shift count out of range\n"
+
+enum variables_consts {
+    init_table_len          = 64,
+    /* the table grows when more than 7/10 of its slots are taken, counting
+    the slots of the removed variables */
+    max_load_numerator      = 7,
+    max_load_denominator    = 10,
+    /* the `name_len` of a slot whose variable has been removed */
+    removed_slot            = -1
+};
+
+typedef struct tag_variable_item {
+    /* `NAME=value`, so the exported ones can be put into the environment
+    block as they are. NULL if the slot is free */
+    char *pair;
+    int name_len;
+    bool exported;
+    /* unset by `export NAME` of a variable with no value: the `pair` is
+    just the `NAME` then, until a value is assigned */
+    bool has_value;
+} variable_item;
+
+typedef struct tag_variables_table {
+    /* open addressing with linear probing, `len` is a power of 2 */
+    variable_item *arr;
+    int len;
+    /* the slots taken by the variables and by the removed ones */
+    int used_len;
+    int exported_len;
+    /* the environment block passed to the `execve`, it points to the
+    `pair`s of the exported variables */
+    char **env;
+    int env_len;
+    /* an exported variable has changed since the `env` was built */
+    bool env_outdated;
+} variables_table;
+
+static variables_table vars = { NULL, 0, 0, 0, NULL, 0, false };
+
+/* the arguments of the function being run, or of the script */
+static positional_parameters params = { NULL, 0 };
+/* `$0` */
+static const char *script_name = "my_shell";
+/* the texts `$#`, `$?`, `$*` and `$PIPESTATUS` expand to */
+static char params_len_text[16];
+static char status_text[16];
+static char *joined_params = NULL;
+static char *joined_statuses = NULL;
+
+static unsigned hash_name(const char *name, int name_len)
+{
+    /* FNV-1a */
+    unsigned hash = 2166136261u;
+    int i;
+    for (i = 0; i < name_len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool slot_holds_name(
+    const variable_item *item, const char *name, int name_len
+)
+{
+    return (
+        item->pair && item->name_len == name_len &&
+        0 == memcmp(item->pair, name, name_len)
+    );
+}
+
+static variable_item *find_slot(const char *name, int name_len, bool insert)
+{
+    /* returns the slot of the variable, or if there is no such variable, the
+    slot it may be inserted into (if `insert` is set) or NULL */
+    unsigned idx = hash_name(name, name_len) & (vars.len-1);
+    variable_item *free_slot = NULL;
+    while (true) {
+        variable_item *item = &vars.arr[idx];
+        if (slot_holds_name(item, name, name_len))
+            return item;
+        if (!item->pair && (item->name_len == removed_slot) && !free_slot)
+            free_slot = item;
+        if (!item->pair && (item->name_len != removed_slot))
+            break;
+        idx = (idx+1) & (vars.len-1);
+    }
+    if (!insert)
+        return NULL;
+    return free_slot ? free_slot : &vars.arr[idx];
+}
+
+static void allocate_table(int len)
+{
+    int i;
+    vars.arr = malloc(len * sizeof(variable_item));
+    vars.len = len;
+    vars.used_len = 0;
+    for (i = 0; i < len; i++) {
+        vars.arr[i].pair = NULL;
+        vars.arr[i].name_len = 0;
+        vars.arr[i].exported = false;
+        vars.arr[i].has_value = false;
+    }
+}
+
+static void grow_table()
+{
+    /* the removed slots are dropped while the variables are rehashed */
+    variable_item *old_arr = vars.arr;
+    int old_len = vars.len, i;
+    allocate_table(old_len*2);
+    for (i = 0; i < old_len; i++) {
+        variable_item *item;
+        if (!old_arr[i].pair)
+            continue;
+        item = find_slot(old_arr[i].pair, old_arr[i].name_len, true);
+        *item = old_arr[i];
+        vars.used_len++;
+    }
+    free(old_arr);
+}
+
+static variable_item *take_slot(const char *name, int name_len)
+{
+    /* the slot of the variable, a new one is taken with no attributes */
+    variable_item *item;
+    if ((vars.used_len+1) * max_load_denominator >
+        vars.len * max_load_numerator)
+    {
+        grow_table();
+    }
+    item = find_slot(name, name_len, true);
+    if (!item->pair) {
+        if (item->name_len != removed_slot)
+            vars.used_len++;
+        item->name_len = name_len;
+        item->exported = false;
+        item->has_value = false;
+    }
+    return item;
+}
+
+static void set_variable(
+    const char *name, int name_len, const char *value, bool exported
+)
+{
+    /* `exported` only ever turns the export attribute on */
+    variable_item *item = take_slot(name, name_len);
+    int value_len = strlen(value);
+    free(item->pair);
+    item->has_value = true;
+    item->pair = malloc(name_len + value_len + 2);
+    memcpy(item->pair, name, name_len);
+    item->pair[name_len] = '=';
+    memcpy(&item->pair[name_len+1], value, value_len+1);
+    if (exported && !item->exported) {
+        item->exported = true;
+        vars.exported_len++;
+    }
+    if (item->exported)
+        vars.env_outdated = true;
+}
+
+static void export_variable(const char *name)
+{
+    /* a variable with no value stays unset, and out of the environment,
+    until one is assigned */
+    int name_len = strlen(name);
+    variable_item *item = take_slot(name, name_len);
+    if (!item->pair) {
+        item->pair = malloc(name_len + 1);
+        memcpy(item->pair, name, name_len + 1);
+    }
+    if (!item->exported) {
+        item->exported = true;
+        vars.exported_len++;
+        vars.env_outdated = true;
+    }
+}
+
+static void unset_variable(const char *name)
+{
+    variable_item *item = find_slot(name, strlen(name), false);
+    if (!item)
+        return;
+    free(item->pair);
+    item->pair = NULL;
+    item->name_len = removed_slot;
+    item->has_value = false;
+    if (item->exported) {
+        item->exported = false;
+        vars.exported_len--;
+        vars.env_outdated = true;
+    }
+}
+
+void refresh_environment()
+{
+    /* the block is rebuilt only if an exported variable has changed, so
+    launching a process normally costs nothing here */
+    int i, idx = 0;
+    if (!vars.env_outdated)
+        return;
+    if (vars.env_len < vars.exported_len+1) {
+        free(vars.env);
+        vars.env_len = (vars.exported_len+1)*2;
+        vars.env = malloc(vars.env_len * sizeof(char*));
+    }
+    for (i = 0; i < vars.len; i++) {
+        if (vars.arr[i].has_value && vars.arr[i].exported) {
+            vars.env[idx] = vars.arr[i].pair;
+            idx++;
+        }
+    }
+    vars.env[idx] = NULL;
+    environ = vars.env;
+    vars.env_outdated = false;
+}
+
+void init_variables()
+{
+    /* the variables of the inherited environment are all exported */
+    char **env;
+    allocate_table(init_table_len);
+    for (env = environ; *env; env++) {
+        const char *eq = strchr(*env, '=');
+        if (!eq || eq == *env)
+            continue;
+        set_variable(*env, eq - *env, eq+1, true);
+    }
+    vars.env_outdated = true;
+    refresh_environment();
+}
+
+void free_variables()
+{
+    int i;
+    for (i = 0; i < vars.len; i++)
+        free(vars.arr[i].pair);
+    free(vars.arr);
+    vars.arr = NULL;
+    vars.len = 0;
+    /* `environ` must not point to the freed block */
+    environ = NULL;
+    free(vars.env);
+    vars.env = NULL;
+    free(joined_params);
+    joined_params = NULL;
+    free(joined_statuses);
+    joined_statuses = NULL;
+}
+
+static int variable_name_length(const char *word)
+{
+    /* returns the length of the name at the start of the `word` */
+    int len = 0;
+    while (variable_name_character((unsigned char)word[len], (len == 0)))
+        len++;
+    return len;
+}
+
+const char *get_variable(const char *name)
+{
+    variable_item *item = find_slot(name, strlen(name), false);
+    return (item && item->has_value) ? &item->pair[item->name_len+1] : NULL;
+}
+
+positional_parameters replace_positional_parameters(
+    positional_parameters new_params
+)
+{
+    /* returns the parameters to be put back once the function returns */
+    positional_parameters old_params = params;
+    params = new_params;
+    return old_params;
+}
+
+void set_script_name(const char *name)
+{
+    script_name = name;
+}
+
+positional_parameters current_positional_parameters()
+{
+    return params;
+}
+
+static const char *join_positional_parameters()
+{
+    /* `$*` and `$@` are the parameters separated by spaces */
+    int i, len = 0;
+    for (i = 0; i < params.len; i++)
+        len += strlen(params.arr[i]) + 1;
+    free(joined_params);
+    joined_params = malloc(len + 1);
+    len = 0;
+    for (i = 0; i < params.len; i++) {
+        int param_len = strlen(params.arr[i]);
+        if (i > 0)
+            joined_params[len++] = ' ';
+        memcpy(&joined_params[len], params.arr[i], param_len);
+        len += param_len;
+    }
+    joined_params[len] = '\0';
+    return joined_params;
+}
+
+static const char *join_pipeline_statuses()
+{
+    /* `$PIPESTATUS` is the statuses of the stages of the last foreground
+    pipeline, separated by spaces */
+    int len, i, pos = 0;
+    const int *arr = last_pipeline_statuses(&len);
+    free(joined_statuses);
+    joined_statuses = malloc(len * 12 + 1);
+    joined_statuses[0] = '\0';
+    for (i = 0; i < len; i++)
+        pos += sprintf(&joined_statuses[pos], i ? " %d" : "%d", arr[i]);
+    return joined_statuses;
+}
+
+const char *get_parameter(const char *name)
+{
+    /* a variable, or one of the special parameters */
+    if (isdigit((unsigned char)name[0])) {
+        int n = atoi(name);
+        if (n == 0)
+            return script_name;
+        return (n <= params.len) ? params.arr[n-1] : NULL;
+    }
+    if (0 == strcmp(name, "#")) {
+        sprintf(params_len_text, "%d", params.len);
+        return params_len_text;
+    }
+    if (0 == strcmp(name, "*") || 0 == strcmp(name, "@"))
+        return join_positional_parameters();
+    if (0 == strcmp(name, "?")) {
+        sprintf(status_text, "%d", last_exit_status());
+        return status_text;
+    }
+    if (0 == strcmp(name, "PIPESTATUS"))
+        return join_pipeline_statuses();
+    return get_variable(name);
+}
+
+void assign_variable(const char *name, const char *value)
+{
+    set_variable(name, strlen(name), value, false);
+    refresh_environment();
+}
+
+bool assignment_word(const char *word)
+{
+    int len = variable_name_length(word);
+    return ((len > 0) && (word[len] == '='));
+}
+
+void apply_assignment(const char *word, bool exported)
+{
+    int len = variable_name_length(word);
+    set_variable(word, len, &word[len+1], exported);
+}
+
+bool valid_variable_name(const char *name)
+{
+    int len = variable_name_length(name);
+    return ((len > 0) && (name[len] == '\0'));
+}
+
+static void print_exported_variables()
+{
+    int i;
+    for (i = 0; i < vars.len; i++) {
+        if (vars.arr[i].pair && vars.arr[i].exported)
+            printf("export %s\n", vars.arr[i].pair);
+    }
+}
+
+int handle_export_command(char **argv)
+{
+    int status = 0;
+    char **p;
+    if (!argv[1])
+        print_exported_variables();
+    for (p = &argv[1]; *p; p++) {
+        if (assignment_word(*p))
+            apply_assignment(*p, true);
+        else
+        if (valid_variable_name(*p))
+            export_variable(*p);
+        else {
+            fprintf(stderr, ERR_NOT_VALID_IDENTIFIER, argv[0], *p);
+            status = 1;
+        }
+    }
+    refresh_environment();
+    return status;
+}
+
+int handle_unset_command(char **argv)
+{
+    int status = 0;
+    char **p;
+    for (p = &argv[1]; *p; p++) {
+        if (valid_variable_name(*p))
+            unset_variable(*p);
+        else {
+            fprintf(stderr, ERR_NOT_VALID_IDENTIFIER, argv[0], *p);
+            status = 1;
+        }
+    }
+    refresh_environment();
+    return status;
+}
+
+int handle_shift_command(char **argv)
+{
+    /* `$2` becomes `$1` and so on, the count is 1 by default */
+    int count = 1;
+    if (argv[1]) {
+        char *end;
+        long res = strtol(argv[1], &end, 10);
+        if (*end || (end == argv[1]) || (res < 0) || (res > params.len)) {
+            fprintf(stderr, ERR_SHIFT_COUNT, argv[1]);
+            return 1;
+        }
+        count = res;
+    }
+    if (count > params.len)
+        return 1;
+    params.arr += count;
+    params.len -= count;
+    return 0;
+}
+#endif
@@ -1,6 +1,7 @@
 /* zombie_handling.c */
 
 #include "error_handling.h"
+#include "job_log.h"
 #include "zombie_handling.h"
 #include <errno.h>
 #include <signal.h>
@@ -10,17 +11,21 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
-static bool getchar_in_block_mode_was_interrupted_by_signal()
+static bool getchar_in_block_mode_was_interrupted_by_signal(int chr)
 {
-    return (errno == EINTR);
+    /* a character read is never dropped, whatever `errno` has been left by
+    the calls before */
+    return ((chr == EOF) && (errno == EINTR));
 }
 
 int getchar_signal_protected()
 {
     while (true) {
-        int chr = getchar();
-        if (getchar_in_block_mode_was_interrupted_by_signal()) {
-            errno = 0;
+        int chr;
+        errno = 0;
+        chr = getchar();
+        if (getchar_in_block_mode_was_interrupted_by_signal(chr)) {
+            clearerr(stdin);
             continue;
         } else
             return chr;
@@ -51,12 +56,17 @@ static void handle_errors(int res)
 
 void handle_background_zombie_process(int sig_num)
 {
-    int res, saved_errno = errno;
+    int res, status, saved_errno = errno;
     (void)sig_num;
     errno = 0;
     do {
-        res = waitpid(-1, NULL, WNOHANG);
+        res = waitpid(-1, &status, WNOHANG);
         handle_errors(res);
+#if defined(EXEC_MODE)
+        /* the logged jobs keep the statuses of their last stages */
+        if (res > 0)
+            note_background_exit(res, status);
+#endif
     } while (res > 0);
     errno = saved_errno;
 }
@@ -71,3 +81,49 @@ void set_signal_disposition(int signum, void (*handler)(int))
     res = sigaction(signum, &act, NULL);
     error_handling(res, __FILE__, __LINE__, "sigaction");
 }
+
+void suspend_background_zombie_handling()
+{
+    /* temporarilly turn off the `SIGCHLD` signal desposition, so the
+    foreground processes can't be reaped by the signal handler */
+    set_signal_disposition(SIGCHLD, SIG_DFL);
+}
+
+void resume_background_zombie_handling()
+{
+    /* turn the `SIGCHLD` signal desposition back on, and reap the background
+    processes which have exited while it was off */
+    set_signal_disposition(SIGCHLD, handle_background_zombie_process);
+    handle_background_zombie_process(SIGCHLD);
+}
+
+int wait_for_one_of_child_processes(const int *pids, int len, int *status)
+{
+    /* returns the index of the first of the `pids` to exit, or -1. The other
+    children are left to the signal handler: `SIGCHLD` is blocked while it's
+    off, so it is kept pending to wake the waiting up */
+    sigset_t child_signal, saved_mask;
+    int idx = -1;
+    sigemptyset(&child_signal);
+    sigaddset(&child_signal, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &child_signal, &saved_mask);
+    while (len > 0) {
+        int i, res = 0;
+        for (i = 0; (i < len) && (res == 0); i++) {
+            do
+                res = waitpid(pids[i], status, WNOHANG);
+            while ((res == -1) && (errno == EINTR));
+        }
+        if (res == 0) {
+            sigwaitinfo(&child_signal, NULL);
+            continue;
+        }
+        if (res > 0)
+            idx = i-1;
+        else
+            error_handling(res, __FILE__, __LINE__, "waitpid");
+        break;
+    }
+    sigprocmask(SIG_SETMASK, &saved_mask, NULL);
+    return idx;
+}
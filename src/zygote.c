@@ -0,0 +1,220 @@
+/* zygote.c */
+
+#if !defined(EXEC_MODE) && !defined(PRINT_TOKENS_MODE)
+#error Please define either EXEC_MODE or PRINT_TOKENS_MODE
+#endif
+
+#define _GNU_SOURCE
+#include "constants.h"
+#include "error_handling.h"
+#include "fd_passing.h"
+#include "io_util.h"
+#include "zygote.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(EXEC_MODE)
+/* The zygote is a helper process forked at the shell's startup, while the
+shell is still small. It starts the external commands on the shell's
+behalf, so their `fork` doesn't have to copy the grown address space of the
+shell. The children are created with `CLONE_PARENT`, so they are the
+children of the shell, which waits for them as for its own */
+
+enum zygote_consts {
+    /* the largest request, the bigger ones are forked by the shell */
+    zygote_request_len  = 65536
+};
+
+typedef struct tag_spawn_request_header {
+    /* followed by the `argv` and then the environment strings, each one
+    with its terminating zero */
+    int argc;
+    int envc;
+} spawn_request_header;
+
+static int zygote_socket = -1;
+/* the forked children of the shell mustn't share its socket */
+static pid_t zygote_owner = 0;
+
+static char request[zygote_request_len];
+
+static char **unpack_request(int len, char ***envp)
+{
+    /* returns the `argv`, the environment follows it in the same array.
+    Returns NULL if the request is malformed */
+    spawn_request_header header;
+    char **arr, *p = &request[sizeof(header)], *end = &request[len];
+    int i, count;
+    if (len < (int)sizeof(header) || request[len-1] != '\0')
+        return NULL;
+    memcpy(&header, request, sizeof(header));
+    if (header.argc < 1 || header.envc < 0)
+        return NULL;
+    count = header.argc + header.envc;
+    arr = malloc((count + 2)*sizeof(char*));
+    for (i = 0; i < count + 2; i++) {
+        if (i == header.argc || i == count + 1) {
+            arr[i] = NULL;
+            continue;
+        }
+        if (p >= end) {
+            free(arr);
+            return NULL;
+        }
+        arr[i] = p;
+        p += strlen(p) + 1;
+    }
+    *envp = &arr[header.argc + 1];
+    return arr;
+}
+
+static void exec_zygote_child(char **argv, char **envp, const int *fds)
+{
+    adopt_passed_fds(fds);
+    /* the `execvp` looks the command up in the `PATH` of the `environ` */
+    environ = envp;
+    execvp(argv[0], argv);
+    fprintf(stderr, "%s, %d, %s: %s:", __FILE__, __LINE__, "execvp", argv[0]);
+    perror("");
+    fflush(stderr);
+    _exit(1);
+}
+
+static pid_t clone_sibling()
+{
+    /* like `fork`, but the child's parent is the shell, not the zygote */
+    return syscall(SYS_clone, CLONE_PARENT|SIGCHLD, NULL, NULL, NULL, NULL);
+}
+
+static void serve_requests(int sock)
+{
+    while (true) {
+        int fds[passed_fds_count], i;
+        int len = receive_with_fds(sock, request, sizeof(request), fds);
+        char **arr, **envp;
+        pid_t pid = -EINVAL;
+        if (len == 0)
+            _exit(0);
+        arr = (len > 0) ? unpack_request(len, &envp) : NULL;
+        if (arr) {
+            pid = clone_sibling();
+            if (pid == 0)
+                exec_zygote_child(arr, envp, fds);
+            if (pid == -1)
+                pid = -errno;
+            free(arr);
+        }
+        if (len > 0) {
+            for (i = 0; i < passed_fds_count; i++)
+                close(fds[i]);
+        }
+        send(sock, &pid, sizeof(pid), MSG_NOSIGNAL);
+    }
+}
+
+void start_zygote()
+{
+    int sv[2], res;
+    pid_t pid;
+    res = socketpair(AF_UNIX, SOCK_SEQPACKET|SOCK_CLOEXEC, 0, sv);
+    error_handling(res, __FILE__, __LINE__, "socketpair");
+    if (res == -1)
+        return;
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    error_handling(pid, __FILE__, __LINE__, "fork");
+    if (pid == 0) {
+        close(sv[0]);
+        open_standard_streams();
+        serve_requests(sv[1]);
+    }
+    close(sv[1]);
+    if (pid == -1) {
+        close(sv[0]);
+        return;
+    }
+    /* the socket would be on the descriptor 3, where `>&3` of a command
+    could write into the requests */
+    zygote_socket = move_fd_above_user_range(sv[0]);
+    zygote_owner = getpid();
+}
+
+bool zygote_running()
+{
+    return (zygote_socket != -1) && (getpid() == zygote_owner);
+}
+
+static int pack_request(char **argv)
+{
+    /* returns the length of the request, -1 if it doesn't fit */
+    spawn_request_header header = { 0, 0 };
+    int len = pack_strings(
+        request, sizeof(request), sizeof(header), argv, &header.argc
+    );
+    if (len != -1)
+        len = pack_strings(
+            request, sizeof(request), len, environ, &header.envc
+        );
+    memcpy(request, &header, sizeof(header));
+    return len;
+}
+
+static pid_t receive_pid()
+{
+    pid_t pid;
+    ssize_t res;
+    do {
+        res = recv(zygote_socket, &pid, sizeof(pid), 0);
+    } while ((res == -1) && (errno == EINTR));
+    return (res == sizeof(pid)) ? pid : 0;
+}
+
+pid_t spawn_with_zygote(char **argv, int fd_input, int fd_output)
+{
+    /* returns -1 if the command has to be forked by the shell itself */
+    int fds[passed_fds_count], len;
+    pid_t pid;
+    if (!zygote_running())
+        return -1;
+    len = pack_request(argv);
+    if (len == -1)
+        return -1;
+    fds[0] = fd_input;
+    fds[1] = fd_output;
+    fds[2] = 2;
+    fds[3] = open(".", O_PATH|O_DIRECTORY|O_CLOEXEC);
+    if (fds[3] == -1)
+        /* the working directory has been removed */
+        return -1;
+    if (!send_with_fds(zygote_socket, request, len, fds)) {
+        close(fds[3]);
+        stop_zygote();
+        return -1;
+    }
+    close(fds[3]);
+    pid = receive_pid();
+    if (pid == 0)
+        /* the zygote has exited */
+        stop_zygote();
+    return (pid > 0) ? pid : -1;
+}
+
+void stop_zygote()
+{
+    /* the zygote exits once its end of the socket reads EOF */
+    if (zygote_socket == -1)
+        return;
+    close(zygote_socket);
+    zygote_socket = -1;
+}
+#endif
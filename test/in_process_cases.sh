@@ -0,0 +1,66 @@
+#!/usr/bin/env bash
+# Writes the `in_process_cases.h` of the `in_process_test.c` to `stdout`. The
+# cases are those of the `print_tokens_test.sh` and of the
+# `session_test.sh`, so the tests can't drift apart. Run by the `make
+# in_process_test`, which builds the test with the header made.
+
+source ./test/print_tokens_cases.sh
+source ./test/session_cases.sh
+
+# prints the text as a C string literal, a line of the text for a line of the
+# literal
+c_string() {
+    local text=$1 last_newline=""
+    if [[ "$text" = *$'\n' ]]; then
+        text=${text%$'\n'}
+        last_newline='\n'
+    fi
+    text=${text//\\/\\\\}
+    text=${text//\"/\\\"}
+    text=${text//$'\t'/\\t}
+    text=${text//$'\r'/\\r}
+    text=${text//$'\n'/\\n\"$'\n'        \"}
+    printf '        "%s%s"' "$text" "$last_newline"
+}
+
+print_case() {
+    printf '    {\n%s,\n%s\n    },\n' "$(c_string "$1")" "$(c_string "$2")"
+}
+
+paced() {
+    local number
+    for number in "${paced_sequences[@]}"; do
+        [[ "$number" = "$1" ]] && return 0
+    done
+    return 1
+}
+
+cat <<'END'
+/* in_process_cases.h */
+/* made by the `in_process_cases.sh`, don't edit. A token case is the input of
+the `print_tokens_test.sh` with the tokens it prints; a session case is a
+sequence of the `session_test.sh` run as a script by a fresh shell, with what
+it writes to `stdout` and `stderr`, the outputs of its commands one after
+another. Both are compared with the trailing newlines removed */
+
+static const token_case token_cases[] = {
+END
+for idx in "${!input[@]}"; do
+    print_case "${input[idx]}" "${expected[idx]}"
+done
+printf '};\n\nstatic const session_case session_cases[] = {\n'
+expected_start=0
+for idx in "${!sequences[@]}"; do
+    IFS=$'\n' read -d '' -ra commands <<< "${sequences[idx]}"
+    output=""
+    for ((i = expected_start; i < expected_start + ${#commands[@]}; i++)); do
+        if [[ -n "${expected_outputs[i]}" ]]; then
+            output+="${output:+$'\n'}${expected_outputs[i]}"
+        fi
+    done
+    expected_start=$((expected_start + ${#commands[@]}))
+    if ! paced $((idx+1)); then
+        print_case "${sequences[idx]}"$'\n' "$output"
+    fi
+done
+echo "};"
@@ -0,0 +1,248 @@
+/* in_process_test.c */
+/* runs the cases of the `in_process_cases.h`, which the `make` generates of
+those of the test scripts, without starting a shell for every one of them: the test is linked with the objects of the shell, and a
+case is parsed from a fresh `string`. A token case goes through the lexer,
+which dumps the tokens as the token printing build prints them; a session
+case is run by the executor in a forked child, so the variables, the working
+directory and the `exit` of one case don't reach the others. The cases are
+shared among the worker processes, one for each core unless `-j N` is given.
+The scripts of the `test` directory still test the shell end to end */
+
+#if !defined(EXEC_MODE)
+#error The test is linked with the objects of the EXEC_MODE build
+#endif
+
+#define _GNU_SOURCE
+#include "aliases.h"
+#include "cmd_execution.h"
+#include "control_flow.h"
+#include "job_log.h"
+#include "str_parsing.h"
+#include "token_dump.h"
+#include "variables.h"
+#include "zombie_handling.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef struct tag_token_case {
+    const char *input;
+    const char *expected;
+} token_case;
+
+typedef struct tag_session_case {
+    const char *script;
+    const char *expected;
+} session_case;
+
+#include "in_process_cases.h"
+
+#define USAGE "usage: %s [-j N]\n"
+#define SEPARATOR_LINE \
+    "--------------------------------------------------------------------------------\n"
+
+enum in_process_test_consts {
+    token_cases_len = sizeof(token_cases)/sizeof(token_cases[0]),
+    session_cases_len = sizeof(session_cases)/sizeof(session_cases[0]),
+    cases_len = token_cases_len + session_cases_len
+};
+
+/* the output of a case is written to the `capture_fd` file, the test's own
+`stdout` and `stderr` are kept in the `saved_fd`, the worker reports the
+number of its failed cases to the `failed_fd` */
+static int capture_fd = -1;
+static int saved_fd[2] = { -1, -1 };
+static int failed_fd = -1;
+
+static void start_capture()
+{
+    ftruncate(capture_fd, 0);
+    lseek(capture_fd, 0, SEEK_SET);
+    fflush(stdout);
+    dup2(capture_fd, STDOUT_FILENO);
+    dup2(capture_fd, STDERR_FILENO);
+}
+
+static char *finish_capture()
+{
+    /* returns the output with the trailing newlines removed, the way the
+    `$(...)` of the test scripts gets it */
+    off_t len;
+    char *output;
+    fflush(stdout);
+    dup2(saved_fd[0], STDOUT_FILENO);
+    dup2(saved_fd[1], STDERR_FILENO);
+    len = lseek(capture_fd, 0, SEEK_END);
+    output = malloc(len+1);
+    if (pread(capture_fd, output, len, 0) != len)
+        len = 0;
+    while (len > 0 && output[len-1] == '\n')
+        len--;
+    output[len] = '\0';
+    return output;
+}
+
+static void parse_text(string *str)
+{
+    while (
+        !shell_exit_requested() && (str->c=read_next_character(str)) != EOF
+    ) {
+        process_character(str);
+        if (str->str_ended)
+            process_end_of_string(str);
+    }
+}
+
+static void run_token_case(const char *input)
+{
+    /* the input is given as the here-string of the `print_tokens_test.sh`,
+    with a newline appended */
+    string str;
+    int len = strlen(input);
+    char *text = malloc(len+1);
+    memcpy(text, input, len);
+    text[len] = '\n';
+    start_token_dump(NULL);
+    init_str(&str, text, len+1);
+    str.tokens_only = true;
+    str.expansion_only = true;
+    parse_text(&str);
+    free_str_memory(&str);
+    finish_token_dump();
+    free(text);
+}
+
+static void run_session_case(const char *script)
+{
+    /* the child is the shell running the script the way `my_shell -c` does,
+    and cleans up as it does, so the leaks are reported into the output. It
+    has only the standard descriptors open, as the shell has */
+    pid_t pid = fork();
+    if (pid == 0) {
+        string str;
+        close(capture_fd);
+        close(saved_fd[0]);
+        close(saved_fd[1]);
+        close(failed_fd);
+        init_str(&str, script, strlen(script));
+        str.non_interactive = true;
+        init_variables();
+        set_signal_disposition(SIGCHLD, handle_background_zombie_process);
+        parse_text(&str);
+        free_str_memory(&str);
+        free_functions();
+        free_aliases();
+        free_variables();
+        free_pipeline_statuses();
+        free_job_logs();
+        exit(last_exit_status());
+    }
+    if (pid > 0)
+        waitpid(pid, NULL, 0);
+    else
+        perror("fork");
+}
+
+static bool run_case(int idx)
+{
+    const char *input, *expected;
+    char *actual;
+    bool passed;
+    start_capture();
+    if (idx < token_cases_len) {
+        input = token_cases[idx].input;
+        expected = token_cases[idx].expected;
+        run_token_case(input);
+    } else {
+        input = session_cases[idx - token_cases_len].script;
+        expected = session_cases[idx - token_cases_len].expected;
+        run_session_case(input);
+    }
+    actual = finish_capture();
+    passed = (0 == strcmp(expected, actual));
+    if (!passed)
+        dprintf(saved_fd[0],
+            SEPARATOR_LINE "\nTEST\n%s\nFAILED: expected: \n%s\ngot: \n%s\n\n"
+            SEPARATOR_LINE, input, expected, actual);
+    free(actual);
+    return passed;
+}
+
+static int run_worker(int worker, int workers)
+{
+    /* runs every `workers`-th case, starting with the `worker`-th one, and
+    returns the number of those failed */
+    int idx, failed = 0;
+    capture_fd = memfd_create("in_process_test", MFD_CLOEXEC);
+    saved_fd[0] = dup(STDOUT_FILENO);
+    saved_fd[1] = dup(STDERR_FILENO);
+    if (capture_fd == -1 || saved_fd[0] == -1 || saved_fd[1] == -1) {
+        perror("in_process_test");
+        return cases_len;
+    }
+    for (idx = worker; idx < cases_len; idx += workers)
+        if (!run_case(idx))
+            failed++;
+    close(capture_fd);
+    close(saved_fd[0]);
+    close(saved_fd[1]);
+    return failed;
+}
+
+static int workers_number(int argc, char **argv)
+{
+    /* 0 for a wrong option */
+    int workers;
+    if (argc == 1)
+        workers = sysconf(_SC_NPROCESSORS_ONLN);
+    else
+    if (argc == 3 && 0 == strcmp(argv[1], "-j"))
+        workers = atoi(argv[2]);
+    else
+        return 0;
+    return (workers > cases_len) ? cases_len : workers;
+}
+
+int main(int argc, char **argv)
+{
+    /* every worker writes the number of its failed cases to the pipe, a
+    worker crashed or with leaks found at its exit counts as one more */
+    int workers = workers_number(argc, argv);
+    int worker, fd[2], status, failed = 0, worker_failed;
+    if (workers < 1) {
+        fprintf(stderr, USAGE, argv[0]);
+        return 2;
+    }
+    if (pipe(fd) == -1) {
+        perror("pipe");
+        return 1;
+    }
+    fflush(stdout);
+    for (worker = 0; worker < workers; worker++)
+        if (fork() == 0) {
+            close(fd[0]);
+            failed_fd = fd[1];
+            worker_failed = run_worker(worker, workers);
+            write(failed_fd, &worker_failed, sizeof(worker_failed));
+            close(failed_fd);
+            exit(0);
+        }
+    close(fd[1]);
+    while (read(fd[0], &worker_failed, sizeof(worker_failed)) ==
+        sizeof(worker_failed))
+    {
+        failed += worker_failed;
+    }
+    close(fd[0]);
+    while (wait(&status) > 0)
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            failed++;
+    if (failed == 0)
+        printf("OK\n");
+    else
+        printf("%d of %d cases FAILED\n", failed, cases_len);
+    return failed ? 1 : 0;
+}
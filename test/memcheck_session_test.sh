@@ -4,62 +4,7 @@ set -o pipefail
 
 valgrind_command="valgrind --error-exitcode=42 --tool=memcheck --leak-check=full --errors-for-leak-kinds=definite,indirect,possible --show-leak-kinds=definite,indirect,possible"
 
-sequences=(
-"mkdir dir
-cd dir
-echo one > dir_file.txt
-cat dir_file.txt
-echo one > background_work_test.txt &
-cat background_work_test.txt
-echo one > background_work_test_2.txt&
-cat background_work_test.txt
-echo two > dir_file.txt
-cat dir_file.txt
-../test/test_program < non_existing_file
-../test/test_program < dir_file.txt
-echo one >> dir_file_2.txt
-cat dir_file_2.txt
-echo two >> dir_file_2.txt
-cat dir_file_2.txt
-> dir_file_3.txt
-cat dir_file_3.txt
-> dir_file.txt
-cat dir_file.txt
-< non_existing_file
-< dir_file_2.txt
-cat dir_file_2.txt
->> dir_file_4.txt
-cat dir_file_4.txt
->> dir_file_2.txt
-cat dir_file_2.txt
-../test/test_program < dir_file_2.txt > dir_file.txt
-cat dir_file.txt
-../test/test_program > dir_file.txt < dir_file_2.txt
-cat dir_file.txt
-../test/test_program > dir_file.txt < dir_file_2.txt &
-cat dir_file.txt
-> dir_file_2.txt
-../test/test_program > dir_file_2.txt dir_file.txt
-> ../test/test_program < dir_file.txt dir_file.txt
-../test/test_program > dir_file_2.txt dir_file.txt blabla
-../test/test_program < dir_file_2.txt dir_file.txt blabla
-../test/test_program >> dir_file.txt dir_file.txt
-../test/test_program >> dir_file.txt dir_file.txt blabla
-../test/test_program > dir_file_2.txt > dir_file.txt
-../test/test_program < dir_file.txt < dir_file_2.txt
-../test/test_program >> dir_file_2.txt > dir_file.txt
-../test/test_program > dir_file_2.txt >> dir_file.txt
-../test/test_program > && dir_file_2.txt
-../test/test_program>&&dir_file_2.txt
-cat dir_file_2.txt
-cat dir_file.txt
-cat ../LICENSE.txt | ../test/test_program | head -n 3
-cat ../LICENSE.txt | ../test/test_program | head -n 3 | grep 2024
-cat ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-cat < ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-cd ..
-rm -r dir"
-)
+source ./test/session_cases.sh
 
 tmp_dir=$(mktemp -d)
 pipe="$tmp_dir/pipe"
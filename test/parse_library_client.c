@@ -0,0 +1,91 @@
+/* parse_library_client.c */
+/* parses `stdin` with the parsing library and prints the plan of every
+command line, or the error message. The memory comes from a counting
+allocator, which has to get all of it back */
+
+#include "my_shell_parse.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static long allocated_blocks = 0;
+
+static void *counting_realloc(void *ctx, void *ptr, size_t size)
+{
+    long *blocks = ctx;
+    if (size == 0) {
+        free(ptr);
+        (*blocks)--;
+        return NULL;
+    }
+    if (!ptr)
+        (*blocks)++;
+    return realloc(ptr, size);
+}
+
+static void print_fd_operation(const fd_operation *op)
+{
+    /* the descriptor is printed if it isn't the default one of the
+    operator, or for a copied and a closed one */
+    static const char *const open_operators[] = { "<", ">", ">>", "<>" };
+    const char *operator = open_operators[op->mode];
+    if (op->type == duplicate_fd_operation) {
+        printf(" %d>&%d", op->fd, op->target_fd);
+        return;
+    }
+    if (op->type == close_fd_operation) {
+        printf(" %d>&-", op->fd);
+        return;
+    }
+    if (op->source != file_source)
+        operator = (op->source == here_document_source) ? "<<" : "<<<";
+    if (op->fd != ((operator[0] == '<') ? 0 : 1))
+        printf(" %d%s [%s]", op->fd, operator, op->redirection_file);
+    else
+        printf(" %s [%s]", operator, op->redirection_file);
+}
+
+static void print_line(const parsed_line *line, void *data)
+{
+    const execvp_cmd_line *stage;
+    (void)data;
+    if (line->err) {
+        fputs(parse_error_message(line->err), stdout);
+        return;
+    }
+    for (stage = line->stages; stage; stage = stage->next) {
+        char **arg;
+        int i;
+        if (stage != line->stages)
+            printf("| ");
+        for (arg = stage->arr; *arg; arg++)
+            printf((arg == stage->arr) ? "[%s]" : " [%s]", *arg);
+        for (i = 0; i < stage->fd_ops_len; i++)
+            print_fd_operation(&stage->fd_ops[i]);
+        printf("\n");
+    }
+    if (line->background_execution)
+        printf("&\n");
+}
+
+int main()
+{
+    parse_allocator allocator = { counting_realloc, &allocated_blocks };
+    shell_parser *parser = new_shell_parser(&allocator);
+    char *text = NULL;
+    size_t len = 0, text_len = 0;
+    int c;
+    while ((c=getchar()) != EOF) {
+        if (len == text_len) {
+            text_len = text_len ? text_len*2 : 4096;
+            text = realloc(text, text_len);
+        }
+        text[len] = c;
+        len++;
+    }
+    parse_shell_text(parser, text, len, true, print_line, NULL);
+    free_shell_parser(parser);
+    free(text);
+    if (allocated_blocks != 0)
+        printf("blocks not freed: %ld\n", allocated_blocks);
+    return 0;
+}
@@ -0,0 +1,100 @@
+#!/usr/bin/env bash
+# The parsing library, linked statically and dynamically into
+# `parse_library_client.c`, which prints the plan of every command line it's
+# given, or the error message. Run by `make parse_library_test`, which builds
+# the library first.
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf "$tmp_dir"' EXIT
+
+gcc -Wall -Wextra -Iinclude test/parse_library_client.c build/lib/libmy_shell_parse.a \
+    -o "$tmp_dir/static_client" || exit 1
+gcc -Wall -Wextra -Iinclude test/parse_library_client.c -Lbuild/lib -lmy_shell_parse \
+    -o "$tmp_dir/shared_client" || exit 1
+
+input=()
+expected=()
+
+input+=( $'cat < in | sort -r > out &' )
+expected+=( $'[cat] < [in]\n| [sort] [-r] > [out]\n&' )
+
+input+=( $'echo "a  b" $x $(ls -l) >> log' )
+expected+=( $'[echo] [a  b] [$x] [$(ls -l)] >> [log]' )
+
+input+=( $'first\n\n   \nsecond | third\n' )
+expected+=( $'[first]\n[second]\n| [third]' )
+
+input+=( $'cat <<END\none\ntwo\nEND\nwc <<< "three four"' )
+expected+=( $'[cat] << [one\ntwo\n]\n[wc] <<< [three four]' )
+
+input+=( $'| a' )
+expected+=( $'my_shell: Error: | at start of the string or two | in a row' )
+
+input+=( $'a | | b' )
+expected+=( $'my_shell: Error: | at start of the string or two | in a row' )
+
+input+=( $'a & b' )
+expected+=( $'my_shell: Error: & not in the end of string' )
+
+input+=( $'a > | b' )
+expected+=( $'my_shell: Error: separator right after IO redirection' )
+
+input+=( $'a > f g' )
+expected+=( $'my_shell: Error: 2nd file name after IO redirection' )
+
+input+=( $'a > f >> g' )
+expected+=( $'my_shell: Error: > or < used twice, or > together with >>' )
+
+input+=( $'make 2> err 3>&2 4>&- 5<> f | cat &>> all' )
+expected+=( $'[make] 2> [err] 3>&2 4>&- 5<> [f]\n| [cat] >> [all] 2>&1' )
+
+input+=( $'a 2>&1 2> f' )
+expected+=( $'my_shell: Error: > or < used twice, or > together with >>' )
+
+input+=( $'a >& f' )
+expected+=( $'my_shell: Error: a file descriptor or - expected after >& or <&' )
+
+input+=( $'a 2>' )
+expected+=( $'my_shell: Error: separator right after IO redirection' )
+
+input+=( $'echo "abra' )
+expected+=( $'my_shell: Error: unmatched quotes' )
+
+input+=( $'echo ab\\ra' )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( $'echo $(ls' )
+expected+=( $'my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)' )
+
+input+=( $'echo ${x' )
+expected+=( $'my_shell: Error: bad substitution' )
+
+input+=( $'a ; b' )
+expected+=( $'my_shell: feature not implemented yet' )
+
+# the lines after one with an error are parsed all the same
+input+=( $'a | | b\nc > d' )
+expected+=( $'my_shell: Error: | at start of the string or two | in a row\n[c] > [d]' )
+
+i=0
+arr_len=${#input[@]}
+for idx in "${!input[@]}"; do
+    for client in static_client shared_client; do
+        actual=$(printf '%s' "${input[idx]}" |
+            LD_LIBRARY_PATH=build/lib "$tmp_dir/$client" 2>&1)
+        if [[ "${expected[idx]}" != "$actual" ]]; then
+            printf -- '--------------------------------------------------------------------------------\n'
+            printf '\nTEST (%s)\n%b\nFAILED: expected: \n%b\ngot: \n%b\n\n' \
+              "$client" \
+              "${input[idx]}" \
+              "${expected[idx]}" \
+              "$actual"
+            printf -- '--------------------------------------------------------------------------------\n'
+            continue 2
+        fi
+    done
+    i=$((i+1))
+done
+if [[ "$i" = "$arr_len" ]]; then
+    echo OK
+fi
@@ -0,0 +1,494 @@
+# The cases of the `print_tokens_test.sh`: the input given to the shell built
+# in the token printing mode, and the tokens it prints. Sourced by the test,
+# and by the `in_process_cases.sh`, which makes the cases of the in-process
+# test of them
+
+input=()
+expected=()
+
+input+=( $'abra schwabra kadabra\n' )
+expected+=( $'[abra]\n[schwabra]\n[kadabra]' );
+
+input+=( "abra   " )
+expected+=( $'[abra]' )
+
+input+=( $'     abra\t\tschwabra \t \tkadabra' )
+expected+=( $'[abra]\n[schwabra]\n[kadabra]' )
+
+input+=( $'abra \"schwabra kadabra\" \"foo    bar\"\n' )
+expected+=( $'[abra]\n[schwabra kadabra]\n[foo    bar]' )
+
+input+=( $'abra schw\"abra ka\"dab\"ra\" foo\"    \"bar\n' )
+expected+=( $'[abra]\n[schwabra kadabra]\n[foo    bar]' )
+
+input+=( $'\\\"abra\\\" \\\"schwabra\\\" \\\"kadabra\\\"' )
+expected+=( $'[\"abra\"]\n[\"schwabra\"]\n[\"kadabra\"]' );
+
+input+=( $'\\\\abra\\\\ \\\\schwabra\\\\ \\\\kadabra\\\\' )
+expected+=( $'[\\abra\\]\n[\\schwabra\\]\n[\\kadabra\\]' );
+
+input+=( $'abra \\\\s\\\"c\\\\h\\\"w\\\\a\\\"b\\\\r\\\"a\\\\ kadabra' )
+expected+=( $'[abra]\n[\\s\"c\\h\"w\\a\"b\\r\"a\\]\n[kadabra]' );
+
+input+=( $'abra \\\\schw\"abra\\\\\\\"ka\"dab\"ra\\\"\" foo\"    \"bar' )
+expected+=( $'[abra]\n[\\schwabra\\\"kadabra\"]\n[foo    bar]' )
+
+input+=( $'abra \\\\schw\"a\\\\b\\\\ra\\\"k\\\"a\"dab\"ra\\\"\" foo\"    \"bar' )
+expected+=( $'[abra]\n[\\schwa\\b\\ra\"k\"adabra\"]\n[foo    bar]' )
+
+input+=( $'abra \\\\schw\"a\\\\b\\\"ra\\\\k\\\"a\"dab\"ra\\\"\" foo\"    \"bar' )
+expected+=( $'[abra]\n[\\schwa\\b\"ra\\k\"adabra\"]\n[foo    bar]' )
+
+input+=( $'abra schwabra kadabra\"  foo bar' )
+expected+=( $'my_shell: Error: unmatched quotes' )
+
+input+=( $'word \"' )
+expected+=( $'my_shell: Error: unmatched quotes' )
+
+input+=( $'abra schw\"abraka\"dab\"ra\"\\ foo\"    \"bar' )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( $'abra schw\"abra ka\"dab\"r\\a\" foo\"    \"bar' )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( $'abra schw\"abra\\ ka\"dab\"ra\" foo\"    \"bar' )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( $'abra schw\"abra ka\"dab\"ra\" f\\oo\"    \"bar' )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( $'abra schw\\\"abra ka\"dab\"ra\" foo\"    \"bar' )
+expected+=( $'my_shell: Error: unmatched quotes' )
+
+input+=( "abraschwabrakadabra" )
+expected+=( "[abraschwabrakadabra]" )
+
+input+=( $'w\"  \"\"  \"ord' )
+expected+=( $'[w    ord]' )
+
+input+=( $'w\"o \"\" r\"d' )
+expected+=( $'[wo  rd]' )
+
+input+=( "    " )
+expected+=( "" )
+
+input+=( $' \t  \t  \t\t ' )
+expected+=( "" )
+
+input+=( $'\"\"' )
+expected+=( "[]" )
+
+input+=( $'\"\"\"\"' )
+expected+=( "[]" )
+
+input+=( $'\"\" \t\"\"' )
+expected+=( $'[]\n[]' )
+
+input+=( $' \"\" \t\"\" ' )
+expected+=( $'[]\n[]' )
+
+input+=( $'\"\" word1 word2' )
+expected+=( $'[]\n[word1]\n[word2]' )
+
+input+=( $'word1 \"\" word2' )
+expected+=( $'[word1]\n[]\n[word2]' )
+
+input+=( $'word1 word2 \"\" word3' )
+expected+=( $'[word1]\n[word2]\n[]\n[word3]' )
+
+input+=( $'word1 word2 \"\"' )
+expected+=( $'[word1]\n[word2]\n[]' )
+
+input+=( $'word1 \"\"word2' )
+expected+=( $'[word1]\n[word2]' )
+
+input+=( $'word1 \"\"word2' )
+expected+=( $'[word1]\n[word2]' )
+
+input+=( $'w\"  \"\"  \"ord' )
+expected+=( $'[w    ord]' )
+
+input+=( $'w\"o \"\" r\"d' )
+expected+=( $'[wo  rd]' )
+
+input+=( $'word \"\"' )
+expected+=( $'[word]\n[]' )
+
+input+=( $'a \"It is a super long string, you see, I could actually overcome the bug where I unfortunately missed the issue that my tmp_wrd_array size was doubled only once, instead of being doubled every time the index value equals array size - 1. So lets see if everything is fine now.\" b' )
+expected+=( $'[a]\n[It is a super long string, you see, I could actually overcome the bug where I unfortunately missed the issue that my tmp_wrd_array size was doubled only once, instead of being doubled every time the index value equals array size - 1. So lets see if everything is fine now.]\n[b]' )
+
+# Separators work check
+input+=( "a & b" )
+expected+=( $'[a]\n[background_operator]\n[b]' )
+
+input+=( "a&b" )
+expected+=( $'[a]\n[background_operator]\n[b]' )
+
+input+=( "a && b" )
+expected+=( $'[a]\n[and_operator]\n[b]' )
+
+input+=( "a&&b" )
+expected+=( $'[a]\n[and_operator]\n[b]' )
+
+input+=( "a &&& b" )
+expected+=( $'[a]\n[and_operator]\n[background_operator]\n[b]' )
+
+input+=( "a&&&b" )
+expected+=( $'[a]\n[and_operator]\n[background_operator]\n[b]' )
+
+input+=( "a &&&& b" )
+expected+=( $'[a]\n[and_operator]\n[and_operator]\n[b]' )
+
+input+=( "a&&&&b" )
+expected+=( $'[a]\n[and_operator]\n[and_operator]\n[b]' )
+
+input+=( "a &&&&& b" )
+expected+=( $'[a]\n[and_operator]\n[and_operator]\n[background_operator]\n[b]' )
+
+input+=( "a&&&&&b" )
+expected+=( $'[a]\n[and_operator]\n[and_operator]\n[background_operator]\n[b]' )
+
+input+=( "&" )
+expected+=( $'[background_operator]' )
+
+input+=( "&&" )
+expected+=( $'[and_operator]' )
+
+input+=( "&&&" )
+expected+=( $'[and_operator]\n[background_operator]' )
+
+input+=( "&&&&" )
+expected+=( $'[and_operator]\n[and_operator]' )
+
+input+=( "&&&&&" )
+expected+=( $'[and_operator]\n[and_operator]\n[background_operator]' )
+
+input+=( "a\"&\"b" )
+expected+=( $'[a&b]' )
+
+input+=( "a \"&\" b" )
+expected+=( $'[a]\n[&]\n[b]' )
+
+input+=( "a \\& b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\&" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+# ------------------------------------------------------------------------------
+input+=( "a > b" )
+expected+=( $'[a]\n[output_redirection]\n[b]' )
+
+input+=( "a>b" )
+expected+=( $'[a]\n[output_redirection]\n[b]' )
+
+input+=( "a >> b" )
+expected+=( $'[a]\n[output_append_redirection]\n[b]' )
+
+input+=( "a>>b" )
+expected+=( $'[a]\n[output_append_redirection]\n[b]' )
+
+input+=( "a >>> b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_redirection]\n[b]' )
+
+input+=( "a>>>b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_redirection]\n[b]' )
+
+input+=( "a >>>> b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_append_redirection]\n[b]' )
+
+input+=( "a>>>>b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_append_redirection]\n[b]' )
+
+input+=( "a >>>>> b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_append_redirection]\n[output_redirection]\n[b]' )
+
+input+=( "a>>>>>b" )
+expected+=( $'[a]\n[output_append_redirection]\n[output_append_redirection]\n[output_redirection]\n[b]' )
+
+input+=( ">" )
+expected+=( $'[output_redirection]' )
+
+input+=( ">>" )
+expected+=( $'[output_append_redirection]' )
+
+input+=( ">>>" )
+expected+=( $'[output_append_redirection]\n[output_redirection]' )
+
+input+=( ">>>>" )
+expected+=( $'[output_append_redirection]\n[output_append_redirection]' )
+
+input+=( ">>>>>" )
+expected+=( $'[output_append_redirection]\n[output_append_redirection]\n[output_redirection]' )
+
+input+=( "a\">\"b" )
+expected+=( $'[a>b]' )
+
+input+=( "a \">\" b" )
+expected+=( $'[a]\n[>]\n[b]' )
+
+input+=( "a \\> b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\>" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+# ------------------------------------------------------------------------------
+# ------------------------------------------------------------------------------
+input+=( "a | b" )
+expected+=( $'[a]\n[pipe_operator]\n[b]' )
+
+input+=( "a|b" )
+expected+=( $'[a]\n[pipe_operator]\n[b]' )
+
+input+=( "a || b" )
+expected+=( $'[a]\n[or_operator]\n[b]' )
+
+input+=( "a||b" )
+expected+=( $'[a]\n[or_operator]\n[b]' )
+
+input+=( "a ||| b" )
+expected+=( $'[a]\n[or_operator]\n[pipe_operator]\n[b]' )
+
+input+=( "a|||b" )
+expected+=( $'[a]\n[or_operator]\n[pipe_operator]\n[b]' )
+
+input+=( "a |||| b" )
+expected+=( $'[a]\n[or_operator]\n[or_operator]\n[b]' )
+
+input+=( "a||||b" )
+expected+=( $'[a]\n[or_operator]\n[or_operator]\n[b]' )
+
+input+=( "a ||||| b" )
+expected+=( $'[a]\n[or_operator]\n[or_operator]\n[pipe_operator]\n[b]' )
+
+input+=( "a|||||b" )
+expected+=( $'[a]\n[or_operator]\n[or_operator]\n[pipe_operator]\n[b]' )
+
+input+=( "|" )
+expected+=( $'[pipe_operator]' )
+
+input+=( "||" )
+expected+=( $'[or_operator]' )
+
+input+=( "|||" )
+expected+=( $'[or_operator]\n[pipe_operator]' )
+
+input+=( "||||" )
+expected+=( $'[or_operator]\n[or_operator]' )
+
+input+=( "|||||" )
+expected+=( $'[or_operator]\n[or_operator]\n[pipe_operator]' )
+
+input+=( "a\"|\"b" )
+expected+=( $'[a|b]' )
+
+input+=( "a \"|\" b" )
+expected+=( $'[a]\n[|]\n[b]' )
+
+input+=( "a \\| b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\|" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+# ------------------------------------------------------------------------------
+
+input+=( "a < b" )
+expected+=( $'[a]\n[input_redirection]\n[b]' )
+
+input+=( "a<b" )
+expected+=( $'[a]\n[input_redirection]\n[b]' )
+
+input+=( $'a << b\nb' )
+expected+=( $'[a]\n[here_document]\n[]' )
+
+input+=( $'a<<b\nb' )
+expected+=( $'[a]\n[here_document]\n[]' )
+
+input+=( "<" )
+expected+=( $'[input_redirection]' )
+
+input+=( "<<" )
+expected+=( $'[here_document]' )
+
+input+=( "a\"<\"b" )
+expected+=( $'[a<b]' )
+
+input+=( "a \"<\" b" )
+expected+=( $'[a]\n[<]\n[b]' )
+
+input+=( "a \\< b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\<" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+# ------------------------------------------------------------------------------
+
+input+=( "a ; b" )
+expected+=( $'[a]\n[command_separator]\n[b]' )
+
+input+=( "a;b" )
+expected+=( $'[a]\n[command_separator]\n[b]' )
+
+input+=( "a ;; b" )
+expected+=( $'[a]\n[command_separator]\n[command_separator]\n[b]' )
+
+input+=( "a;;b" )
+expected+=( $'[a]\n[command_separator]\n[command_separator]\n[b]' )
+
+input+=( ";" )
+expected+=( $'[command_separator]' )
+
+input+=( ";;" )
+expected+=( $'[command_separator]\n[command_separator]' )
+
+input+=( "a\";\"b" )
+expected+=( $'[a;b]' )
+
+input+=( "a \";\" b" )
+expected+=( $'[a]\n[;]\n[b]' )
+
+# ------------------------------------------------------------------------------
+
+input+=( "a ( b" )
+expected+=( $'[a]\n[open_parenthesis]\n[b]' )
+
+input+=( "a(b" )
+expected+=( $'[a]\n[open_parenthesis]\n[b]' )
+
+input+=( "a (( b" )
+expected+=( $'[a]\n[open_parenthesis]\n[open_parenthesis]\n[b]' )
+
+input+=( "a((b" )
+expected+=( $'[a]\n[open_parenthesis]\n[open_parenthesis]\n[b]' )
+
+input+=( "(" )
+expected+=( $'[open_parenthesis]' )
+
+input+=( "((" )
+expected+=( $'[open_parenthesis]\n[open_parenthesis]' )
+
+input+=( "a\"(\"b" )
+expected+=( $'[a(b]' )
+
+input+=( "a \"(\" b" )
+expected+=( $'[a]\n[(]\n[b]' )
+
+input+=( "a \\( b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\(" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+# ------------------------------------------------------------------------------
+
+input+=( "a ) b" )
+expected+=( $'[a]\n[close_parenthesis]\n[b]' )
+
+input+=( "a)b" )
+expected+=( $'[a]\n[close_parenthesis]\n[b]' )
+
+input+=( "a )) b" )
+expected+=( $'[a]\n[close_parenthesis]\n[close_parenthesis]\n[b]' )
+
+input+=( "a))b" )
+expected+=( $'[a]\n[close_parenthesis]\n[close_parenthesis]\n[b]' )
+
+input+=( ")" )
+expected+=( $'[close_parenthesis]' )
+
+input+=( "))" )
+expected+=( $'[close_parenthesis]\n[close_parenthesis]' )
+
+input+=( "a\")\"b" )
+expected+=( $'[a)b]' )
+
+input+=( "a \")\" b" )
+expected+=( $'[a]\n[)]\n[b]' )
+
+input+=( "a \\) b" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "\\)" )
+expected+=( $'my_shell: Error: only the characters `\"`, `\\` and `$` can be escaped' )
+
+input+=( "&>" )
+expected+=( $'[output_error_redirection]' )
+
+input+=( "&>|&" )
+expected+=( $'[output_error_redirection]\n[pipe_operator]\n[background_operator]' )
+
+input+=( $'&\"&\"&' )
+expected+=( $'[background_operator]\n[&]\n[background_operator]' )
+
+input+=( $'\"&>\"|&' )
+expected+=( $'[&>]\n[pipe_operator]\n[background_operator]' )
+
+input+=( "<;()" )
+expected+=( $'[input_redirection]\n[command_separator]\n[open_parenthesis]\n[close_parenthesis]' )
+
+input+=( $'<\";(\")' )
+expected+=( $'[input_redirection]\n[;(]\n[close_parenthesis]' )
+
+input+=( "a <<< b" )
+expected+=( $'[a]\n[here_string]\n[b]' )
+
+input+=( "a<<<b<c" )
+expected+=( $'[a]\n[here_string]\n[b]\n[input_redirection]\n[c]' )
+
+input+=( $'a \"<<<\" b' )
+expected+=( $'[a]\n[<<<]\n[b]' )
+
+input+=( $'a << end\nfirst line\nsecond line\nend' )
+expected+=( $'[a]\n[here_document]\n[first line\nsecond line\n]' )
+
+input+=( $'a<<end|b\nline\nend' )
+expected+=( $'[a]\n[here_document]\n[line\n]\n[pipe_operator]\n[b]' )
+
+input+=( $'a $(b c) d' )
+expected+=( $'[a]\n[$(b c)]\n[d]' )
+
+input+=( $'a x$(b $(c) \")\")y' )
+expected+=( $'[a]\n[x$(b $(c) \")\")y]' )
+
+input+=( $'a $b $' )
+expected+=( $'[a]\n[$b]\n[$]' )
+
+input+=( $'a $(b c' )
+expected+=( $'my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)' )
+
+input+=( $'a ${b}c $d_1-e "$f g"' )
+expected+=( $'[a]\n[${b}c]\n[$d_1-e]\n[$f g]' )
+
+input+=( $'a ${b c} d' )
+expected+=( $'my_shell: Error: bad substitution' )
+
+input+=( $'a \\$b \"\\$(c)\" \\${d}' )
+expected+=( $'[a]\n[$b]\n[$(c)]\n[${d}]' )
+
+input+=( $'a $((1 + (2 * b))) c$((d))' )
+expected+=( $'[a]\n[$((1 + (2 * b)))]\n[c$((d))]' )
+
+input+=( $'a $((1 + 2) b' )
+expected+=( $'my_shell: Error: unmatched parenthesis in $(...), <(...) or >(...)' )
+
+input+=( $'a <(b c) >(d) e<(f)' )
+expected+=( $'[a]\n[<(b c)]\n[>(d)]\n[e]\n[<(f)]' )
+
+input+=( $'a < <(b) > >(c)' )
+expected+=( $'[a]\n[input_redirection]\n[<(b)]\n[output_redirection]\n[>(c)]' )
+
+input+=( $'a "<(b)" >>(c)' )
+expected+=( $'[a]\n[<(b)]\n[output_append_redirection]\n[open_parenthesis]\n[c]\n[close_parenthesis]' )
+
+input+=( $'a 2> b 2>&1 >&- 3<> c' )
+expected+=( $'[a]\n[output_redirection 2]\n[b]\n[duplication_redirection 2]\n[1]\n[duplication_redirection 1]\n[-]\n[input_output_redirection 3]\n[c]' )
+
+input+=( $'a&>b &>> c 0<&3 12>d "2">e' )
+expected+=( $'[a]\n[output_error_redirection]\n[b]\n[output_error_append_redirection]\n[c]\n[duplication_redirection 0]\n[3]\n[12]\n[output_redirection]\n[d]\n[2]\n[output_redirection]\n[e]' )
+
+# Simulate EOF with empty input
+input+=( "" )
+expected+=( "" )
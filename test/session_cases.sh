@@ -0,0 +1,1029 @@
+# The cases of the `session_test.sh`: the sequences of commands, each one run
+# by a shell of its own, and the output expected after every command. Sourced
+# by the test, by the `memcheck_session_test.sh` and by the
+# `in_process_cases.sh`, which makes the cases of the in-process test of them
+
+# Test sequences - each sequence represents a continuous shell session
+sequences=(
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `> non_existing_file`       (create `non_existing_file`);
+    #       `> existing_file`           (clear `existing_file`);
+    #       `< non_existing_file`       (error);
+    #       `< existing_file`           (nothing happens);
+    #       `>> non_existing_file`      (create `non_existing_file`);
+    #       `>> existing_file`          (nothing happens);
+    #
+    #       `cmd > non_existing_file`   (create `non_existing_file` w content);
+    #       `cmd > existing_file`       (clear `existing_file`, write content);
+    #       `cmd < non_existing_file`   (error);
+    #       `cmd < existing_file`       (output as it was `stdin`);
+    #       `cmd >> non_existing_file`  (create `non_existing_file` w content);
+    #       `cmd >> existing_file`      (append `existing_file`);
+    # You see the same separator in a line twice: Error;
+    # You see `>` and `>>` separators in one line: Error;
+    # You see a separator after the redirection token: Error;
+    # You see more than one simple word after a separator redirecton: Error;
+    # Separators redirection combination (one input, one output): Correct work;
+"mkdir dir
+cd dir
+echo one > dir_file.txt
+cat dir_file.txt
+echo one > background_work_test.txt &
+cat background_work_test.txt
+echo one > background_work_test_2.txt&
+cat background_work_test.txt
+echo two > dir_file.txt
+cat dir_file.txt
+../test/test_program < non_existing_file
+../test/test_program < dir_file.txt
+echo one >> dir_file_2.txt
+cat dir_file_2.txt
+echo two >> dir_file_2.txt
+cat dir_file_2.txt
+> dir_file_3.txt
+cat dir_file_3.txt
+> dir_file.txt
+cat dir_file.txt
+< non_existing_file
+< dir_file_2.txt
+cat dir_file_2.txt
+>> dir_file_4.txt
+cat dir_file_4.txt
+>> dir_file_2.txt
+cat dir_file_2.txt
+../test/test_program < dir_file_2.txt > dir_file.txt
+cat dir_file.txt
+../test/test_program > dir_file.txt < dir_file_2.txt
+cat dir_file.txt
+../test/test_program > dir_file.txt < dir_file_2.txt &
+cat dir_file.txt
+> dir_file_2.txt
+../test/test_program > dir_file_2.txt dir_file.txt
+> ../test/test_program < dir_file.txt dir_file.txt
+../test/test_program > dir_file_2.txt dir_file.txt blabla
+../test/test_program < dir_file_2.txt dir_file.txt blabla
+../test/test_program >> dir_file.txt dir_file.txt
+../test/test_program >> dir_file.txt dir_file.txt blabla
+../test/test_program > dir_file_2.txt > dir_file.txt
+../test/test_program < dir_file.txt < dir_file_2.txt
+../test/test_program >> dir_file_2.txt > dir_file.txt
+../test/test_program > dir_file_2.txt >> dir_file.txt
+../test/test_program > && dir_file_2.txt
+../test/test_program>&&dir_file_2.txt
+cat dir_file_2.txt
+cat dir_file.txt
+cat ../LICENSE.txt | ../test/test_program | head -n 3
+cat ../LICENSE.txt | ../test/test_program | head -n 3 | grep 2024
+cat ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
+cat < ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
+cd ..
+rm -r dir"
+    # Test sequence
+    # Includes:
+    # The correct work of the `batch` builtin:
+    #       `batch cmd ::: items`       (items from the command line);
+    #       `... | batch cmd args`      (items from `stdin`);
+    #       `batch -P N cmd`            (parallel execution);
+    #       more items than fit into `ARG_MAX` (split into several runs);
+    # Incorrect `batch` usage: Error;
+"batch echo ::: one two three
+echo two three | batch echo one
+batch -P 2 echo one ::: two
+seq 1 300000 | batch -P 4 printf %.0s. | wc -c
+batch"
+    # Test sequence
+    # Includes:
+    # The correct work of the `parallel` builtin:
+    #       `parallel -k cmd {} ::: items`  (ordered output, `{}` substitution);
+    #       `... | parallel cmd`            (items from `stdin`, one per line);
+    #       failed jobs                     (summary of failures);
+    #       a job which closes its `stdout` early (the others go on);
+    # Incorrect `parallel` usage: Error;
+"parallel -k echo item {}.txt ::: one two three
+seq 1 200 | parallel -j 8 echo | wc -l
+parallel -j 2 sh -c \"exit {}\" ::: 0 3 0 5
+parallel -j 2 sh -c ::: \"exec >&-; sleep 1\" \"sleep 0.1; echo fast\" > par_test.txt &
+sleep 0.2; cat par_test.txt
+sleep 1; rm par_test.txt
+parallel -j 0 echo"
+    # Test sequence
+    # Includes:
+    # The correct work of the `cat` and `tee` builtins:
+    #       `cat file > file`           (file to file copying);
+    #       `cat file | cmd`            (the shell process writes the pipe);
+    #       `cmd | tee file > file`     (the shell process reads the pipe);
+    #       `cmd | tee -a file | cmd`   (appending, pipe to pipe copying);
+    #       `cat -n`, `tee --append`    (options, the external commands);
+    #       `cat file >> file`          (input file is output file, error);
+    #       `cat non_existing_file`     (error);
+"cat LICENSE.txt > cat_test.txt
+cat cat_test.txt | head -n 1
+cat LICENSE.txt | tee tee_test.txt > tee_test_2.txt
+cat tee_test.txt tee_test_2.txt | grep -c MIT
+echo one | tee -a tee_test.txt | cat
+tail -n 1 tee_test.txt
+echo one | cat -n
+echo two | tee --append tee_test.txt > /dev/null; tail -n 1 tee_test.txt
+cat tee_test.txt >> tee_test.txt; echo \$?
+cat non_existing_file
+rm cat_test.txt tee_test.txt tee_test_2.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `cmd << delimiter`          (here-document);
+    #       `cmd << delimiter`          (the body is expanded);
+    #       `cmd << \"delimiter\"`      (quoted, not expanded);
+    #       `cmd << delimiter | cmd`    (here-document in a pipeline);
+    #       `cmd <<< word`              (here-string);
+    # You see a here-string together with `<`: Error;
+"cat << EOF
+first line
+  second line
+EOF
+x=val
+cat << EOF
+a \$x \"q\" \\\$x \$((1+1)) \$(echo sub)
+EOF
+cat << \"EOF\"
+b \$x
+EOF
+wc -l << END | ./test/test_program
+one
+two
+END
+tr a-z A-Z <<< \"here string\"
+cat <<< one < LICENSE.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `cmd $(cmd)`                (command substitution, word splitting);
+    #       `cmd \"$(cmd)\"`            (quoted, no word splitting);
+    #       `cmd $(cmd $(cmd))`         (nested command substitution);
+    #       `cmd $(cd dir)`             (`cd` doesn't affect the shell);
+    #       `cmd $(cmd)`                (large output);
+"echo \$(echo one   two) three
+echo \"\$(ls -d src test)\"
+echo a\$(echo b)c
+echo \$(echo \$(echo nested) twice)
+echo x\$(cd test)y
+ls -d test
+wc -c <<< \"\$(seq 1 200000)\""
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `cmd <(cmd) <(cmd)`         (two producers, one consumer);
+    #       `cmd < <(cmd)`              (process substitution as a file name);
+    #       `cmd > >(cmd)`              (output process substitution);
+    #       `cmd | tee >(cmd)`          (output process substitution);
+    #       the shell's ends of the pipes aren't leaked into other commands;
+"cat <(echo one) <(echo two)
+paste <(seq 1 3) <(seq 4 6)
+wc -l < <(seq 1 5)
+echo three > >(tr a-z A-Z)
+seq 1 4 | tee >(wc -l) > /dev/null
+ls /proc/self/fd | wc -l"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `NAME=value`                (shell variable);
+    #       `$NAME`, `${NAME}`          (expansion, split unless quoted or
+    #                                   the value of an assignment);
+    #       `export NAME=value`         (variable in the environment);
+    #       `export NAME`, `${NAME-word}`, `${NAME:-word}` (still unset);
+    #       `NAME=value cmd`            (variable in the `cmd` environment);
+    #       `\$NAME`                    (a literal `$NAME`);
+    #       `unset NAME`                (expands to nothing);
+    # Bad substitution and bad variable name: Error;
+"x=\"one   two\"
+echo \$x
+echo \"\$x\" \${x}s
+export Y=exported
+printenv Y
+export W; echo \${W-unset} \${W:-empty}; printenv W; echo \$?
+W=assigned; printenv W; echo \${W-unset}
+v=\"p q\"; z=\$v; x=\$(echo a b); y=\$v printenv y; echo [\$z] [\$x]
+export FOO=outer; sh -c \"FOO=inner; echo \\\$FOO\"; echo \\\$FOO
+Z=temporary printenv Z
+printenv Z
+unset x Y
+echo [\$x] [\$Y] \$
+echo \${x y}
+export 1x"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `$((expr))`                 (C operators and precedence);
+    #       `$((NAME op= expr))`        (variables, assignments, `++`, `--`);
+    #       `$((a ? b : c))`            (only the chosen operand is evaluated);
+    #       64-bit overflow             (wraps around);
+    # Division by zero and syntax error: Error;
+"echo \$((1 + 2 * 3)) \$(( (1 + 2) * 3 )) \$((-7 / 2)) \$((-7 % 3)) \$((0x10 + 010))
+x=5
+echo \$((x * 2)) \$((\$x + 1)) \$((x += 3)) \$x \$((x++)) \$((--x)) \$x
+echo \$((x > 1 ? 1 : (y = 9))) [\$y] \$((0 && (z = 1))) [\$z] \$((a = b = 4, a + b))
+echo \$((9223372036854775807 + 1)) \$((1 << 65)) \$((~0)) \$((!5)) \$((5 ^ 3))
+echo \$((1 / 0)) not printed
+echo \$((2 * (x %= 0))) not printed
+echo \$((1 +))"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `for NAME in words; do list; done`
+    #       `while list; do list; done < file` (`read` from a redirection);
+    #       `cmd | while list; do list; done` (in a forked shell);
+    #       `if list; then list; else list; fi` (over several lines);
+    #       `break N`, `continue N`     (nested loops);
+    #       `until list; do list; done`;
+    #       `cmd; cmd`, `cmd && cmd`, `cmd || cmd` (lists);
+    #       `$(compound command)`;
+    #       `read NAME NAME`            (the last one takes the rest);
+    # You see a compound command followed by a `|`: Error;
+    # You see a `done` with no commands before it: Error;
+"for i in 1 2 3; do echo i=\$i; done
+seq 1 5 > loop_test.txt
+n=0; while read line; do n=\$((n + line)); done < loop_test.txt; echo \$n
+x=out; seq 3 | while read x; do echo [\$x]; done; echo \$x
+f() { cat loop_test.txt | while read x; do [ \$x = 3 ] && break; echo \$x; done; }; f; echo \"[\$(seq 2 | { read a; read b; echo \$b\$a; })]\"
+seq 2 | while read x; do echo \$x; done | sort
+if [ \$n -gt 10 ]
+then echo big
+else echo small
+fi
+for a in 1 2 3; do for b in x y z; do if [ \$b = y ]; then continue 2; fi; [ \$a = 3 ] && break 2; echo \$a\$b; done; done
+k=0; until [ \$k -ge 3 ]; do k=\$((k + 1)); done; echo k=\$k
+false || echo or && echo and; false && echo not printed
+echo \$(for w in a b; do echo \$w\$w; done)
+read x y <<< \"one two three\"
+echo [\$x] [\$y]
+for w in 1 2; do v=\"[\$w  x]\"; echo \"\$v\" \$v \$((w * 10))\$unset_var; done
+while true; do done
+rm loop_test.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `name() { list; }`          (`$1`, `$#`, `$@` inside it);
+    #       `name() compound-command`   (over several lines);
+    #       `return N`                  (the status of the call);
+    #       `for NAME; do list; done`, `shift` (the positional parameters);
+    #       `{ list; } > file`;
+    #       a function in a pipeline and a recursive one;
+    #       `alias NAME=VALUE`, `alias NAME`, `unalias NAME`;
+    # You see a `return` outside of a function: Error;
+"greet() { echo hello \$1 of \$#: \$@; }
+greet a b c
+check()
+{
+if [ \$1 = yes ]; then return 0; fi
+return 3
+}
+check yes && echo passed; check no || echo failed
+args() { for a; do echo arg \$a; done; shift 2; echo \$# left: \$1; }
+args x y z
+{ echo one; echo two; } > group_test.txt; cat group_test.txt
+greet piped | tr a-z A-Z
+count() { if [ \$1 -gt 0 ]; then echo -n \$1; count \$((\$1 - 1)); fi; }
+count 3; echo
+alias say=\"echo said\"
+say it twice
+alias say
+unalias say; alias say
+return 1
+rm group_test.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `my_shell FILE [ARG]...`    (`$0`, `$1`, `$#` of the script);
+    #       `my_shell -c TEXT`;
+    #       the last command of a script replaces the shell process (it has
+    #       the pid of the shell, the previous ones are its children);
+    #       `exec cmd`                  (the rest of the script isn't run);
+    #       `exec > file`               (the redirection stays in effect);
+    # You see an `exec` of a command that doesn't exist: Error;
+    # You see a script file that doesn't exist: Error;
+"printf \"cut -d%s -f4 /proc/self/stat\" \"\\\" \\\"\" > exec_test.sh; echo >> exec_test.sh; echo readlink /proc/self >> exec_test.sh
+./build/bin/my_shell exec_test.sh | uniq | wc -l
+echo true >> exec_test.sh; ./build/bin/my_shell exec_test.sh | uniq | wc -l
+printf \"echo %s0 %s1 %s#\" $ $ $ > exec_test.sh; echo >> exec_test.sh; echo exec echo replaced >> exec_test.sh; echo echo not printed >> exec_test.sh
+./build/bin/my_shell exec_test.sh a b
+./build/bin/my_shell -c \"exec > exec_test.txt; echo into file\"; cat exec_test.txt
+./build/bin/my_shell -c \"exec no_such_command\"
+./build/bin/my_shell no_such_script.sh
+rm exec_test.sh exec_test.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `$?`, `${?}`                (the status of the last command);
+    #       `$PIPESTATUS`               (the statuses of the pipeline stages);
+    #       `set -o pipefail`, `set +o pipefail`, `set -o`;
+    #       `exit N`                    (from a function inside a loop);
+    #       the exit status of `my_shell -c` (the one of its last command);
+    # You see an unknown option of the `set`: Error;
+"false; echo \$? \${?}
+true | false | true; echo \$PIPESTATUS \$?
+set -o pipefail; true | false | true; echo \$?
+set -o
+set +o pipefail; false | true; echo \$?
+./build/bin/my_shell -c \"f() { exit 4; }; for i in 1 2; do f; echo not printed; done\"; echo \$?
+./build/bin/my_shell -c \"true | false\"; echo \$?
+set -o nope; echo \$?"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `*`, `?`, `[...]`           (the matches are sorted);
+    #       the files starting with `.` match only an explicit `.`;
+    #       `"*"`, and a pattern matching nothing (kept as they are);
+    #       `*/`                        (the directories only);
+    #       the patterns in several path components;
+    #       `for NAME in pattern`, `[ ... ]` (isn't a pattern);
+"mkdir -p glob_dir/sub glob_dir/other
+touch glob_dir/a.txt glob_dir/b.txt glob_dir/ab.c glob_dir/.hidden glob_dir/sub/c.txt
+echo glob_dir/*.txt glob_dir/?b.c glob_dir/[ab].txt
+echo glob_dir/*
+echo \"glob_dir/*\" glob_dir/*.none glob_dir/\"*\".txt
+echo glob_dir/*/ glob_*/*/*.txt glob_dir/.*
+for f in glob_dir/*.c; do echo f=\$f; done; [ 1 = 1 ] && echo not a pattern
+rm -r glob_dir"
+    # Test sequence
+    # Includes:
+    # The correct work of the commands started by the zygote
+    # (`MY_SHELL_ZYGOTE=1`):
+    #       the pipelines, `cd`, `<<<`, `<`;
+    #       the environment: `NAME=value cmd`, `export`;
+    #       the exit status;
+"MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"echo a b | tr a-z A-Z; cd test; /bin/pwd | grep -o test; tr a-z A-Z <<< here\"
+MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"X=1 env | grep ^X=; export Y=2; env | grep ^Y=; false || echo failed\"
+MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"echo a | cat; cat < Makefile | head -n 1\""
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `my_shell --server PATH`    (removes the socket on `SIGTERM`);
+    #       `my_shell --connect PATH TEXT`:
+    #           the exit status, the working directory and the environment
+    #           of the client, its `stdin`, a syntax error in the TEXT;
+    #           no server at the PATH (error);
+"./build/bin/my_shell --server server_test.sock &
+./build/bin/my_shell --connect server_test.sock \"cd test; /bin/pwd | grep -o test; exit 3\"; echo \$?
+X=1 ./build/bin/my_shell --connect server_test.sock \"env | grep ^X=\"; pwd | grep -c test
+echo input | ./build/bin/my_shell --connect server_test.sock \"tr a-z A-Z\"
+./build/bin/my_shell --connect server_test.sock \"echo \\\"unterminated\"; echo \$?
+pkill -f \"my_shell --server server_test.sock\"
+[ -e server_test.sock ] || echo removed; ./build/bin/my_shell --connect server_test.sock true; echo \$?"
+    # Test sequence
+    # Includes:
+    # The correct work of the line editor (in a terminal made by `script`):
+    #       the lines typed are appended to the history file;
+    #       ^R (the reverse search), the up arrow (the previous entry);
+"printf \"echo one\\\\recho two\\\\r\\\\022on\\\\r\\\\033[A\\\\033[A\\\\r\\\\004\" > history_keys.txt
+sh -c \"sleep 0.2; cat history_keys.txt\" | MY_SHELL_HISTFILE=history_test.txt script -qc ./build/bin/my_shell /dev/null > /dev/null &
+sleep 0.3
+cat history_test.txt; rm history_keys.txt history_test.txt history_test.txt.index"
+    # Test sequence
+    # Includes:
+    # The correct work of the Tab completion (in a terminal made by `script`):
+    #       of a command name from the `PATH`;
+    #       of a command added to the `PATH` directory after the start;
+    #       of a directory and of a file path;
+    #       `PATH=dirs cmd` runs the `cmd` of its own `PATH`, not of the table;
+"mkdir completion_bin; printf \"#!/bin/sh\\\\necho tool\\\\n\" > completion_bin/my_shell_tool_one; chmod +x completion_bin/my_shell_tool_one
+printf \"my_shell_tool_o\\\\t>> completion_out.txt\\\\r\" > completion_keys_1.txt; printf \"my_shell_tool_t\\\\t>> completion_out.txt\\\\recho completion_bi\\\\tmy_shell_tool_o\\\\t>> completion_out.txt\\\\r\\\\004\" > completion_keys_2.txt
+sh -c \"sleep 0.2; cat completion_keys_1.txt; cp completion_bin/my_shell_tool_one completion_bin/my_shell_tool_two; sleep 0.1; cat completion_keys_2.txt\" | PATH=\$PWD/completion_bin:\$PATH MY_SHELL_HISTFILE=completion_history.txt script -qc ./build/bin/my_shell /dev/null > /dev/null &
+sleep 0.3
+printf \"#!/bin/sh\\\\necho fake ls\\\\n\" > completion_bin/ls; chmod +x completion_bin/ls; printf \"PATH=\$PWD/completion_bin ls\\\\nexit\\\\n\" | MY_SHELL_HISTFILE=completion_history.txt script -qc ./build/bin/my_shell /dev/null | grep -c \"fake ls\"
+cat completion_out.txt; rm -r completion_bin completion_keys_1.txt completion_keys_2.txt completion_out.txt completion_history.txt completion_history.txt.index"
+    # Test sequence
+    # Includes:
+    # The correct work of:
+    #       `pin CPU_LIST pipeline`     (the stages pinned to the CPUs);
+    #       `pin auto pipeline`;
+    #       a wrong CPU list, no command (errors);
+"pin 0 true | grep Cpus_allowed_list /proc/self/status | cut -f 2
+pin auto grep -c Cpus_allowed_list /proc/self/status
+pin 0-x true; echo \$?
+pin 0; echo \$?"
+    # Test sequence
+    # Includes:
+    # The correct work of `set -o bgnice`:
+    #       the background jobs get the batch policy and the nice value 10
+    #       by default, the foreground ones aren't changed;
+    #       `MY_SHELL_BG_SCHED`, `MY_SHELL_BG_NICE`, `MY_SHELL_BG_IOPRIO`;
+    #       a wrong value (error);
+"set -o bgnice; cut -d \" \" -f 19,41 /proc/self/stat > bgnice_test.txt &
+cat bgnice_test.txt; cut -d \" \" -f 19,41 /proc/self/stat
+MY_SHELL_BG_SCHED=idle; MY_SHELL_BG_NICE=5; MY_SHELL_BG_IOPRIO=idle; cut -d \" \" -f 19,41 /proc/self/stat > bgnice_test.txt & ionice > bgnice_test_2.txt &
+cat bgnice_test.txt bgnice_test_2.txt; rm bgnice_test.txt bgnice_test_2.txt
+MY_SHELL_BG_NICE=20; true &
+set -o"
+    # Test sequence
+    # Includes:
+    # The correct work of `my_shell --dump-tokens[=FORMAT] [file]`:
+    #       the text format (the one of the token printing build);
+    #       the descriptor of a redirection, `2>&1`;
+    #       the JSON format, from `stdin`;
+    #       the binary format;
+    #       a wrong format (error);
+"printf \"echo \\\"a  b\\\" *.c | wc -l > out 2>&1 &\\\\ncat <<END; done\\\\nbody\\\\nEND\\\\n\" > dump_test.txt
+./build/bin/my_shell --dump-tokens dump_test.txt
+./build/bin/my_shell --dump-tokens=json < dump_test.txt
+./build/bin/my_shell --dump-tokens=binary dump_test.txt | wc -c
+./build/bin/my_shell --dump-tokens=xml dump_test.txt; echo \$?; rm dump_test.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of the descriptor redirections:
+    #       `2>`, `2>&1` before a pipe, `&>`, `&>>`, `3>`, `1<>`;
+    #       `3>&-` (the descriptor closed);
+    #       `exec 3> file` and `exec 3>&-` in the shell process;
+    #       a descriptor redirected twice, `>&` with a file name (errors);
+    #       `>&3` ... `>&9` when none is open, the shell's own descriptors
+    #       are out of their reach, the zygote socket too (an error);
+"ls no_such_file 2> fd_test.txt; cat fd_test.txt | wc -l
+ls no_such_file 2>&1 | wc -l
+sh -c \"echo out; echo err >&2\" &> fd_test.txt; cat fd_test.txt
+sh -c \"echo err >&2\" &>> fd_test.txt; sh -c \"echo three >&3\" 3> fd_test_2.txt; cat fd_test.txt fd_test_2.txt
+echo new 1<> fd_test_2.txt; cat fd_test_2.txt
+sh -c \"echo x >&3\" 3>&-; echo \$?
+echo a 2>&1 2> fd_test.txt
+echo a >& fd_test.txt
+for n in 3 4 5 6 7 8 9; do /bin/echo x >&\$n; done; echo y >&9; echo \$?
+MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c \"/bin/echo hi >&3; echo one; /bin/echo two\"
+exec 3> fd_test_3.txt; echo three >&3; exec 3>&-; cat fd_test_3.txt; rm fd_test.txt fd_test_2.txt fd_test_3.txt"
+    # Test sequence
+    # Includes:
+    # The correct work of the rc file (`MY_SHELL_RC`):
+    #       the aliases, the functions, `set -o` and `export` of the rc file;
+    #       the cache of the parsed rc file, written next to it;
+    #       the cache of an rc file changed since (parsed again);
+    #       an incomplete rc file, a syntax error (errors, the shell starts);
+"printf \"alias say=echo\\\\ntwice() { say again; say again; }\\\\nset -o pipefail\\\\nexport RC_VAR=from_rc\\\\n\" > rc_test.txt
+MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"twice; printenv RC_VAR; set -o\"
+ls rc_test.txt*; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c twice
+echo \"echo changed\" >> rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c twice
+echo \"if true\" > rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"echo started\"
+echo fi > rc_test.txt; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c \"echo started\"; rm rc_test.txt rc_test.txt.cache"
+    # Test sequence
+    # Includes:
+    # The correct work of `set -o joblog`:
+    #       the output of a background job kept in its log, `joblog %N`;
+    #       a failed job, its log printed once it's done;
+    #       the list of the jobs, `joblog`;
+    #       a log smaller than the output (`MY_SHELL_JOBLOG_SIZE`);
+    #       an invalid log size, an unknown job, a wrong usage (errors);
+    #       the log of a job out of reach of `>&3` of another command;
+    #       the status of a job which exits while `batch` runs;
+    #       a script ending while a logged job runs (no exec of the last
+    #       command, which would close the pipe of the job);
+"set -o joblog; echo hi &
+sleep 0.2; joblog %1
+sh -c \"sleep 0.1; echo bad; exit 3\" &
+sleep 0.2
+joblog
+MY_SHELL_JOBLOG_SIZE=3; seq 10 &
+sleep 0.2; joblog %3
+MY_SHELL_JOBLOG_SIZE=x; echo no &
+echo \$?
+joblog %9; joblog x
+MY_SHELL_JOBLOG_SIZE=100; sh -c \"sleep 0.1; echo own\" &
+/bin/echo injected >&3; sleep 0.2; joblog %4
+sh -c \"sleep 0.1; exit 5\" &
+batch sleep ::: 0.3
+printf \"set -o joblog\\\\nsh -c \\\"sleep 0.1; echo late; echo written > jl_test.txt\\\" &\\\\nsleep 0.3\\\\n\" > jl_test.sh
+./build/bin/my_shell jl_test.sh
+cat jl_test.txt; rm jl_test.sh jl_test.txt"
+)
+
+# Expected outputs after EACH command in the sequence
+expected_outputs=(
+    # mkdir dir
+    ""
+    # cd dir
+    ""
+    # echo one > dir_file.txt
+    ""
+    # cat dir_file.txt
+    "one"
+    # echo one > background_work_test.txt &
+    ""
+    # cat background_work_test.txt
+    "one"
+    # echo one > background_work_test_2.txt&
+    ""
+    # cat background_work_test.txt
+    "one"
+    # echo two > dir_file.txt
+    ""
+    # cat dir_file.txt
+    "two"
+    # ../test/test_program < non_existing_file
+    "my_shell: non_existing_file: No such file or directory"
+    # ../test/test_program < dir_file.txt
+    "(two)"
+    # echo one >> dir_file_2.txt
+    ""
+    # cat dir_file_2.txt
+    "one"
+    # echo two >> dir_file_2.txt
+    ""
+    # cat dir_file_2.txt
+    $'one\ntwo'
+    # > dir_file_3.txt
+    ""
+    # cat dir_file_3.txt
+    ""
+    # > dir_file.txt
+    ""
+    # cat dir_file.txt
+    ""
+    # < non_existing_file
+    "my_shell: non_existing_file: No such file or directory"
+    # < dir_file_2.txt
+    ""
+    # cat dir_file_2.txt
+    $'one\ntwo'
+    # >> dir_file_4.txt
+    ""
+    # cat dir_file_4.txt
+    ""
+    # >> dir_file_2.txt
+    ""
+    # cat dir_file_2.txt
+    $'one\ntwo'
+    # ../test/test_program < dir_file_2.txt > dir_file.txt
+    ""
+    # cat dir_file.txt
+    $'(one)\n(two)'
+    # ../test/test_program > dir_file.txt < dir_file_2.txt
+    ""
+    # cat dir_file.txt
+    $'(one)\n(two)'
+    # ../test/test_program > dir_file.txt < dir_file_2.txt &
+    ""
+    # cat dir_file.txt
+    $'(one)\n(two)'
+    # > dir_file_2.txt
+    ""
+    # ../test/test_program > dir_file_2.txt dir_file.txt
+    "my_shell: Error: 2nd file name after IO redirection"
+    # > ../test/test_program < dir_file.txt dir_file.txt
+    "my_shell: Error: 2nd file name after IO redirection"
+    # ../test/test_program > dir_file_2.txt dir_file.txt blabla
+    "my_shell: Error: 2nd file name after IO redirection"
+    # ../test/test_program < dir_file_2.txt dir_file.txt blabla
+    "my_shell: Error: 2nd file name after IO redirection"
+    # ../test/test_program >> dir_file.txt dir_file.txt
+    "my_shell: Error: 2nd file name after IO redirection"
+    # ../test/test_program >> dir_file.txt dir_file.txt blabla
+    "my_shell: Error: 2nd file name after IO redirection"
+    # ../test/test_program > dir_file_2.txt > dir_file.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # ../test/test_program < dir_file.txt < dir_file_2.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # ../test/test_program >> dir_file_2.txt > dir_file.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # ../test/test_program > dir_file_2.txt >> dir_file.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # ../test/test_program > && dir_file_2.txt
+    "my_shell: Error: separator right after IO redirection"
+    # ../test/test_program>&&dir_file_2.txt
+    "my_shell: Error: separator right after IO redirection"
+    # cat dir_file_2.txt
+    ""
+    # cat dir_file.txt
+    $'(one)\n(two)'
+    # cat ../LICENSE.txt | ../test/test_program | head -n 3
+    $'(MIT) (License)\n\n(Copyright) ((c)) (2024) (FyodorPotseluev)'
+    # cat ../LICENSE.txt | ../test/test_program | head -n 3 | grep 2024
+    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
+    # cat ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
+    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
+    # cat < ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
+    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
+    # cd ..
+    ""
+    # rm -r dir
+    ""
+    # batch echo ::: one two three
+    "one two three"
+    # echo two three | batch echo one
+    "one two three"
+    # batch -P 2 echo one ::: two
+    "one two"
+    # seq 1 300000 | batch -P 4 printf %.0s. | wc -c
+    "300000"
+    # batch
+    "my_shell: batch: usage: batch [-P N] command [args...] [::: items...]"
+    # parallel -k echo item {}.txt ::: one two three
+    $'item one.txt\nitem two.txt\nitem three.txt'
+    # seq 1 200 | parallel -j 8 echo | wc -l
+    "200"
+    # parallel -j 2 sh -c \"exit {}\" ::: 0 3 0 5
+    $'my_shell: parallel: 2 of 4 jobs failed:\nmy_shell: parallel:     3 (status 3)\nmy_shell: parallel:     5 (status 5)'
+    # parallel -j 2 sh -c ::: "exec >&-; sleep 1" "sleep 0.1; ...
+    ""
+    # sleep 0.2; cat par_test.txt
+    "fast"
+    # sleep 1; rm par_test.txt
+    ""
+    # parallel -j 0 echo
+    "my_shell: parallel: usage: parallel [-j N] [-k] command [args...] [::: items...]"
+    # cat LICENSE.txt > cat_test.txt
+    ""
+    # cat cat_test.txt | head -n 1
+    "MIT License"
+    # cat LICENSE.txt | tee tee_test.txt > tee_test_2.txt
+    ""
+    # cat tee_test.txt tee_test_2.txt | grep -c MIT
+    "4"
+    # echo one | tee -a tee_test.txt | cat
+    "one"
+    # tail -n 1 tee_test.txt
+    "one"
+    # echo one | cat -n
+    $'     1\tone'
+    # echo two | tee --append tee_test.txt > /dev/null; tail -n 1 tee_test.txt
+    "two"
+    # cat tee_test.txt >> tee_test.txt; echo $?
+    $'my_shell: cat: tee_test.txt: input file is output file\n1'
+    # cat non_existing_file
+    "my_shell: cat: non_existing_file: No such file or directory"
+    # rm cat_test.txt tee_test.txt tee_test_2.txt
+    ""
+    # cat << EOF
+    ""
+    # first line
+    ""
+    #   second line
+    ""
+    # EOF
+    $'first line\n  second line'
+    # x=val
+    ""
+    # cat << EOF
+    ""
+    # a $x \"q\" \\$x $((1+1)) $(echo sub)
+    ""
+    # EOF
+    "a val \"q\" \$x 2 sub"
+    # cat << \"EOF\"
+    ""
+    # b $x
+    ""
+    # EOF
+    "b \$x"
+    # wc -l << END | ./test/test_program
+    ""
+    # one
+    ""
+    # two
+    ""
+    # END
+    "(2)"
+    # tr a-z A-Z <<< \"here string\"
+    "HERE STRING"
+    # cat <<< one < LICENSE.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # echo $(echo one   two) three
+    "one two three"
+    # echo \"$(ls -d src test)\"
+    $'src\ntest'
+    # echo a$(echo b)c
+    "abc"
+    # echo $(echo $(echo nested) twice)
+    "nested twice"
+    # echo x$(cd test)y
+    "xy"
+    # ls -d test
+    "test"
+    # wc -c <<< \"$(seq 1 200000)\"
+    "1288895"
+    # cat <(echo one) <(echo two)
+    $'one\ntwo'
+    # paste <(seq 1 3) <(seq 4 6)
+    $'1\t4\n2\t5\n3\t6'
+    # wc -l < <(seq 1 5)
+    "5"
+    # echo three > >(tr a-z A-Z)
+    "THREE"
+    # seq 1 4 | tee >(wc -l) > /dev/null
+    "4"
+    # ls /proc/self/fd | wc -l
+    "4"
+    # x=\"one   two\"
+    ""
+    # echo $x
+    "one two"
+    # echo \"$x\" ${x}s
+    "one   two one twos"
+    # export Y=exported
+    ""
+    # printenv Y
+    "exported"
+    # export W; echo ${W-unset} ${W:-empty}; printenv W; echo $?
+    $'unset empty\n1'
+    # W=assigned; printenv W; echo ${W-unset}
+    $'assigned\nassigned'
+    # v="p q"; z=$v; x=$(echo a b); y=$v printenv y; echo [$z] [$x]
+    $'p q\n[p q] [a b]'
+    # export FOO=outer; sh -c "FOO=inner; echo \$FOO"; echo \$FOO
+    $'inner\n$FOO'
+    # Z=temporary printenv Z
+    "temporary"
+    # printenv Z
+    ""
+    # unset x Y
+    ""
+    # echo [$x] [$Y] $
+    "[] [] $"
+    # echo ${x y}
+    "my_shell: Error: bad substitution"
+    # export 1x
+    $'my_shell: export: `1x\': not a valid identifier'
+    # echo $((1 + 2 * 3)) $(( (1 + 2) * 3 )) $((-7 / 2)) ...
+    "7 9 -3 -1 24"
+    # x=5
+    ""
+    # echo $((x * 2)) $(($x + 1)) $((x += 3)) $x $((x++)) $((--x)) $x
+    "10 6 8 8 8 8 8"
+    # echo $((x > 1 ? 1 : (y = 9))) [$y] $((0 && (z = 1))) [$z] ...
+    "1 [] 0 [] 8"
+    # echo $((9223372036854775807 + 1)) $((1 << 65)) $((~0)) $((!5)) ...
+    "-9223372036854775808 2 -1 0 6"
+    # echo $((1 / 0)) not printed
+    'my_shell: 1 / 0: division by 0 (error token is "/ 0")'
+    # echo $((2 * (x %= 0))) not printed
+    'my_shell: 2 * (x %= 0): division by 0 (error token is "%= 0)")'
+    # echo $((1 +))
+    'my_shell: 1 +: operand expected (error token is "")'
+    # for i in 1 2 3; do echo i=$i; done
+    $'i=1\ni=2\ni=3'
+    # seq 1 5 > loop_test.txt
+    ""
+    # n=0; while read line; do n=$((n + line)); done < loop_test.txt; ...
+    "15"
+    # x=out; seq 3 | while read x; do echo [$x]; done; echo $x
+    $'[1]\n[2]\n[3]\nout'
+    # f() { cat loop_test.txt | while read x; do [ $x = 3 ] && break; ...
+    $'1\n2\n[21]'
+    # seq 2 | while read x; do echo $x; done | sort
+    "my_shell: syntax error near unexpected token \`|'"
+    # if [ $n -gt 10 ]
+    ""
+    # then echo big
+    ""
+    # else echo small
+    ""
+    # fi
+    "big"
+    # for a in 1 2 3; do for b in x y z; do if [ $b = y ]; then ...
+    $'1x\n2x'
+    # k=0; until [ $k -ge 3 ]; do k=$((k + 1)); done; echo k=$k
+    "k=3"
+    # false || echo or && echo and; false && echo not printed
+    $'or\nand'
+    # echo $(for w in a b; do echo $w$w; done)
+    "aa bb"
+    # read x y <<< \"one two three\"
+    ""
+    # echo [$x] [$y]
+    "[one] [two three]"
+    # for w in 1 2; do v="[$w  x]"; echo "$v" $v $((w * 10))$unset_var; done
+    $'[1  x] [1 x] 10\n[2  x] [2 x] 20'
+    # while true; do done
+    "my_shell: syntax error near unexpected token \`done'"
+    # rm loop_test.txt
+    ""
+    # greet() { echo hello $1 of $#: $@; }
+    ""
+    # greet a b c
+    "hello a of 3: a b c"
+    # check()
+    ""
+    # {
+    ""
+    # if [ $1 = yes ]; then return 0; fi
+    ""
+    # return 3
+    ""
+    # }
+    ""
+    # check yes && echo passed; check no || echo failed
+    $'passed\nfailed'
+    # args() { for a; do echo arg $a; done; shift 2; echo $# left: $1; }
+    ""
+    # args x y z
+    $'arg x\narg y\narg z\n1 left: z'
+    # { echo one; echo two; } > group_test.txt; cat group_test.txt
+    $'one\ntwo'
+    # greet piped | tr a-z A-Z
+    "HELLO PIPED OF 1: PIPED"
+    # count() { if [ $1 -gt 0 ]; then echo -n $1; count $(($1 - 1)); fi; }
+    ""
+    # count 3; echo
+    "321"
+    # alias say=\"echo said\"
+    ""
+    # say it twice
+    "said it twice"
+    # alias say
+    "alias say='echo said'"
+    # unalias say; alias say
+    "my_shell: alias: say: not found"
+    # return 1
+    "my_shell: return: can only \`return' from a function"
+    # rm group_test.txt
+    ""
+    # printf "cut -d%s -f4 /proc/self/stat" ... > exec_test.sh; ...
+    ""
+    # ./build/bin/my_shell exec_test.sh | uniq | wc -l
+    "1"
+    # echo true >> exec_test.sh; ./build/bin/my_shell exec_test.sh | uniq ...
+    "2"
+    # printf "echo %s0 %s1 %s#" $ $ $ > exec_test.sh; ...
+    ""
+    # ./build/bin/my_shell exec_test.sh a b
+    $'exec_test.sh a 2\nreplaced'
+    # ./build/bin/my_shell -c "exec > exec_test.txt; echo into file"; ...
+    "into file"
+    # ./build/bin/my_shell -c "exec no_such_command"
+    "my_shell: exec: no_such_command: No such file or directory"
+    # ./build/bin/my_shell no_such_script.sh
+    "my_shell: no_such_script.sh: No such file or directory"
+    # rm exec_test.sh exec_test.txt
+    ""
+    # false; echo $? ${?}
+    "1 1"
+    # true | false | true; echo $PIPESTATUS $?
+    "0 1 0 0"
+    # set -o pipefail; true | false | true; echo $?
+    "1"
+    # set -o
+    $'bgnice\toff\njoblog\toff\npipefail\ton'
+    # set +o pipefail; false | true; echo $?
+    "0"
+    # ./build/bin/my_shell -c "f() { exit 4; }; for i in 1 2; do f; ..."; ...
+    "4"
+    # ./build/bin/my_shell -c "true | false"; echo $?
+    "1"
+    # set -o nope; echo $?
+    $'my_shell: set: nope: invalid option name\n2'
+    # mkdir -p glob_dir/sub glob_dir/other
+    ""
+    # touch glob_dir/a.txt glob_dir/b.txt glob_dir/ab.c ...
+    ""
+    # echo glob_dir/*.txt glob_dir/?b.c glob_dir/[ab].txt
+    "glob_dir/a.txt glob_dir/b.txt glob_dir/ab.c glob_dir/a.txt glob_dir/b.txt"
+    # echo glob_dir/*
+    "glob_dir/a.txt glob_dir/ab.c glob_dir/b.txt glob_dir/other glob_dir/sub"
+    # echo \"glob_dir/*\" glob_dir/*.none glob_dir/\"*\".txt
+    "glob_dir/* glob_dir/*.none glob_dir/*.txt"
+    # echo glob_dir/*/ glob_*/*/*.txt glob_dir/.*
+    "glob_dir/other/ glob_dir/sub/ glob_dir/sub/c.txt glob_dir/.hidden"
+    # for f in glob_dir/*.c; do echo f=$f; done; [ 1 = 1 ] && echo ...
+    $'f=glob_dir/ab.c\nnot a pattern'
+    # rm -r glob_dir
+    ""
+    # MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c "echo a b | tr a-z A-Z; ...
+    $'A B\ntest\nHERE'
+    # MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c "X=1 env | grep ^X=; ...
+    $'X=1\nY=2\nfailed'
+    # MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c "echo a | cat; ...
+    $'a\nPROJECT := my_shell'
+    # ./build/bin/my_shell --server server_test.sock &
+    ""
+    # ./build/bin/my_shell --connect server_test.sock "cd test; ...
+    $'test\n3'
+    # X=1 ./build/bin/my_shell --connect server_test.sock "env | grep ^X="; ...
+    $'X=1\n0'
+    # echo input | ./build/bin/my_shell --connect server_test.sock ...
+    "INPUT"
+    # ./build/bin/my_shell --connect server_test.sock "echo \"unterminated"; ...
+    $'my_shell: Error: unmatched quotes\n2'
+    # pkill -f "my_shell --server server_test.sock"
+    ""
+    # [ -e server_test.sock ] || echo removed; ./build/bin/my_shell ...
+    $'removed\nmy_shell: server_test.sock: No such file or directory\n1'
+    # printf "echo one\\recho two\\r..." > history_keys.txt
+    ""
+    # sh -c "sleep 0.2; cat history_keys.txt" | ... script ... &
+    ""
+    # sleep 0.3
+    ""
+    # cat history_test.txt; rm history_keys.txt history_test.txt history_test.txt.index
+    $'echo one\necho two\necho one\necho two'
+    # mkdir completion_bin; printf "#!/bin/sh\\necho tool\\n" > ...
+    ""
+    # printf "my_shell_tool_o\\t>> completion_out.txt\\r" > ...
+    ""
+    # sh -c "sleep 0.2; cat completion_keys_1.txt; cp ...; cat ..." | ... &
+    ""
+    # sleep 0.3
+    ""
+    # printf "#!/bin/sh\\necho fake ls\\n" > completion_bin/ls; ...; script ...
+    "1"
+    # cat completion_out.txt; rm -r completion_bin ...
+    $'tool\ntool\ncompletion_bin/my_shell_tool_one'
+    # pin 0 true | grep Cpus_allowed_list /proc/self/status | cut -f 2
+    "0"
+    # pin auto grep -c Cpus_allowed_list /proc/self/status
+    "1"
+    # pin 0-x true; echo $?
+    $'my_shell: pin: 0-x: invalid CPU list\n2'
+    # pin 0; echo $?
+    $'my_shell: pin: usage: pin auto|CPU_LIST command...\n2'
+    # set -o bgnice; cut -d " " -f 19,41 /proc/self/stat > bgnice_test.txt &
+    ""
+    # cat bgnice_test.txt; cut -d " " -f 19,41 /proc/self/stat
+    $'10 3\n0 0'
+    # MY_SHELL_BG_SCHED=idle; MY_SHELL_BG_NICE=5; MY_SHELL_BG_IOPRIO=idle; ...
+    ""
+    # cat bgnice_test.txt bgnice_test_2.txt; rm bgnice_test.txt ...
+    $'5 5\nidle'
+    # MY_SHELL_BG_NICE=20; true &
+    "my_shell: MY_SHELL_BG_NICE: 20: invalid value"
+    # set -o
+    $'bgnice\ton\njoblog\toff\npipefail\toff'
+    # printf "echo \"a  b\" *.c | wc -l > out 2>&1 &\\ncat <<END; ..." > dump_test.txt
+    ""
+    # ./build/bin/my_shell --dump-tokens dump_test.txt
+    $'[echo]\n[a  b]\n[*.c]\n[pipe_operator]\n[wc]\n[-l]\n[output_redirection]\n[out]\n[duplication_redirection 2]\n[1]\n[background_operator]\n[cat]\n[here_document]\n[body\n]\n[command_separator]\n[done]'
+    # ./build/bin/my_shell --dump-tokens=json < dump_test.txt
+    $'["echo","a  b","*.c",{"separator":"pipe_operator"},"wc","-l",{"separator":"output_redirection"},"out",{"separator":"duplication_redirection","fd":2},"1",{"separator":"background_operator"}]\n["cat",{"separator":"here_document"},"body\\n",{"separator":"command_separator"},"done"]'
+    # ./build/bin/my_shell --dump-tokens=binary dump_test.txt | wc -c
+    "95"
+    # ./build/bin/my_shell --dump-tokens=xml dump_test.txt; echo $?; rm dump_test.txt
+    $'my_shell: --dump-tokens: xml: unknown format, use text, json or binary\n2'
+    # ls no_such_file 2> fd_test.txt; cat fd_test.txt | wc -l
+    "1"
+    # ls no_such_file 2>&1 | wc -l
+    "1"
+    # sh -c "echo out; echo err >&2" &> fd_test.txt; cat fd_test.txt
+    $'out\nerr'
+    # sh -c "echo err >&2" &>> fd_test.txt; sh -c "echo three >&3" 3> ...
+    $'out\nerr\nerr\nthree'
+    # echo new 1<> fd_test_2.txt; cat fd_test_2.txt
+    $'new\ne'
+    # sh -c "echo x >&3" 3>&-; echo $?
+    $'sh: 1: 3: Bad file descriptor\n2'
+    # echo a 2>&1 2> fd_test.txt
+    "my_shell: Error: > or < used twice, or > together with >>"
+    # echo a >& fd_test.txt
+    "my_shell: Error: a file descriptor or - expected after >& or <&"
+    # for n in 3 4 5 6 7 8 9; do /bin/echo x >&$n; done; echo y >&9; echo $?
+    $'my_shell: 3: Bad file descriptor\nmy_shell: 4: Bad file descriptor\nmy_shell: 5: Bad file descriptor\nmy_shell: 6: Bad file descriptor\nmy_shell: 7: Bad file descriptor\nmy_shell: 8: Bad file descriptor\nmy_shell: 9: Bad file descriptor\nmy_shell: 9: Bad file descriptor\n1'
+    # MY_SHELL_ZYGOTE=1 ./build/bin/my_shell -c "/bin/echo hi >&3; echo one; ..."
+    $'my_shell: 3: Bad file descriptor\none\ntwo'
+    # exec 3> fd_test_3.txt; echo three >&3; exec 3>&-; cat fd_test_3.txt; ...
+    "three"
+    # printf "alias say=echo\\ntwice() { say again; ... }\\n..." > rc_test.txt
+    ""
+    # MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c "twice; ...; set -o"
+    $'again\nagain\nfrom_rc\nbgnice\toff\njoblog\toff\npipefail\ton'
+    # ls rc_test.txt*; MY_SHELL_RC=rc_test.txt ./build/bin/my_shell -c twice
+    $'rc_test.txt\nrc_test.txt.cache\nagain\nagain'
+    # echo "echo changed" >> rc_test.txt; MY_SHELL_RC=rc_test.txt ...
+    $'changed\nagain\nagain'
+    # echo "if true" > rc_test.txt; MY_SHELL_RC=rc_test.txt ...
+    $'my_shell: rc_test.txt: syntax error: unexpected end of file\nstarted'
+    # echo fi > rc_test.txt; MY_SHELL_RC=rc_test.txt ...; rm rc_test.txt ...
+    $'my_shell: syntax error near unexpected token `fi\'\nstarted'
+    # set -o joblog; echo hi &
+    ""
+    # sleep 0.2; joblog %1
+    "hi"
+    # sh -c "sleep 0.1; echo bad; exit 3" &
+    ""
+    # sleep 0.2
+    $'[2] Exit 3\tsh -c sleep 0.1; echo bad; exit 3 &\nbad'
+    # joblog
+    $'[1] Done\techo hi &\n[2] Exit 3\tsh -c sleep 0.1; echo bad; exit 3 &'
+    # MY_SHELL_JOBLOG_SIZE=3; seq 10 &
+    ""
+    # sleep 0.2; joblog %3
+    $'my_shell: joblog: %3: the first 18 bytes have been dropped\n10'
+    # MY_SHELL_JOBLOG_SIZE=x; echo no &
+    "my_shell: MY_SHELL_JOBLOG_SIZE: x: invalid value"
+    # echo $?
+    "1"
+    # joblog %9; joblog x
+    $'my_shell: joblog: %9: no such job\nmy_shell: joblog: usage: joblog [%N]'
+    # MY_SHELL_JOBLOG_SIZE=100; sh -c "sleep 0.1; echo own" &
+    ""
+    # /bin/echo injected >&3; sleep 0.2; joblog %4
+    $'my_shell: 3: Bad file descriptor\nown'
+    # sh -c "sleep 0.1; exit 5" &
+    ""
+    # batch sleep ::: 0.3
+    $'[5] Exit 5\tsh -c sleep 0.1; exit 5 &'
+    # printf "set -o joblog\\nsh -c \"sleep 0.1; ...\" &\\nsleep 0.3\\n" > jl_test.sh
+    ""
+    # ./build/bin/my_shell jl_test.sh
+    ""
+    # cat jl_test.txt; rm jl_test.sh jl_test.txt
+    "written"
+)
+
+# The sequences relying on the pause the `session_test.sh` makes after every
+# command, the background job of one command is done by the next one. The
+# in-process test, which runs a sequence as a script, leaves them out. The
+# numbers start with 1
+paced_sequences=( 1 16 20 )
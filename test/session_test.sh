@@ -1,194 +1,7 @@
 #!/usr/bin/env bash
-# Test sequences - each sequence represents a continuous shell session
-sequences=(
-    # Test sequence
-    # Includes:
-    # The correct work of:
-    #       `> non_existing_file`       (create `non_existing_file`);
-    #       `> existing_file`           (clear `existing_file`);
-    #       `< non_existing_file`       (error);
-    #       `< existing_file`           (nothing happens);
-    #       `>> non_existing_file`      (create `non_existing_file`);
-    #       `>> existing_file`          (nothing happens);
-    #
-    #       `cmd > non_existing_file`   (create `non_existing_file` w content);
-    #       `cmd > existing_file`       (clear `existing_file`, write content);
-    #       `cmd < non_existing_file`   (error);
-    #       `cmd < existing_file`       (output as it was `stdin`);
-    #       `cmd >> non_existing_file`  (create `non_existing_file` w content);
-    #       `cmd >> existing_file`      (append `existing_file`);
-    # You see the same separator in a line twice: Error;
-    # You see `>` and `>>` separators in one line: Error;
-    # You see a separator after the redirection token: Error;
-    # You see more than one simple word after a separator redirecton: Error;
-    # Separators redirection combination (one input, one output): Correct work;
-"mkdir dir
-cd dir
-echo one > dir_file.txt
-cat dir_file.txt
-echo one > background_work_test.txt &
-cat background_work_test.txt
-echo one > background_work_test_2.txt&
-cat background_work_test.txt
-echo two > dir_file.txt
-cat dir_file.txt
-../test/test_program < non_existing_file
-../test/test_program < dir_file.txt
-echo one >> dir_file_2.txt
-cat dir_file_2.txt
-echo two >> dir_file_2.txt
-cat dir_file_2.txt
-> dir_file_3.txt
-cat dir_file_3.txt
-> dir_file.txt
-cat dir_file.txt
-< non_existing_file
-< dir_file_2.txt
-cat dir_file_2.txt
->> dir_file_4.txt
-cat dir_file_4.txt
->> dir_file_2.txt
-cat dir_file_2.txt
-../test/test_program < dir_file_2.txt > dir_file.txt
-cat dir_file.txt
-../test/test_program > dir_file.txt < dir_file_2.txt
-cat dir_file.txt
-../test/test_program > dir_file.txt < dir_file_2.txt &
-cat dir_file.txt
-> dir_file_2.txt
-../test/test_program > dir_file_2.txt dir_file.txt
-> ../test/test_program < dir_file.txt dir_file.txt
-../test/test_program > dir_file_2.txt dir_file.txt blabla
-../test/test_program < dir_file_2.txt dir_file.txt blabla
-../test/test_program >> dir_file.txt dir_file.txt
-../test/test_program >> dir_file.txt dir_file.txt blabla
-../test/test_program > dir_file_2.txt > dir_file.txt
-../test/test_program < dir_file.txt < dir_file_2.txt
-../test/test_program >> dir_file_2.txt > dir_file.txt
-../test/test_program > dir_file_2.txt >> dir_file.txt
-../test/test_program > && dir_file_2.txt
-../test/test_program>&&dir_file_2.txt
-cat dir_file_2.txt
-cat dir_file.txt
-cat ../LICENSE.txt | ../test/test_program | head -n 3
-cat ../LICENSE.txt | ../test/test_program | head -n 3 | grep 2024
-cat ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-cat < ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-cd ..
-rm -r dir"
-)
 
-# Expected outputs after EACH command in the sequence
-expected_outputs=(
-    # mkdir dir
-    ""
-    # cd dir
-    ""
-    # echo one > dir_file.txt
-    ""
-    # cat dir_file.txt
-    "one"
-    # echo one > background_work_test.txt &
-    ""
-    # cat background_work_test.txt
-    "one"
-    # echo one > background_work_test_2.txt&
-    ""
-    # cat background_work_test.txt
-    "one"
-    # echo two > dir_file.txt
-    ""
-    # cat dir_file.txt
-    "two"
-    # ../test/test_program < non_existing_file
-    "my_shell: non_existing_file: No such file or directory"
-    # ../test/test_program < dir_file.txt
-    "(two)"
-    # echo one >> dir_file_2.txt
-    ""
-    # cat dir_file_2.txt
-    "one"
-    # echo two >> dir_file_2.txt
-    ""
-    # cat dir_file_2.txt
-    $'one\ntwo'
-    # > dir_file_3.txt
-    ""
-    # cat dir_file_3.txt
-    ""
-    # > dir_file.txt
-    ""
-    # cat dir_file.txt
-    ""
-    # < non_existing_file
-    "my_shell: non_existing_file: No such file or directory"
-    # < dir_file_2.txt
-    ""
-    # cat dir_file_2.txt
-    $'one\ntwo'
-    # >> dir_file_4.txt
-    ""
-    # cat dir_file_4.txt
-    ""
-    # >> dir_file_2.txt
-    ""
-    # cat dir_file_2.txt
-    $'one\ntwo'
-    # ../test/test_program < dir_file_2.txt > dir_file.txt
-    ""
-    # cat dir_file.txt
-    $'(one)\n(two)'
-    # ../test/test_program > dir_file.txt < dir_file_2.txt
-    ""
-    # cat dir_file.txt
-    $'(one)\n(two)'
-    # ../test/test_program > dir_file.txt < dir_file_2.txt &
-    ""
-    # cat dir_file.txt
-    $'(one)\n(two)'
-    # > dir_file_2.txt
-    ""
-    # ../test/test_program > dir_file_2.txt dir_file.txt
-    "my_shell: Error: 2nd file name after IO redirection"
-    # > ../test/test_program < dir_file.txt dir_file.txt
-    "my_shell: Error: 2nd file name after IO redirection"
-    # ../test/test_program > dir_file_2.txt dir_file.txt blabla
-    "my_shell: Error: 2nd file name after IO redirection"
-    # ../test/test_program < dir_file_2.txt dir_file.txt blabla
-    "my_shell: Error: 2nd file name after IO redirection"
-    # ../test/test_program >> dir_file.txt dir_file.txt
-    "my_shell: Error: 2nd file name after IO redirection"
-    # ../test/test_program >> dir_file.txt dir_file.txt blabla
-    "my_shell: Error: 2nd file name after IO redirection"
-    # ../test/test_program > dir_file_2.txt > dir_file.txt
-    "my_shell: Error: > or < used twice, or > together with >>"
-    # ../test/test_program < dir_file.txt < dir_file_2.txt
-    "my_shell: Error: > or < used twice, or > together with >>"
-    # ../test/test_program >> dir_file_2.txt > dir_file.txt
-    "my_shell: Error: > or < used twice, or > together with >>"
-    # ../test/test_program > dir_file_2.txt >> dir_file.txt
-    "my_shell: Error: > or < used twice, or > together with >>"
-    # ../test/test_program > && dir_file_2.txt
-    "my_shell: Error: separator right after IO redirection"
-    # ../test/test_program>&&dir_file_2.txt
-    "my_shell: Error: separator right after IO redirection"
-    # cat dir_file_2.txt
-    ""
-    # cat dir_file.txt
-    $'(one)\n(two)'
-    # cat ../LICENSE.txt | ../test/test_program | head -n 3
-    $'(MIT) (License)\n\n(Copyright) ((c)) (2024) (FyodorPotseluev)'
-    # cat ../LICENSE.txt | ../test/test_program | head -n 3 | grep 2024
-    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
-    # cat ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
-    # cat < ../LICENSE.txt | cat | cat | ../test/test_program | cat | head -n 3 | cat | grep 2024
-    "(Copyright) ((c)) (2024) (FyodorPotseluev)"
-    # cd ..
-    ""
-    # rm -r dir
-    ""
-)
+source ./test/session_cases.sh
+
 # Run tests
 passed=0
 total=${#sequences[@]}